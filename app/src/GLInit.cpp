@@ -94,6 +94,12 @@ namespace TrenchBroom {
     static Func4<void, GLenum, GLsizei, GLenum, const GLvoid*>& _glDrawElements = glDrawElements;
     static Func6<void, GLenum, GLuint, GLuint, GLsizei, GLenum, const GLvoid*>& _glDrawRangeElements = glDrawRangeElements;
     static Func5<void, GLenum, const GLsizei*, GLenum, const GLvoid**, GLsizei>& _glMultiDrawElements = glMultiDrawElements;
+    
+    static Func0<GLboolean>& _glInstancingSupported = glInstancingSupported;
+    static Func4<void, GLenum, GLint, GLsizei, GLsizei>& _glDrawArraysInstanced = glDrawArraysInstanced;
+    static Func2<void, GLuint, GLuint>& _glVertexAttribDivisor = glVertexAttribDivisor;
+    
+    static Func0<GLboolean>& _glHalfFloatVerticesSupported = glHalfFloatVerticesSupported;
 
     static Func1<GLuint, GLenum>& _glCreateShader = glCreateShader;
     static Func1<void, GLuint>& _glDeleteShader = glDeleteShader;
@@ -148,6 +154,7 @@ namespace TrenchBroom {
     static Func4<void, GLint, GLsizei, GLboolean, const GLfloat*>& _glUniformMatrix4x3fv = glUniformMatrix4x3fv;
     
     static Func2<GLint, GLuint, const GLchar*>& _glGetUniformLocation = glGetUniformLocation;
+    static Func2<GLint, GLuint, const GLchar*>& _glGetAttribLocation = glGetAttribLocation;
     
 #ifdef __APPLE__
     static Func2<void, GLenum, GLint>& _glFinishObjectAPPLE = glFinishObjectAPPLE;
@@ -157,6 +164,14 @@ namespace TrenchBroom {
 #include <GL/glew.h>
 
 namespace TrenchBroom {
+    static GLboolean instancingSupported() {
+        return GLEW_ARB_draw_instanced && GLEW_ARB_instanced_arrays;
+    }
+    
+    static GLboolean halfFloatVerticesSupported() {
+        return GLEW_VERSION_3_0 || GLEW_ARB_half_float_vertex;
+    }
+    
     static void initRemainingFunctions() {
         _glGetError.bindFunc(&::glGetError);
         _glGetString.bindFunc(&::glGetString);
@@ -227,6 +242,12 @@ namespace TrenchBroom {
         _glDrawRangeElements.bindFunc(glDrawRangeElements);
         _glMultiDrawElements.bindFunc(glMultiDrawElements);
         
+        _glInstancingSupported.bindFunc(&instancingSupported);
+        _glDrawArraysInstanced.bindFunc(glDrawArraysInstancedARB);
+        _glVertexAttribDivisor.bindFunc(glVertexAttribDivisorARB);
+        
+        _glHalfFloatVerticesSupported.bindFunc(&halfFloatVerticesSupported);
+        
         _glCreateShader.bindFunc(glCreateShader);
         _glDeleteShader.bindFunc(glDeleteShader);
         _glShaderSource.bindFunc(glShaderSource);
@@ -280,6 +301,7 @@ namespace TrenchBroom {
         _glUniformMatrix4x3fv.bindFunc(glUniformMatrix4x3fv);
         
         _glGetUniformLocation.bindFunc(glGetUniformLocation);
+        _glGetAttribLocation.bindFunc(glGetAttribLocation);
         
 #ifdef __APPLE__
         _glFinishObjectAPPLE.bindFunc(glFinishObjectAPPLE);
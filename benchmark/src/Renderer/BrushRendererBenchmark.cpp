@@ -142,6 +142,29 @@ namespace TrenchBroom {
             VectorUtils::clearAndDelete(brushes);
             VectorUtils::clearAndDelete(textures);
         }
+
+        TEST(BrushRendererBenchmark, benchVertexFormats) {
+            auto brushesTextures = makeBrushes();
+            std::vector<Model::Brush*> brushes = brushesTextures.first;
+            std::vector<Assets::Texture*> textures = brushesTextures.second;
+
+            const std::vector<std::pair<BrushVertexFormat, std::string>> formats = {
+                { BrushVertexFormat::Full, "full" },
+                { BrushVertexFormat::Compact, "compact" }
+            };
+
+            for (const auto& [format, name] : formats) {
+                BrushRenderer r(false);
+                r.setVertexFormat(format);
+                r.addBrushes(brushes);
+
+                timeLambda([&](){ r.validate(); }, "validate " + std::to_string(brushes.size()) + " brushes with " + name + " vertices");
+                printf("Vertex data size with %s vertices: %zu bytes\n", name.c_str(), r.vertexDataSize());
+            }
+
+            VectorUtils::clearAndDelete(brushes);
+            VectorUtils::clearAndDelete(textures);
+        }
     }
 }
 
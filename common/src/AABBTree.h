@@ -24,6 +24,7 @@
 #include "Exceptions.h"
 #include "BBox.h"
 #include "Ray.h"
+#include "RayKernels.h"
 #include "MathUtils.h"
 
 #include <algorithm>
@@ -214,6 +215,24 @@ private:
             delete m_right;
         }
 
+        /**
+         * Returns the left child of this node.
+         *
+         * @return the left child
+         */
+        const Node* left() const {
+            return m_left;
+        }
+
+        /**
+         * Returns the right child of this node.
+         *
+         * @return the right child
+         */
+        const Node* right() const {
+            return m_right;
+        }
+
         bool leaf() const override {
             return false;
         }
@@ -460,6 +479,55 @@ private:
             str << ": " << m_data << std::endl;
         }
     };
+
+    /**
+     * Finds the leaves whose bounds intersect with a ray. The bounds of both children of an inner node are tested at
+     * once, so that every node is tested exactly once, by its parent.
+     *
+     * @tparam O the output iterator type
+     */
+    template <typename O>
+    class RayIntersectorVisitor : public Visitor {
+    private:
+        const RayKernels::SlabRay<T,S> m_ray;
+        O& m_out;
+    public:
+        RayIntersectorVisitor(const Ray<T,S>& ray, O& out) :
+        m_ray(ray),
+        m_out(out) {}
+
+        bool intersects(const Node* node) const {
+            return RayKernels::intersectsBox(m_ray, node->bounds());
+        }
+
+        bool visit(const InnerNode* innerNode) override {
+            const Node* left = innerNode->left();
+            const Node* right = innerNode->right();
+
+            bool leftHit, rightHit;
+            RayKernels::intersectsBoxes(m_ray, left->bounds(), right->bounds(), leftHit, rightHit);
+            if (leftHit) {
+                visitChild(left);
+            }
+            if (rightHit) {
+                visitChild(right);
+            }
+            return false;
+        }
+
+        void visit(const LeafNode* leaf) override {
+            m_out = leaf->data();
+            ++m_out;
+        }
+    private:
+        void visitChild(const Node* child) {
+            if (child->leaf()) {
+                visit(static_cast<const LeafNode*>(child));
+            } else {
+                visit(static_cast<const InnerNode*>(child));
+            }
+        }
+    };
 private:
     Node* m_root;
 public:
@@ -542,13 +610,37 @@ public:
      */
     template <typename O>
     void findIntersectors(const Ray<T,S>& ray, O out) const {
+        if (!empty()) {
+            RayIntersectorVisitor<O> visitor(ray, out);
+            if (visitor.intersects(m_root)) {
+                m_root->accept(visitor);
+            }
+        }
+    }
+
+    List findIntersectors(const Box& bounds) const override {
+        List result;
+        findIntersectors(bounds, std::back_inserter(result));
+        return std::move(result);
+    }
+
+    /**
+     * Finds every data item in this tree whose bounding box intersects with the given bounding box and appends it to
+     * the given output iterator.
+     *
+     * @tparam O the output iterator type
+     * @param bounds the bounding box to test
+     * @param out the output iterator to append to
+     */
+    template <typename O>
+    void findIntersectors(const Box& bounds, O out) const {
         if (!empty()) {
             LambdaVisitor visitor(
                     [&](const InnerNode* innerNode) {
-                        return innerNode->bounds().contains(ray.origin) || !Math::isnan(innerNode->bounds().intersectWithRay(ray));
+                        return innerNode->bounds().intersects(bounds);
                     },
                     [&](const LeafNode* leaf) {
-                        if (leaf->bounds().contains(ray.origin) || !Math::isnan(leaf->bounds().intersectWithRay(ray))) {
+                        if (leaf->bounds().intersects(bounds)) {
                             out = leaf->data();
                             ++out;
                         }
@@ -0,0 +1,60 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Allocator.h"
+
+namespace {
+    thread_local ScratchArena* currentScratchArena = nullptr;
+}
+
+ScratchArena::ScratchArena() :
+m_previous(currentScratchArena),
+m_next(nullptr) {
+    currentScratchArena = this;
+}
+
+ScratchArena::~ScratchArena() {
+    assert(currentScratchArena == this);
+    currentScratchArena = m_previous;
+
+    for (unsigned char* chunk : m_chunks)
+        AllocatorUtils::freeChunk(chunk);
+}
+
+ScratchArena* ScratchArena::current() {
+    return currentScratchArena;
+}
+
+void* ScratchArena::allocate(const size_t size, const size_t alignment) {
+    const size_t firstOffset = AllocatorUtils::alignUp(sizeof(AllocatorUtils::ChunkHeader), alignment);
+    assert(firstOffset + size <= AllocatorUtils::ChunkSize);
+
+    if (m_next != nullptr) {
+        const size_t offset = AllocatorUtils::alignUp(static_cast<size_t>(m_next - m_chunks.back()), alignment);
+        if (offset + size <= AllocatorUtils::ChunkSize) {
+            m_next = m_chunks.back() + offset + size;
+            return m_chunks.back() + offset;
+        }
+    }
+
+    unsigned char* chunk = AllocatorUtils::allocateChunk(this, true);
+    m_chunks.push_back(chunk);
+    m_next = chunk + firstOffset + size;
+    return chunk + firstOffset;
+}
@@ -20,181 +20,254 @@
 #ifndef TrenchBroom_Allocator_h
 #define TrenchBroom_Allocator_h
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <iostream>
-#include <limits>
-#include <stack>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
 #include <vector>
 
 // Undefine this to prevent false positives when looking for memory leaks.
 #define TB_ENABLE_ALLOCATOR 1
 
-template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
+namespace AllocatorUtils {
+    /**
+     * All blocks are carved out of chunks of this size. Every chunk is aligned to its size, so that the header of the
+     * chunk that contains a block can be found by masking the address of the block. The aligned allocation functions
+     * are not available on all supported platforms, so every chunk is carved out of an allocation of twice its size.
+     */
+    static const size_t ChunkSize = 64 * 1024;
+
+    struct ChunkHeader {
+        /**
+         * The arena or the scratch arena that allocated the chunk.
+         */
+        void* owner;
+        bool scratch;
+        /**
+         * The allocation that contains the chunk.
+         */
+        void* memory;
+    };
+
+    inline size_t alignUp(const size_t value, const size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    inline unsigned char* allocateChunk(void* owner, const bool scratch) {
+        void* memory = ::operator new(ChunkSize * 2);
+        const auto address = reinterpret_cast<std::uintptr_t>(memory);
+        void* chunk = reinterpret_cast<void*>(alignUp(address, ChunkSize));
+
+        ChunkHeader* header = new (chunk) ChunkHeader;
+        header->owner = owner;
+        header->scratch = scratch;
+        header->memory = memory;
+        return static_cast<unsigned char*>(chunk);
+    }
+
+    inline void freeChunk(unsigned char* chunk) {
+        ::operator delete(reinterpret_cast<ChunkHeader*>(chunk)->memory);
+    }
+
+    inline const ChunkHeader* chunkHeader(const void* block) {
+        const auto address = reinterpret_cast<std::uintptr_t>(block);
+        return reinterpret_cast<const ChunkHeader*>(address & ~static_cast<std::uintptr_t>(ChunkSize - 1));
+    }
+}
+
+/**
+ * While a scratch arena is alive, every object that derives from Allocator and that is created on the thread which
+ * created the scratch arena is allocated from the scratch arena. Deleting such an object does not free its memory;
+ * instead, the memory of all objects is released at once when the scratch arena is destroyed. This is meant for
+ * temporary polyhedra, e.g. when checking whether vertices can be moved.
+ *
+ * All objects allocated from a scratch arena must be deleted before the scratch arena is destroyed, and they must not
+ * be handed to other threads. Scratch arenas can be nested, but they must be destroyed in the reverse order of their
+ * creation.
+ */
+class ScratchArena {
+private:
+    ScratchArena* m_previous;
+    std::vector<unsigned char*> m_chunks;
+    unsigned char* m_next;
+public:
+    ScratchArena();
+    ~ScratchArena();
+
+    /**
+     * Returns the innermost scratch arena of the calling thread, or null if there is none.
+     */
+    static ScratchArena* current();
+
+    void* allocate(size_t size, size_t alignment);
+private:
+    ScratchArena(const ScratchArena& other);
+    ScratchArena& operator=(const ScratchArena& other);
+};
+
+/**
+ * Allocates objects of type T from per-thread arenas. Allocating never takes a lock: every thread allocates from its
+ * own arena, which reuses the blocks that were freed on the same thread first. Blocks freed on other threads are
+ * pushed onto a lock-free list of the owning arena, which the owning thread reclaims once its own free blocks run out.
+ * Objects can therefore be created on worker threads and deleted on the main thread, and vice versa.
+ *
+ * When a thread exits, its arena is kept alive together with all objects allocated from it, and it is handed to the
+ * next thread that needs an arena. Only this handover takes a lock.
+ */
+template <class T>
 class Allocator {
 private:
-    class Chunk {
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // T is incomplete when this class is instantiated, so the block layout must be computed lazily
+    static constexpr size_t blockAlignment() {
+        return std::max(alignof(T), alignof(FreeBlock));
+    }
+
+    static constexpr size_t blockSize() {
+        return (std::max(sizeof(T), sizeof(FreeBlock)) + blockAlignment() - 1) / blockAlignment() * blockAlignment();
+    }
+
+    static constexpr size_t firstBlockOffset() {
+        return (sizeof(AllocatorUtils::ChunkHeader) + blockAlignment() - 1) / blockAlignment() * blockAlignment();
+    }
+
+    static constexpr size_t blocksPerChunk() {
+        return (AllocatorUtils::ChunkSize - firstBlockOffset()) / blockSize();
+    }
+
+    class Arena {
     private:
-        unsigned char m_blocks[BlocksPerChunk * sizeof(T)];
-        unsigned char m_firstFreeBlock;
-        unsigned char m_numFreeBlocks;
+        FreeBlock* m_freeBlocks;
+        std::atomic<FreeBlock*> m_remoteFreeBlocks;
+        unsigned char* m_next;
+        unsigned char* m_end;
     public:
-        Chunk() :
-        m_firstFreeBlock(0),
-        m_numFreeBlocks(BlocksPerChunk - 1) {
-            for (size_t i = 0; i < BlocksPerChunk - 1; i++)
-                m_blocks[i * sizeof(T)] = static_cast<unsigned char>(i + 1);
-        }
-        
-        bool contains(const T* t) const {
-            const unsigned char* block = reinterpret_cast<const unsigned char*>(t);
-            if (block < m_blocks)
-                return false;
-            size_t offset = static_cast<size_t>(block - m_blocks);
-            return offset < (BlocksPerChunk - 1) * sizeof(T);
+        Arena() :
+        m_freeBlocks(nullptr),
+        m_remoteFreeBlocks(nullptr),
+        m_next(nullptr),
+        m_end(nullptr) {}
+
+        void* allocate() {
+            if (m_freeBlocks == nullptr)
+                m_freeBlocks = m_remoteFreeBlocks.exchange(nullptr, std::memory_order_acquire);
+
+            if (m_freeBlocks != nullptr) {
+                FreeBlock* block = m_freeBlocks;
+                m_freeBlocks = block->next;
+                return block;
+            }
+
+            if (m_next == m_end) {
+                unsigned char* chunk = AllocatorUtils::allocateChunk(this, false);
+                m_next = chunk + firstBlockOffset();
+                m_end = m_next + blocksPerChunk() * blockSize();
+            }
+
+            void* block = m_next;
+            m_next += blockSize();
+            return block;
         }
-        
-        T* allocate() {
-            if (m_numFreeBlocks == 0)
-                return nullptr;
-            
-            unsigned char* block = m_blocks + m_firstFreeBlock * sizeof(T);
-            m_firstFreeBlock = *block;
-            m_numFreeBlocks--;
-            return reinterpret_cast<T*>(block);
+
+        // must only be called by the thread that owns this arena
+        void deallocateLocal(void* block) {
+            FreeBlock* freeBlock = new (block) FreeBlock;
+            freeBlock->next = m_freeBlocks;
+            m_freeBlocks = freeBlock;
         }
-        
-        void deallocate(T* t) {
-            assert(m_numFreeBlocks < BlocksPerChunk - 1);
-            assert(contains(t));
-            
-            unsigned char* block = reinterpret_cast<unsigned char*>(t);
-            assert(block >= m_blocks);
-            size_t offset = static_cast<size_t>(block - m_blocks);
-            assert(offset % sizeof(T) == 0);
-            
-            size_t index = offset / sizeof(T);
-            assert(index < BlocksPerChunk);
-            
-            *block = m_firstFreeBlock;
-            m_firstFreeBlock = static_cast<unsigned char>(index);
-            m_numFreeBlocks++;
+
+        void deallocateRemote(void* block) {
+            FreeBlock* freeBlock = new (block) FreeBlock;
+            freeBlock->next = m_remoteFreeBlocks.load(std::memory_order_relaxed);
+            while (!m_remoteFreeBlocks.compare_exchange_weak(freeBlock->next, freeBlock,
+                                                             std::memory_order_release,
+                                                             std::memory_order_relaxed));
         }
-        
-        bool empty() const {
-            return m_numFreeBlocks == BlocksPerChunk - 1;
+    };
+
+    /**
+     * Holds the arena of a thread and hands it over to the next thread when this thread exits.
+     */
+    class ThreadArena {
+    private:
+        Arena* m_arena;
+    public:
+        ThreadArena() :
+        m_arena(nullptr) {
+            std::lock_guard<std::mutex> lock(orphanMutex());
+            std::vector<Arena*>& orphans = orphanArenas();
+            if (!orphans.empty()) {
+                m_arena = orphans.back();
+                orphans.pop_back();
+            } else {
+                m_arena = new Arena();
+            }
+            threadArena() = m_arena;
         }
-        
-        bool full() const {
-            return m_numFreeBlocks == 0;
+
+        ~ThreadArena() {
+            threadArena() = nullptr;
+            std::lock_guard<std::mutex> lock(orphanMutex());
+            orphanArenas().push_back(m_arena);
         }
     };
-    
-    typedef std::vector<Chunk*> ChunkList;
-    typedef std::stack<T*> Pool;
-    
-    static Pool& pool() {
-        static Pool p;
-        return p;
+
+    static Arena*& threadArena() {
+        thread_local Arena* arena = nullptr;
+        return arena;
     }
-    
-    static ChunkList& fullChunks() {
-        static ChunkList chunks;
-        return chunks;
+
+    static Arena& localArena() {
+        Arena* arena = threadArena();
+        if (arena == nullptr) {
+            thread_local ThreadArena threadArenaHolder;
+            arena = threadArena();
+        }
+        assert(arena != nullptr);
+        return *arena;
     }
-    
-    static ChunkList& mixedChunks() {
-        static ChunkList chunks;
-        return chunks;
+
+    static std::vector<Arena*>& orphanArenas() {
+        static std::vector<Arena*> arenas;
+        return arenas;
     }
-    
-    static ChunkList emptyChunks() {
-        static ChunkList chunks;
-        return chunks;
+
+    static std::mutex& orphanMutex() {
+        static std::mutex m;
+        return m;
     }
 public:
 #ifdef TB_ENABLE_ALLOCATOR
     void* operator new(size_t size) {
         assert(size == sizeof(T));
-        
-        if (!pool().empty()) {
-            T* t = pool().top();
-            pool().pop();
-            return t;
-        }
-        
-        Chunk* chunk = nullptr;
-        if (mixedChunks().empty()) {
-            if (!emptyChunks().empty()) {
-                chunk = emptyChunks().back();
-                emptyChunks().pop_back();
-            } else {
-                chunk = new Chunk();
-            }
-        } else {
-            chunk = mixedChunks().back();
-            mixedChunks().pop_back();
-        }
-        
-        assert(!chunk->full());
-        T* block = chunk->allocate();
-        
-        if (chunk->full()) {
-            fullChunks().push_back(chunk);
-        } else {
-            mixedChunks().push_back(chunk);
-        }
-        return block;
+        static_assert(blocksPerChunk() > 0, "type is too large for allocator chunks");
+        ScratchArena* scratch = ScratchArena::current();
+        if (scratch != nullptr)
+            return scratch->allocate(blockSize(), blockAlignment());
+        return localArena().allocate();
     }
-    
+
     void operator delete(void* block) {
-        T* t = reinterpret_cast<T*>(block);
-        
-        if (PoolSize > 0 && pool().size() < PoolSize) {
-            pool().push(t);
+        if (block == nullptr)
+            return;
+
+        const AllocatorUtils::ChunkHeader* header = AllocatorUtils::chunkHeader(block);
+        if (header->scratch) {
+            // released together with the scratch arena
             return;
         }
-        
-        typename ChunkList::reverse_iterator fullIt, fullEnd, mixedIt, mixedEnd;
-        fullIt = fullChunks().rbegin();
-        fullEnd = fullChunks().rend();
-        mixedIt = mixedChunks().rbegin();
-        mixedEnd = mixedChunks().rend();
-        
-        Chunk* chunk = nullptr;
-        while (fullIt < fullEnd || mixedIt < mixedEnd) {
-            if (fullIt < fullEnd) {
-                Chunk* fullChunk = *fullIt;
-                if (fullChunk->contains(t)) {
-                    chunk = fullChunk;
-                    break;
-                }
-                ++fullIt;
-            }
-            if (mixedIt < mixedEnd) {
-                Chunk* mixedChunk = *mixedIt;
-                if (mixedChunk->contains(t)) {
-                    chunk = mixedChunk;
-                    break;
-                }
-                ++mixedIt;
-            }
-        }
-        
-        assert(chunk != nullptr);
-        
-        if (chunk->full()) {
-            fullChunks().erase((fullIt + 1).base());
-            mixedChunks().push_back(chunk);
-        }
-        
-        chunk->deallocate(t);
-        
-        if (chunk->empty()) {
-            mixedChunks().erase((mixedIt + 1).base());
-            if (emptyChunks().size() < 2)
-                emptyChunks().push_back(chunk);
-                else
-                    delete chunk;
+
+        Arena* owner = static_cast<Arena*>(header->owner);
+        if (owner == threadArena()) {
+            owner->deallocateLocal(block);
+        } else {
+            owner->deallocateRemote(block);
         }
     }
 #endif
@@ -100,6 +100,19 @@ namespace TrenchBroom {
             return new Renderer::TexturedIndexRangeRenderer(vertexArray, indexArray);
         }
 
+        Renderer::MeshSimplifier::TexturedTriangles Bsp29Model::doGetTriangles(const size_t skinIndex, const size_t frameIndex) const {
+            using Renderer::MeshSimplifier;
+
+            const SubModel& model = m_subModels.front();
+
+            MeshSimplifier::TexturedTriangles result;
+            for (const Face& face : model.faces) {
+                const Face::VertexList& vertices = face.vertices();
+                MeshSimplifier::addPrimitive(result[face.texture()], GL_POLYGON, vertices, 0, vertices.size());
+            }
+            return result;
+        }
+
         BBox3f Bsp29Model::doGetBounds(const size_t skinIndex, const size_t frameIndex) const {
             const SubModel& model = m_subModels.front();
             return model.bounds;
@@ -19,8 +19,15 @@
 
 #include "EntityModel.h"
 
+#include "Renderer/TexturedIndexRangeMap.h"
+#include "Renderer/TexturedIndexRangeMapBuilder.h"
+#include "Renderer/TexturedIndexRangeRenderer.h"
+#include "Renderer/VertexArray.h"
+
 namespace TrenchBroom {
     namespace Assets {
+        const size_t EntityModel::ReducedLodCellsPerAxis = 8;
+
         EntityModel::EntityModel() :
         m_prepared(false) {}
 
@@ -30,6 +37,34 @@ namespace TrenchBroom {
             return doBuildRenderer(skinIndex, frameIndex);
         }
 
+        Renderer::TexturedIndexRangeRenderer* EntityModel::buildRenderer(const size_t skinIndex, const size_t frameIndex, const EntityModelLod lod) const {
+            using Renderer::MeshSimplifier;
+
+            if (lod == EntityModelLod::Full)
+                return buildRenderer(skinIndex, frameIndex);
+
+            const MeshSimplifier::TexturedTriangles triangles = doGetTriangles(skinIndex, frameIndex);
+            const MeshSimplifier::TexturedTriangles mesh = lod == EntityModelLod::Reduced ?
+                MeshSimplifier::simplify(triangles, ReducedLodCellsPerAxis) :
+                MeshSimplifier::boundingBox(triangles);
+            if (mesh.empty())
+                return nullptr;
+
+            size_t vertexCount = 0;
+            Renderer::TexturedIndexRangeMap::Size size;
+            for (const auto& [texture, vertices] : mesh) {
+                size.inc(texture, GL_TRIANGLES);
+                vertexCount += vertices.size();
+            }
+
+            Renderer::TexturedIndexRangeMapBuilder<MeshSimplifier::Vertex::Spec> builder(vertexCount, size);
+            for (const auto& [texture, vertices] : mesh)
+                builder.addTriangles(texture, vertices);
+
+            const Renderer::VertexArray vertexArray = Renderer::VertexArray::swap(builder.vertices());
+            return new Renderer::TexturedIndexRangeRenderer(vertexArray, builder.indices());
+        }
+
         BBox3f EntityModel::bounds(const size_t skinIndex, const size_t frameIndex) const {
             return doGetBounds(skinIndex, frameIndex);
         }
@@ -21,6 +21,7 @@
 #define TrenchBroom_EntityModel
 
 #include "VecMath.h"
+#include "Renderer/MeshSimplifier.h"
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -28,14 +29,34 @@ namespace TrenchBroom {
     }
     
     namespace Assets {
+        /**
+         * The level of detail at which an entity model is rendered. The reduced level is a simplified version of the
+         * model's mesh, and the impostor level is the model's bounding box.
+         */
+        enum class EntityModelLod {
+            Full,
+            Reduced,
+            Impostor
+        };
+
         class EntityModel {
         private:
+            /**
+             * The number of grid cells per axis used to simplify the mesh for the reduced level of detail.
+             */
+            static const size_t ReducedLodCellsPerAxis;
+
             bool m_prepared;
         public:
             EntityModel();
             virtual ~EntityModel();
             
             Renderer::TexturedIndexRangeRenderer* buildRenderer(const size_t skinIndex, const size_t frameIndex) const;
+            /**
+             * Builds a renderer for the given level of detail. Returns null if the model cannot be rendered at that
+             * level of detail.
+             */
+            Renderer::TexturedIndexRangeRenderer* buildRenderer(const size_t skinIndex, const size_t frameIndex, EntityModelLod lod) const;
             BBox3f bounds(const size_t skinIndex, const size_t frameIndex) const;
             BBox3f transformedBounds(const size_t skinIndex, const size_t frameIndex, const Mat4x4f& transformation) const;
             
@@ -44,6 +65,10 @@ namespace TrenchBroom {
             void setTextureMode(int minFilter, int magFilter);
         private:
             virtual Renderer::TexturedIndexRangeRenderer* doBuildRenderer(const size_t skinIndex, const size_t frameIndex) const = 0;
+            /**
+             * Returns the triangles of the given frame, textured with the given skin.
+             */
+            virtual Renderer::MeshSimplifier::TexturedTriangles doGetTriangles(const size_t skinIndex, const size_t frameIndex) const = 0;
             virtual BBox3f doGetBounds(const size_t skinIndex, const size_t frameIndex) const = 0;
             virtual BBox3f doGetTransformedBounds(const size_t skinIndex, const size_t frameIndex, const Mat4x4f& transformation) const = 0;
             virtual void doPrepare(int minFilter, int magFilter) = 0;
@@ -22,11 +22,16 @@
 #include "CollectionUtils.h"
 #include "Exceptions.h"
 #include "Logger.h"
+#include "ParallelUtils.h"
 #include "Assets/EntityModel.h"
 #include "IO/EntityModelLoader.h"
 #include "Model/Entity.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
 namespace TrenchBroom {
     namespace Assets {
         EntityModelManager::EntityModelManager(Logger* logger, int minFilter, int magFilter) :
@@ -34,13 +39,16 @@ namespace TrenchBroom {
         m_loader(nullptr),
         m_minFilter(minFilter),
         m_magFilter(magFilter),
-        m_resetTextureMode(false) {}
+        m_resetTextureMode(false),
+        m_runningLoads(0),
+        m_modelGeneration(0) {}
         
         EntityModelManager::~EntityModelManager() {
             clear();
         }
         
         void EntityModelManager::clear() {
+            cancelLoads();
             MapUtils::clearAndDelete(m_renderers);
             MapUtils::clearAndDelete(m_models);
             m_rendererMismatches.clear();
@@ -63,6 +71,10 @@ namespace TrenchBroom {
             m_loader = loader;
         }
 
+        void EntityModelManager::setLoadCallback(const LoadCallback& loadCallback) {
+            m_loadCallback = loadCallback;
+        }
+
         EntityModel* EntityModelManager::model(const IO::Path& path) const {
             if (path.isEmpty())
                 return nullptr;
@@ -74,6 +86,21 @@ namespace TrenchBroom {
             if (m_modelMismatches.count(path) > 0)
                 return nullptr;
             
+            LoadingModels::iterator lIt = m_loadingModels.find(path);
+            if (lIt != std::end(m_loadingModels)) {
+                if (lIt->second.future.valid()) {
+                    // the model is being loaded in the background, so we wait for it
+                    Load load = std::move(lIt->second);
+                    m_loadingModels.erase(lIt);
+                    --m_runningLoads;
+                    startPendingLoads();
+                    return finishLoad(path, load);
+                }
+                
+                m_loadingModels.erase(lIt);
+                m_pendingLoads.erase(std::remove(std::begin(m_pendingLoads), std::end(m_pendingLoads), path), std::end(m_pendingLoads));
+            }
+            
             try {
                 EntityModel* model = loadModel(path);
                 ensure(model != nullptr, "model is null");
@@ -98,27 +125,48 @@ namespace TrenchBroom {
             }
         }
         
+        EntityModel* EntityModelManager::requestModel(const IO::Path& path) const {
+            if (path.isEmpty())
+                return nullptr;
+            
+            ModelCache::const_iterator it = m_models.find(path);
+            if (it != std::end(m_models))
+                return it->second;
+            
+            if (m_modelMismatches.count(path) == 0 && m_loadingModels.count(path) == 0) {
+                m_loadingModels.insert(std::make_pair(path, Load()));
+                m_pendingLoads.push_back(path);
+                startPendingLoads();
+            }
+            return nullptr;
+        }
+        
         Renderer::TexturedIndexRangeRenderer* EntityModelManager::renderer(const Assets::ModelSpecification& spec) const {
-            EntityModel* entityModel = safeGetModel(spec.path);
+            return renderer(spec, EntityModelLod::Full);
+        }
+
+        Renderer::TexturedIndexRangeRenderer* EntityModelManager::renderer(const Assets::ModelSpecification& spec, const EntityModelLod lod) const {
+            EntityModel* entityModel = requestModel(spec.path);
 
             if (entityModel == nullptr)
                 return nullptr;
             
-            RendererCache::const_iterator it = m_renderers.find(spec);
+            const RendererKey key(spec, lod);
+            RendererCache::const_iterator it = m_renderers.find(key);
             if (it != std::end(m_renderers))
                 return it->second;
             
-            if (m_rendererMismatches.count(spec) > 0)
+            if (m_rendererMismatches.count(key) > 0)
                 return nullptr;
             
-            Renderer::TexturedIndexRangeRenderer* renderer = entityModel->buildRenderer(spec.skinIndex, spec.frameIndex);
+            Renderer::TexturedIndexRangeRenderer* renderer = entityModel->buildRenderer(spec.skinIndex, spec.frameIndex, lod);
             if (renderer == nullptr) {
-                m_rendererMismatches.insert(spec);
+                m_rendererMismatches.insert(key);
                 
                 if (m_logger != nullptr)
                     m_logger->debug("Failed to construct entity model renderer for %s", spec.asString().c_str());
             } else {
-                m_renderers[spec] = renderer;
+                m_renderers[key] = renderer;
                 m_unpreparedRenderers.push_back(renderer);
                 
                 if (m_logger != nullptr)
@@ -135,12 +183,113 @@ namespace TrenchBroom {
             return renderer(spec) != nullptr;
         }
 
+        bool EntityModelManager::loading() const {
+            return !m_loadingModels.empty();
+        }
+
+        bool EntityModelManager::collectLoadedModels() {
+            bool collected = false;
+            
+            LoadingModels::iterator it = std::begin(m_loadingModels);
+            while (it != std::end(m_loadingModels)) {
+                Load& load = it->second;
+                if (load.future.valid() && load.future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                    try {
+                        finishLoad(it->first, load);
+                    } catch (const Exception& e) {
+                        if (m_logger != nullptr)
+                            m_logger->debug("Failed to load entity model %s: %s", it->first.asString().c_str(), e.what());
+                    }
+                    it = m_loadingModels.erase(it);
+                    --m_runningLoads;
+                    collected = true;
+                } else {
+                    ++it;
+                }
+            }
+            
+            if (collected)
+                startPendingLoads();
+            return collected;
+        }
+        
+        size_t EntityModelManager::modelGeneration() const {
+            return m_modelGeneration;
+        }
+
         EntityModel* EntityModelManager::loadModel(const IO::Path& path) const {
             ensure(m_loader != nullptr, "loader is null");
             return m_loader->loadEntityModel(path);
         }
 
+        EntityModel* EntityModelManager::finishLoad(const IO::Path& path, Load& load) const {
+            // the thread may still be calling the load callback
+            load.thread.join();
+
+            ++m_modelGeneration;
+            try {
+                EntityModel* model = load.future.get();
+                ensure(model != nullptr, "model is null");
+                m_models[path] = model;
+                m_unpreparedModels.push_back(model);
+                
+                if (m_logger != nullptr)
+                    m_logger->debug("Loaded entity model %s", path.asString().c_str());
+                
+                return model;
+            } catch (...) {
+                m_modelMismatches.insert(path);
+                throw;
+            }
+        }
+        
+        void EntityModelManager::startPendingLoads() const {
+            while (!m_pendingLoads.empty() && m_runningLoads < ParallelUtils::threadCount()) {
+                const IO::Path path = m_pendingLoads.front();
+                m_pendingLoads.pop_front();
+                
+                // the thread only uses copies of the loader and the callback, and it signals the callback after
+                // the result is available, so that the callback can rely on the model being ready for collection
+                const IO::EntityModelLoader* loader = m_loader;
+                const LoadCallback callback = m_loadCallback;
+                std::promise<EntityModel*> promise;
+                Load& load = m_loadingModels[path];
+                load.future = promise.get_future();
+                
+                ensure(loader != nullptr, "loader is null");
+                load.thread = std::thread([loader, callback, path, promise = std::move(promise)]() mutable {
+                    try {
+                        promise.set_value(loader->loadEntityModel(path));
+                    } catch (...) {
+                        promise.set_exception(std::current_exception());
+                    }
+                    if (callback)
+                        callback();
+                });
+                ++m_runningLoads;
+            }
+        }
+        
+        void EntityModelManager::cancelLoads() {
+            m_pendingLoads.clear();
+            
+            // the loads cannot be interrupted, so we wait for them and discard the results
+            for (auto& entry : m_loadingModels) {
+                Load& load = entry.second;
+                if (load.thread.joinable())
+                    load.thread.join();
+                if (load.future.valid()) {
+                    try {
+                        delete load.future.get();
+                    } catch (...) {}
+                }
+            }
+            m_loadingModels.clear();
+            m_runningLoads = 0;
+        }
+        
         void EntityModelManager::prepare(Renderer::Vbo& vbo) {
+            collectLoadedModels();
             resetTextureMode();
             prepareModels();
             prepareRenderers(vbo);
@@ -24,8 +24,12 @@
 #include "IO/Path.h"
 #include "Model/ModelTypes.h"
 
+#include <deque>
+#include <functional>
+#include <future>
 #include <map>
 #include <set>
+#include <thread>
 #include <vector>
 
 namespace TrenchBroom {
@@ -42,15 +46,41 @@ namespace TrenchBroom {
     
     namespace Assets {
         class EntityModel;
+        enum class EntityModelLod;
         
+        /**
+         * Loads and caches entity models. Models that are requested for rendering are loaded on background threads,
+         * and the entities that use them are drawn as their bounding boxes until the models are ready. Finished models
+         * are collected on the calling thread, either explicitly or when the manager is prepared for rendering.
+         *
+         * The loader threads are owned by the manager and joined when their models are collected or when the manager
+         * is cleared. The loader must not be changed while models are loading, so clear the manager before changing
+         * the game's file systems.
+         */
         class EntityModelManager {
+        public:
+            /**
+             * Called on a background thread whenever a model has been loaded or failed to load.
+             */
+            typedef std::function<void()> LoadCallback;
         private:
             typedef std::map<IO::Path, EntityModel*> ModelCache;
+
+            /**
+             * A model that is waiting to be loaded has neither a future nor a thread.
+             */
+            struct Load {
+                std::future<EntityModel*> future;
+                std::thread thread;
+            };
+            typedef std::map<IO::Path, Load> LoadingModels;
+            typedef std::deque<IO::Path> PendingLoads;
             typedef std::set<IO::Path> ModelMismatches;
             typedef std::vector<EntityModel*> ModelList;
             
-            typedef std::map<Assets::ModelSpecification, Renderer::TexturedIndexRangeRenderer*> RendererCache;
-            typedef std::set<Assets::ModelSpecification> RendererMismatches;
+            typedef std::pair<Assets::ModelSpecification, EntityModelLod> RendererKey;
+            typedef std::map<RendererKey, Renderer::TexturedIndexRangeRenderer*> RendererCache;
+            typedef std::set<RendererKey> RendererMismatches;
             typedef std::vector<Renderer::TexturedIndexRangeRenderer*> RendererList;
             
             Logger* m_logger;
@@ -67,6 +97,12 @@ namespace TrenchBroom {
 
             mutable ModelList m_unpreparedModels;
             mutable RendererList m_unpreparedRenderers;
+            
+            mutable LoadingModels m_loadingModels;
+            mutable PendingLoads m_pendingLoads;
+            mutable size_t m_runningLoads;
+            mutable size_t m_modelGeneration;
+            LoadCallback m_loadCallback;
         public:
             EntityModelManager(Logger* logger, int minFilter, int magFilter);
             ~EntityModelManager();
@@ -75,15 +111,50 @@ namespace TrenchBroom {
 
             void setTextureMode(int minFilter, int magFilter);
             void setLoader(const IO::EntityModelLoader* loader);
+            void setLoadCallback(const LoadCallback& loadCallback);
             
+            /**
+             * Returns the model at the given path, loading it on the calling thread if necessary.
+             */
             EntityModel* model(const IO::Path& path) const;
             EntityModel* safeGetModel(const IO::Path& path) const;
+            
+            /**
+             * Returns the model at the given path if it is loaded. Otherwise, the model is loaded on a background
+             * thread and null is returned until it has been collected.
+             */
+            EntityModel* requestModel(const IO::Path& path) const;
+            
+            /**
+             * Returns the renderer for the given specification, or null if the model is not available or still loading.
+             */
             Renderer::TexturedIndexRangeRenderer* renderer(const Assets::ModelSpecification& spec) const;
+            /**
+             * Returns the renderer for the given specification at the given level of detail. The renderers for the
+             * lower levels of detail are built from the model's mesh once and cached like the full renderers.
+             */
+            Renderer::TexturedIndexRangeRenderer* renderer(const Assets::ModelSpecification& spec, EntityModelLod lod) const;
             
             bool hasModel(const Model::Entity* entity) const;
             bool hasModel(const Assets::ModelSpecification& spec) const;
+            
+            bool loading() const;
+            
+            /**
+             * Takes over the models that have finished loading in the background. Returns true if any model was
+             * collected, in which case the model generation has changed.
+             */
+            bool collectLoadedModels();
+            
+            /**
+             * Returns a number that changes whenever models that were loaded in the background are collected.
+             */
+            size_t modelGeneration() const;
         private:
             EntityModel* loadModel(const IO::Path& path) const;
+            EntityModel* finishLoad(const IO::Path& path, Load& load) const;
+            void startPendingLoads() const;
+            void cancelLoads();
         public:
             void prepare(Renderer::Vbo& vbo);
         private:
@@ -89,6 +89,30 @@ namespace TrenchBroom {
             return new Renderer::TexturedIndexRangeRenderer(vertexArray, texturedIndices);
         }
         
+        Renderer::MeshSimplifier::TexturedTriangles Md2Model::doGetTriangles(const size_t skinIndex, const size_t frameIndex) const {
+            using Renderer::MeshSimplifier;
+
+            const TextureList& textures = m_skins->textures();
+
+            ensure(skinIndex < textures.size(), "skin index out of range");
+            ensure(frameIndex < m_frames.size(), "frame index out of range");
+
+            const Assets::Texture* skin = textures[skinIndex];
+            const Frame* frame = m_frames[frameIndex];
+
+            MeshSimplifier::VertexList vertices;
+            vertices.reserve(frame->vertices().size());
+            for (const Vertex& vertex : frame->vertices())
+                vertices.push_back(MeshSimplifier::Vertex(vertex.v1, vertex.v3));
+
+            MeshSimplifier::TexturedTriangles result;
+            MeshSimplifier::VertexList& triangles = result[skin];
+            frame->indices().forEachRange([&](const PrimType primType, const size_t index, const size_t count) {
+                MeshSimplifier::addPrimitive(triangles, primType, vertices, index, count);
+            });
+            return result;
+        }
+        
         BBox3f Md2Model::doGetBounds(const size_t skinIndex, const size_t frameIndex) const {
             ensure(skinIndex < m_skins->textures().size(), "skin index out of range");
             ensure(frameIndex < m_frames.size(), "frame index out of range");
@@ -53,6 +53,14 @@ namespace TrenchBroom {
             return m_textures.textures().front();
         }
 
+        const TextureList& MdlSkin::textures() const {
+            return m_textures.textures();
+        }
+
+        const MdlTimeList& MdlSkin::times() const {
+            return m_times;
+        }
+
         MdlBaseFrame::~MdlBaseFrame() {}
 
         MdlFrame::MdlFrame(const String& name, const VertexList& triangles, const BBox3f& bounds) :
@@ -64,6 +72,10 @@ namespace TrenchBroom {
             return this;
         }
 
+        const String& MdlFrame::name() const {
+            return m_name;
+        }
+
         const MdlFrame::VertexList& MdlFrame::triangles() const {
             return m_triangles;
         }
@@ -122,6 +134,14 @@ namespace TrenchBroom {
             m_frames.push_back(frame);
         }
 
+        const MdlModel::MdlSkinList& MdlModel::skins() const {
+            return m_skins;
+        }
+
+        const MdlModel::MdlFrameList& MdlModel::frames() const {
+            return m_frames;
+        }
+
         Renderer::TexturedIndexRangeRenderer* MdlModel::doBuildRenderer(const size_t skinIndex, const size_t frameIndex) const {
             if (skinIndex >= m_skins.size())
                 return nullptr;
@@ -141,6 +161,20 @@ namespace TrenchBroom {
             return new Renderer::TexturedIndexRangeRenderer(vertexArray, indexArray);
         }
 
+        Renderer::MeshSimplifier::TexturedTriangles MdlModel::doGetTriangles(const size_t skinIndex, const size_t frameIndex) const {
+            Renderer::MeshSimplifier::TexturedTriangles result;
+            if (skinIndex >= m_skins.size())
+                return result;
+            if (frameIndex >= m_frames.size())
+                return result;
+
+            const MdlSkin* skin = m_skins[skinIndex];
+            const MdlFrame* frame = m_frames[frameIndex]->firstFrame();
+
+            result[skin->firstPicture()] = frame->triangles();
+            return result;
+        }
+
         BBox3f MdlModel::doGetBounds(const size_t skinIndex, const size_t frameIndex) const {
             if (frameIndex >= m_frames.size())
                 return BBox3f(-8.0f, 8.0f);
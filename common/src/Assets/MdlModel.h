@@ -46,6 +46,9 @@ namespace TrenchBroom {
             void prepare(int minFilter, int magFilter);
             void setTextureMode(int minFilter, int magFilter);
             const Texture* firstPicture() const;
+
+            const TextureList& textures() const;
+            const MdlTimeList& times() const;
         };
 
         class MdlFrame;
@@ -67,6 +70,7 @@ namespace TrenchBroom {
         public:
             MdlFrame(const String& name, const VertexList& triangles, const BBox3f& bounds);
             const MdlFrame* firstFrame() const override;
+            const String& name() const;
             const VertexList& triangles() const;
             BBox3f bounds() const;
             BBox3f transformedBounds(const Mat4x4f& transformation) const;
@@ -85,10 +89,10 @@ namespace TrenchBroom {
         };
         
         class MdlModel : public EntityModel {
-        private:
+        public:
             typedef std::vector<MdlSkin*> MdlSkinList;
             typedef std::vector<MdlBaseFrame*> MdlFrameList;
-            
+        private:
             String m_name;
             MdlSkinList m_skins;
             MdlFrameList m_frames;
@@ -98,8 +102,12 @@ namespace TrenchBroom {
             
             void addSkin(MdlSkin* skin);
             void addFrame(MdlBaseFrame* frame);
+
+            const MdlSkinList& skins() const;
+            const MdlFrameList& frames() const;
         private:
             Renderer::TexturedIndexRangeRenderer* doBuildRenderer(const size_t skinIndex, const size_t frameIndex) const override;
+            Renderer::MeshSimplifier::TexturedTriangles doGetTriangles(const size_t skinIndex, const size_t frameIndex) const override;
             BBox3f doGetBounds(const size_t skinIndex, const size_t frameIndex) const override;
             BBox3f doGetTransformedBounds(const size_t skinIndex, const size_t frameIndex, const Mat4x4f& transformation) const override;
             void doPrepare(int minFilter, int magFilter) override;
@@ -24,7 +24,9 @@
 #include "ByteBuffer.h"
 #include "IO/MappedFile.h"
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 
 namespace TrenchBroom {
     namespace IO {
@@ -78,6 +80,28 @@ namespace TrenchBroom {
                         averageColor[i] = static_cast<float>(avg[i] / pixelCount / 0xFF);
                     averageColor[3] = 1.0f;
                 }
+                
+                template <typename IndexT>
+                void averageColor(const IndexT* indexedImage, const size_t pixelCount, Color& averageColor) const {
+                    size_t histogram[256];
+                    std::fill(std::begin(histogram), std::end(histogram), 0u);
+                    for (size_t i = 0; i < pixelCount; ++i)
+                        ++histogram[static_cast<unsigned char>(indexedImage[i])];
+                    
+                    double avg[3];
+                    avg[0] = avg[1] = avg[2] = 0.0;
+                    for (size_t index = 0; index < 256; ++index) {
+                        if (histogram[index] > 0) {
+                            assert(index * 3 + 2 < m_size);
+                            for (size_t j = 0; j < 3; ++j)
+                                avg[j] += static_cast<double>(histogram[index]) * static_cast<double>(m_data[index * 3 + j]);
+                        }
+                    }
+                    
+                    for (size_t i = 0; i < 3; ++i)
+                        averageColor[i] = static_cast<float>(avg[i] / pixelCount / 0xFF);
+                    averageColor[3] = 1.0f;
+                }
             };
             
             typedef std::shared_ptr<Data> DataPtr;
@@ -98,6 +122,14 @@ namespace TrenchBroom {
             void indexedToRgba(const IndexT* indexedImage, const size_t pixelCount, Buffer<ColorT>& rgbaImage, Color& averageColor, const PaletteTransparency transparency = PaletteTransparency::Opaque) const {
                 m_data->indexedToRgba(indexedImage, pixelCount, rgbaImage, averageColor, transparency);
             }
+            
+            /**
+             * Computes the average color of the given indexed image without converting it.
+             */
+            template <typename IndexT>
+            void averageColor(const IndexT* indexedImage, const size_t pixelCount, Color& averageColor) const {
+                m_data->averageColor(indexedImage, pixelCount, averageColor);
+            }
         };
     }
 }
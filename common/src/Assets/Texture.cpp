@@ -84,6 +84,23 @@ namespace TrenchBroom {
             }
         }
         
+        Texture::Texture(const String& name, const size_t width, const size_t height, const Color& averageColor, const TextureBufferLoader& bufferLoader, const GLenum format, const TextureType type) :
+        m_collection(nullptr),
+        m_name(name),
+        m_width(width),
+        m_height(height),
+        m_averageColor(averageColor),
+        m_usageCount(0),
+        m_overridden(false),
+        m_format(format),
+        m_type(type),
+        m_textureId(0),
+        m_bufferLoader(bufferLoader) {
+            assert(m_width > 0);
+            assert(m_height > 0);
+            assert(m_bufferLoader);
+        }
+        
         Texture::Texture(const String& name, const size_t width, const size_t height, const GLenum format, const TextureType type) :
         m_collection(nullptr),
         m_name(name),
@@ -118,6 +135,32 @@ namespace TrenchBroom {
             return m_averageColor;
         }
         
+        GLenum Texture::format() const {
+            return m_format;
+        }
+        
+        TextureType Texture::type() const {
+            return m_type;
+        }
+        
+        const TextureBuffer::List& Texture::buffers() const {
+            if (m_bufferLoader) {
+                // decode the image data on first use and release the source data afterwards
+                m_buffers = m_bufferLoader();
+                m_bufferLoader = nullptr;
+            }
+            return m_buffers;
+        }
+        
+        TextureBufferLoader Texture::bufferLoader() const {
+            if (m_bufferLoader)
+                return m_bufferLoader;
+            
+            assert(!m_buffers.empty());
+            const TextureBuffer::List buffers = m_buffers;
+            return [buffers]() { return buffers; };
+        }
+        
         size_t Texture::usageCount() const {
             return m_usageCount;
         }
@@ -149,6 +192,8 @@ namespace TrenchBroom {
 
         void Texture::prepare(const GLuint textureId, const int minFilter, const int magFilter) {
             assert(textureId > 0);
+            
+            buffers();
             assert(!m_buffers.empty());
             
             glAssert(glPixelStorei(GL_UNPACK_SWAP_BYTES, false));
@@ -26,6 +26,7 @@
 #include "Renderer/GL.h"
 
 #include <cassert>
+#include <functional>
 #include <vector>
 
 namespace TrenchBroom {
@@ -34,6 +35,11 @@ namespace TrenchBroom {
         
         typedef Buffer<unsigned char> TextureBuffer;
 
+        /**
+         * Decodes the mip buffers of a texture whose image data is only decoded when the texture is prepared.
+         */
+        typedef std::function<TextureBuffer::List()> TextureBufferLoader;
+
         enum class TextureType {
             Opaque, Masked
         };
@@ -58,9 +64,11 @@ namespace TrenchBroom {
 
             mutable GLuint m_textureId;
             mutable TextureBuffer::List m_buffers;
+            mutable TextureBufferLoader m_bufferLoader;
         public:
             Texture(const String& name, size_t width, size_t height, const Color& averageColor, const TextureBuffer& buffer, GLenum format, TextureType type);
             Texture(const String& name, size_t width, size_t height, const Color& averageColor, const TextureBuffer::List& buffers, GLenum format, TextureType type);
+            Texture(const String& name, size_t width, size_t height, const Color& averageColor, const TextureBufferLoader& bufferLoader, GLenum format, TextureType type);
             Texture(const String& name, size_t width, size_t height, GLenum format = GL_RGB, TextureType type = TextureType::Opaque);
             ~Texture();
 
@@ -69,6 +77,21 @@ namespace TrenchBroom {
             size_t width() const;
             size_t height() const;
             const Color& averageColor() const;
+            GLenum format() const;
+            TextureType type() const;
+
+            /**
+             * Returns the mip buffers of this texture, decoding them first if they have not been decoded yet. The
+             * buffers are released when the texture is prepared.
+             */
+            const TextureBuffer::List& buffers() const;
+
+            /**
+             * Returns a function that decodes the mip buffers of this texture independently of this texture, so that
+             * they can be decoded on another thread while this texture is in use. Must be called before this texture
+             * is prepared.
+             */
+            TextureBufferLoader bufferLoader() const;
 
             size_t usageCount() const;
             void incUsageCount();
@@ -20,6 +20,7 @@
 #include "TextureCollection.h"
 
 #include "CollectionUtils.h"
+#include "ParallelUtils.h"
 #include "Assets/Texture.h"
 
 namespace TrenchBroom {
@@ -85,6 +86,10 @@ namespace TrenchBroom {
             return m_textures;
         }
 
+        void TextureCollection::setDecodedCallback(const DecodedCallback& callback) {
+            m_decodedCallback = callback;
+        }
+
         size_t TextureCollection::usageCount() const {
             return m_usageCount;
         }
@@ -93,9 +98,24 @@ namespace TrenchBroom {
             return !m_textureIds.empty();
         }
 
+        void TextureCollection::decode() {
+            ParallelUtils::forEachIndex(m_textures.size(), [this](const size_t i) {
+                m_textures[i]->buffers();
+            });
+            
+            if (m_decodedCallback) {
+                const DecodedCallback callback = m_decodedCallback;
+                m_decodedCallback = nullptr;
+                callback(m_textures);
+            }
+        }
+
         void TextureCollection::prepare(const int minFilter, const int magFilter) {
             assert(!prepared());
             
+            // only the upload must happen on the GL thread
+            decode();
+            
             const size_t textureCount = m_textures.size();
             m_textureIds.resize(textureCount);
             glAssert(glGenTextures(static_cast<GLsizei>(textureCount),
@@ -26,11 +26,14 @@
 #include "IO/Path.h"
 #include "Renderer/GL.h"
 
+#include <functional>
 #include <vector>
 
 namespace TrenchBroom {
     namespace Assets {
         class TextureCollection {
+        public:
+            typedef std::function<void(const TextureList& textures)> DecodedCallback;
         private:
             typedef std::vector<GLuint> TextureIdList;
             
@@ -41,6 +44,7 @@ namespace TrenchBroom {
             size_t m_usageCount;
             
             TextureIdList m_textureIds;
+            DecodedCallback m_decodedCallback;
             
             friend class Texture;
         public:
@@ -59,10 +63,27 @@ namespace TrenchBroom {
             const IO::Path& path() const;
             String name() const;
             const TextureList& textures() const;
+            
+            /**
+             * Sets a function that is called once with the textures of this collection when they have been decoded,
+             * before the upload releases their image data. It is called on the thread that decodes the collection.
+             */
+            void setDecodedCallback(const DecodedCallback& callback);
 
             size_t usageCount() const;
             
             bool prepared() const;
+            
+            /**
+             * Decodes the image data of all textures of this collection in parallel. Does not require an OpenGL
+             * context, so it may be called on any thread. Textures that were already decoded are skipped. Calls the
+             * decoded callback afterwards, if any.
+             */
+            void decode();
+            
+            /**
+             * Uploads all textures of this collection, decoding them first if they have not been decoded yet.
+             */
             void prepare(int minFilter, int magFilter);
             void setTextureMode(int minFilter, int magFilter);
         private:
@@ -22,12 +22,14 @@
 #include "Exceptions.h"
 #include "CollectionUtils.h"
 #include "Logger.h"
+#include "ParallelUtils.h"
 #include "Assets/Texture.h"
 #include "Assets/TextureCollection.h"
 #include "IO/TextureLoader.h"
 
 #include <algorithm>
 #include <iterator>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Assets {
@@ -63,24 +65,50 @@ namespace TrenchBroom {
             m_collections.clear();
             clear();
             
-            for (const IO::Path& path : paths) {
-                const auto it = collections.find(path);
-                if (it == std::end(collections) || !it->second->loaded()) {
-                    try {
-                        Assets::TextureCollection* collection = loader.loadTextureCollection(path);
-                        m_logger->info("Loaded texture collection '" + path.asString() + "'");
-                        addTextureCollection(collection);
-                        collection->usageCountDidChange.addObserver(usageCountDidChange);
-                    } catch (const Exception& e) {
-                        addTextureCollection(new Assets::TextureCollection(path));
-                        if (it == std::end(collections))
-                            m_logger->error("Could not load texture collection '" + path.asString() + "': " + e.what());
+            // find the collections that can be kept and the ones that must be loaded
+            TextureCollectionList result(paths.size(), nullptr);
+            std::vector<bool> known(paths.size(), false);
+            for (size_t i = 0; i < paths.size(); ++i) {
+                const auto it = collections.find(paths[i]);
+                if (it != std::end(collections)) {
+                    known[i] = true;
+                    if (it->second->loaded())
+                        result[i] = it->second;
+                    collections.erase(it);
+                }
+            }
+            
+            // decode the missing collections on worker threads, the GL upload happens in commitChanges
+            TextureCollectionList loaded(paths.size(), nullptr);
+            StringList errors(paths.size());
+            try {
+                ParallelUtils::forEachIndex(paths.size(), [&](const size_t i) {
+                    if (result[i] == nullptr) {
+                        try {
+                            loaded[i] = loader.loadTextureCollection(paths[i]);
+                        } catch (const Exception& e) {
+                            errors[i] = e.what();
+                        }
                     }
+                });
+            } catch (...) {
+                VectorUtils::clearAndDelete(loaded);
+                throw;
+            }
+            
+            for (size_t i = 0; i < paths.size(); ++i) {
+                const IO::Path& path = paths[i];
+                if (result[i] != nullptr) {
+                    addTextureCollection(result[i]);
+                } else if (loaded[i] != nullptr) {
+                    m_logger->info("Loaded texture collection '" + path.asString() + "'");
+                    addTextureCollection(loaded[i]);
+                    loaded[i]->usageCountDidChange.addObserver(usageCountDidChange);
                 } else {
-                    addTextureCollection(it->second);
+                    addTextureCollection(new Assets::TextureCollection(path));
+                    if (!known[i])
+                        m_logger->error("Could not load texture collection '" + path.asString() + "': " + errors[i]);
                 }
-                if (it != std::end(collections))
-                    collections.erase(it);
             }
             
             updateTextures();
@@ -158,6 +186,11 @@ namespace TrenchBroom {
         }
         
         void TextureManager::prepare() {
+            // decode all collections in parallel before uploading them one after another
+            ParallelUtils::forEachIndex(m_toPrepare.size(), [this](const size_t i) {
+                m_toPrepare[i]->decode();
+            });
+            
             std::for_each(std::begin(m_toPrepare), std::end(m_toPrepare),
                           [this](auto collection) { collection->prepare(m_minFilter, m_magFilter); });
             m_toPrepare.clear();
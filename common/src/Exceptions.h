@@ -132,4 +132,9 @@ public:
     using ExceptionStream::ExceptionStream;
 };
 
+class CancelledException : public ExceptionStream<CancelledException> {
+public:
+    using ExceptionStream::ExceptionStream;
+};
+
 #endif
@@ -0,0 +1,371 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AssetCache.h"
+
+#include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "Assets/MdlModel.h"
+#include "Assets/Texture.h"
+#include "IO/DiskIO.h"
+
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        AssetCache::Key::Key() :
+        m_hash(14695981039346656037ULL) {}
+
+        void AssetCache::Key::add(const String& str) {
+            // prefix the length so that consecutive strings cannot be confused with each other
+            add(static_cast<uint64_t>(str.size()));
+            add(str.data(), str.data() + str.size());
+        }
+
+        void AssetCache::Key::add(const uint64_t value) {
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            add(bytes, bytes + sizeof(value));
+        }
+
+        void AssetCache::Key::add(const char* begin, const char* end) {
+            // 64 bit FNV-1a
+            for (const char* cur = begin; cur != end; ++cur) {
+                m_hash ^= static_cast<uint64_t>(static_cast<unsigned char>(*cur));
+                m_hash *= 1099511628211ULL;
+            }
+        }
+
+        void AssetCache::Key::addContents(const MappedFile& file) {
+            add(static_cast<uint64_t>(file.size()));
+            add(file.begin(), file.end());
+        }
+
+        uint64_t AssetCache::Key::hash() const {
+            return m_hash;
+        }
+
+        String AssetCache::Key::asString() const {
+            StringStream str;
+            str << std::hex << std::setw(16) << std::setfill('0') << m_hash;
+            return str.str();
+        }
+
+        void AssetCache::Writer::writeSize(const size_t size) {
+            write(static_cast<uint64_t>(size));
+        }
+
+        void AssetCache::Writer::writeString(const String& str) {
+            writeSize(str.size());
+            m_data.append(str);
+        }
+
+        void AssetCache::Writer::writeBytes(const char* begin, const size_t size) {
+            m_data.append(begin, size);
+        }
+
+        const String& AssetCache::Writer::data() const {
+            return m_data;
+        }
+
+        AssetCache::Reader::Reader(MappedFile::Ptr file) :
+        m_file(file),
+        m_cur(m_file->begin()) {}
+
+        bool AssetCache::Reader::eof() const {
+            return m_cur == m_file->end();
+        }
+
+        const MappedFile::Ptr& AssetCache::Reader::file() const {
+            return m_file;
+        }
+
+        size_t AssetCache::Reader::readSize() {
+            return static_cast<size_t>(read<uint64_t>());
+        }
+
+        size_t AssetCache::Reader::readLength() {
+            const uint64_t length = read<uint64_t>();
+            if (length > static_cast<uint64_t>(m_file->end() - m_cur))
+                throw FileFormatException("Invalid length in asset cache");
+            return static_cast<size_t>(length);
+        }
+
+        String AssetCache::Reader::readString() {
+            const size_t length = readLength();
+            return String(readBytes(length), length);
+        }
+
+        const char* AssetCache::Reader::readBytes(const size_t size) {
+            if (static_cast<size_t>(m_file->end() - m_cur) < size)
+                throw FileFormatException("Unexpected end of asset cache entry");
+            const char* result = m_cur;
+            m_cur += size;
+            return result;
+        }
+
+        const uint32_t AssetCache::TextureVersion = 1;
+        const uint32_t AssetCache::MdlModelVersion = 1;
+
+        const char AssetCache::Magic[] = { 'T', 'B', 'A', 'C' };
+        const uint32_t AssetCache::Version = 1;
+
+        AssetCache::AssetCache(const Path& directory) :
+        m_directory(directory) {}
+
+        const Path& AssetCache::directory() const {
+            return m_directory;
+        }
+
+        MappedFile::Ptr AssetCache::read(const Key& key) const {
+            try {
+                const Path path = entryPath(key);
+                if (!Disk::fileExists(path))
+                    return MappedFile::Ptr();
+
+                Reader reader(Disk::openFile(path));
+                char magic[sizeof(Magic)];
+                for (size_t i = 0; i < sizeof(Magic); ++i)
+                    magic[i] = reader.read<char>();
+                if (std::memcmp(magic, Magic, sizeof(Magic)) != 0 || reader.read<uint32_t>() != Version || reader.read<uint64_t>() != key.hash())
+                    return MappedFile::Ptr();
+
+                const size_t size = reader.readLength();
+                const char* begin = reader.readBytes(size);
+                if (!reader.eof())
+                    return MappedFile::Ptr();
+                return MappedFile::Ptr(new MappedFileView(reader.file(), path, begin, size));
+            } catch (const Exception&) {
+                return MappedFile::Ptr();
+            }
+        }
+
+        void AssetCache::write(const Key& key, const String& contents) const {
+            Disk::ensureDirectoryExists(m_directory);
+
+            // every thread uses its own temporary file, so that concurrent writers never write to the same file
+            const Path path = entryPath(key);
+            StringStream tempName;
+            tempName << key.asString() << "." << std::hex << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+            const Path tempPath = m_directory + Path(tempName.str());
+
+            Writer writer;
+            writer.writeBytes(Magic, sizeof(Magic));
+            writer.write(Version);
+            writer.write(key.hash());
+            writer.writeSize(contents.size());
+            writer.writeBytes(contents.data(), contents.size());
+
+            try {
+                std::ofstream stream(tempPath.asString().c_str(), std::ios::out | std::ios::binary);
+                if (!stream.is_open())
+                    throw FileSystemException("Could not open asset cache file '" + tempPath.asString() + "'");
+                stream.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+                stream.close();
+                if (stream.fail())
+                    throw FileSystemException("Could not write asset cache file '" + tempPath.asString() + "'");
+
+                Disk::moveFile(tempPath, path, true);
+            } catch (const FileSystemException&) {
+                if (Disk::fileExists(tempPath))
+                    Disk::deleteFile(tempPath);
+                throw;
+            }
+        }
+
+        void AssetCache::writeTextures(Writer& writer, const Assets::TextureList& textures) {
+            writer.writeSize(textures.size());
+            for (const Assets::Texture* texture : textures) {
+                writer.writeString(texture->name());
+                writer.writeSize(texture->width());
+                writer.writeSize(texture->height());
+                writer.write(static_cast<uint32_t>(texture->format()));
+                writer.write(static_cast<uint8_t>(texture->type()));
+
+                const Color& averageColor = texture->averageColor();
+                for (size_t i = 0; i < 4; ++i)
+                    writer.write(static_cast<float>(averageColor[i]));
+
+                const Assets::TextureBuffer::List& buffers = texture->buffers();
+                writer.writeSize(buffers.size());
+                for (const Assets::TextureBuffer& buffer : buffers) {
+                    writer.writeSize(buffer.size());
+                    writer.writeBytes(reinterpret_cast<const char*>(buffer.ptr()), buffer.size());
+                }
+            }
+        }
+
+        Assets::TextureList AssetCache::readTextures(Reader& reader) {
+            typedef std::pair<const char*, size_t> MipData;
+
+            Assets::TextureList result;
+            try {
+                const size_t count = reader.readLength();
+                for (size_t i = 0; i < count; ++i) {
+                    const String name = reader.readString();
+                    const size_t width = reader.readSize();
+                    const size_t height = reader.readSize();
+                    const GLenum format = static_cast<GLenum>(reader.read<uint32_t>());
+                    const uint8_t type = reader.read<uint8_t>();
+
+                    Color averageColor;
+                    for (size_t j = 0; j < 4; ++j)
+                        averageColor[j] = reader.read<float>();
+
+                    if (width == 0 || height == 0 || (format != GL_RGB && format != GL_BGR && format != GL_RGBA))
+                        throw FileFormatException("Invalid texture in asset cache");
+                    if (type != static_cast<uint8_t>(Assets::TextureType::Opaque) && type != static_cast<uint8_t>(Assets::TextureType::Masked))
+                        throw FileFormatException("Invalid texture type in asset cache");
+
+                    // the mip buffers must be large enough to be uploaded, so that a damaged entry cannot lead to
+                    // reads past the end of the mapped file
+                    const size_t mipCount = reader.readLength();
+                    if (mipCount == 0)
+                        throw FileFormatException("Missing mip buffers in asset cache");
+
+                    std::vector<MipData> mips;
+                    mips.reserve(mipCount);
+                    for (size_t j = 0; j < mipCount; ++j) {
+                        const size_t size = reader.readLength();
+                        const size_t div = static_cast<size_t>(1) << j;
+                        if (size < Assets::bytesPerPixelForFormat(format) * (width / div) * (height / div))
+                            throw FileFormatException("Invalid mip buffer size in asset cache");
+                        mips.push_back(std::make_pair(reader.readBytes(size), size));
+                    }
+
+                    const MappedFile::Ptr file = reader.file();
+                    const Assets::TextureBufferLoader loader = [file, mips]() {
+                        Assets::TextureBuffer::List buffers;
+                        buffers.reserve(mips.size());
+                        for (const MipData& mip : mips) {
+                            Assets::TextureBuffer buffer(mip.second);
+                            std::memcpy(buffer.ptr(), mip.first, mip.second);
+                            buffers.push_back(buffer);
+                        }
+                        return buffers;
+                    };
+
+                    result.push_back(new Assets::Texture(name, width, height, averageColor, loader, format, static_cast<Assets::TextureType>(type)));
+                }
+            } catch (...) {
+                VectorUtils::clearAndDelete(result);
+                throw;
+            }
+            return result;
+        }
+
+        void AssetCache::writeMdlModel(Writer& writer, const Assets::MdlModel& model) {
+            typedef Assets::MdlFrame::Vertex Vertex;
+
+            const Assets::MdlModel::MdlSkinList& skins = model.skins();
+            writer.writeSize(skins.size());
+            for (const Assets::MdlSkin* skin : skins) {
+                writeTextures(writer, skin->textures());
+                for (const float time : skin->times())
+                    writer.write(time);
+            }
+
+            // the renderer only uses the first frame of every frame group
+            writer.writeSize(sizeof(Vertex));
+            const Assets::MdlModel::MdlFrameList& frames = model.frames();
+            writer.writeSize(frames.size());
+            for (const Assets::MdlBaseFrame* baseFrame : frames) {
+                const Assets::MdlFrame* frame = baseFrame->firstFrame();
+                writer.write(static_cast<uint8_t>(frame != nullptr ? 1 : 0));
+                if (frame != nullptr) {
+                    writer.writeString(frame->name());
+
+                    const BBox3f bounds = frame->bounds();
+                    for (size_t i = 0; i < 3; ++i)
+                        writer.write(bounds.min[i]);
+                    for (size_t i = 0; i < 3; ++i)
+                        writer.write(bounds.max[i]);
+
+                    const Assets::MdlFrame::VertexList& vertices = frame->triangles();
+                    writer.writeSize(vertices.size());
+                    writer.writeBytes(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(Vertex));
+                }
+            }
+        }
+
+        Assets::MdlModel* AssetCache::readMdlModel(Reader& reader, const String& name) {
+            typedef Assets::MdlFrame::Vertex Vertex;
+
+            std::unique_ptr<Assets::MdlModel> model(new Assets::MdlModel(name));
+
+            const size_t skinCount = reader.readLength();
+            for (size_t i = 0; i < skinCount; ++i) {
+                Assets::TextureList textures = readTextures(reader);
+                try {
+                    if (textures.empty())
+                        throw FileFormatException("Empty skin in asset cache");
+
+                    Assets::MdlTimeList times;
+                    times.reserve(textures.size());
+                    for (size_t j = 0; j < textures.size(); ++j)
+                        times.push_back(reader.read<float>());
+                    model->addSkin(new Assets::MdlSkin(textures, times));
+                } catch (...) {
+                    VectorUtils::clearAndDelete(textures);
+                    throw;
+                }
+            }
+
+            if (reader.readSize() != sizeof(Vertex))
+                throw FileFormatException("Incompatible vertex format in asset cache");
+
+            const size_t frameCount = reader.readLength();
+            for (size_t i = 0; i < frameCount; ++i) {
+                if (reader.read<uint8_t>() == 0) {
+                    model->addFrame(new Assets::MdlFrameGroup());
+                    continue;
+                }
+
+                const String frameName = reader.readString();
+
+                BBox3f bounds;
+                for (size_t j = 0; j < 3; ++j)
+                    bounds.min[j] = reader.read<float>();
+                for (size_t j = 0; j < 3; ++j)
+                    bounds.max[j] = reader.read<float>();
+
+                const size_t vertexCount = reader.readLength();
+                const char* data = reader.readBytes(vertexCount * sizeof(Vertex));
+
+                Assets::MdlFrame::VertexList vertices(vertexCount);
+                if (vertexCount > 0)
+                    std::memcpy(static_cast<void*>(vertices.data()), data, vertexCount * sizeof(Vertex));
+                model->addFrame(new Assets::MdlFrame(frameName, vertices, bounds));
+            }
+
+            return model.release();
+        }
+
+        Path AssetCache::entryPath(const Key& key) const {
+            return m_directory + Path(key.asString() + ".tbasset");
+        }
+    }
+}
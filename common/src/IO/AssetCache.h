@@ -0,0 +1,186 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_AssetCache
+#define TrenchBroom_AssetCache
+
+#include "StringUtils.h"
+#include "Assets/AssetTypes.h"
+#include "IO/MappedFile.h"
+#include "IO/Path.h"
+
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Assets {
+        class MdlModel;
+    }
+
+    namespace IO {
+        /**
+         * A directory of decoded assets such as the RGBA mip buffers of textures and the vertex data of entity
+         * models. Every entry is stored in a file of its own whose name is derived from a key. The key is computed
+         * from everything that the decoded data depends on, such as the kind of asset, the version of its format,
+         * the path and the size of the source file and its modification time or contents. Entries therefore never
+         * need to be invalidated; an entry whose source has changed is simply never looked up again.
+         *
+         * The entries store their data in a flat layout that is read directly from a memory mapped file. Decoded
+         * textures keep a reference to the mapped entry and only copy their mip buffers when they are prepared.
+         */
+        class AssetCache {
+        public:
+            /**
+             * Computes the key of a cache entry by hashing the values that are added to it.
+             */
+            class Key {
+            private:
+                uint64_t m_hash;
+            public:
+                Key();
+
+                void add(const String& str);
+                void add(uint64_t value);
+                void add(const char* begin, const char* end);
+
+                /**
+                 * Adds the size and the contents of the given file.
+                 */
+                void addContents(const MappedFile& file);
+
+                uint64_t hash() const;
+                String asString() const;
+            };
+
+            /**
+             * Appends values to the contents of a cache entry.
+             */
+            class Writer {
+            private:
+                String m_data;
+            public:
+                template <typename T>
+                void write(const T value) {
+                    m_data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+                }
+
+                void writeSize(size_t size);
+                void writeString(const String& str);
+                void writeBytes(const char* begin, size_t size);
+
+                const String& data() const;
+            };
+
+            /**
+             * Reads values from the contents of a cache entry and throws a FileFormatException if a value extends
+             * past the end of the contents.
+             */
+            class Reader {
+            private:
+                MappedFile::Ptr m_file;
+                const char* m_cur;
+            public:
+                explicit Reader(MappedFile::Ptr file);
+
+                bool eof() const;
+                const MappedFile::Ptr& file() const;
+
+                template <typename T>
+                T read() {
+                    T value;
+                    std::memcpy(&value, readBytes(sizeof(T)), sizeof(T));
+                    return value;
+                }
+
+                size_t readSize();
+
+                /**
+                 * Reads the length of a string or the number of elements of a list. Every character or element
+                 * occupies at least one byte, so the length cannot exceed the number of remaining bytes.
+                 */
+                size_t readLength();
+                String readString();
+
+                /**
+                 * Skips the given number of bytes and returns a pointer to the first of them.
+                 */
+                const char* readBytes(size_t size);
+            };
+        public:
+            /**
+             * The versions of the formats in which textures and models are stored. Increment the version whenever
+             * the format or the decoded data changes.
+             */
+            static const uint32_t TextureVersion;
+            static const uint32_t MdlModelVersion;
+        private:
+            static const char Magic[];
+            static const uint32_t Version;
+
+            Path m_directory;
+        public:
+            explicit AssetCache(const Path& directory);
+
+            const Path& directory() const;
+
+            /**
+             * Returns the contents of the entry with the given key, or null if there is no such entry or if it is
+             * damaged.
+             */
+            MappedFile::Ptr read(const Key& key) const;
+
+            /**
+             * Stores the given contents in the entry with the given key, replacing any existing entry. The entry is
+             * written to a temporary file first, so that other readers never see a partially written entry. This
+             * function can be called from multiple threads at once.
+             *
+             * Throws a FileSystemException if the entry cannot be written.
+             */
+            void write(const Key& key, const String& contents) const;
+
+            /**
+             * Appends the given textures including their mip buffers. Textures whose mip buffers have not been
+             * decoded yet are decoded by this function.
+             */
+            static void writeTextures(Writer& writer, const Assets::TextureList& textures);
+
+            /**
+             * Reads textures that were written by writeTextures. The returned textures copy their mip buffers from
+             * the reader's file when they are prepared.
+             */
+            static Assets::TextureList readTextures(Reader& reader);
+
+            /**
+             * Appends the skins and the first frame of every frame of the given model, which are the parts of the
+             * model that are used for rendering.
+             */
+            static void writeMdlModel(Writer& writer, const Assets::MdlModel& model);
+            static Assets::MdlModel* readMdlModel(Reader& reader, const String& name);
+        private:
+            Path entryPath(const Key& key) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_AssetCache) */
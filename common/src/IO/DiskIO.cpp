@@ -106,6 +106,13 @@ namespace TrenchBroom {
                 const Path fixedPath = fixPath(path);
                 return ::wxFileExists(fixedPath.asString());
             }
+
+            time_t fileModificationTime(const Path& path) {
+                const Path fixedPath = fixPath(path);
+                if (!fileExists(fixedPath))
+                    throw FileNotFoundException("File not found: '" + fixedPath.asString() + "'");
+                return ::wxFileModificationTime(fixedPath.asString());
+            }
             
             String replaceForbiddenChars(const String& name) {
                 static const String forbidden = wxFileName::GetForbiddenChars().ToStdString();
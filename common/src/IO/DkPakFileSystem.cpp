@@ -112,15 +112,16 @@ namespace TrenchBroom {
                 const size_t compressedSize = reader.readSize<int32_t>();
                 const bool compressed = reader.readBool<int32_t>();
                 
-                const char* entryBegin = m_file->begin() + entryAddress;
-                const char* entryEnd = entryBegin + compressedSize;
                 const Path filePath(StringUtils::toLower(entryName));
-                MappedFile::Ptr entryFile(new MappedFileView(m_file, filePath, entryBegin, entryEnd));
                 
-                if (compressed)
-                    m_root.addFile(filePath, new SimpleFile(entryFile));
-                else
+                if (compressed) {
+                    m_root.addFile(filePath, new ViewFile(m_file, filePath, entryAddress, compressedSize));
+                } else {
+                    const char* entryBegin = m_file->begin() + entryAddress;
+                    const char* entryEnd = entryBegin + compressedSize;
+                    MappedFile::Ptr entryFile(new MappedFileView(m_file, filePath, entryBegin, entryEnd));
                     m_root.addFile(filePath, new CompressedFile(entryFile, uncompressedSize));
+                }
             }
         }
     }
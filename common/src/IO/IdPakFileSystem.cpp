@@ -62,12 +62,8 @@ namespace TrenchBroom {
                 const size_t entryLength = readSize<int32_t>(cursor);
                 assert(m_file->begin() + entryAddress + entryLength <= m_file->end());
                 
-                const char* entryBegin = m_file->begin() + entryAddress;
-                const char* entryEnd = entryBegin + entryLength;
                 const Path filePath(StringUtils::toLower(entryName));
-                MappedFile::Ptr entryFile(new MappedFileView(m_file, filePath, entryBegin, entryEnd));
-
-                m_root.addFile(filePath, new SimpleFile(entryFile));
+                m_root.addFile(filePath, new ViewFile(m_file, filePath, entryAddress, entryLength));
             }
         }
     }
@@ -37,9 +37,11 @@ namespace TrenchBroom {
         
         Assets::Texture* IdWalTextureReader::doReadTexture(const char* const begin, const char* const end, const Path& path) const {
             static const size_t MipLevels = 4;
-            static Color tempColor, averageColor;
-            static Assets::TextureBuffer::List buffers(MipLevels);
-            static size_t offset[MipLevels];
+            
+            // textures may be read concurrently, so the buffers must not be shared between calls
+            Color tempColor, averageColor;
+            Assets::TextureBuffer::List buffers(MipLevels);
+            size_t offset[MipLevels];
 
             CharArrayReader reader(begin, end);
             const String name = reader.readString(WalLayout::TextureNameLength);
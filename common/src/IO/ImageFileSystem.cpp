@@ -40,6 +40,18 @@ namespace TrenchBroom {
             return m_file;
         }
         
+        ImageFileSystem::ViewFile::ViewFile(MappedFile::Ptr image, const Path& path, const size_t offset, const size_t size) :
+        m_image(image),
+        m_path(path),
+        m_offset(offset),
+        m_size(size) {
+            ensure(m_offset + m_size <= m_image->size(), "file exceeds image");
+        }
+        
+        MappedFile::Ptr ImageFileSystem::ViewFile::doOpen() {
+            return MappedFile::Ptr(new MappedFileView(m_image, m_path, m_image->begin() + m_offset, m_size));
+        }
+        
         ImageFileSystem::Directory::Directory(const Path& path) :
         m_path(path) {}
         
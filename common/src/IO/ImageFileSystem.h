@@ -48,6 +48,22 @@ namespace TrenchBroom {
                 MappedFile::Ptr doOpen() override;
             };
             
+            /**
+             * A file that is stored uncompressed in the image. The view into the image is only created when the file
+             * is opened, so that indexing large images does not allocate a view per entry.
+             */
+            class ViewFile : public File {
+            private:
+                MappedFile::Ptr m_image;
+                Path m_path;
+                size_t m_offset;
+                size_t m_size;
+            public:
+                ViewFile(MappedFile::Ptr image, const Path& path, size_t offset, size_t size);
+            private:
+                MappedFile::Ptr doOpen() override;
+            };
+            
             class Directory {
             private:
                 typedef std::map<Path, Directory*, Path::Less<StringUtils::CaseInsensitiveStringLess>> DirMap;
@@ -0,0 +1,469 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapCache.h"
+
+#include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "ParallelUtils.h"
+#include "IO/IOUtils.h"
+#include "IO/Path.h"
+#include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/BrushFaceAttributes.h"
+#include "Model/Entity.h"
+#include "Model/Group.h"
+#include "Model/Layer.h"
+#include "Model/NodeVisitor.h"
+#include "Model/World.h"
+
+#include <cassert>
+#include <cstring>
+#include <ostream>
+
+namespace TrenchBroom {
+    namespace IO {
+        const char MapCache::Magic[] = { 'T', 'B', 'M', 'C' };
+        const uint32_t MapCache::Version = 2;
+
+        MapCache::Key::Key(const uint64_t i_size, const int64_t i_modificationTime, const uint64_t i_hash) :
+        size(i_size),
+        modificationTime(i_modificationTime),
+        hash(i_hash) {}
+
+        bool MapCache::Key::operator==(const Key& other) const {
+            return size == other.size && modificationTime == other.modificationTime && hash == other.hash;
+        }
+
+        MapCache::PendingBrush::PendingBrush(const size_t i_lineNumber, const size_t i_lineCount) :
+        lineNumber(i_lineNumber),
+        lineCount(i_lineCount),
+        brush(nullptr) {}
+
+        MapCache::PendingChild::PendingChild(Model::Node* i_parent, Model::Node* i_node, const size_t i_brushIndex) :
+        parent(i_parent),
+        node(i_node),
+        brushIndex(i_brushIndex) {}
+
+        /**
+         * Reads values from the cache contents and throws a FileFormatException if a value extends past the end of
+         * the contents.
+         */
+        class MapCache::Reader {
+        private:
+            const char* m_cur;
+            const char* m_end;
+        public:
+            Reader(const char* begin, const char* end) :
+            m_cur(begin),
+            m_end(end) {
+                assert(m_cur <= m_end);
+            }
+
+            bool eof() const {
+                return m_cur == m_end;
+            }
+
+            template <typename T>
+            T read() {
+                check(sizeof(T));
+                return IO::read<T>(m_cur);
+            }
+
+            size_t readSize() {
+                return static_cast<size_t>(read<uint64_t>());
+            }
+
+            /**
+             * Reads the length of a string or the number of elements of a list. Every character or element occupies at
+             * least one byte, so the length cannot exceed the number of remaining bytes.
+             */
+            size_t readLength() {
+                const uint64_t length = read<uint64_t>();
+                if (length > static_cast<uint64_t>(m_end - m_cur))
+                    throw FileFormatException("Invalid length in map cache");
+                return static_cast<size_t>(length);
+            }
+
+            String readString() {
+                const size_t length = readLength();
+                const String result(m_cur, length);
+                m_cur += length;
+                return result;
+            }
+
+            Vec3 readVec3() {
+                const double x = read<double>();
+                const double y = read<double>();
+                const double z = read<double>();
+                return Vec3(x, y, z);
+            }
+
+            Model::EntityAttribute::List readAttributes() {
+                Model::EntityAttribute::List result;
+                const size_t count = readLength();
+                for (size_t i = 0; i < count; ++i) {
+                    const String name = readString();
+                    const String value = readString();
+                    result.push_back(Model::EntityAttribute(name, value));
+                }
+                return result;
+            }
+        private:
+            void check(const size_t size) const {
+                if (static_cast<size_t>(m_end - m_cur) < size)
+                    throw FileFormatException("Unexpected end of map cache");
+            }
+        };
+
+        /**
+         * Appends the nodes of a world to a buffer in pre-order.
+         */
+        class MapCache::WriteNode : public Model::ConstNodeVisitor {
+        private:
+            String& m_buffer;
+        public:
+            WriteNode(String& buffer) :
+            m_buffer(buffer) {}
+
+            template <typename T>
+            void write(const T value) {
+                m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            void writeSize(const size_t size) {
+                write(static_cast<uint64_t>(size));
+            }
+
+            void writeString(const String& str) {
+                writeSize(str.size());
+                m_buffer.append(str);
+            }
+
+            void writeVec3(const Vec3& vec) {
+                write(static_cast<double>(vec.x()));
+                write(static_cast<double>(vec.y()));
+                write(static_cast<double>(vec.z()));
+            }
+        private:
+            void doVisit(const Model::World* world) override {
+                writeAttributes(world->attributes());
+                writePosition(world);
+                writeChildren(world);
+            }
+
+            void doVisit(const Model::Layer* layer) override {
+                writeString(layer->name());
+                writePosition(layer);
+                writeChildren(layer);
+            }
+
+            void doVisit(const Model::Group* group) override {
+                write(static_cast<uint8_t>(NodeType_Group));
+                writeString(group->name());
+                writePosition(group);
+                writeChildren(group);
+            }
+
+            void doVisit(const Model::Entity* entity) override {
+                write(static_cast<uint8_t>(NodeType_Entity));
+                writeAttributes(entity->attributes());
+                writePosition(entity);
+                writeChildren(entity);
+            }
+
+            void doVisit(const Model::Brush* brush) override {
+                write(static_cast<uint8_t>(NodeType_Brush));
+                writePosition(brush);
+
+                const Model::FlatBrushGeometry& geometry = brush->flatGeometry();
+                writeSize(geometry.vertexCount());
+                for (const Vec3& position : geometry.vertexPositions())
+                    writeVec3(position);
+
+                const Model::BrushFaceList& faces = brush->faces();
+                writeSize(faces.size());
+                for (const Model::BrushFace* face : faces) {
+                    writeFace(face);
+                    writeFaceVertexIndices(geometry, face);
+                }
+            }
+
+            void writeFace(const Model::BrushFace* face) {
+                const Model::BrushFace::Points& points = face->points();
+                writeVec3(points[0]);
+                writeVec3(points[1]);
+                writeVec3(points[2]);
+                writeSize(face->lineNumber());
+                writeSize(face->lineCount());
+
+                const Model::BrushFaceAttributes& attribs = face->attribs();
+                writeString(attribs.textureName());
+                write(attribs.xOffset());
+                write(attribs.yOffset());
+                write(attribs.rotation());
+                write(attribs.xScale());
+                write(attribs.yScale());
+                write(static_cast<int32_t>(attribs.surfaceContents()));
+                write(static_cast<int32_t>(attribs.surfaceFlags()));
+                write(attribs.surfaceValue());
+
+                writeVec3(face->textureXAxis());
+                writeVec3(face->textureYAxis());
+            }
+
+            void writeFaceVertexIndices(const Model::FlatBrushGeometry& geometry, const Model::BrushFace* face) {
+                size_t faceIndex = 0;
+                while (faceIndex < geometry.faceCount() && geometry.face(faceIndex) != face)
+                    ++faceIndex;
+                assert(faceIndex < geometry.faceCount());
+
+                writeSize(geometry.faceVertexCount(faceIndex));
+                for (const size_t* index = geometry.faceVertexIndicesBegin(faceIndex); index != geometry.faceVertexIndicesEnd(faceIndex); ++index)
+                    write(static_cast<uint32_t>(*index));
+            }
+
+            void writeAttributes(const Model::EntityAttribute::List& attributes) {
+                writeSize(attributes.size());
+                for (const Model::EntityAttribute& attribute : attributes) {
+                    writeString(attribute.name());
+                    writeString(attribute.value());
+                }
+            }
+
+            void writePosition(const Model::Node* node) {
+                writeSize(node->lineNumber());
+                writeSize(node->lineCount());
+            }
+
+            void writeChildren(const Model::Node* node) {
+                const Model::NodeList& children = node->children();
+                writeSize(children.size());
+                for (const Model::Node* child : children)
+                    child->accept(*this);
+            }
+        };
+
+        MapCache::MapCache(const char* mapBegin, const char* mapEnd, const int64_t mapModificationTime) :
+        m_key(static_cast<uint64_t>(mapEnd - mapBegin), mapModificationTime, hash(mapBegin, mapEnd)) {}
+
+        Path MapCache::cachePath(const Path& mapPath) {
+            return mapPath.addExtension("tbcache");
+        }
+
+        Model::World* MapCache::read(const char* begin, const char* end, const Model::MapFormat::Type format, const BBox3& worldBounds, const Model::BrushContentTypeBuilder* brushContentTypeBuilder) const {
+            Model::World* world = nullptr;
+            std::vector<PendingChild> children;
+            std::vector<PendingBrush> brushes;
+
+            try {
+                Reader reader(begin, end);
+
+                char magic[sizeof(Magic)];
+                for (size_t i = 0; i < sizeof(Magic); ++i)
+                    magic[i] = reader.read<char>();
+                if (std::memcmp(magic, Magic, sizeof(Magic)) != 0 || reader.read<uint32_t>() != Version)
+                    return nullptr;
+
+                const uint64_t size = reader.read<uint64_t>();
+                const int64_t modificationTime = reader.read<int64_t>();
+                const uint64_t hash = reader.read<uint64_t>();
+                if (!(Key(size, modificationTime, hash) == m_key))
+                    return nullptr;
+
+                if (reader.read<int32_t>() != static_cast<int32_t>(format))
+                    return nullptr;
+
+                world = new Model::World(format, brushContentTypeBuilder, worldBounds);
+                world->disableNodeTreeUpdates();
+
+                readWorld(reader, world, worldBounds, children, brushes);
+                if (!reader.eof())
+                    throw FileFormatException("Unexpected data at end of map cache");
+
+                createBrushes(worldBounds, brushContentTypeBuilder, brushes);
+            } catch (const Exception&) {
+                for (const PendingChild& child : children)
+                    delete child.node;
+                for (PendingBrush& brush : brushes) {
+                    VectorUtils::clearAndDelete(brush.faces);
+                    delete brush.brush;
+                }
+                delete world;
+                return nullptr;
+            }
+
+            for (const PendingChild& child : children) {
+                Model::Node* node = child.node != nullptr ? child.node : brushes[child.brushIndex].brush;
+                child.parent->addChild(node);
+            }
+
+            world->rebuildNodeTree();
+            world->enableNodeTreeUpdates();
+            return world;
+        }
+
+        void MapCache::write(const Model::World* world, std::ostream& stream) const {
+            String buffer;
+            WriteNode writer(buffer);
+
+            buffer.append(Magic, sizeof(Magic));
+            writer.write(Version);
+            writer.write(m_key.size);
+            writer.write(m_key.modificationTime);
+            writer.write(m_key.hash);
+            writer.write(static_cast<int32_t>(world->format()));
+            world->accept(writer);
+
+            stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+
+        uint64_t MapCache::hash(const char* begin, const char* end) {
+            // 64 bit FNV-1a
+            uint64_t result = 14695981039346656037ULL;
+            for (const char* cur = begin; cur != end; ++cur) {
+                result ^= static_cast<uint64_t>(static_cast<unsigned char>(*cur));
+                result *= 1099511628211ULL;
+            }
+            return result;
+        }
+
+        void MapCache::readWorld(Reader& reader, Model::World* world, const BBox3& worldBounds, std::vector<PendingChild>& children, std::vector<PendingBrush>& brushes) const {
+            world->setAttributes(reader.readAttributes());
+            const size_t lineNumber = reader.readSize();
+            const size_t lineCount = reader.readSize();
+            world->setFilePosition(lineNumber, lineCount);
+
+            // the first layer is always the default layer, which is created by the world
+            const size_t layerCount = reader.readLength();
+            if (layerCount == 0)
+                throw FileFormatException("Missing default layer in map cache");
+
+            for (size_t i = 0; i < layerCount; ++i) {
+                const String name = reader.readString();
+                Model::Layer* layer = i == 0 ? world->defaultLayer() : world->createLayer(name, worldBounds);
+                if (i > 0)
+                    children.push_back(PendingChild(world, layer, 0));
+
+                const size_t layerLineNumber = reader.readSize();
+                const size_t layerLineCount = reader.readSize();
+                layer->setFilePosition(layerLineNumber, layerLineCount);
+
+                readChildren(reader, world, layer, children, brushes);
+            }
+        }
+
+        void MapCache::readChildren(Reader& reader, Model::World* world, Model::Node* parent, std::vector<PendingChild>& children, std::vector<PendingBrush>& brushes) const {
+            const size_t count = reader.readLength();
+            for (size_t i = 0; i < count; ++i) {
+                const NodeType type = static_cast<NodeType>(reader.read<uint8_t>());
+                switch (type) {
+                    case NodeType_Group: {
+                        Model::Group* group = world->createGroup(reader.readString());
+                        children.push_back(PendingChild(parent, group, 0));
+
+                        const size_t lineNumber = reader.readSize();
+                        const size_t lineCount = reader.readSize();
+                        group->setFilePosition(lineNumber, lineCount);
+
+                        readChildren(reader, world, group, children, brushes);
+                        break;
+                    }
+                    case NodeType_Entity: {
+                        Model::Entity* entity = world->createEntity();
+                        children.push_back(PendingChild(parent, entity, 0));
+                        entity->setAttributes(reader.readAttributes());
+
+                        const size_t lineNumber = reader.readSize();
+                        const size_t lineCount = reader.readSize();
+                        entity->setFilePosition(lineNumber, lineCount);
+
+                        readChildren(reader, world, entity, children, brushes);
+                        break;
+                    }
+                    case NodeType_Brush: {
+                        const size_t lineNumber = reader.readSize();
+                        const size_t lineCount = reader.readSize();
+                        children.push_back(PendingChild(parent, nullptr, brushes.size()));
+                        brushes.push_back(PendingBrush(lineNumber, lineCount));
+
+                        readBrush(reader, world, brushes.back());
+                        break;
+                    }
+                    default:
+                        throw FileFormatException("Unknown node type in map cache");
+                }
+            }
+        }
+
+        void MapCache::readBrush(Reader& reader, Model::World* world, PendingBrush& brush) const {
+            const size_t vertexCount = reader.readLength();
+            brush.vertexPositions.reserve(vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i)
+                brush.vertexPositions.push_back(reader.readVec3());
+
+            const size_t faceCount = reader.readLength();
+            brush.faceVertexIndices.resize(faceCount);
+            for (size_t i = 0; i < faceCount; ++i) {
+                const Vec3 point1 = reader.readVec3();
+                const Vec3 point2 = reader.readVec3();
+                const Vec3 point3 = reader.readVec3();
+                const size_t lineNumber = reader.readSize();
+                const size_t lineCount = reader.readSize();
+
+                Model::BrushFaceAttributes attribs(reader.readString());
+                attribs.setXOffset(reader.read<float>());
+                attribs.setYOffset(reader.read<float>());
+                attribs.setRotation(reader.read<float>());
+                attribs.setXScale(reader.read<float>());
+                attribs.setYScale(reader.read<float>());
+                attribs.setSurfaceContents(reader.read<int32_t>());
+                attribs.setSurfaceFlags(reader.read<int32_t>());
+                attribs.setSurfaceValue(reader.read<float>());
+
+                const Vec3 texAxisX = reader.readVec3();
+                const Vec3 texAxisY = reader.readVec3();
+
+                Model::BrushFace* face = world->createFace(point1, point2, point3, attribs, texAxisX, texAxisY);
+                face->setFilePosition(lineNumber, lineCount);
+                brush.faces.push_back(face);
+
+                // the brush checks that the indices refer to its vertices
+                std::vector<size_t>& indices = brush.faceVertexIndices[i];
+                const size_t indexCount = reader.readLength();
+                indices.reserve(indexCount);
+                for (size_t j = 0; j < indexCount; ++j)
+                    indices.push_back(static_cast<size_t>(reader.read<uint32_t>()));
+            }
+        }
+
+        void MapCache::createBrushes(const BBox3& worldBounds, const Model::BrushContentTypeBuilder* brushContentTypeBuilder, std::vector<PendingBrush>& brushes) const {
+            // a brush that cannot be built invalidates the entire cache because it was valid when the cache was written
+            ParallelUtils::forEachIndex(brushes.size(), [brushContentTypeBuilder, &worldBounds, &brushes](const size_t i) {
+                PendingBrush& pending = brushes[i];
+                Model::BrushFaceList faces;
+                faces.swap(pending.faces); // the faces are now owned by the brush or deleted by its constructor
+
+                pending.brush = new Model::Brush(worldBounds, faces, pending.vertexPositions, pending.faceVertexIndices);
+                pending.brush->setContentTypeBuilder(brushContentTypeBuilder);
+                pending.brush->setFilePosition(pending.lineNumber, pending.lineCount);
+            });
+        }
+    }
+}
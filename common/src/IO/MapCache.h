@@ -0,0 +1,131 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapCache
+#define TrenchBroom_MapCache
+
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "StringUtils.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelTypes.h"
+
+#include <iosfwd>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushContentTypeBuilder;
+    }
+
+    namespace IO {
+        class Path;
+
+        /**
+         * A binary snapshot of a world that was loaded from a map file. The snapshot is stored next to the map file
+         * and is keyed by the size, the modification time and a hash of the contents of the map file, so that it can
+         * be used instead of the map file as long as the map file has not changed.
+         *
+         * The snapshot stores the node hierarchy, the entity attributes, the brush faces and the vertices of the brush
+         * geometry in a flat layout that is read directly from a memory mapped file. The brush geometry is created
+         * from the stored vertices in parallel when the snapshot is read, so the geometry need not be computed from
+         * the face planes again.
+         */
+        class MapCache {
+        private:
+            typedef enum {
+                NodeType_Group,
+                NodeType_Entity,
+                NodeType_Brush
+            } NodeType;
+
+            struct Key {
+                uint64_t size;
+                int64_t modificationTime;
+                uint64_t hash;
+
+                Key(uint64_t i_size, int64_t i_modificationTime, uint64_t i_hash);
+                bool operator==(const Key& other) const;
+            };
+
+            struct PendingBrush {
+                size_t lineNumber;
+                size_t lineCount;
+                Model::BrushFaceList faces;
+                Vec3::List vertexPositions;
+                std::vector<std::vector<size_t>> faceVertexIndices;
+                Model::Brush* brush;
+
+                PendingBrush(size_t i_lineNumber, size_t i_lineCount);
+            };
+
+            struct PendingChild {
+                Model::Node* parent;
+                Model::Node* node;
+                size_t brushIndex;
+
+                PendingChild(Model::Node* i_parent, Model::Node* i_node, size_t i_brushIndex);
+            };
+
+            class Reader;
+            class WriteNode;
+
+            static const char Magic[];
+            static const uint32_t Version;
+
+            Key m_key;
+        public:
+            /**
+             * Creates a cache for the map file with the given contents and modification time.
+             */
+            MapCache(const char* mapBegin, const char* mapEnd, int64_t mapModificationTime);
+
+            /**
+             * Returns the path of the cache file for the map file at the given path.
+             */
+            static Path cachePath(const Path& mapPath);
+
+            /**
+             * Reads a world from the given cache file contents. Returns null if the cache does not belong to the map
+             * file, if it was created for a different format or by a different version, or if it is damaged.
+             */
+            Model::World* read(const char* begin, const char* end, Model::MapFormat::Type format, const BBox3& worldBounds, const Model::BrushContentTypeBuilder* brushContentTypeBuilder) const;
+
+            /**
+             * Writes the given world to the given stream, which must be opened in binary mode.
+             */
+            void write(const Model::World* world, std::ostream& stream) const;
+        private:
+            static uint64_t hash(const char* begin, const char* end);
+
+            void readWorld(Reader& reader, Model::World* world, const BBox3& worldBounds, std::vector<PendingChild>& children, std::vector<PendingBrush>& brushes) const;
+            void readChildren(Reader& reader, Model::World* world, Model::Node* parent, std::vector<PendingChild>& children, std::vector<PendingBrush>& brushes) const;
+            void readBrush(Reader& reader, Model::World* world, PendingBrush& brush) const;
+            void createBrushes(const BBox3& worldBounds, const Model::BrushContentTypeBuilder* brushContentTypeBuilder, std::vector<PendingBrush>& brushes) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapCache) */
@@ -0,0 +1,214 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapEntityScanner.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace IO {
+        MapEntityScanner::Range::Range(const char* i_begin, const char* i_end, const size_t i_line, const size_t i_column) :
+        begin(i_begin),
+        end(i_end),
+        line(i_line),
+        column(i_column) {}
+
+        MapEntityScanner::Entity::Entity(const Range& i_range) :
+        range(i_range),
+        lastLine(i_range.line),
+        splittable(true) {}
+
+        MapEntityScanner::MapEntityScanner(const char* begin, const char* end) :
+        m_begin(begin),
+        m_end(end),
+        m_cur(m_begin),
+        m_line(1),
+        m_lineBegin(m_begin) {
+            assert(m_begin <= m_end);
+        }
+
+        bool MapEntityScanner::scan(EntityList& result) {
+            return scan(result, std::numeric_limits<size_t>::max());
+        }
+
+        bool MapEntityScanner::scan(EntityList& result, const size_t byteCount) {
+            const char* begin = m_cur;
+            if (!skipWhitespaceAndComments())
+                return false;
+
+            while (!eof() && static_cast<size_t>(m_cur - begin) < byteCount) {
+                if (*m_cur != '{' || !scanEntity(result))
+                    return false;
+                if (!skipWhitespaceAndComments())
+                    return false;
+            }
+            return true;
+        }
+
+        bool MapEntityScanner::scanEntity(EntityList& result) {
+            assert(*m_cur == '{');
+
+            Entity entity(Range(m_cur, m_cur, m_line, column()));
+            const char* brushBegin = nullptr;
+            size_t brushLine = 0;
+            size_t brushColumn = 0;
+
+            size_t depth = 0;
+            while (!eof()) {
+                switch (*m_cur) {
+                    case '"':
+                        if (depth == 1 && !entity.brushes.empty())
+                            entity.splittable = false;
+                        advance();
+                        if (!skipQuotedString())
+                            return false;
+                        break;
+                    case '/':
+                        if (m_cur + 1 < m_end && m_cur[1] == '/') {
+                            // extra attributes after the first brush belong to the entity
+                            if (depth == 1 && !entity.brushes.empty() && m_cur + 2 < m_end && m_cur[2] == '/')
+                                entity.splittable = false;
+                            skipComment();
+                        } else {
+                            advance();
+                        }
+                        break;
+                    case '{':
+                        // brushes cannot contain any nested structures
+                        if (++depth > 2)
+                            return false;
+                        if (depth == 2) {
+                            brushBegin = m_cur;
+                            brushLine = m_line;
+                            brushColumn = column();
+                        }
+                        advance();
+                        break;
+                    case '}':
+                        if (depth == 1)
+                            entity.lastLine = m_line;
+                        advance();
+                        if (--depth == 0) {
+                            entity.range.end = m_cur;
+                            result.push_back(entity);
+                            return true;
+                        } else if (depth == 1) {
+                            entity.brushes.push_back(Range(brushBegin, m_cur, brushLine, brushColumn));
+                        }
+                        break;
+                    case ')':
+                        advance();
+                        if (depth == 2) {
+                            // texture names follow the last point of a face and can contain braces, so we skip them
+                            skipWhitespace();
+                            if (!eof() && *m_cur != '(') {
+                                if (*m_cur == '"') {
+                                    advance();
+                                    if (!skipQuotedString())
+                                        return false;
+                                } else {
+                                    skipWord();
+                                }
+                            }
+                        }
+                        break;
+                    default:
+                        advance();
+                        break;
+                }
+            }
+            return false;
+        }
+
+        bool MapEntityScanner::skipQuotedString() {
+            // This mirrors the handling of quoted strings in QuakeMapTokenizer, including its handling of paths with
+            // trailing backslashes.
+            bool escaped = false;
+            while (!eof()) {
+                const char c = *m_cur;
+                if (c == '"') {
+                    if (!escaped || (m_cur + 1 < m_end && (m_cur[1] == '\n' || m_cur[1] == '}'))) {
+                        advance();
+                        return true;
+                    }
+                    escaped = false;
+                } else if (c == '\\') {
+                    escaped = !escaped;
+                } else {
+                    escaped = false;
+                }
+                advance();
+            }
+            return false;
+        }
+
+        void MapEntityScanner::skipWord() {
+            while (!eof() && *m_cur != ' ' && *m_cur != '\t' && *m_cur != '\n' && *m_cur != '\r')
+                advance();
+        }
+
+        void MapEntityScanner::skipComment() {
+            while (!eof() && *m_cur != '\n')
+                advance();
+        }
+
+        bool MapEntityScanner::skipWhitespaceAndComments() {
+            skipWhitespace();
+            while (!eof() && *m_cur == '/') {
+                // extra attribute comments are not allowed at the top level
+                if (m_cur + 1 < m_end && m_cur[1] == '/' && (m_cur + 2 == m_end || m_cur[2] != '/'))
+                    skipComment();
+                else
+                    return false;
+                skipWhitespace();
+            }
+            return true;
+        }
+
+        void MapEntityScanner::skipWhitespace() {
+            while (!eof() && (*m_cur == ' ' || *m_cur == '\t' || *m_cur == '\n' || *m_cur == '\r'))
+                advance();
+        }
+
+        bool MapEntityScanner::eof() const {
+            return m_cur >= m_end;
+        }
+
+        const char* MapEntityScanner::position() const {
+            return m_cur;
+        }
+
+        size_t MapEntityScanner::line() const {
+            return m_line;
+        }
+
+        size_t MapEntityScanner::column() const {
+            return static_cast<size_t>(m_cur - m_lineBegin) + 1;
+        }
+
+        void MapEntityScanner::advance() {
+            assert(!eof());
+            if (*m_cur == '\n') {
+                ++m_line;
+                m_lineBegin = m_cur + 1;
+            }
+            ++m_cur;
+        }
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapEntityScanner
+#define TrenchBroom_MapEntityScanner
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * Finds the character ranges of the top level entities and their brushes in a map file without tokenizing
+         * it. The scanner only tracks braces, quoted strings, comments and texture names, so it is much faster than
+         * the parser, and the ranges it finds can be parsed independently of each other.
+         *
+         * The scanner is conservative: if it encounters anything that the parser would not accept at the top level,
+         * it fails, and the caller is expected to fall back to parsing the entire buffer.
+         */
+        class MapEntityScanner {
+        public:
+            struct Range {
+                const char* begin;
+                const char* end;
+                size_t line;
+                size_t column;
+
+                Range(const char* i_begin, const char* i_end, size_t i_line, size_t i_column);
+            };
+
+            typedef std::vector<Range> RangeList;
+
+            struct Entity {
+                Range range;
+                RangeList brushes;
+                // the line of the closing brace
+                size_t lastLine;
+                // true if the entity's attributes all precede its first brush and nothing but brushes and plain
+                // comments follow, so that its brushes can be parsed separately from its attributes
+                bool splittable;
+
+                Entity(const Range& i_range);
+            };
+
+            typedef std::vector<Entity> EntityList;
+        private:
+            const char* m_begin;
+            const char* m_end;
+            const char* m_cur;
+            size_t m_line;
+            const char* m_lineBegin;
+        public:
+            MapEntityScanner(const char* begin, const char* end);
+
+            /**
+             * Scans the remainder of the buffer and appends every top level entity to the given list.
+             *
+             * @param result the list to append the entities to
+             * @return true if the remainder of the buffer could be scanned and false otherwise, in which case the
+             * contents of the given list are undefined
+             */
+            bool scan(EntityList& result);
+
+            /**
+             * Scans whole top level entities from the current position until at least the given number of bytes
+             * have been scanned or the end of the buffer is reached, and appends them to the given list. Calling
+             * this repeatedly scans the buffer in chunks.
+             *
+             * @param result the list to append the entities to
+             * @param byteCount the minimum number of bytes to scan
+             * @return true if the entities could be scanned and false otherwise, in which case the contents of the
+             * given list and the position of the scanner are undefined
+             */
+            bool scan(EntityList& result, size_t byteCount);
+
+            /**
+             * Indicates whether the scanner has reached the end of the buffer.
+             */
+            bool eof() const;
+
+            const char* position() const;
+            size_t line() const;
+            size_t column() const;
+        private:
+            bool scanEntity(EntityList& result);
+            bool skipQuotedString();
+            void skipWord();
+            void skipComment();
+            bool skipWhitespaceAndComments();
+            void skipWhitespace();
+
+            void advance();
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapEntityScanner) */
@@ -19,191 +19,110 @@
 
 #include "MapFileSerializer.h"
 #include "Exceptions.h"
+#include "ParallelUtils.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/Path.h"
 #include "Model/BrushFace.h"
 
+#include <cstdio>
+
 namespace TrenchBroom {
     namespace IO {
         class StandardFileSerializer : public MapFileSerializer {
         private:
             bool m_longFormat;
-            String FaceFormat;
         public:
             StandardFileSerializer(FILE* stream, const bool longFormat) :
             MapFileSerializer(stream),
-            m_longFormat(longFormat) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "%s %.6g %.6g %.6g %.6g %.6g";
-                if (m_longFormat)
-                    str << " %d %d %.6g";
-                FaceFormat = str.str();
-            }
+            m_longFormat(longFormat) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                const Model::BrushFace::Points& points = face->points();
+            void doWriteBrushFace(String& buffer, const Model::BrushFace* face) const override {
+                appendPoints(buffer, face);
+                appendTextureName(buffer, face);
+                appendRounded(buffer, face->xOffset());
+                buffer += ' ';
+                appendRounded(buffer, face->yOffset());
+                buffer += ' ';
+                appendRounded(buffer, face->rotation());
+                buffer += ' ';
+                appendRounded(buffer, face->xScale());
+                buffer += ' ';
+                appendRounded(buffer, face->yScale());
                 
                 if (m_longFormat) {
-                    std::fprintf(stream, FaceFormat.c_str(),
-                                 points[0].x(),
-                                 points[0].y(),
-                                 points[0].z(),
-                                 points[1].x(),
-                                 points[1].y(),
-                                 points[1].z(),
-                                 points[2].x(),
-                                 points[2].y(),
-                                 points[2].z(),
-                                 textureName.c_str(),
-                                 face->xOffset(),
-                                 face->yOffset(),
-                                 face->rotation(),
-                                 face->xScale(),
-                                 face->yScale(),
-                                 face->surfaceContents(),
-                                 face->surfaceFlags(),
-                                 face->surfaceValue());
-                } else {
-                    std::fprintf(stream, FaceFormat.c_str(),
-                                 points[0].x(),
-                                 points[0].y(),
-                                 points[0].z(),
-                                 points[1].x(),
-                                 points[1].y(),
-                                 points[1].z(),
-                                 points[2].x(),
-                                 points[2].y(),
-                                 points[2].z(),
-                                 textureName.c_str(),
-                                 face->xOffset(),
-                                 face->yOffset(),
-                                 face->rotation(),
-                                 face->xScale(),
-                                 face->yScale());
+                    buffer += ' ';
+                    appendInt(buffer, face->surfaceContents());
+                    buffer += ' ';
+                    appendInt(buffer, face->surfaceFlags());
+                    buffer += ' ';
+                    appendRounded(buffer, face->surfaceValue());
                 }
-                std::fprintf(stream, "\n");
-                return 1;
+                buffer += '\n';
             }
         };
         
         class Hexen2FileSerializer : public MapFileSerializer {
-        private:
-            String FaceFormat;
         public:
             Hexen2FileSerializer(FILE* stream) :
-            MapFileSerializer(stream) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "%s %.6g %.6g %.6g %.6g %.6g 0\n"; // the extra value is written here
-                
-                FaceFormat = str.str();
-            }
+            MapFileSerializer(stream) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                const Model::BrushFace::Points& points = face->points();
-                
-                std::fprintf(stream, FaceFormat.c_str(),
-                             points[0].x(),
-                             points[0].y(),
-                             points[0].z(),
-                             points[1].x(),
-                             points[1].y(),
-                             points[1].z(),
-                             points[2].x(),
-                             points[2].y(),
-                             points[2].z(),
-                             textureName.c_str(),
-                             face->xOffset(),
-                             face->yOffset(),
-                             face->rotation(),
-                             face->xScale(),
-                             face->yScale());
-                return 1;
+            void doWriteBrushFace(String& buffer, const Model::BrushFace* face) const override {
+                appendPoints(buffer, face);
+                appendTextureName(buffer, face);
+                appendRounded(buffer, face->xOffset());
+                buffer += ' ';
+                appendRounded(buffer, face->yOffset());
+                buffer += ' ';
+                appendRounded(buffer, face->rotation());
+                buffer += ' ';
+                appendRounded(buffer, face->xScale());
+                buffer += ' ';
+                appendRounded(buffer, face->yScale());
+                buffer += " 0\n"; // the extra value is written here
             }
         };
         
         class ValveFileSerializer : public MapFileSerializer {
-        private:
-            String FaceFormat;
         public:
             ValveFileSerializer(FILE* stream) :
-            MapFileSerializer(stream) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "%s " <<
-                "[ %.6g %.6g %.6g %.6g ] " <<
-                "[ %.6g %.6g %.6g %.6g ] " <<
-                "%.6g %.6g %.6g\n";
-                
-                FaceFormat = str.str();
-            }
+            MapFileSerializer(stream) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
+            void doWriteBrushFace(String& buffer, const Model::BrushFace* face) const override {
                 const Vec3 xAxis = face->textureXAxis();
                 const Vec3 yAxis = face->textureYAxis();
-                const Model::BrushFace::Points& points = face->points();
                 
-                std::fprintf(stream, FaceFormat.c_str(),
-                             points[0].x(),
-                             points[0].y(),
-                             points[0].z(),
-                             points[1].x(),
-                             points[1].y(),
-                             points[1].z(),
-                             points[2].x(),
-                             points[2].y(),
-                             points[2].z(),
-                             
-                             textureName.c_str(),
-                             
-                             xAxis.x(),
-                             xAxis.y(),
-                             xAxis.z(),
-                             face->xOffset(),
-                             
-                             yAxis.x(),
-                             yAxis.y(),
-                             yAxis.z(),
-                             face->yOffset(),
-                             
-                             face->rotation(),
-                             face->xScale(),
-                             face->yScale());
-                return 1;
+                appendPoints(buffer, face);
+                appendTextureName(buffer, face);
+                
+                buffer += "[ ";
+                appendRounded(buffer, xAxis.x());
+                buffer += ' ';
+                appendRounded(buffer, xAxis.y());
+                buffer += ' ';
+                appendRounded(buffer, xAxis.z());
+                buffer += ' ';
+                appendRounded(buffer, face->xOffset());
+                buffer += " ] [ ";
+                appendRounded(buffer, yAxis.x());
+                buffer += ' ';
+                appendRounded(buffer, yAxis.y());
+                buffer += ' ';
+                appendRounded(buffer, yAxis.z());
+                buffer += ' ';
+                appendRounded(buffer, face->yOffset());
+                buffer += " ] ";
+                
+                appendRounded(buffer, face->rotation());
+                buffer += ' ';
+                appendRounded(buffer, face->xScale());
+                buffer += ' ';
+                appendRounded(buffer, face->yScale());
+                buffer += '\n';
             }
         };
 
+        const size_t MapFileSerializer::FlushFaceCount = 1 << 16;
+
         NodeSerializer::Ptr MapFileSerializer::create(const Model::MapFormat::Type format, FILE* stream) {
             switch (format) {
                 case Model::MapFormat::Standard:
@@ -222,52 +141,72 @@ namespace TrenchBroom {
         
         MapFileSerializer::MapFileSerializer(FILE* stream) :
         m_line(1),
-        m_stream(stream) {
+        m_stream(stream),
+        m_faceCount(0) {
             ensure(m_stream != nullptr, "stream is null");
         }
         
         void MapFileSerializer::doBeginFile() {}
-        void MapFileSerializer::doEndFile() {}
+        
+        void MapFileSerializer::doEndFile() {
+            flush();
+        }
 
         void MapFileSerializer::doBeginEntity(const Model::Node* node) {
-            std::fprintf(m_stream, "// entity %u\n", entityNo());
+            String& buffer = text();
+            buffer += "// entity ";
+            appendInt(buffer, static_cast<int>(entityNo()));
+            buffer += '\n';
             ++m_line;
             m_startLineStack.push_back(m_line);
-            std::fprintf(m_stream, "{\n");
+            buffer += "{\n";
             ++m_line;
         }
         
         void MapFileSerializer::doEndEntity(Model::Node* node) {
-            std::fprintf(m_stream, "}\n");
+            text() += "}\n";
             ++m_line;
             setFilePosition(node);
+            
+            if (m_faceCount >= FlushFaceCount)
+                flush();
         }
         
-        void MapFileSerializer::doEntityAttribute(const Model::EntityAttribute& attribute) { 
-            std::fprintf(m_stream, "\"%s\" \"%s\"\n",
-                         escapeEntityAttribute( attribute.name()).c_str(),
-                         escapeEntityAttribute(attribute.value()).c_str());
+        void MapFileSerializer::doEntityAttribute(const Model::EntityAttribute& attribute) {
+            String& buffer = text();
+            buffer += '"';
+            buffer += escapeEntityAttribute(attribute.name());
+            buffer += "\" \"";
+            buffer += escapeEntityAttribute(attribute.value());
+            buffer += "\"\n";
             ++m_line;
         }
         
         void MapFileSerializer::doBeginBrush(const Model::Brush* brush) {
-            std::fprintf(m_stream, "// brush %u\n", brushNo());
+            String& buffer = text();
+            buffer += "// brush ";
+            appendInt(buffer, static_cast<int>(brushNo()));
+            buffer += '\n';
             ++m_line;
             m_startLineStack.push_back(m_line);
-            std::fprintf(m_stream, "{\n");
+            buffer += "{\n";
             ++m_line;
         }
         
         void MapFileSerializer::doEndBrush(Model::Brush* brush) {
-            std::fprintf(m_stream, "}\n");
+            text() += "}\n";
             ++m_line;
             setFilePosition(brush);
         }
         
         void MapFileSerializer::doBrushFace(Model::BrushFace* face) {
-            const size_t lines = doWriteBrushFace(m_stream, face);
-            face->setFilePosition(m_line, lines);
-            m_line += lines;
+            if (m_chunks.empty())
+                m_chunks.push_back(Chunk());
+            m_chunks.back().faces.push_back(face);
+            ++m_faceCount;
+            
+            face->setFilePosition(m_line, 1);
+            ++m_line;
         }
         
         void MapFileSerializer::setFilePosition(Model::Node* node) {
@@ -281,5 +220,67 @@ namespace TrenchBroom {
             m_startLineStack.pop_back();
             return result;
         }
+        
+        String& MapFileSerializer::text() {
+            if (m_chunks.empty() || !m_chunks.back().faces.empty())
+                m_chunks.push_back(Chunk());
+            return m_chunks.back().text;
+        }
+        
+        void MapFileSerializer::flush() {
+            ParallelUtils::forEachIndex(m_chunks.size(), [this](const size_t i) {
+                Chunk& chunk = m_chunks[i];
+                for (const Model::BrushFace* face : chunk.faces)
+                    doWriteBrushFace(chunk.formattedFaces, face);
+            });
+            
+            for (const Chunk& chunk : m_chunks) {
+                std::fwrite(chunk.text.data(), 1, chunk.text.size(), m_stream);
+                std::fwrite(chunk.formattedFaces.data(), 1, chunk.formattedFaces.size(), m_stream);
+            }
+            
+            m_chunks.clear();
+            m_faceCount = 0;
+        }
+        
+        void MapFileSerializer::appendExact(String& buffer, const double value) {
+            char chars[32];
+            const int count = std::snprintf(chars, sizeof(chars), "%.*g", FloatPrecision, value);
+            assert(count > 0 && static_cast<size_t>(count) < sizeof(chars));
+            buffer.append(chars, static_cast<size_t>(count));
+        }
+        
+        void MapFileSerializer::appendRounded(String& buffer, const double value) {
+            char chars[32];
+            const int count = std::snprintf(chars, sizeof(chars), "%.6g", value);
+            assert(count > 0 && static_cast<size_t>(count) < sizeof(chars));
+            buffer.append(chars, static_cast<size_t>(count));
+        }
+        
+        void MapFileSerializer::appendInt(String& buffer, const int value) {
+            char chars[16];
+            const int count = std::snprintf(chars, sizeof(chars), "%d", value);
+            assert(count > 0 && static_cast<size_t>(count) < sizeof(chars));
+            buffer.append(chars, static_cast<size_t>(count));
+        }
+        
+        void MapFileSerializer::appendPoints(String& buffer, const Model::BrushFace* face) {
+            const Model::BrushFace::Points& points = face->points();
+            for (size_t i = 0; i < 3; ++i) {
+                buffer += "( ";
+                appendExact(buffer, points[i].x());
+                buffer += ' ';
+                appendExact(buffer, points[i].y());
+                buffer += ' ';
+                appendExact(buffer, points[i].z());
+                buffer += " ) ";
+            }
+        }
+        
+        void MapFileSerializer::appendTextureName(String& buffer, const Model::BrushFace* face) {
+            const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
+            buffer += textureName;
+            buffer += ' ';
+        }
     }
 }
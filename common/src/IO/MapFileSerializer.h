@@ -26,17 +26,42 @@
 #include "Model/Node.h"
 
 #include <cstdio>
+#include <vector>
 
 namespace TrenchBroom {
     namespace IO {
         class Path;
         
+        /**
+         * Writes a map to a file. Everything except the brush faces is formatted immediately, but the brush faces
+         * are only collected and then formatted in parallel once enough of them have been collected or the file
+         * ends. The formatted text is written to the file in order using large unformatted writes.
+         *
+         * Since every brush face occupies exactly one line, the file positions of all nodes and faces are still
+         * known and set immediately.
+         */
         class MapFileSerializer : public NodeSerializer {
         private:
+            static const size_t FlushFaceCount;
+            
+            /**
+             * A piece of the output, consisting of some text followed by a number of brush faces which are
+             * formatted later.
+             */
+            struct Chunk {
+                String text;
+                Model::BrushFaceList faces;
+                String formattedFaces;
+            };
+            
+            typedef std::vector<Chunk> ChunkList;
             typedef std::vector<size_t> LineStack;
             LineStack m_startLineStack;
             size_t m_line;
             FILE* m_stream;
+            
+            ChunkList m_chunks;
+            size_t m_faceCount;
         public:
             static Ptr create(Model::MapFormat::Type format, FILE* stream);
         protected:
@@ -54,8 +79,27 @@ namespace TrenchBroom {
         private:
             void setFilePosition(Model::Node* node);
             size_t startLine();
+            
+            String& text();
+            void flush();
+        protected:
+            /**
+             * Appends the given value with FloatPrecision significant digits, like printf's %.17g would.
+             */
+            static void appendExact(String& buffer, double value);
+            /**
+             * Appends the given value rounded to six significant digits, like printf's %.6g would.
+             */
+            static void appendRounded(String& buffer, double value);
+            static void appendInt(String& buffer, int value);
+            static void appendPoints(String& buffer, const Model::BrushFace* face);
+            static void appendTextureName(String& buffer, const Model::BrushFace* face);
         private:
-            virtual size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) = 0;
+            /**
+             * Appends a brush face as exactly one line of text to the given buffer. This is called on worker threads
+             * and must not modify the serializer or the face.
+             */
+            virtual void doWriteBrushFace(String& buffer, const Model::BrushFace* face) const = 0;
         };
     }
 }
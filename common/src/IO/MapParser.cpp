@@ -71,5 +71,11 @@ namespace TrenchBroom {
         void MapParser::brushFace(const size_t line, const Vec3& point1, const Vec3& point2, const Vec3& point3, const Model::BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY, ParserStatus& status) {
             onBrushFace(line, point1, point2, point3, attribs, texAxisX, texAxisY, status);
         }
+
+        void MapParser::entitiesParsed(ParserStatus& status) {
+            onEntitiesParsed(status);
+        }
+
+        void MapParser::onEntitiesParsed(ParserStatus& status) {}
     }
 }
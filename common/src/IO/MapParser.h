@@ -37,6 +37,8 @@ namespace TrenchBroom {
     namespace IO {
         class ParserStatus;
         
+        class RecordingMapParser;
+        
         class MapParser {
         protected:
             class ExtraAttribute {
@@ -68,6 +70,8 @@ namespace TrenchBroom {
             };
             
             typedef std::map<String, ExtraAttribute> ExtraAttributes;
+
+            friend class RecordingMapParser;
         public:
             virtual ~MapParser();
         protected:
@@ -77,6 +81,7 @@ namespace TrenchBroom {
             void beginBrush(size_t line, ParserStatus& status);
             void endBrush(size_t startLine, size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status);
             void brushFace(size_t line, const Vec3& point1, const Vec3& point2, const Vec3& point3, const Model::BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY, ParserStatus& status);
+            void entitiesParsed(ParserStatus& status);
         private: // subclassing interface for users of the parser
             virtual void onFormatSet(Model::MapFormat::Type format) = 0;
             virtual void onBeginEntity(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status) = 0;
@@ -84,6 +89,8 @@ namespace TrenchBroom {
             virtual void onBeginBrush(size_t line, ParserStatus& status) = 0;
             virtual void onEndBrush(size_t startLine, size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status) = 0;
             virtual void onBrushFace(size_t line, const Vec3& point1, const Vec3& point2, const Vec3& point3, const Model::BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY, ParserStatus& status) = 0;
+            // called when a parser that parses the buffer in chunks has passed all callbacks for a chunk
+            virtual void onEntitiesParsed(ParserStatus& status);
         };
     }
 }
@@ -28,6 +28,7 @@
 #include "Model/Group.h"
 #include "Model/Layer.h"
 #include "Model/ModelFactory.h"
+#include "ParallelUtils.h"
 
 namespace TrenchBroom {
     namespace IO {
@@ -55,20 +56,37 @@ namespace TrenchBroom {
             return m_id;
         }
 
+        MapReader::PendingBrush::PendingBrush(Model::Node* i_parent, const size_t i_startLine, const size_t i_lineCount, const ExtraAttributes& i_extraAttributes, const Model::BrushFaceList& i_faces) :
+        parent(i_parent),
+        startLine(i_startLine),
+        lineCount(i_lineCount),
+        extraAttributes(i_extraAttributes),
+        faces(i_faces),
+        brush(nullptr) {}
+
         MapReader::MapReader(const char* begin, const char* end) :
         StandardMapParser(begin, end),
         m_factory(nullptr),
         m_brushParent(nullptr),
-        m_currentNode(nullptr) {}
+        m_currentNode(nullptr),
+        m_brushParentIsEntity(false),
+        m_pendingBrushOrderMatters(false) {}
         
         MapReader::MapReader(const String& str) :
         StandardMapParser(str),
         m_factory(nullptr),
         m_brushParent(nullptr),
-        m_currentNode(nullptr) {}
+        m_currentNode(nullptr),
+        m_brushParentIsEntity(false),
+        m_pendingBrushOrderMatters(false) {}
         
         MapReader::~MapReader() {
             VectorUtils::clearAndDelete(m_faces);
+            clearPendingBrushes();
+
+            // nodes whose parents were never resolved because reading failed
+            for (const auto& entry : m_unresolvedNodes)
+                delete entry.first;
         }
 
         void MapReader::readEntities(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status) {
@@ -77,9 +95,16 @@ namespace TrenchBroom {
             resolveNodes(status);
         }
         
+        void MapReader::readEntitiesParallel(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status) {
+            m_worldBounds = worldBounds;
+            parseEntitiesParallel(format, status);
+            resolveNodes(status);
+        }
+        
         void MapReader::readBrushes(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status) {
             m_worldBounds = worldBounds;
             parseBrushes(format, status);
+            createPendingBrushes(status);
         }
         
         void MapReader::readBrushFaces(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status) {
@@ -117,6 +142,7 @@ namespace TrenchBroom {
                 onWorldspawnFilePosition(startLine, lineCount, status);
             m_currentNode = nullptr;
             m_brushParent = nullptr;
+            m_brushParentIsEntity = false;
         }
         
         void MapReader::onBeginBrush(const size_t line, ParserStatus& status) {
@@ -132,6 +158,11 @@ namespace TrenchBroom {
             onBrushFace(face, status);
         }
 
+        void MapReader::onEntitiesParsed(ParserStatus& status) {
+            createPendingBrushes(status);
+            onEntitiesRead(m_currentNode, status);
+        }
+
         void MapReader::createLayer(const size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status) {
             const String& name = findAttribute(attributes, Model::AttributeNames::LayerName);
             if (StringUtils::isBlank(name)) {
@@ -220,29 +251,60 @@ namespace TrenchBroom {
             
             m_currentNode = entity;
             m_brushParent = entity;
+            m_brushParentIsEntity = true;
         }
 
         void MapReader::createBrush(const size_t startLine, const size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status) {
-            try {
-                // sort the faces by the weight of their plane normals like QBSP does
-                Model::BrushFace::sortFaces(m_faces);
-                
-                Model::Brush* brush = m_factory->createBrush(m_worldBounds, m_faces);
-                setFilePosition(brush, startLine, lineCount);
-                setExtraAttributes(brush, extraAttributes);
-                
-                onBrush(m_brushParent, brush, status);
-                m_faces.clear();
-            } catch (GeometryException& e) {
-                StringStream msg;
-                msg << "Skipping brush: " << e.what();
-                status.error(startLine, msg.str());
-                m_faces.clear(); // the faces will have been deleted by the brush's constructor
-            }
+            m_pendingBrushes.push_back(PendingBrush(m_brushParent, startLine, lineCount, extraAttributes, m_faces));
+            m_pendingBrushOrderMatters |= !m_brushParentIsEntity;
+            m_faces.clear();
+        }
 
+        void MapReader::createPendingBrushes(ParserStatus& status) {
+            ParallelUtils::forEachIndex(m_pendingBrushes.size(), [this](const size_t i) {
+                PendingBrush& pending = m_pendingBrushes[i];
+                try {
+                    // sort the faces by the weight of their plane normals like QBSP does
+                    Model::BrushFace::sortFaces(pending.faces);
+                    pending.brush = m_factory->createBrush(m_worldBounds, pending.faces);
+                } catch (GeometryException& e) {
+                    pending.error = e.what();
+                }
+                pending.faces.clear(); // the faces are now owned by the brush or have been deleted by its constructor
+            });
+            
+            for (PendingBrush& pending : m_pendingBrushes) {
+                if (pending.brush != nullptr) {
+                    Model::Brush* brush = pending.brush;
+                    pending.brush = nullptr;
+                    
+                    setFilePosition(brush, pending.startLine, pending.lineCount);
+                    setExtraAttributes(brush, pending.extraAttributes);
+                    onBrush(pending.parent, brush, status);
+                } else {
+                    StringStream msg;
+                    msg << "Skipping brush: " << pending.error;
+                    status.error(pending.startLine, msg.str());
+                }
+            }
+            
+            m_pendingBrushes.clear();
+            m_pendingBrushOrderMatters = false;
+        }
+        
+        void MapReader::clearPendingBrushes() {
+            for (PendingBrush& pending : m_pendingBrushes) {
+                VectorUtils::clearAndDelete(pending.faces);
+                delete pending.brush;
+            }
+            m_pendingBrushes.clear();
+            m_pendingBrushOrderMatters = false;
         }
 
         MapReader::ParentInfo::Type MapReader::storeNode(Model::Node* node, const Model::EntityAttribute::List& attributes, ParserStatus& status) {
+            if (m_pendingBrushOrderMatters)
+                createPendingBrushes(status);
+            
             const String& layerIdStr = findAttribute(attributes, Model::AttributeNames::Layer);
             if (!StringUtils::isBlank(layerIdStr)) {
                 const long rawId = std::atol(layerIdStr.c_str());
@@ -298,6 +360,8 @@ namespace TrenchBroom {
         }
 
         void MapReader::resolveNodes(ParserStatus& status) {
+            createPendingBrushes(status);
+            
             for (const auto& entry : m_unresolvedNodes) {
                 Model::Node* node = entry.first;
                 const ParentInfo& info = entry.second;
@@ -308,6 +372,7 @@ namespace TrenchBroom {
                 else
                     onNode(parent, node, status);
             }
+            m_unresolvedNodes.clear();
         }
 
         Model::Node* MapReader::resolveParent(const ParentInfo& parentInfo) const {
@@ -348,5 +413,7 @@ namespace TrenchBroom {
         void MapReader::onBrushFace(Model::BrushFace* face, ParserStatus& status) {
             m_faces.push_back(face);
         }
+
+        void MapReader::onEntitiesRead(const Model::Node* openNode, ParserStatus& status) {}
     }
 }
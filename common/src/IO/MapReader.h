@@ -69,6 +69,20 @@ namespace TrenchBroom {
             typedef std::pair<Model::Node*, ParentInfo> NodeParentPair;
             typedef std::vector<NodeParentPair> NodeParentList;
             
+            struct PendingBrush {
+                Model::Node* parent;
+                size_t startLine;
+                size_t lineCount;
+                ExtraAttributes extraAttributes;
+                Model::BrushFaceList faces;
+                Model::Brush* brush;
+                String error;
+                
+                PendingBrush(Model::Node* i_parent, size_t i_startLine, size_t i_lineCount, const ExtraAttributes& i_extraAttributes, const Model::BrushFaceList& i_faces);
+            };
+            
+            typedef std::vector<PendingBrush> PendingBrushList;
+            
             BBox3 m_worldBounds;
             Model::ModelFactory* m_factory;
             
@@ -76,6 +90,15 @@ namespace TrenchBroom {
             Model::Node* m_currentNode;
             Model::BrushFaceList m_faces;
             
+            /*
+             The brushes are not created immediately when they have been parsed, because their geometry can be built
+             in parallel. Pending brushes must be created before any other node is added to the same parent, so
+             unless all pending brushes belong to entities, they are created before the next node is stored.
+             */
+            bool m_brushParentIsEntity;
+            PendingBrushList m_pendingBrushes;
+            bool m_pendingBrushOrderMatters;
+            
             LayerMap m_layers;
             GroupMap m_groups;
             NodeParentList m_unresolvedNodes;
@@ -84,6 +107,7 @@ namespace TrenchBroom {
             MapReader(const String& str);
             
             void readEntities(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status);
+            void readEntitiesParallel(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status);
             void readBrushes(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status);
             void readBrushFaces(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status);
         public:
@@ -95,11 +119,14 @@ namespace TrenchBroom {
             void onBeginBrush(size_t line, ParserStatus& status) override;
             void onEndBrush(size_t startLine, size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status) override;
             void onBrushFace(size_t line, const Vec3& point1, const Vec3& point2, const Vec3& point3, const Model::BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY, ParserStatus& status) override;
+            void onEntitiesParsed(ParserStatus& status) override;
         private: // helper methods
             void createLayer(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status);
             void createGroup(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status);
             void createEntity(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status);
             void createBrush(size_t startLine, size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status);
+            void createPendingBrushes(ParserStatus& status);
+            void clearPendingBrushes();
 
             ParentInfo::Type storeNode(Model::Node* node, const Model::EntityAttribute::List& attributes, ParserStatus& status);
             void stripParentAttributes(Model::AttributableNode* attributable, ParentInfo::Type parentType);
@@ -121,6 +148,13 @@ namespace TrenchBroom {
             virtual void onUnresolvedNode(const ParentInfo& parentInfo, Model::Node* node, ParserStatus& status) = 0;
             virtual void onBrush(Model::Node* parent, Model::Brush* brush, ParserStatus& status) = 0;
             virtual void onBrushFace(Model::BrushFace* face, ParserStatus& status);
+            /**
+             * Called when the nodes of a chunk of entities have been passed to the other callbacks. The given node
+             * belongs to an entity that has not been read completely, so it may still receive children and its file
+             * position is not set yet. It is null if no such entity is open or if the open entity is the worldspawn
+             * entity.
+             */
+            virtual void onEntitiesRead(const Model::Node* openNode, ParserStatus& status);
         };
     }
 }
@@ -30,6 +30,7 @@ namespace TrenchBroom {
     namespace IO {
         namespace MipLayout {
             static const size_t TextureNameLength = 16;
+            static const size_t MipLevels = 4;
         }
         
         MipTextureReader::MipTextureReader(const NameStrategy& nameStrategy) :
@@ -44,42 +45,77 @@ namespace TrenchBroom {
             return result;
         }
         
-        Assets::Texture* MipTextureReader::doReadTexture(const char* const begin, const char* const end, const Path& path) const {
-            static const size_t MipLevels = 4;
+        Assets::Texture* MipTextureReader::doReadTextureFile(MappedFile::Ptr file) const {
+            CharArrayReader reader(file->begin(), file->end());
+            const String name = reader.readString(MipLayout::TextureNameLength);
+            const size_t width = reader.readSize<int32_t>();
+            const size_t height = reader.readSize<int32_t>();
+            
+            size_t offset[MipLayout::MipLevels];
+            for (size_t i = 0; i < MipLayout::MipLevels; ++i)
+                offset[i] = reader.readSize<int32_t>();
             
-            static Color tempColor, averageColor;
-            static Assets::TextureBuffer::List buffers(MipLevels);
-            static size_t offset[MipLevels];
+            const Assets::PaletteTransparency transparency = mipTransparency(name);
+            const Assets::Palette palette = doGetPalette(reader, offset, width, height);
             
+            // only the average color is needed up front, the mip levels are decoded when the texture is prepared
+            Color averageColor;
+            palette.averageColor(file->begin() + offset[0], mipSize(width, height, 0), averageColor);
+            
+            const Assets::TextureBufferLoader loader = [file, palette, offset, width, height, transparency]() {
+                Color mipColor;
+                return readMipBuffers(file->begin(), palette, offset, width, height, transparency, mipColor);
+            };
+            
+            return new Assets::Texture(textureName(name, file->path()), width, height, averageColor, loader, GL_RGBA, mipTextureType(transparency));
+        }
+        
+        Assets::Texture* MipTextureReader::doReadTexture(const char* const begin, const char* const end, const Path& path) const {
             CharArrayReader reader(begin, end);
             const String name = reader.readString(MipLayout::TextureNameLength);
             const size_t width = reader.readSize<int32_t>();
             const size_t height = reader.readSize<int32_t>();
-            for (size_t i = 0; i < MipLevels; ++i)
+            
+            size_t offset[MipLayout::MipLevels];
+            for (size_t i = 0; i < MipLayout::MipLevels; ++i)
                 offset[i] = reader.readSize<int32_t>();
 
-            const auto transparency = (name.size() > 0 && name.at(0) == '{')
-                    ? Assets::PaletteTransparency::Index255Transparent
-                    : Assets::PaletteTransparency::Opaque;
+            const Assets::PaletteTransparency transparency = mipTransparency(name);
+            const Assets::Palette palette = doGetPalette(reader, offset, width, height);
+            
+            Color averageColor;
+            const Assets::TextureBuffer::List buffers = readMipBuffers(begin, palette, offset, width, height, transparency, averageColor);
 
+            return new Assets::Texture(textureName(name, path), width, height, averageColor, buffers, GL_RGBA, mipTextureType(transparency));
+        }
+        
+        Assets::TextureBuffer::List MipTextureReader::readMipBuffers(const char* const begin, const Assets::Palette& palette, const size_t offset[], const size_t width, const size_t height, const Assets::PaletteTransparency transparency, Color& averageColor) {
+            Color tempColor;
+            Assets::TextureBuffer::List buffers(MipLayout::MipLevels);
             Assets::setMipBufferSize(buffers, width, height, GL_RGBA);
-            Assets::Palette palette = doGetPalette(reader, offset, width, height);
             
-            for (size_t i = 0; i < MipLevels; ++i) {
+            for (size_t i = 0; i < MipLayout::MipLevels; ++i) {
                 const char* data = begin + offset[i];
                 const size_t size = mipSize(width, height, i);
                 
                 palette.indexedToRgba(data, size, buffers[i], tempColor, transparency);
                 if (i == 0)
                     averageColor = tempColor;
-                
             }
-
-            const auto type = (transparency == Assets::PaletteTransparency::Index255Transparent)
+            
+            return buffers;
+        }
+        
+        Assets::PaletteTransparency MipTextureReader::mipTransparency(const String& name) {
+            return (name.size() > 0 && name.at(0) == '{')
+                    ? Assets::PaletteTransparency::Index255Transparent
+                    : Assets::PaletteTransparency::Opaque;
+        }
+        
+        Assets::TextureType MipTextureReader::mipTextureType(const Assets::PaletteTransparency transparency) {
+            return (transparency == Assets::PaletteTransparency::Index255Transparent)
                     ? Assets::TextureType::Masked
                     : Assets::TextureType::Opaque;
-
-            return new Assets::Texture(textureName(name, path), width, height, averageColor, buffers, GL_RGBA, type);
         }
     }
 }
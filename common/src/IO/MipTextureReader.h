@@ -20,8 +20,11 @@
 #ifndef MipTextureReader_h
 #define MipTextureReader_h
 
+#include "Color.h"
+#include "StringUtils.h"
 #include "IO/TextureReader.h"
 #include "Assets/Palette.h"
+#include "Assets/Texture.h"
 
 namespace TrenchBroom {
     namespace IO {
@@ -36,7 +39,18 @@ namespace TrenchBroom {
         public:
             static size_t mipFileSize(size_t width, size_t height, size_t mipLevels);
         protected:
+            /**
+             * Reads the header and computes the average color of the texture, but defers decoding the mip levels
+             * until the texture's collection is decoded in parallel right before its upload. The texture keeps a
+             * reference to the given file until then.
+             */
+            Assets::Texture* doReadTextureFile(MappedFile::Ptr file) const override;
             Assets::Texture* doReadTexture(const char* const begin, const char* const end, const Path& path) const override;
+        private:
+            static Assets::TextureBuffer::List readMipBuffers(const char* begin, const Assets::Palette& palette, const size_t offset[], size_t width, size_t height, Assets::PaletteTransparency transparency, Color& averageColor);
+            static Assets::PaletteTransparency mipTransparency(const String& name);
+            static Assets::TextureType mipTextureType(Assets::PaletteTransparency transparency);
+        protected:
             virtual Assets::Palette doGetPalette(CharArrayReader& reader, const size_t offset[], size_t width, size_t height) const = 0;
         };
     }
@@ -34,6 +34,8 @@ namespace TrenchBroom {
             virtual ~ParserStatus();
         public:
             void progress(double progress);
+            bool cancelled() const;
+            void log(Logger::LogLevel level, const String& str);
 
             void debug(size_t line, size_t column, const String& str);
             void info(size_t line, size_t column, const String& str);
@@ -54,6 +56,7 @@ namespace TrenchBroom {
             String buildMessage(size_t line, const String& str) const;
         private:
             virtual void doProgress(double progress) = 0;
+            virtual bool doCancelled() const;
             virtual void doLog(Logger::LogLevel level, const String& str);
         };
     }
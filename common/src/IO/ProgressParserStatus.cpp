@@ -0,0 +1,38 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProgressParserStatus.h"
+
+#include "ProgressStatus.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        ProgressParserStatus::ProgressParserStatus(Logger* logger, ProgressStatus& progressStatus) :
+        ParserStatus(logger),
+        m_progressStatus(progressStatus) {}
+
+        void ProgressParserStatus::doProgress(const double progress) {
+            m_progressStatus.progress(progress);
+        }
+
+        bool ProgressParserStatus::doCancelled() const {
+            return m_progressStatus.cancelled();
+        }
+    }
+}
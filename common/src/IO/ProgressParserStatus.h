@@ -0,0 +1,45 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ProgressParserStatus
+#define TrenchBroom_ProgressParserStatus
+
+#include "IO/ParserStatus.h"
+
+namespace TrenchBroom {
+    class ProgressStatus;
+
+    namespace IO {
+        /**
+         * Forwards the progress of a parser to the given progress status, and cancels the parser when the progress
+         * status is cancelled.
+         */
+        class ProgressParserStatus : public ParserStatus {
+        private:
+            ProgressStatus& m_progressStatus;
+        public:
+            ProgressParserStatus(Logger* logger, ProgressStatus& progressStatus);
+        private:
+            void doProgress(double progress) override;
+            bool doCancelled() const override;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_ProgressParserStatus) */
@@ -0,0 +1,152 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RecordingMapParser.h"
+
+#include "Macros.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        RecordingMapParser::Event::Event(const EventType i_type, const size_t i_index) :
+        type(i_type),
+        index(i_index) {}
+
+        RecordingMapParser::BeginEntity::BeginEntity(const size_t i_line, const Model::EntityAttribute::List& i_attributes, const ExtraAttributes& i_extraAttributes) :
+        line(i_line),
+        attributes(i_attributes),
+        extraAttributes(i_extraAttributes) {}
+
+        RecordingMapParser::EndEntityOrBrush::EndEntityOrBrush(const size_t i_startLine, const size_t i_lineCount, const ExtraAttributes& i_extraAttributes) :
+        startLine(i_startLine),
+        lineCount(i_lineCount),
+        extraAttributes(i_extraAttributes) {}
+
+        RecordingMapParser::Face::Face(const size_t i_line, const Vec3& i_point1, const Vec3& i_point2, const Vec3& i_point3, const Model::BrushFaceAttributes& i_attribs, const Vec3& i_texAxisX, const Vec3& i_texAxisY) :
+        line(i_line),
+        point1(i_point1),
+        point2(i_point2),
+        point3(i_point3),
+        attribs(i_attribs),
+        texAxisX(i_texAxisX),
+        texAxisY(i_texAxisY) {}
+
+        RecordingMapParser::LogMessage::LogMessage(const Logger::LogLevel i_level, const String& i_message) :
+        level(i_level),
+        message(i_message) {}
+
+        RecordingMapParser::RecordingStatus::RecordingStatus(RecordingMapParser& parser) :
+        ParserStatus(nullptr),
+        m_parser(parser) {}
+
+        void RecordingMapParser::RecordingStatus::doProgress(const double progress) {}
+
+        void RecordingMapParser::RecordingStatus::doLog(const Logger::LogLevel level, const String& str) {
+            m_parser.onLog(level, str);
+        }
+
+        RecordingMapParser::RecordingMapParser(const char* begin, const char* end, const size_t line, const size_t column, const Model::MapFormat::Type format, const Mode mode) :
+        StandardMapParser(begin, end, line, column),
+        m_format(format),
+        m_mode(mode) {}
+
+        void RecordingMapParser::parse() {
+            RecordingStatus status(*this);
+            switch (m_mode) {
+                case Mode_Entities:
+                    parseEntities(m_format, status);
+                    break;
+                case Mode_EntityHeader:
+                    parseEntityHeader(m_format, status);
+                    break;
+                case Mode_Brushes:
+                    parseBrushes(m_format, status);
+                    break;
+                switchDefault()
+            }
+        }
+
+        void RecordingMapParser::replay(MapParser& parser, ParserStatus& status) const {
+            for (const Event& event : m_events) {
+                switch (event.type) {
+                    case Event_BeginEntity: {
+                        const BeginEntity& data = m_beginEntities[event.index];
+                        parser.beginEntity(data.line, data.attributes, data.extraAttributes, status);
+                        break;
+                    }
+                    case Event_EndEntity: {
+                        const EndEntityOrBrush& data = m_endEntities[event.index];
+                        parser.endEntity(data.startLine, data.lineCount, status);
+                        break;
+                    }
+                    case Event_BeginBrush:
+                        parser.beginBrush(m_beginBrushes[event.index], status);
+                        break;
+                    case Event_EndBrush: {
+                        const EndEntityOrBrush& data = m_endBrushes[event.index];
+                        parser.endBrush(data.startLine, data.lineCount, data.extraAttributes, status);
+                        break;
+                    }
+                    case Event_BrushFace: {
+                        const Face& data = m_faces[event.index];
+                        parser.brushFace(data.line, data.point1, data.point2, data.point3, data.attribs, data.texAxisX, data.texAxisY, status);
+                        break;
+                    }
+                    case Event_Log: {
+                        const LogMessage& data = m_messages[event.index];
+                        status.log(data.level, data.message);
+                        break;
+                    }
+                    switchDefault()
+                }
+            }
+        }
+
+        void RecordingMapParser::onFormatSet(const Model::MapFormat::Type format) {}
+
+        void RecordingMapParser::onBeginEntity(const size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status) {
+            m_events.push_back(Event(Event_BeginEntity, m_beginEntities.size()));
+            m_beginEntities.push_back(BeginEntity(line, attributes, extraAttributes));
+        }
+
+        void RecordingMapParser::onEndEntity(const size_t startLine, const size_t lineCount, ParserStatus& status) {
+            m_events.push_back(Event(Event_EndEntity, m_endEntities.size()));
+            m_endEntities.push_back(EndEntityOrBrush(startLine, lineCount, ExtraAttributes()));
+        }
+
+        void RecordingMapParser::onBeginBrush(const size_t line, ParserStatus& status) {
+            m_events.push_back(Event(Event_BeginBrush, m_beginBrushes.size()));
+            m_beginBrushes.push_back(line);
+        }
+
+        void RecordingMapParser::onEndBrush(const size_t startLine, const size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status) {
+            m_events.push_back(Event(Event_EndBrush, m_endBrushes.size()));
+            m_endBrushes.push_back(EndEntityOrBrush(startLine, lineCount, extraAttributes));
+        }
+
+        void RecordingMapParser::onBrushFace(const size_t line, const Vec3& point1, const Vec3& point2, const Vec3& point3, const Model::BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY, ParserStatus& status) {
+            m_events.push_back(Event(Event_BrushFace, m_faces.size()));
+            m_faces.push_back(Face(line, point1, point2, point3, attribs, texAxisX, texAxisY));
+        }
+
+        void RecordingMapParser::onLog(const Logger::LogLevel level, const String& message) {
+            m_events.push_back(Event(Event_Log, m_messages.size()));
+            m_messages.push_back(LogMessage(level, message));
+        }
+    }
+}
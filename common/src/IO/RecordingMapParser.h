@@ -0,0 +1,148 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_RecordingMapParser
+#define TrenchBroom_RecordingMapParser
+
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Logger.h"
+#include "IO/ParserStatus.h"
+#include "IO/StandardMapParser.h"
+#include "Model/BrushFaceAttributes.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * Parses a part of a map file and records the parser callbacks and status messages instead of acting on
+         * them, so that the parsing can happen on a worker thread. The recorded callbacks can later be replayed
+         * into another parser on the main thread, in the order in which they were recorded.
+         */
+        class RecordingMapParser : public StandardMapParser {
+        public:
+            typedef enum {
+                // one or more complete entities
+                Mode_Entities,
+                // the opening brace and the attributes of an entity, up to its first brush
+                Mode_EntityHeader,
+                // one or more brushes
+                Mode_Brushes
+            } Mode;
+        private:
+            typedef enum {
+                Event_BeginEntity,
+                Event_EndEntity,
+                Event_BeginBrush,
+                Event_EndBrush,
+                Event_BrushFace,
+                Event_Log
+            } EventType;
+
+            struct Event {
+                EventType type;
+                size_t index;
+
+                Event(EventType i_type, size_t i_index);
+            };
+
+            struct BeginEntity {
+                size_t line;
+                Model::EntityAttribute::List attributes;
+                ExtraAttributes extraAttributes;
+
+                BeginEntity(size_t i_line, const Model::EntityAttribute::List& i_attributes, const ExtraAttributes& i_extraAttributes);
+            };
+
+            struct EndEntityOrBrush {
+                size_t startLine;
+                size_t lineCount;
+                ExtraAttributes extraAttributes;
+
+                EndEntityOrBrush(size_t i_startLine, size_t i_lineCount, const ExtraAttributes& i_extraAttributes);
+            };
+
+            struct Face {
+                size_t line;
+                Vec3 point1, point2, point3;
+                Model::BrushFaceAttributes attribs;
+                Vec3 texAxisX, texAxisY;
+
+                Face(size_t i_line, const Vec3& i_point1, const Vec3& i_point2, const Vec3& i_point3, const Model::BrushFaceAttributes& i_attribs, const Vec3& i_texAxisX, const Vec3& i_texAxisY);
+            };
+
+            struct LogMessage {
+                Logger::LogLevel level;
+                String message;
+
+                LogMessage(Logger::LogLevel i_level, const String& i_message);
+            };
+
+            class RecordingStatus : public ParserStatus {
+            private:
+                RecordingMapParser& m_parser;
+            public:
+                RecordingStatus(RecordingMapParser& parser);
+            private:
+                void doProgress(double progress) override;
+                void doLog(Logger::LogLevel level, const String& str) override;
+            };
+
+            Model::MapFormat::Type m_format;
+            Mode m_mode;
+
+            std::vector<Event> m_events;
+            std::vector<BeginEntity> m_beginEntities;
+            std::vector<EndEntityOrBrush> m_endEntities;
+            std::vector<size_t> m_beginBrushes;
+            std::vector<EndEntityOrBrush> m_endBrushes;
+            std::vector<Face> m_faces;
+            std::vector<LogMessage> m_messages;
+        public:
+            /**
+             * Creates a parser for the given part of a larger buffer, starting at the given line and column.
+             */
+            RecordingMapParser(const char* begin, const char* end, size_t line, size_t column, Model::MapFormat::Type format, Mode mode);
+
+            /**
+             * Parses the buffer according to the mode and records the callbacks. This may be called on a worker
+             * thread.
+             */
+            void parse();
+
+            /**
+             * Replays the recorded callbacks into the given parser and forwards the recorded status messages to the
+             * given status. This must be called on the thread that owns the given parser.
+             */
+            void replay(MapParser& parser, ParserStatus& status) const;
+        private: // implement MapParser interface
+            void onFormatSet(Model::MapFormat::Type format) override;
+            void onBeginEntity(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status) override;
+            void onEndEntity(size_t startLine, size_t lineCount, ParserStatus& status) override;
+            void onBeginBrush(size_t line, ParserStatus& status) override;
+            void onEndBrush(size_t startLine, size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status) override;
+            void onBrushFace(size_t line, const Vec3& point1, const Vec3& point2, const Vec3& point3, const Model::BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY, ParserStatus& status) override;
+
+            void onLog(Logger::LogLevel level, const String& message);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_RecordingMapParser) */
@@ -20,9 +20,17 @@
 #include "StandardMapParser.h"
 
 #include "Logger.h"
+#include "ParallelUtils.h"
 #include "TemporarilySetAny.h"
+#include "IO/MapEntityScanner.h"
+#include "IO/RecordingMapParser.h"
 #include "Model/BrushFace.h"
 
+#include <cassert>
+#include <exception>
+#include <memory>
+#include <vector>
+
 namespace TrenchBroom {
     namespace IO {
         const String& QuakeMapTokenizer::NumberDelim() {
@@ -34,6 +42,10 @@ namespace TrenchBroom {
         Tokenizer(begin, end, "\"", '\\'),
         m_skipEol(true) {}
         
+        QuakeMapTokenizer::QuakeMapTokenizer(const char* begin, const char* end, const size_t line, const size_t column) :
+        Tokenizer(begin, end, "\"", '\\', line, column),
+        m_skipEol(true) {}
+        
         QuakeMapTokenizer::QuakeMapTokenizer(const String& str) :
         Tokenizer(str, "\"", '\\'),
         m_skipEol(true) {}
@@ -113,13 +125,233 @@ namespace TrenchBroom {
             return Token(QuakeMapToken::Eof, nullptr, nullptr, length(), line(), column());
         }
 
+        bool QuakeMapTokenizer::readFaceLine(const bool valve, FaceLine& face) {
+            discardWhile(Whitespace());
+            face.line = line();
+            face.column = column();
+
+            const char* begin = curPos();
+            const char* end = endPos();
+            const char* cur = begin;
+            
+            for (size_t i = 0; i < 3; ++i) {
+                if ((cur = readPoint(cur, end, face.points[i])) == nullptr)
+                    return false;
+            }
+            
+            // quoted texture names must be unescaped, so we leave them to the regular tokenizer
+            cur = skipBlanks(cur, end);
+            if (cur == end || *cur == '"' || *cur == '\n')
+                return false;
+            face.textureBegin = cur;
+            while (cur < end && !isWhitespace(*cur))
+                ++cur;
+            face.textureEnd = cur;
+            
+            if (valve) {
+                if ((cur = readTexAxis(cur, end, face.texAxisX, face.xOffset)) == nullptr ||
+                    (cur = readTexAxis(cur, end, face.texAxisY, face.yOffset)) == nullptr)
+                    return false;
+            } else {
+                if ((cur = readNumber(cur, end, face.xOffset)) == nullptr ||
+                    (cur = readNumber(cur, end, face.yOffset)) == nullptr)
+                    return false;
+            }
+            
+            if ((cur = readNumber(cur, end, face.rotation)) == nullptr ||
+                (cur = readNumber(cur, end, face.xScale)) == nullptr ||
+                (cur = readNumber(cur, end, face.yScale)) == nullptr)
+                return false;
+            
+            bool integer[3];
+            face.extraCount = 0;
+            const char* faceEnd = cur;
+            cur = skipBlanks(cur, end);
+            while (cur < end && *cur != '\n') {
+                if (face.extraCount == 3)
+                    return false;
+                if ((cur = readNumber(cur, end, face.extra[face.extraCount], integer[face.extraCount])) == nullptr)
+                    return false;
+                ++face.extraCount;
+                faceEnd = cur;
+                cur = skipBlanks(cur, end);
+            }
+            
+            if (face.extraCount == 2 || (face.extraCount == 3 && (!integer[0] || !integer[1])))
+                return false;
+            
+            // the regular parser would look for more face attributes on the following lines
+            while (cur < end && isWhitespace(*cur))
+                ++cur;
+            if (cur < end && *cur != '(' && *cur != '}')
+                return false;
+            
+            advance(static_cast<size_t>(faceEnd - begin));
+            return true;
+        }
+        
+        const char* QuakeMapTokenizer::skipBlanks(const char* cur, const char* end) {
+            while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\r'))
+                ++cur;
+            return cur;
+        }
+        
+        const char* QuakeMapTokenizer::readPoint(const char* cur, const char* end, Vec3& point) {
+            cur = skipBlanks(cur, end);
+            if (cur == end || *cur != '(')
+                return nullptr;
+            ++cur;
+            
+            for (size_t i = 0; i < 3; ++i) {
+                if ((cur = readNumber(cur, end, point[i])) == nullptr)
+                    return nullptr;
+            }
+            
+            cur = skipBlanks(cur, end);
+            if (cur == end || *cur != ')')
+                return nullptr;
+            return cur + 1;
+        }
+        
+        const char* QuakeMapTokenizer::readTexAxis(const char* cur, const char* end, Vec3& axis, double& offset) {
+            cur = skipBlanks(cur, end);
+            if (cur == end || *cur != '[')
+                return nullptr;
+            ++cur;
+            
+            for (size_t i = 0; i < 3; ++i) {
+                if ((cur = readNumber(cur, end, axis[i])) == nullptr)
+                    return nullptr;
+            }
+            if ((cur = readNumber(cur, end, offset)) == nullptr)
+                return nullptr;
+            
+            cur = skipBlanks(cur, end);
+            if (cur == end || *cur != ']')
+                return nullptr;
+            return cur + 1;
+        }
+        
+        const char* QuakeMapTokenizer::readNumber(const char* cur, const char* end, double& value) {
+            bool integer;
+            return readNumber(cur, end, value, integer);
+        }
+        
+        const char* QuakeMapTokenizer::readNumber(const char* cur, const char* end, double& value, bool& integer) {
+            // Numbers with at most 15 significant digits and a decimal exponent of at most 22 can be converted by a
+            // single multiplication or division of two exactly representable doubles, which yields the same
+            // correctly rounded result as std::atof.
+            static const size_t MaxDigits = 15;
+            static const int MaxExponent = 22;
+            static const double PowersOfTen[] = {
+                1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+            
+            cur = skipBlanks(cur, end);
+            if (cur == end)
+                return nullptr;
+            
+            const bool negative = *cur == '-';
+            if (*cur == '-' || *cur == '+')
+                ++cur;
+            
+            unsigned long long mantissa = 0;
+            size_t digits = 0;
+            int exponent = 0;
+            bool anyDigits = false;
+            
+            while (cur < end && *cur >= '0' && *cur <= '9') {
+                if (mantissa > 0 || *cur != '0') {
+                    if (++digits > MaxDigits)
+                        return nullptr;
+                    mantissa = 10 * mantissa + static_cast<unsigned long long>(*cur - '0');
+                }
+                anyDigits = true;
+                ++cur;
+            }
+            
+            integer = true;
+            if (cur < end && *cur == '.') {
+                integer = false;
+                ++cur;
+                while (cur < end && *cur >= '0' && *cur <= '9') {
+                    if (mantissa > 0 || *cur != '0') {
+                        if (++digits > MaxDigits)
+                            return nullptr;
+                        mantissa = 10 * mantissa + static_cast<unsigned long long>(*cur - '0');
+                    }
+                    --exponent;
+                    anyDigits = true;
+                    ++cur;
+                }
+            }
+            
+            if (!anyDigits)
+                return nullptr;
+            
+            if (cur < end && *cur == 'e') {
+                integer = false;
+                ++cur;
+                
+                const bool negativeExponent = cur < end && *cur == '-';
+                if (cur < end && (*cur == '-' || *cur == '+'))
+                    ++cur;
+                if (cur == end || *cur < '0' || *cur > '9')
+                    return nullptr;
+                
+                int explicitExponent = 0;
+                while (cur < end && *cur >= '0' && *cur <= '9') {
+                    if (explicitExponent > 2 * MaxExponent)
+                        return nullptr;
+                    explicitExponent = 10 * explicitExponent + (*cur - '0');
+                    ++cur;
+                }
+                exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            }
+            
+            if (cur < end && *cur != ' ' && *cur != '\t' && *cur != '\n' && *cur != '\r' && *cur != ')')
+                return nullptr;
+            
+            if (mantissa == 0) {
+                exponent = 0;
+            } else if (exponent < -MaxExponent || exponent > MaxExponent) {
+                return nullptr;
+            }
+            
+            value = static_cast<double>(mantissa);
+            if (exponent > 0)
+                value *= PowersOfTen[exponent];
+            else if (exponent < 0)
+                value /= PowersOfTen[-exponent];
+            if (negative)
+                value = -value;
+            return cur;
+        }
+
+        const size_t StandardMapParser::ParallelBrushBatchSize = 256;
+        const size_t StandardMapParser::DefaultChunkSize = 1 << 22;
+
         StandardMapParser::StandardMapParser(const char* begin, const char* end) :
+        m_begin(begin),
+        m_end(end),
         m_tokenizer(QuakeMapTokenizer(begin, end)),
-        m_format(Model::MapFormat::Unknown) {}
+        m_format(Model::MapFormat::Unknown),
+        m_chunkSize(DefaultChunkSize) {}
         
         StandardMapParser::StandardMapParser(const String& str) :
+        m_begin(str.c_str()),
+        m_end(str.c_str() + str.size()),
         m_tokenizer(QuakeMapTokenizer(str)),
-        m_format(Model::MapFormat::Unknown) {}
+        m_format(Model::MapFormat::Unknown),
+        m_chunkSize(DefaultChunkSize) {}
+        
+        StandardMapParser::StandardMapParser(const char* begin, const char* end, const size_t line, const size_t column) :
+        m_begin(begin),
+        m_end(end),
+        m_tokenizer(QuakeMapTokenizer(begin, end, line, column)),
+        m_format(Model::MapFormat::Unknown),
+        m_chunkSize(DefaultChunkSize) {}
         
         StandardMapParser::~StandardMapParser() {}
 
@@ -183,6 +415,163 @@ namespace TrenchBroom {
             }
         }
         
+        void StandardMapParser::parseEntitiesParallel(const Model::MapFormat::Type format, ParserStatus& status) {
+            typedef std::unique_ptr<RecordingMapParser> RecordingMapParserPtr;
+
+            MapEntityScanner scanner(m_begin, m_end);
+            bool replayed = false;
+
+            while (!scanner.eof()) {
+                const char* chunkBegin = scanner.position();
+                const size_t chunkLine = scanner.line();
+                const size_t chunkColumn = scanner.column();
+
+                MapEntityScanner::EntityList entities;
+                if (!scanner.scan(entities, m_chunkSize)) {
+                    if (!replayed)
+                        parseEntities(format, status);
+                    else
+                        parseRemainder(chunkBegin, chunkLine, chunkColumn, format, status);
+                    return;
+                }
+
+                // The parts of the chunk that can be parsed independently. For every part, the entity that must be
+                // ended after its callbacks have been replayed, if any. Large entities such as worldspawn are split
+                // into their header and batches of their brushes.
+                MapEntityScanner::RangeList parts;
+                std::vector<RecordingMapParser::Mode> modes;
+                std::vector<const MapEntityScanner::Entity*> endEntities;
+
+                for (const MapEntityScanner::Entity& entity : entities) {
+                    const MapEntityScanner::Range& range = entity.range;
+                    const MapEntityScanner::RangeList& brushes = entity.brushes;
+
+                    if (!entity.splittable || brushes.size() <= ParallelBrushBatchSize) {
+                        parts.push_back(range);
+                        modes.push_back(RecordingMapParser::Mode_Entities);
+                        endEntities.push_back(nullptr);
+                    } else {
+                        parts.push_back(MapEntityScanner::Range(range.begin, brushes.front().begin, range.line, range.column));
+                        modes.push_back(RecordingMapParser::Mode_EntityHeader);
+                        endEntities.push_back(nullptr);
+
+                        for (size_t i = 0; i < brushes.size(); i += ParallelBrushBatchSize) {
+                            const MapEntityScanner::Range& first = brushes[i];
+                            const MapEntityScanner::Range& last = brushes[std::min(i + ParallelBrushBatchSize, brushes.size()) - 1];
+                            parts.push_back(MapEntityScanner::Range(first.begin, last.end, first.line, first.column));
+                            modes.push_back(RecordingMapParser::Mode_Brushes);
+                            endEntities.push_back(nullptr);
+                        }
+                        endEntities.back() = &entity;
+                    }
+                }
+
+                if (!replayed && scanner.eof() && parts.size() < 2) {
+                    parseEntities(format, status);
+                    return;
+                }
+
+                // A chunk may contain a single large entity, so its parts are parsed and replayed in batches of
+                // roughly the chunk size to report the progress and to release the recorded callbacks early.
+                size_t first = 0;
+                while (first < parts.size()) {
+                    size_t last = first;
+                    size_t size = 0;
+                    while (last < parts.size() && size < m_chunkSize) {
+                        size += static_cast<size_t>(parts[last].end - parts[last].begin);
+                        ++last;
+                    }
+
+                    std::vector<RecordingMapParserPtr> parsers;
+                    for (size_t i = first; i < last; ++i)
+                        parsers.push_back(RecordingMapParserPtr(new RecordingMapParser(parts[i].begin, parts[i].end, parts[i].line, parts[i].column, format, modes[i])));
+
+                    std::vector<std::exception_ptr> errors(parsers.size());
+                    ParallelUtils::forEachIndex(parsers.size(), [&parsers, &errors](const size_t i) {
+                        try {
+                            parsers[i]->parse();
+                        } catch (const ParserException&) {
+                            errors[i] = std::current_exception();
+                        }
+                    });
+
+                    if (!replayed) {
+                        for (const std::exception_ptr& error : errors) {
+                            if (error) {
+                                // let the sequential parser report the error
+                                parseEntities(format, status);
+                                return;
+                            }
+                        }
+                        setFormat(format);
+                        replayed = true;
+                    }
+
+                    for (size_t i = 0; i < parsers.size(); ++i) {
+                        if (errors[i])
+                            std::rethrow_exception(errors[i]);
+                        parsers[i]->replay(*this, status);
+
+                        const MapEntityScanner::Entity* entity = endEntities[first + i];
+                        if (entity != nullptr)
+                            endEntity(entity->range.line, entity->lastLine - entity->range.line, status);
+                    }
+
+                    // trailing whitespace and comments count as parsed once the last part has been replayed
+                    chunkParsed(scanner.eof() && last == parts.size() ? m_end : parts[last - 1].end, status);
+                    first = last;
+                }
+            }
+
+            if (!replayed)
+                parseEntities(format, status);
+        }
+
+        void StandardMapParser::parseRemainder(const char* begin, const size_t line, const size_t column, const Model::MapFormat::Type format, ParserStatus& status) {
+            RecordingMapParser parser(begin, m_end, line, column, format, RecordingMapParser::Mode_Entities);
+            parser.parse();
+            parser.replay(*this, status);
+            chunkParsed(m_end, status);
+        }
+
+        void StandardMapParser::chunkParsed(const char* end, ParserStatus& status) {
+            status.progress(static_cast<double>(end - m_begin) / static_cast<double>(m_end - m_begin));
+            if (status.cancelled())
+                throw CancelledException("Parsing was cancelled");
+            entitiesParsed(status);
+        }
+
+        void StandardMapParser::parseEntityHeader(const Model::MapFormat::Type format, ParserStatus& status) {
+            setFormat(format);
+
+            Token token = m_tokenizer.nextToken();
+            expect(QuakeMapToken::OBrace, token);
+
+            Model::EntityAttribute::List attributes;
+            AttributeNames attributeNames;
+            ExtraAttributes extraAttributes;
+            const size_t startLine = token.line();
+
+            token = m_tokenizer.peekToken();
+            while (token.type() != QuakeMapToken::Eof) {
+                switch (token.type()) {
+                    case QuakeMapToken::Comment:
+                        m_tokenizer.nextToken();
+                        parseExtraAttributes(extraAttributes, status);
+                        break;
+                    case QuakeMapToken::String:
+                        parseEntityAttribute(attributes, attributeNames, status);
+                        break;
+                    default:
+                        expect(QuakeMapToken::Comment | QuakeMapToken::String, token);
+                }
+
+                token = m_tokenizer.peekToken();
+            }
+
+            beginEntity(startLine, attributes, extraAttributes, status);
+        }
+        
         void StandardMapParser::parseBrushes(const Model::MapFormat::Type format, ParserStatus& status) {
             setFormat(format);
 
@@ -209,6 +598,11 @@ namespace TrenchBroom {
             m_tokenizer.reset();
         }
 
+        void StandardMapParser::setChunkSize(const size_t chunkSize) {
+            assert(chunkSize > 0);
+            m_chunkSize = chunkSize;
+        }
+
         void StandardMapParser::setFormat(const Model::MapFormat::Type format) {
             assert(format != Model::MapFormat::Unknown);
             m_format = format;
@@ -323,6 +717,9 @@ namespace TrenchBroom {
         }
         
         void StandardMapParser::parseFace(ParserStatus& status) {
+            if (parseFaceLine(status))
+                return;
+            
             Vec3 texAxisX, texAxisY;
             
             Token token = m_tokenizer.nextToken();
@@ -406,6 +803,41 @@ namespace TrenchBroom {
                 status.error(line, column, "Skipping face: face points are colinear");
         }
         
+        bool StandardMapParser::parseFaceLine(ParserStatus& status) {
+            QuakeMapTokenizer::FaceLine face;
+            if (!m_tokenizer.readFaceLine(m_format == Model::MapFormat::Valve, face))
+                return false;
+            
+            const Vec3 p1 = face.points[0].corrected();
+            const Vec3 p2 = face.points[1].corrected();
+            const Vec3 p3 = face.points[2].corrected();
+            
+            String textureName(face.textureBegin, face.textureEnd);
+            if (textureName == Model::BrushFace::NoTextureName)
+                textureName = "";
+            
+            Model::BrushFaceAttributes attribs(textureName);
+            attribs.setXOffset(static_cast<float>(face.xOffset));
+            attribs.setYOffset(static_cast<float>(face.yOffset));
+            attribs.setRotation(static_cast<float>(face.rotation));
+            attribs.setXScale(static_cast<float>(face.xScale));
+            attribs.setYScale(static_cast<float>(face.yScale));
+            
+            if (face.extraCount == 3 && m_format == Model::MapFormat::Quake2) {
+                // mirror the conversion by std::atoi in Token::toInteger
+                attribs.setSurfaceContents(static_cast<int>(static_cast<long>(face.extra[0])));
+                attribs.setSurfaceFlags(static_cast<int>(static_cast<long>(face.extra[1])));
+                attribs.setSurfaceValue(static_cast<float>(face.extra[2]));
+            }
+            
+            const Vec3 normal = crossed(p3 - p1, p2 - p1).normalized();
+            if (!normal.null())
+                brushFace(face.line, p1, p2, p3, attribs, face.texAxisX, face.texAxisY, status);
+            else
+                status.error(face.line, face.column, "Skipping face: face points are colinear");
+            return true;
+        }
+        
         Vec3 StandardMapParser::parseVector() {
             Token token;
             Vec3 vec;
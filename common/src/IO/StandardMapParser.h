@@ -49,16 +49,56 @@ namespace TrenchBroom {
         class ParserStatus;
 
         class QuakeMapTokenizer : public Tokenizer<QuakeMapToken::Type> {
+        public:
+            /**
+             * A brush face as read by readFaceLine. The texture name is not copied, but points into the buffer.
+             */
+            struct FaceLine {
+                size_t line;
+                size_t column;
+                Vec3 points[3];
+                const char* textureBegin;
+                const char* textureEnd;
+                // only read for the Valve format
+                Vec3 texAxisX;
+                Vec3 texAxisY;
+                double xOffset;
+                double yOffset;
+                double rotation;
+                double xScale;
+                double yScale;
+                // either nothing, a single Hexen 2 value, or the Quake 2 surface contents, flags and value
+                double extra[3];
+                size_t extraCount;
+            };
         private:
             static const String& NumberDelim();
             bool m_skipEol;
         public:
             QuakeMapTokenizer(const char* begin, const char* end);
+            QuakeMapTokenizer(const char* begin, const char* end, size_t line, size_t column);
             QuakeMapTokenizer(const String& str);
             
             void setSkipEol(bool skipEol);
+            
+            /**
+             * Reads a brush face that occupies a single line directly from the buffer, without creating any tokens
+             * or strings, and skips it if successful. Leading whitespace is skipped in any case.
+             *
+             * This is a fast path for the common case only. If the face has anything unusual about it, such as a
+             * quoted texture name, a comment, a line break or a number that cannot be converted exactly without
+             * calling the standard library, this returns false without consuming the face, and the caller must
+             * parse it from the regular tokens instead.
+             */
+            bool readFaceLine(bool valve, FaceLine& face);
         private:
             Token emitToken() override;
+            
+            static const char* skipBlanks(const char* cur, const char* end);
+            static const char* readPoint(const char* cur, const char* end, Vec3& point);
+            static const char* readTexAxis(const char* cur, const char* end, Vec3& axis, double& offset);
+            static const char* readNumber(const char* cur, const char* end, double& value);
+            static const char* readNumber(const char* cur, const char* end, double& value, bool& integer);
         };
 
         class StandardMapParser : public MapParser, public Parser<QuakeMapToken::Type> {
@@ -66,28 +106,61 @@ namespace TrenchBroom {
             typedef QuakeMapTokenizer::Token Token;
             typedef std::set<Model::AttributeName> AttributeNames;
 
+            static const size_t ParallelBrushBatchSize;
+            static const size_t DefaultChunkSize;
+
+            const char* m_begin;
+            const char* m_end;
             QuakeMapTokenizer m_tokenizer;
             Model::MapFormat::Type m_format;
+            size_t m_chunkSize;
         public:
             StandardMapParser(const char* begin, const char* end);
             StandardMapParser(const String& str);
             
             virtual ~StandardMapParser() override;
         protected:
+            StandardMapParser(const char* begin, const char* end, size_t line, size_t column);
+
             Model::MapFormat::Type detectFormat();
             
             void parseEntities(Model::MapFormat::Type format, ParserStatus& status);
+            /**
+             * Parses the entities like parseEntities, but splits the buffer into entities and batches of brushes
+             * first and parses those on worker threads. The parser callbacks are called on the calling thread in
+             * the same order and with the same arguments as they would be by parseEntities.
+             *
+             * The buffer is scanned and parsed in chunks of roughly the chunk size. After the callbacks for a chunk
+             * have been called, the progress is reported to the given status as the fraction of the buffer that
+             * has been parsed, a CancelledException is thrown if the status has been cancelled, and finally,
+             * onEntitiesParsed is called.
+             *
+             * Falls back to parseEntities if the buffer cannot be split or if parsing any part of the first chunk
+             * fails. Later chunks that cannot be split are parsed sequentially, and if parsing any part of a later
+             * chunk fails, the resulting exception is rethrown after the callbacks for the preceding parts have been
+             * called.
+             */
+            void parseEntitiesParallel(Model::MapFormat::Type format, ParserStatus& status);
+            void parseEntityHeader(Model::MapFormat::Type format, ParserStatus& status);
             void parseBrushes(Model::MapFormat::Type format, ParserStatus& status);
             void parseBrushFaces(Model::MapFormat::Type format, ParserStatus& status);
             
             void reset();
+
+            /**
+             * Sets the number of bytes that parseEntitiesParallel parses before it reports its progress.
+             */
+            void setChunkSize(size_t chunkSize);
         private:
             void setFormat(Model::MapFormat::Type format);
+            void parseRemainder(const char* begin, size_t line, size_t column, Model::MapFormat::Type format, ParserStatus& status);
+            void chunkParsed(const char* end, ParserStatus& status);
             
             void parseEntity(ParserStatus& status);
             void parseEntityAttribute(Model::EntityAttribute::List& attributes, AttributeNames& names, ParserStatus& status);
             void parseBrush(ParserStatus& status);
             void parseFace(ParserStatus& status);
+            bool parseFaceLine(ParserStatus& status);
 
             Vec3 parseVector();
             void parseExtraAttributes(ExtraAttributes& extraAttributes, ParserStatus& status);
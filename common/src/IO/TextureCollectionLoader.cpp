@@ -19,7 +19,11 @@
 
 #include "TextureCollectionLoader.h"
 
+#include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "ParallelUtils.h"
 #include "Assets/AssetTypes.h"
+#include "Assets/Texture.h"
 #include "Assets/TextureCollection.h"
 #include "Assets/TextureManager.h"
 #include "IO/DiskIO.h"
@@ -35,20 +39,86 @@
 
 namespace TrenchBroom {
     namespace IO {
-        TextureCollectionLoader::TextureCollectionLoader() {}
+        TextureCollectionLoader::TextureCollectionLoader() :
+        m_assetCache(nullptr) {}
+        
         TextureCollectionLoader::~TextureCollectionLoader() {}
 
+        void TextureCollectionLoader::setAssetCache(const AssetCache* assetCache, const AssetCache::Key& readerKey) {
+            m_assetCache = assetCache;
+            m_readerKey = readerKey;
+        }
+
         Assets::TextureCollection* TextureCollectionLoader::loadTextureCollection(const Path& path, const String& textureExtension, const TextureReader& textureReader) {
             std::unique_ptr<Assets::TextureCollection> collection(new Assets::TextureCollection(path));
             
-            for (MappedFile::Ptr file : doFindTextures(path, textureExtension)) {
-                Assets::Texture* texture = textureReader.readTexture(file->begin(), file->end(), file->path());
-                collection->addTexture(texture);
+            const MappedFile::List files = doFindTextures(path, textureExtension);
+            if (m_assetCache == nullptr) {
+                collection->addTextures(readTextures(files, textureReader));
+                return collection.release();
+            }
+            
+            AssetCache::Key key(m_readerKey);
+            key.add(path.asString());
+            key.add(textureExtension);
+            doAddCacheKey(path, files, key);
+            
+            const MappedFile::Ptr entry = m_assetCache->read(key);
+            if (entry.get() != nullptr) {
+                try {
+                    AssetCache::Reader reader(entry);
+                    collection->addTextures(AssetCache::readTextures(reader));
+                    return collection.release();
+                } catch (const FileFormatException&) {
+                    // the entry is damaged and will be replaced below
+                }
             }
             
+            collection->addTextures(readTextures(files, textureReader));
+            writeCacheEntry(key, *collection);
+            
             return collection.release();
         }
 
+        void TextureCollectionLoader::writeCacheEntry(const AssetCache::Key& key, Assets::TextureCollection& collection) const {
+            // the entry is written from the image data that the collection decodes for its upload, so the textures are
+            // only decoded once, and the callback only uses copies of the cache and the key
+            const AssetCache cache = *m_assetCache;
+            collection.setDecodedCallback([cache, key](const Assets::TextureList& textures) {
+                try {
+                    AssetCache::Writer writer;
+                    AssetCache::writeTextures(writer, textures);
+                    cache.write(key, writer.data());
+                } catch (const Exception&) {
+                    // the collection can still be used, but it will be decoded again next time
+                }
+            });
+        }
+
+        Assets::TextureList TextureCollectionLoader::readTextures(const MappedFile::List& files, const TextureReader& textureReader) const {
+            Assets::TextureList textures(files.size(), nullptr);
+            
+            try {
+                ParallelUtils::forEachIndex(files.size(), [&](const size_t i) {
+                    textures[i] = textureReader.readTexture(files[i]);
+                });
+            } catch (...) {
+                VectorUtils::clearAndDelete(textures);
+                throw;
+            }
+            
+            // the textures are returned in file order regardless of the order in which they were decoded
+            return textures;
+        }
+
+        void TextureCollectionLoader::doAddCacheKey(const Path& path, const MappedFile::List& files, AssetCache::Key& key) const {
+            key.add(static_cast<uint64_t>(files.size()));
+            for (const MappedFile::Ptr& file : files) {
+                key.add(file->path().asString());
+                key.addContents(*file);
+            }
+        }
+
         FileTextureCollectionLoader::FileTextureCollectionLoader(const IO::Path::List& searchPaths) :
         m_searchPaths(searchPaths) {}
 
@@ -67,6 +137,14 @@ namespace TrenchBroom {
             return result;
         }
 
+        void FileTextureCollectionLoader::doAddCacheKey(const Path& path, const MappedFile::List& files, AssetCache::Key& key) const {
+            // a texture package file is only modified as a whole, so its size and modification time suffice
+            const Path wadPath = Disk::resolvePath(m_searchPaths, path);
+            key.add(wadPath.asString());
+            key.add(static_cast<uint64_t>(Disk::openFile(wadPath)->size()));
+            key.add(static_cast<uint64_t>(Disk::fileModificationTime(wadPath)));
+        }
+
         DirectoryTextureCollectionLoader::DirectoryTextureCollectionLoader(const FileSystem& gameFS) :
         m_gameFS(gameFS) {}
 
@@ -21,6 +21,8 @@
 #define TextureCollectionLoader_h
 
 #include "StringUtils.h"
+#include "Assets/AssetTypes.h"
+#include "IO/AssetCache.h"
 #include "IO/MappedFile.h"
 #include "IO/Path.h"
 
@@ -43,14 +45,36 @@ namespace TrenchBroom {
         class TextureCollectionLoader {
         public:
             typedef std::unique_ptr<TextureCollectionLoader> Ptr;
+        private:
+            const AssetCache* m_assetCache;
+            AssetCache::Key m_readerKey;
         protected:
             TextureCollectionLoader();
         public:
             virtual ~TextureCollectionLoader();
         public:
+            /**
+             * Stores the decoded textures of every loaded collection in the given cache and loads them from the cache
+             * if the collection has not changed. The textures are stored once the collection has decoded them for
+             * its upload. The given key must identify the texture reader and everything that
+             * the decoded textures depend on besides the texture files, such as the palette.
+             */
+            void setAssetCache(const AssetCache* assetCache, const AssetCache::Key& readerKey);
             Assets::TextureCollection* loadTextureCollection(const Path& path, const String& textureExtension, const TextureReader& textureReader);
         private:
+            Assets::TextureList readTextures(const MappedFile::List& files, const TextureReader& textureReader) const;
+            /**
+             * Writes the textures of the given collection to the cache when the collection decodes them. The textures
+             * are not decoded by this function.
+             */
+            void writeCacheEntry(const AssetCache::Key& key, Assets::TextureCollection& collection) const;
             virtual MappedFile::List doFindTextures(const Path& path, const String& extension) = 0;
+
+            /**
+             * Adds the given texture files to the given cache key. By default, the path, the size and the contents of
+             * every file are added.
+             */
+            virtual void doAddCacheKey(const Path& path, const MappedFile::List& files, AssetCache::Key& key) const;
         };
         
         class FileTextureCollectionLoader : public TextureCollectionLoader {
@@ -60,6 +84,7 @@ namespace TrenchBroom {
             FileTextureCollectionLoader(const Path::List& searchPaths);
         private:
             MappedFile::List doFindTextures(const Path& path, const String& extension) override;
+            void doAddCacheKey(const Path& path, const MappedFile::List& files, AssetCache::Key& key) const override;
         };
         
         class DirectoryTextureCollectionLoader : public TextureCollectionLoader {
@@ -22,6 +22,8 @@
 #include "Assets/Palette.h"
 #include "Assets/TextureManager.h"
 #include "EL/Interpolator.h"
+#include "IO/AssetCache.h"
+#include "IO/FileSystem.h"
 #include "IO/FreeImageTextureReader.h"
 #include "IO/HlMipTextureReader.h"
 #include "IO/IdMipTextureReader.h"
@@ -33,7 +35,7 @@
 
 namespace TrenchBroom {
     namespace IO {
-        TextureLoader::TextureLoader(const EL::VariableStore& variables, const FileSystem& gameFS, const IO::Path::List& fileSearchPaths, const Model::GameConfig::TextureConfig& textureConfig) :
+        TextureLoader::TextureLoader(const EL::VariableStore& variables, const FileSystem& gameFS, const IO::Path::List& fileSearchPaths, const Model::GameConfig::TextureConfig& textureConfig, const AssetCache* assetCache) :
         m_variables(variables.clone()),
         m_gameFS(gameFS),
         m_fileSearchPaths(fileSearchPaths),
@@ -42,6 +44,8 @@ namespace TrenchBroom {
         m_textureCollectionLoader(createTextureCollectionLoader(textureConfig)) {
             ensure(m_textureReader != nullptr, "textureReader is null");
             ensure(m_textureCollectionLoader != nullptr, "textureCollectionLoader is null");
+            if (assetCache != nullptr)
+                setAssetCache(assetCache, textureConfig);
         }
         
         TextureLoader::~TextureLoader() {
@@ -72,11 +76,28 @@ namespace TrenchBroom {
             }
         }
         
-        Assets::Palette TextureLoader::loadPalette(const Model::GameConfig::TextureConfig& textureConfig) const {
+        Path TextureLoader::palettePath(const Model::GameConfig::TextureConfig& textureConfig) const {
             const String pathSpec = textureConfig.palette.asString();
             const String pathStr = EL::interpolate(pathSpec, EL::EvaluationContext(*m_variables));
-            const Path path(pathStr);
-            return Assets::Palette::loadFile(m_gameFS, path);
+            return Path(pathStr);
+        }
+
+        Assets::Palette TextureLoader::loadPalette(const Model::GameConfig::TextureConfig& textureConfig) const {
+            return Assets::Palette::loadFile(m_gameFS, palettePath(textureConfig));
+        }
+
+        void TextureLoader::setAssetCache(const AssetCache* assetCache, const Model::GameConfig::TextureConfig& textureConfig) {
+            AssetCache::Key readerKey;
+            readerKey.add("textures");
+            readerKey.add(static_cast<uint64_t>(AssetCache::TextureVersion));
+            readerKey.add(textureConfig.format.format);
+            
+            // paletted textures must be decoded again when the palette changes
+            const Path path = palettePath(textureConfig);
+            if (!path.isEmpty() && m_gameFS.fileExists(path))
+                readerKey.addContents(*m_gameFS.openFile(path));
+            
+            m_textureCollectionLoader->setAssetCache(assetCache, readerKey);
         }
 
         TextureCollectionLoader* TextureLoader::createTextureCollectionLoader(const Model::GameConfig::TextureConfig& textureConfig) const {
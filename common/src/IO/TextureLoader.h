@@ -36,6 +36,7 @@ namespace TrenchBroom {
     }
     
     namespace IO {
+        class AssetCache;
         class FileSystem;
         class TextureCollectionLoader;
         class TextureReader;
@@ -49,12 +50,18 @@ namespace TrenchBroom {
             TextureReader* m_textureReader;
             TextureCollectionLoader* m_textureCollectionLoader;
         public:
-            TextureLoader(const EL::VariableStore& variables, const FileSystem& gameFS, const IO::Path::List& fileSearchPaths, const Model::GameConfig::TextureConfig& textureConfig);
+            /**
+             * Creates a texture loader. If an asset cache is given, the decoded textures are stored in and loaded from
+             * it.
+             */
+            TextureLoader(const EL::VariableStore& variables, const FileSystem& gameFS, const IO::Path::List& fileSearchPaths, const Model::GameConfig::TextureConfig& textureConfig, const AssetCache* assetCache = nullptr);
             ~TextureLoader();
         private:
             String getTextureExtension(const Model::GameConfig::TextureConfig& textureConfig) const;
             TextureReader* createTextureReader(const Model::GameConfig::TextureConfig& textureConfig) const;
+            Path palettePath(const Model::GameConfig::TextureConfig& textureConfig) const;
             Assets::Palette loadPalette(const Model::GameConfig::TextureConfig& textureConfig) const;
+            void setAssetCache(const AssetCache* assetCache, const Model::GameConfig::TextureConfig& textureConfig);
             TextureCollectionLoader* createTextureCollectionLoader(const Model::GameConfig::TextureConfig& textureConfig) const;
         public:
             Assets::TextureCollection* loadTextureCollection(const Path& path);
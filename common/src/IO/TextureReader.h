@@ -75,11 +75,20 @@ namespace TrenchBroom {
         public:
             virtual ~TextureReader();
             
+            /**
+             * Reads a texture from the given file. Readers may keep a reference to the file and defer decoding the
+             * image data until the texture is prepared.
+             */
             Assets::Texture* readTexture(MappedFile::Ptr file) const;
+            
+            /**
+             * Reads a texture from the given memory range, decoding the image data immediately.
+             */
             Assets::Texture* readTexture(const char* const begin, const char* const end, const Path& path) const;
         protected:
             String textureName(const String& textureName, const Path& path) const;
         private:
+            virtual Assets::Texture* doReadTextureFile(MappedFile::Ptr file) const;
             virtual Assets::Texture* doReadTexture(const char* const begin, const char* const end, const Path& path) const = 0;
         public:
             static size_t mipSize(size_t width, size_t height, size_t mipLevel);
@@ -95,7 +95,7 @@ namespace TrenchBroom {
             template <typename T>
             T toFloat() const {
                 static const size_t BufferSize = 256;
-                static char buffer[BufferSize];
+                char buffer[BufferSize];
                 assert(length() < BufferSize);
                 
                 memcpy(buffer, m_begin, length());
@@ -106,7 +106,7 @@ namespace TrenchBroom {
             
             template <typename T>
             T toInteger() const {
-                static char buffer[64];
+                char buffer[64];
                 assert(length() < 64);
                 
                 memcpy(buffer, m_begin, length());
@@ -22,13 +22,18 @@
 namespace TrenchBroom {
     namespace IO {
         TokenizerState::TokenizerState(const char* begin, const char* end, const String& escapableChars, const char escapeChar) :
+        TokenizerState(begin, end, escapableChars, escapeChar, 1, 1) {}
+
+        TokenizerState::TokenizerState(const char* begin, const char* end, const String& escapableChars, const char escapeChar, const size_t line, const size_t column) :
         m_begin(begin),
         m_cur(m_begin),
         m_end(end),
         m_escapableChars(escapableChars),
         m_escapeChar(escapeChar),
-        m_line(1),
-        m_column(1),
+        m_startLine(line),
+        m_startColumn(column),
+        m_line(m_startLine),
+        m_column(m_startColumn),
         m_escaped(false) {}
         
         size_t TokenizerState::length() const {
@@ -117,8 +122,8 @@ namespace TrenchBroom {
         
         void TokenizerState::reset() {
             m_cur = m_begin;
-            m_line = 1;
-            m_column = 1;
+            m_line = m_startLine;
+            m_column = m_startColumn;
             m_escaped = false;
         }
         
@@ -59,11 +59,14 @@ namespace TrenchBroom {
             const char* m_end;
             String m_escapableChars;
             char m_escapeChar;
+            size_t m_startLine;
+            size_t m_startColumn;
             size_t m_line;
             size_t m_column;
             bool m_escaped;
         public:
             TokenizerState(const char* begin, const char* end, const String& escapableChars, char escapeChar);
+            TokenizerState(const char* begin, const char* end, const String& escapableChars, char escapeChar, size_t line, size_t column);
             
             size_t length() const;
             const char* begin() const;
@@ -134,6 +137,13 @@ namespace TrenchBroom {
             Tokenizer(const String& str, const String& escapableChars, const char escapeChar) :
             m_state(new TokenizerState(str.c_str(), str.c_str() + str.size(), escapableChars, escapeChar)) {}
 
+            /**
+             * Creates a tokenizer for a part of a larger buffer that starts at the given line and column, so that
+             * the positions of the emitted tokens refer to the larger buffer.
+             */
+            Tokenizer(const char* begin, const char* end, const String& escapableChars, const char escapeChar, const size_t line, const size_t column) :
+            m_state(new TokenizerState(begin, end, escapableChars, escapeChar, line, column)) {}
+
             template <typename OtherType>
             Tokenizer(Tokenizer<OtherType>& nestedTokenizer) :
             m_state(nestedTokenizer.m_state) {}
@@ -223,6 +233,10 @@ namespace TrenchBroom {
                 return m_state->curPos();
             }
 
+            const char* endPos() const {
+                return m_state->end();
+            }
+
             char curChar() const {
                 if (eof())
                     return 0;
@@ -72,13 +72,10 @@ namespace TrenchBroom {
                 reader.seekForward(WadLayout::DirEntryNameOffset);
                 const String entryName = reader.readString(WadLayout::DirEntryNameSize) + "." + entryType;
                 
-                const char* entryBegin = m_file->begin() + entryAddress;
-                const char* entryEnd = entryBegin + entrySize;
-                assert(entryEnd <= m_file->end());
+                assert(entryAddress + entrySize <= m_file->size());
                 
-                IO::Path path(entryName);
-                MappedFile::Ptr file(new MappedFileView(m_file, path, entryBegin, entryEnd));
-                m_root.addFile(path, file);
+                const IO::Path path(entryName);
+                m_root.addFile(path, new ViewFile(m_file, path, entryAddress, entrySize));
             }
         }
     }
@@ -26,33 +26,74 @@
 
 namespace TrenchBroom {
     namespace IO {
+        WorldReader::UnpublishedNode::UnpublishedNode(Model::Node* i_parent, Model::Node* i_node, const bool i_brush) :
+        parent(i_parent),
+        node(i_node),
+        brush(i_brush) {}
+
         WorldReader::WorldReader(const char* begin, const char* end, const Model::BrushContentTypeBuilder* brushContentTypeBuilder) :
         MapReader(begin, end),
         m_brushContentTypeBuilder(brushContentTypeBuilder),
-        m_world(nullptr) {}
+        m_world(nullptr),
+        m_worldspawnRead(false),
+        m_published(false) {}
         
         WorldReader::WorldReader(const String& str, const Model::BrushContentTypeBuilder* brushContentTypeBuilder) :
         MapReader(str),
         m_brushContentTypeBuilder(brushContentTypeBuilder),
-        m_world(nullptr) {}
+        m_world(nullptr),
+        m_worldspawnRead(false),
+        m_published(false) {}
         
         Model::World* WorldReader::read(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status) {
-            readEntities(format, worldBounds, status);
+            try {
+                readEntitiesParallel(format, worldBounds, status);
+            } catch (...) {
+                delete m_world;
+                m_world = nullptr;
+                throw;
+            }
             m_world->rebuildNodeTree();
             m_world->enableNodeTreeUpdates();
             return m_world;
         }
 
+        Model::World* WorldReader::read(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status, const PublishCallback& publish) {
+            assert(publish);
+            m_publish = publish;
+            try {
+                readEntitiesParallel(format, worldBounds, status);
+                publishNodes(nullptr);
+            } catch (...) {
+                deleteUnpublishedNodes();
+                if (!m_published)
+                    delete m_world;
+                m_world = nullptr;
+                throw;
+            }
+            assert(m_unpublishedNodes.empty());
+            return m_world;
+        }
+
+        void WorldReader::setChunkSize(const size_t chunkSize) {
+            StandardMapParser::setChunkSize(chunkSize);
+        }
+
         Model::ModelFactory* WorldReader::initialize(const Model::MapFormat::Type format, const BBox3& worldBounds) {
             assert(m_world == nullptr);
             m_world = new Model::World(format, m_brushContentTypeBuilder, worldBounds);
             m_world->disableNodeTreeUpdates();
+            if (m_publish) {
+                m_publishedParents.insert(m_world);
+                m_publishedParents.insert(m_world->defaultLayer());
+            }
             return m_world;
         }
         
         Model::Node* WorldReader::onWorldspawn(const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status) {
             m_world->setAttributes(attributes);
             setExtraAttributes(m_world, extraAttributes);
+            m_worldspawnRead = true;
             return m_world->defaultLayer();
         }
 
@@ -61,14 +102,14 @@ namespace TrenchBroom {
         }
 
         void WorldReader::onLayer(Model::Layer* layer, ParserStatus& status) {
-            m_world->addChild(layer);
+            addNode(m_world, layer, false);
         }
         
         void WorldReader::onNode(Model::Node* parent, Model::Node* node, ParserStatus& status) {
             if (parent != nullptr)
-                parent->addChild(node);
+                addNode(parent, node, false);
             else
-                m_world->defaultLayer()->addChild(node);
+                addNode(m_world->defaultLayer(), node, false);
         }
         
         void WorldReader::onUnresolvedNode(const ParentInfo& parentInfo, Model::Node* node, ParserStatus& status) {
@@ -81,14 +122,64 @@ namespace TrenchBroom {
                 msg << "Entity references missing group '" << parentInfo.id() << "', adding to default layer";
                 status.warn(node->lineNumber(), msg.str());
             }
-            m_world->defaultLayer()->addChild(node);
+            addNode(m_world->defaultLayer(), node, false);
         }
         
         void WorldReader::onBrush(Model::Node* parent, Model::Brush* brush, ParserStatus& status) {
             if (parent != nullptr)
-                parent->addChild(brush);
+                addNode(parent, brush, true);
             else
-                m_world->defaultLayer()->addChild(brush);
+                addNode(m_world->defaultLayer(), brush, true);
+        }
+
+        void WorldReader::onEntitiesRead(const Model::Node* openNode, ParserStatus& status) {
+            // the world must not be published before its attributes are set
+            if (m_publish && m_worldspawnRead)
+                publishNodes(openNode);
+        }
+
+        void WorldReader::addNode(Model::Node* parent, Model::Node* node, const bool brush) {
+            if (m_publish)
+                m_unpublishedNodes.push_back(UnpublishedNode(parent, node, brush));
+            else
+                parent->addChild(node);
+        }
+
+        void WorldReader::publishNodes(const Model::Node* openNode) {
+            Model::ParentChildrenMap nodes;
+
+            // A node is published once its parent is published, which may happen later in the same pass if the
+            // parent was read after the node, e.g. if the node belongs to a group that was resolved at the end.
+            bool published = true;
+            while (published && !m_unpublishedNodes.empty()) {
+                published = false;
+
+                UnpublishedNodeList remaining;
+                for (const UnpublishedNode& unpublished : m_unpublishedNodes) {
+                    if (unpublished.node != openNode && m_publishedParents.count(unpublished.parent) > 0) {
+                        nodes[unpublished.parent].push_back(unpublished.node);
+                        // brushes have no children, so there is no need to remember them
+                        if (!unpublished.brush)
+                            m_publishedParents.insert(unpublished.node);
+                        published = true;
+                    } else {
+                        remaining.push_back(unpublished);
+                    }
+                }
+                m_unpublishedNodes.swap(remaining);
+            }
+
+            if (!m_published || !nodes.empty()) {
+                m_published = true;
+                m_publish(m_world, nodes);
+            }
+        }
+
+        void WorldReader::deleteUnpublishedNodes() {
+            // the unpublished nodes were not added to their parents, so every node must be deleted separately
+            for (const UnpublishedNode& unpublished : m_unpublishedNodes)
+                delete unpublished.node;
+            m_unpublishedNodes.clear();
         }
     }
 }
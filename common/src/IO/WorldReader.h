@@ -21,6 +21,10 @@
 #define TrenchBroom_WorldReader
 
 #include "IO/MapReader.h"
+#include "Model/ModelTypes.h"
+
+#include <functional>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Model {
@@ -31,14 +35,66 @@ namespace TrenchBroom {
         class ParserStatus;
         
         class WorldReader : public MapReader {
+        public:
+            /**
+             * Receives the world and the nodes that were read since the previous call, by parent. Every parent is
+             * either the world, a node that was passed in a previous call, or a node that is passed in the same call.
+             * The passed nodes are not attached to their parents yet.
+             */
+            typedef std::function<void(Model::World* world, const Model::ParentChildrenMap& nodes)> PublishCallback;
         private:
+            struct UnpublishedNode {
+                Model::Node* parent;
+                Model::Node* node;
+                bool brush;
+
+                UnpublishedNode(Model::Node* i_parent, Model::Node* i_node, bool i_brush);
+            };
+
+            typedef std::vector<UnpublishedNode> UnpublishedNodeList;
+
             const Model::BrushContentTypeBuilder* m_brushContentTypeBuilder;
             Model::World* m_world;
+
+            PublishCallback m_publish;
+            bool m_worldspawnRead;
+            bool m_published;
+            UnpublishedNodeList m_unpublishedNodes;
+            Model::NodeSet m_publishedParents;
         public:
             WorldReader(const char* begin, const char* end, const Model::BrushContentTypeBuilder* brushContentTypeBuilder);
             WorldReader(const String& str, const Model::BrushContentTypeBuilder* brushContentTypeBuilder);
 
+            /**
+             * Reads the world from the buffer in chunks. After every chunk, the progress is reported to the given
+             * status. If the status is cancelled, reading stops with a CancelledException.
+             *
+             * If reading fails or is cancelled, the partial world is deleted.
+             */
             Model::World* read(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status);
+
+            /**
+             * Reads the world like the other overload, but passes the world and the nodes that were read to the given
+             * callback after every chunk, so that the world can be used while it is being read. The callback is
+             * called on the calling thread and takes ownership of the world and the nodes.
+             *
+             * The world is passed once its worldspawn entity has been read, and an entity is passed once it has been
+             * read completely together with its brushes. Apart from the file position of the world, which is set once
+             * the worldspawn entity has been read completely, the reader does not change a node once it was passed.
+             * Therefore, the file position of the world must not be accessed until this function returns.
+             *
+             * Since the nodes are added to the world by the callback, updating the node tree of the world is left to
+             * the callback's owner, see Model::World::rebuildNodeTree.
+             *
+             * If reading fails or is cancelled, the nodes that were not passed yet are deleted, and the world is
+             * deleted if it was not passed yet.
+             */
+            Model::World* read(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status, const PublishCallback& publish);
+
+            /**
+             * Sets the approximate number of bytes that are read before the progress is reported.
+             */
+            void setChunkSize(size_t chunkSize);
         private: // implement MapReader interface
             Model::ModelFactory* initialize(Model::MapFormat::Type format, const BBox3& worldBounds) override;
             Model::Node* onWorldspawn(const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status) override;
@@ -47,6 +103,11 @@ namespace TrenchBroom {
             void onNode(Model::Node* parent, Model::Node* node, ParserStatus& status) override;
             void onUnresolvedNode(const ParentInfo& parentInfo, Model::Node* node, ParserStatus& status) override;
             void onBrush(Model::Node* parent, Model::Brush* brush, ParserStatus& status) override;
+            void onEntitiesRead(const Model::Node* openNode, ParserStatus& status) override;
+        private:
+            void addNode(Model::Node* parent, Model::Node* node, bool brush);
+            void publishNodes(const Model::Node* openNode);
+            void deleteUnpublishedNodes();
         };
     }
 }
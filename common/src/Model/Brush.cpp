@@ -19,8 +19,11 @@
 
 #include "Brush.h"
 
+#include "Allocator.h"
 #include "CollectionUtils.h"
 #include "Macros.h"
+#include "ParallelUtils.h"
+#include "ProgressStatus.h"
 #include "Model/BrushContentTypeBuilder.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
@@ -36,11 +39,14 @@
 #include "Model/World.h"
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <iterator>
 
 namespace TrenchBroom {
     namespace Model {
         const Hit::HitType Brush::BrushHit = Hit::freeHitType();
+        const size_t Brush::MaxDirectGeometryFaceCount = 32;
 
         BrushVertex*& Brush::ProjectToVertex::project(BrushVertex*& vertex) {
             return vertex;
@@ -130,6 +136,18 @@ namespace TrenchBroom {
             }
         };
 
+        class Brush::LinkFaceGeometryCallback : public BrushGeometry::Callback {
+        private:
+            BrushFace* m_face;
+        public:
+            LinkFaceGeometryCallback(BrushFace* face) :
+            m_face(face) {}
+
+            void faceWasCreated(BrushFaceGeometry* face) override {
+                face->setPayload(m_face);
+            }
+        };
+
         class Brush::MoveVerticesCallback : public BrushGeometry::Callback {
         private:
             typedef std::map<Vec3, BrushFaceList> IncidenceMap;
@@ -303,6 +321,25 @@ namespace TrenchBroom {
             }
         }
 
+        Brush::Brush(const BBox3& worldBounds, const BrushFaceList& faces, const Vec3::List& vertexPositions, const std::vector<std::vector<size_t>>& faceVertexIndices) :
+        m_geometry(nullptr),
+        m_contentTypeBuilder(nullptr),
+        m_contentType(0),
+        m_transparent(false),
+        m_contentTypeValid(true) {
+            addFaces(faces);
+            try {
+                if (buildGeometryFromVertices(worldBounds, vertexPositions, faceVertexIndices)) {
+                    m_flatGeometry = FlatBrushGeometry(*m_geometry);
+                } else {
+                    buildGeometry(worldBounds);
+                }
+            } catch (const GeometryException&) {
+                cleanup();
+                throw;
+            }
+        }
+
         Brush::~Brush() {
             cleanup();
         }
@@ -528,6 +565,9 @@ namespace TrenchBroom {
         }
 
         bool Brush::canMoveBoundary(const BBox3& worldBounds, const BrushFace* face, const Vec3& delta) const {
+            // the geometry of the test brush is released in one go
+            const ScratchArena scratch;
+
             auto* testFace = face->clone();
             testFace->transform(translationMatrix(delta), false);
 
@@ -589,7 +629,7 @@ namespace TrenchBroom {
 
         size_t Brush::vertexCount() const {
             ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->vertexCount();
+            return m_flatGeometry.vertexCount();
         }
 
         Brush::VertexList Brush::vertices() const {
@@ -597,20 +637,20 @@ namespace TrenchBroom {
             return VertexList(m_geometry->vertices());
         }
 
-        const Vec3::List Brush::vertexPositions() const {
+        const Vec3::List& Brush::vertexPositions() const {
             ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->vertexPositions();
+            return m_flatGeometry.vertexPositions();
         }
 
         bool Brush::hasVertex(const Vec3& position, const FloatType epsilon) const {
             ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->findVertexByPosition(position, nullptr, epsilon) != nullptr;
+            return m_flatGeometry.hasVertex(position, epsilon);
         }
 
         bool Brush::hasVertices(const Vec3::List positions, const FloatType epsilon) const {
             ensure(m_geometry != nullptr, "geometry is null");
             for (const auto& position : positions) {
-                if (!m_geometry->hasVertex(position, epsilon)) {
+                if (!m_flatGeometry.hasVertex(position, epsilon)) {
                     return false;
                 }
             }
@@ -619,18 +659,18 @@ namespace TrenchBroom {
 
         Vec3 Brush::findClosestVertexPosition(const Vec3& position) const {
             ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->findClosestVertex(position)->position();
+            return m_flatGeometry.findClosestVertexPosition(position);
         }
 
         bool Brush::hasEdge(const Edge3& edge, const FloatType epsilon) const {
             ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->findEdgeByPositions(edge.start(), edge.end(), epsilon) != nullptr;
+            return m_flatGeometry.hasEdge(edge.start(), edge.end(), epsilon);
         }
 
         bool Brush::hasEdges(const Edge3::List& edges, const FloatType epsilon) const {
             ensure(m_geometry != nullptr, "geometry is null");
             for (const auto& edge : edges) {
-                if (!m_geometry->hasEdge(edge.start(), edge.end(), epsilon)) {
+                if (!m_flatGeometry.hasEdge(edge.start(), edge.end(), epsilon)) {
                     return false;
                 }
             }
@@ -639,13 +679,13 @@ namespace TrenchBroom {
 
         bool Brush::hasFace(const Polygon3& face, const FloatType epsilon) const {
             ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->hasFace(face.vertices(), epsilon);
+            return m_flatGeometry.hasFace(face.vertices(), epsilon);
         }
 
         bool Brush::hasFaces(const Polygon3::List& faces, const FloatType epsilon) const {
             ensure(m_geometry != nullptr, "geometry is null");
             for (const auto& face : faces) {
-                if (!m_geometry->hasFace(face.vertices(), epsilon)) {
+                if (!m_flatGeometry.hasFace(face.vertices(), epsilon)) {
                     return false;
                 }
             }
@@ -667,7 +707,7 @@ namespace TrenchBroom {
 
         size_t Brush::edgeCount() const {
             ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->edgeCount();
+            return m_flatGeometry.edgeCount();
         }
 
         Brush::EdgeList Brush::edges() const {
@@ -676,16 +716,13 @@ namespace TrenchBroom {
         }
 
         bool Brush::containsPoint(const Vec3& point) const {
-            if (!bounds().contains(point)) {
-                return false;
-            } else {
-                for (const auto* face : m_faces) {
-                    if (face->boundary().pointStatus(point) == Math::PointStatus::PSAbove) {
-                        return false;
-                    }
-                }
-                return true;
-            }
+            ensure(m_geometry != nullptr, "geometry is null");
+            return m_flatGeometry.containsPoint(point);
+        }
+
+        const FlatBrushGeometry& Brush::flatGeometry() const {
+            ensure(m_geometry != nullptr, "geometry is null");
+            return m_flatGeometry;
         }
 
         BrushFaceList Brush::incidentFaces(const BrushVertex* vertex) const {
@@ -703,6 +740,7 @@ namespace TrenchBroom {
         }
 
         bool Brush::canMoveVertices(const BBox3& worldBounds, const Vec3::List& vertices, const Vec3& delta) const {
+            const ScratchArena scratch;
             return doCanMoveVertices(worldBounds, vertices, delta, true).success;
         }
 
@@ -747,6 +785,7 @@ namespace TrenchBroom {
             ensure(m_geometry != nullptr, "geometry is null");
             ensure(!vertexPositions.empty(), "no vertex positions");
 
+            const ScratchArena scratch;
             BrushGeometry testGeometry(*m_geometry);
 
             for (const auto& position : vertexPositions) {
@@ -822,6 +861,7 @@ namespace TrenchBroom {
             ensure(!edgePositions.empty(), "no edge positions");
 
             const auto vertexPositions = Edge3::asVertexList(edgePositions);
+            const ScratchArena scratch;
             const auto result = doCanMoveVertices(worldBounds, vertexPositions, delta, false);
 
             if (!result.success) {
@@ -861,6 +901,7 @@ namespace TrenchBroom {
             ensure(!facePositions.empty(), "no face positions");
 
             const auto vertexPositions = Polygon3::asVertexList(facePositions);
+            const ScratchArena scratch;
             const auto result = doCanMoveVertices(worldBounds, vertexPositions, delta, false);
 
             if (!result.success) {
@@ -1070,17 +1111,34 @@ namespace TrenchBroom {
         }
 
         BrushList Brush::subtract(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const Brush* subtrahend) const {
-            const auto result = m_geometry->subtract(*subtrahend->m_geometry);
+            const BrushList fragments = createFragments(factory, worldBounds, defaultTextureName, subtrahend);
+            cloneFragmentFaceAttributes(fragments, subtrahend);
+            return fragments;
+        }
 
-            BrushList brushes;
-            brushes.reserve(result.size());
+        std::vector<BrushList> Brush::subtract(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushList& minuends, const Brush* subtrahend, ProgressStatus& status) {
+            std::vector<BrushList> result(minuends.size());
 
-            for (const auto& geometry : result) {
-                auto* brush = createBrush(factory, worldBounds, defaultTextureName, geometry, subtrahend);
-                brushes.push_back(brush);
+            bool completed = false;
+            try {
+                completed = ParallelUtils::forEachIndex(minuends.size(), [&](const size_t i) {
+                    result[i] = minuends[i]->createFragments(factory, worldBounds, defaultTextureName, subtrahend);
+                }, status);
+            } catch (...) {
+                for (BrushList& fragments : result)
+                    VectorUtils::clearAndDelete(fragments);
+                throw;
             }
 
-            return brushes;
+            if (!completed) {
+                for (BrushList& fragments : result)
+                    VectorUtils::clearAndDelete(fragments);
+                return std::vector<BrushList>();
+            }
+
+            for (size_t i = 0; i < minuends.size(); ++i)
+                minuends[i]->cloneFragmentFaceAttributes(result[i], subtrahend);
+            return result;
         }
 
         void Brush::intersect(const BBox3& worldBounds, const Brush* brush) {
@@ -1091,6 +1149,66 @@ namespace TrenchBroom {
             rebuildGeometry(worldBounds);
         }
 
+        Brush* Brush::intersect(const ModelFactory& factory, const BBox3& worldBounds, const BrushList& brushes, ProgressStatus& status) {
+            if (brushes.empty())
+                return nullptr;
+
+            // the intersection is contained in the intersection of the bounds of the brushes
+            BBox3 bounds = brushes.front()->bounds();
+            for (const Brush* brush : brushes) {
+                if (!bounds.intersects(brush->bounds()))
+                    return nullptr;
+                bounds.intersectWith(brush->bounds());
+            }
+
+            // use several batches per thread so that progress can be reported while the batches are intersected
+            const size_t batchCount = std::min(brushes.size(), 4 * ParallelUtils::threadCount());
+            std::vector<BrushGeometry> geometries(batchCount, BrushGeometry(worldBounds.expanded(1.0)));
+            std::atomic<bool> empty(false);
+
+            const bool completed = ParallelUtils::forEachIndex(batchCount, [&](const size_t i) {
+                if (empty)
+                    return;
+
+                BrushFaceList faces;
+                const size_t first = brushes.size() * i / batchCount;
+                const size_t last = brushes.size() * (i + 1) / batchCount;
+                for (size_t j = first; j < last; ++j)
+                    VectorUtils::append(faces, brushes[j]->faces());
+
+                if (!intersectGeometryWithFaces(geometries[i], faces))
+                    empty = true;
+            }, status);
+
+            if (!completed || empty)
+                return nullptr;
+
+            BrushGeometry& geometry = geometries.front();
+            for (size_t i = 1; i < batchCount; ++i) {
+                BrushFaceList faces;
+                for (const BrushFaceGeometry* face : geometries[i].faces()) {
+                    if (face->payload() != nullptr)
+                        faces.push_back(face->payload());
+                }
+
+                if (!intersectGeometryWithFaces(geometry, faces))
+                    return nullptr;
+            }
+
+            BrushFaceList faces;
+            faces.reserve(geometry.faceCount());
+            for (const BrushFaceGeometry* face : geometry.faces()) {
+                // a face of the cube that the geometries were clipped from remains if the brushes are unbounded
+                if (face->payload() == nullptr) {
+                    VectorUtils::clearAndDelete(faces);
+                    return nullptr;
+                }
+                faces.push_back(face->payload()->clone());
+            }
+
+            return factory.createBrush(worldBounds, faces);
+        }
+
         bool Brush::canTransform(const Mat4x4& transformation, const BBox3& worldBounds) const {
             auto* testBrush = clone(worldBounds);
             bool result = true;
@@ -1105,7 +1223,28 @@ namespace TrenchBroom {
             return result;
         }
 
-        Brush* Brush::createBrush(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry& geometry, const Brush* subtrahend) const {
+        BrushList Brush::createFragments(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const Brush* subtrahend) const {
+            const auto result = m_geometry->subtract(*subtrahend->m_geometry);
+
+            BrushList brushes;
+            brushes.reserve(result.size());
+
+            for (const auto& geometry : result) {
+                auto* brush = createBrush(factory, worldBounds, defaultTextureName, geometry);
+                brushes.push_back(brush);
+            }
+
+            return brushes;
+        }
+
+        void Brush::cloneFragmentFaceAttributes(const BrushList& fragments, const Brush* subtrahend) const {
+            for (auto* brush : fragments) {
+                brush->cloneFaceAttributesFrom(this);
+                brush->cloneInvertedFaceAttributesFrom(subtrahend);
+            }
+        }
+
+        Brush* Brush::createBrush(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry& geometry) {
             BrushFaceList faces(0);
             faces.reserve(geometry.faceCount());
 
@@ -1122,10 +1261,20 @@ namespace TrenchBroom {
                 faces.push_back(factory.createFace(p0, p1, p2, attribs));
             }
 
-            auto* brush = factory.createBrush(worldBounds, faces);
-            brush->cloneFaceAttributesFrom(this);
-            brush->cloneInvertedFaceAttributesFrom(subtrahend);
-            return brush;
+            return factory.createBrush(worldBounds, faces);
+        }
+
+        bool Brush::intersectGeometryWithFaces(BrushGeometry& geometry, const BrushFaceList& faces) {
+            try {
+                for (BrushFace* face : faces) {
+                    LinkFaceGeometryCallback callback(face);
+                    if (geometry.clip(face->boundary(), callback).empty() || !geometry.healEdges())
+                        return false;
+                }
+                return true;
+            } catch (const GeometryException&) {
+                return false;
+            }
         }
 
         void Brush::updateFacesFromGeometry(const BBox3& worldBounds, const BrushGeometry& brushGeometry) {
@@ -1163,21 +1312,131 @@ namespace TrenchBroom {
             nodeBoundsDidChange(oldBounds);
         }
 
+        void Brush::rebuildGeometry(const BBox3& worldBounds, const BrushList& brushes) {
+            std::vector<BBox3> oldBounds;
+            oldBounds.reserve(brushes.size());
+            for (const Brush* brush : brushes)
+                oldBounds.push_back(brush->bounds());
+            
+            std::vector<std::exception_ptr> exceptions(brushes.size());
+            ParallelUtils::forEachIndex(brushes.size(), [&](const size_t i) {
+                Brush* brush = brushes[i];
+                try {
+                    brush->deleteGeometry();
+                    brush->buildGeometry(worldBounds);
+                } catch (const GeometryException&) {
+                    exceptions[i] = std::current_exception();
+                }
+            });
+            
+            // like the single brush version, only notify brushes whose geometry was actually rebuilt
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                if (!exceptions[i])
+                    brushes[i]->nodeBoundsDidChange(oldBounds[i]);
+            }
+            
+            for (const std::exception_ptr& exception : exceptions) {
+                if (exception)
+                    std::rethrow_exception(exception);
+            }
+        }
+
         void Brush::buildGeometry(const BBox3& worldBounds) {
             assert(m_geometry == nullptr);
 
-            m_geometry = new BrushGeometry(worldBounds.expanded(1.0));
+            if (!buildGeometryFromPlanes(worldBounds)) {
+                // the direct construction failed on a degenerate or unbounded brush, so clip a cube that is larger
+                // than the world, which also detects brushes that are not fully specified
+                m_geometry = new BrushGeometry(worldBounds.expanded(1.0));
+
+                AddFacesToGeometry addFacesToGeometry(*m_geometry, m_faces);
+                updateFacesFromGeometry(worldBounds, *m_geometry);
+
+                if (addFacesToGeometry.brushEmpty()) {
+                    throw GeometryException("Brush is empty");
+                } else  if (!addFacesToGeometry.brushValid()) {
+                    throw GeometryException("Brush is invalid");
+                } else if (!fullySpecified()) {
+                    throw GeometryException("Brush is not fully specified");
+                }
+            }
+
+            m_flatGeometry = FlatBrushGeometry(*m_geometry);
+        }
+
+        bool Brush::buildGeometryFromPlanes(const BBox3& worldBounds) {
+            assert(m_geometry == nullptr);
+
+            if (m_faces.size() > MaxDirectGeometryFaceCount) {
+                return false;
+            }
+
+            Plane3::List planes;
+            planes.reserve(m_faces.size());
+            for (const auto* brushFace : m_faces) {
+                planes.push_back(brushFace->boundary());
+            }
+
+            auto* geometry = new BrushGeometry();
+            std::vector<BrushFaceGeometry*> faceGeometries;
+            if (!geometry->intersectHalfspaces(planes, faceGeometries) ||
+                !worldBounds.expanded(1.0).contains(geometry->bounds())) {
+                delete geometry;
+                return false;
+            }
+
+            const auto brushFaces = m_faces;
+            for (size_t i = 0; i < brushFaces.size(); ++i) {
+                auto* brushFace = brushFaces[i];
+                if (faceGeometries[i] != nullptr) {
+                    brushFace->setGeometry(faceGeometries[i]);
+                } else {
+                    // the face does not touch the brush, delete it like a face that was clipped away
+                    ensure(!brushFace->selected(), "brush face is selected");
+                    delete brushFace;
+                }
+            }
+
+            m_geometry = geometry;
+
+            HealEdgesCallback healCallback;
+            bool brushValid = m_geometry->healEdges(healCallback);
+            if (brushValid) {
+                m_geometry->correctVertexPositions();
+                brushValid = m_geometry->healEdges(healCallback);
+            }
 
-            AddFacesToGeometry addFacesToGeometry(*m_geometry, m_faces);
             updateFacesFromGeometry(worldBounds, *m_geometry);
 
-            if (addFacesToGeometry.brushEmpty()) {
-                throw GeometryException("Brush is empty");
-            } else  if (!addFacesToGeometry.brushValid()) {
+            if (!brushValid) {
                 throw GeometryException("Brush is invalid");
-            } else if (!fullySpecified()) {
-                throw GeometryException("Brush is not fully specified");
             }
+            return true;
+        }
+
+        bool Brush::buildGeometryFromVertices(const BBox3& worldBounds, const Vec3::List& vertexPositions, const std::vector<std::vector<size_t>>& faceVertexIndices) {
+            assert(m_geometry == nullptr);
+
+            if (faceVertexIndices.size() != m_faces.size()) {
+                return false;
+            }
+
+            auto* geometry = new BrushGeometry();
+            std::vector<BrushFaceGeometry*> faceGeometries;
+            if (!geometry->buildFromFaces(vertexPositions, faceVertexIndices, faceGeometries) ||
+                std::find(std::begin(faceGeometries), std::end(faceGeometries), nullptr) != std::end(faceGeometries) ||
+                !worldBounds.expanded(1.0).contains(geometry->bounds())) {
+                delete geometry;
+                return false;
+            }
+
+            for (size_t i = 0; i < m_faces.size(); ++i) {
+                m_faces[i]->setGeometry(faceGeometries[i]);
+            }
+
+            m_geometry = geometry;
+            updateFacesFromGeometry(worldBounds, *m_geometry);
+            return true;
         }
 
         void Brush::deleteGeometry() {
@@ -1189,6 +1448,7 @@ namespace TrenchBroom {
             }
             delete m_geometry;
             m_geometry = nullptr;
+            m_flatGeometry.clear();
         }
 
         bool Brush::checkGeometry() const {
@@ -1344,17 +1604,12 @@ namespace TrenchBroom {
         Brush::BrushFaceHit::BrushFaceHit(BrushFace* i_face, const FloatType i_distance) : face(i_face), distance(i_distance) {}
 
         Brush::BrushFaceHit Brush::findFaceHit(const Ray3& ray) const {
-            if (Math::isnan(bounds().intersectWithRay(ray))) {
+            size_t faceIndex;
+            const auto distance = m_flatGeometry.intersectWithRay(ray, faceIndex);
+            if (Math::isnan(distance)) {
                 return BrushFaceHit();
             }
-
-            for (auto* face : m_faces) {
-                const auto distance = face->intersectWithRay(ray);
-                if (!Math::isnan(distance)) {
-                    return BrushFaceHit(face, distance);
-                }
-            }
-            return BrushFaceHit();
+            return BrushFaceHit(m_flatGeometry.face(faceIndex), distance);
         }
 
         Node* Brush::doGetContainer() const {
@@ -27,6 +27,7 @@
 #include "Polyhedron_Matcher.h"
 #include "Model/BrushContentType.h"
 #include "Model/BrushGeometry.h"
+#include "Model/FlatBrushGeometry.h"
 #include "Model/Node.h"
 #include "Model/Object.h"
 #include "Renderer/BrushRendererBrushCache.h"
@@ -41,6 +42,8 @@
 #include <set>
 
 namespace TrenchBroom {
+    class ProgressStatus;
+
     namespace Model {
         struct BrushAlgorithmResult;
         class BrushContentTypeBuilder;
@@ -54,6 +57,13 @@ namespace TrenchBroom {
         public:
             static const Hit::HitType BrushHit;
         private:
+            /**
+             * Brushes with up to this many faces are built by intersecting their face planes directly. Larger brushes
+             * are built by clipping a world sized cube, since the direct construction scales with the cube of the
+             * number of faces.
+             */
+            static const size_t MaxDirectGeometryFaceCount;
+
             struct ProjectToVertex : public ProjectingSequenceProjector<BrushVertex*, BrushVertex*> {
                 static BrushVertex*& project(BrushVertex*& vertex);
             };
@@ -65,6 +75,7 @@ namespace TrenchBroom {
             class AddFaceToGeometryCallback;
             class HealEdgesCallback;
             class AddFacesToGeometry;
+            class LinkFaceGeometryCallback;
             class MoveVerticesCallback;
             typedef MoveVerticesCallback RemoveVertexCallback;
             class QueryCallback;
@@ -78,6 +89,11 @@ namespace TrenchBroom {
         private:
             BrushFaceList m_faces;
             BrushGeometry* m_geometry;
+            /**
+             * A compact copy of m_geometry that is used by the read only geometry queries. It is rebuilt whenever the
+             * geometry is rebuilt.
+             */
+            FlatBrushGeometry m_flatGeometry;
             
             const BrushContentTypeBuilder* m_contentTypeBuilder;
             mutable BrushContentType::FlagType m_contentType;
@@ -86,6 +102,13 @@ namespace TrenchBroom {
             mutable Renderer::BrushRendererBrushCache m_brushRendererBrushCache;
         public:
             Brush(const BBox3& worldBounds, const BrushFaceList& faces);
+            /**
+             * Creates a brush whose geometry has the given vertex positions and, for each of the given faces, the
+             * indices of its vertices in counter clockwise order. This avoids computing the geometry from the face
+             * planes. If the given vertices and faces do not form a valid geometry, the geometry is computed from the
+             * face planes instead.
+             */
+            Brush(const BBox3& worldBounds, const BrushFaceList& faces, const Vec3::List& vertexPositions, const std::vector<std::vector<size_t>>& faceVertexIndices);
             ~Brush() override;
         private:
             void cleanup();
@@ -155,7 +178,7 @@ namespace TrenchBroom {
             // geometry access
             size_t vertexCount() const;
             VertexList vertices() const;
-            const Vec3::List vertexPositions() const;
+            const Vec3::List& vertexPositions() const;
             Vec3 findClosestVertexPosition(const Vec3& position) const;
 
             bool hasVertex(const Vec3& position, FloatType epsilon = static_cast<FloatType>(0.0)) const;
@@ -174,6 +197,8 @@ namespace TrenchBroom {
             bool containsPoint(const Vec3& point) const;
             
             BrushFaceList incidentFaces(const BrushVertex* vertex) const;
+
+            const FlatBrushGeometry& flatGeometry() const;
             
             // vertex operations
             bool canMoveVertices(const BBox3& worldBounds, const Vec3::List& vertices, const Vec3& delta) const;
@@ -217,19 +242,62 @@ namespace TrenchBroom {
         public:
             // CSG operations
             BrushList subtract(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const Brush* subtrahend) const;
+
+            /**
+             * Subtracts the given subtrahend from each of the given minuends and returns the fragments of every
+             * minuend, in the order of the minuends. The fragments are built in parallel, and their face attributes
+             * are copied afterwards on the calling thread, since copying them changes the usage counts of the
+             * textures.
+             *
+             * If the given status reports that the operation was cancelled, no fragments are returned.
+             */
+            static std::vector<BrushList> subtract(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushList& minuends, const Brush* subtrahend, ProgressStatus& status);
             void intersect(const BBox3& worldBounds, const Brush* brush);
 
+            /**
+             * Returns a new brush that is the intersection of the given brushes, or null if the intersection is empty
+             * or if the given status reports that the operation was cancelled. The brushes are split into batches
+             * which are intersected in parallel, and only the faces that bound the final intersection are cloned.
+             */
+            static Brush* intersect(const ModelFactory& factory, const BBox3& worldBounds, const BrushList& brushes, ProgressStatus& status);
+
             // transformation
             bool canTransform(const Mat4x4& transformation, const BBox3& worldBounds) const;
         private:
-            Brush* createBrush(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry& geometry, const Brush* subtrahend) const;
+            /**
+             * Creates the fragments of subtracting the given subtrahend from this brush, but leaves their face
+             * attributes at their defaults. This does not modify any shared state, so it can be called for several
+             * brushes at once.
+             */
+            BrushList createFragments(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const Brush* subtrahend) const;
+            void cloneFragmentFaceAttributes(const BrushList& fragments, const Brush* subtrahend) const;
+            static Brush* createBrush(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry& geometry);
+
+            /**
+             * Clips the given geometry with the boundaries of the given faces and links the created geometry faces to
+             * the brush faces, but leaves the brush faces unchanged. Returns false if the geometry becomes empty or
+             * invalid.
+             */
+            static bool intersectGeometryWithFaces(BrushGeometry& geometry, const BrushFaceList& faces);
         private:
             void updateFacesFromGeometry(const BBox3& worldBounds, const BrushGeometry& geometry);
             void updatePointsFromVertices(const BBox3& worldBounds);
         public: // brush geometry
             void rebuildGeometry(const BBox3& worldBounds);
+
+            /**
+             * Rebuilds the geometry of each of the given brushes. Since the geometry of a brush only depends on its
+             * own faces and the world bounds, the geometries are built in parallel, and the bounds change
+             * notifications are sent afterwards on the calling thread for those brushes whose geometry was rebuilt.
+             *
+             * If the geometry of any brush cannot be built, the remaining brushes are still processed, and the
+             * exception of the first such brush in the given list is rethrown.
+             */
+            static void rebuildGeometry(const BBox3& worldBounds, const BrushList& brushes);
         private:
             void buildGeometry(const BBox3& worldBounds);
+            bool buildGeometryFromPlanes(const BBox3& worldBounds);
+            bool buildGeometryFromVertices(const BBox3& worldBounds, const Vec3::List& vertexPositions, const std::vector<std::vector<size_t>>& faceVertexIndices);
             void deleteGeometry();
             bool checkGeometry() const;
         public:
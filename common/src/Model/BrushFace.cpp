@@ -574,6 +574,14 @@ namespace TrenchBroom {
             invalidateVertexCache();
         }
 
+        size_t BrushFace::lineNumber() const {
+            return m_lineNumber;
+        }
+
+        size_t BrushFace::lineCount() const {
+            return m_lineCount;
+        }
+
         void BrushFace::setFilePosition(const size_t lineNumber, const size_t lineCount) {
             m_lineNumber = lineNumber;
             m_lineCount = lineCount;
@@ -187,6 +187,8 @@ namespace TrenchBroom {
             void setGeometry(BrushFaceGeometry* geometry);
             void invalidate();
             
+            size_t lineNumber() const;
+            size_t lineCount() const;
             void setFilePosition(const size_t lineNumber, const size_t lineCount);
             
             bool selected() const;
@@ -0,0 +1,296 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FlatBrushGeometry.h"
+
+#include "Algorithms.h"
+#include "Ensure.h"
+#include "Model/BrushFace.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace TrenchBroom {
+    namespace Model {
+        /**
+         * Maps the elements of a half edge geometry to their indices in the flat geometry.
+         */
+        template <typename E>
+        class IndexLookup {
+        private:
+            using Entry = std::pair<const E*, size_t>;
+            std::vector<Entry> m_entries;
+        public:
+            template <typename L>
+            explicit IndexLookup(const L& elements) {
+                m_entries.reserve(elements.size());
+                for (const E* element : elements) {
+                    m_entries.emplace_back(element, m_entries.size());
+                }
+                std::sort(std::begin(m_entries), std::end(m_entries));
+            }
+
+            size_t operator()(const E* element) const {
+                const auto it = std::lower_bound(std::begin(m_entries), std::end(m_entries), Entry(element, 0));
+                assert(it != std::end(m_entries) && it->first == element);
+                return it->second;
+            }
+        };
+
+        FlatBrushGeometry::FlatBrushGeometry() {}
+
+        FlatBrushGeometry::FlatBrushGeometry(const BrushGeometry& geometry) :
+        m_bounds(geometry.bounds()) {
+            const IndexLookup<BrushVertex> vertexIndex(geometry.vertices());
+            const IndexLookup<BrushFaceGeometry> faceIndex(geometry.faces());
+
+            m_vertexPositions.reserve(geometry.vertexCount());
+            for (const auto* vertex : geometry.vertices()) {
+                m_vertexPositions.push_back(vertex->position());
+            }
+
+            m_faceVertexIndices.reserve(2 * geometry.edgeCount());
+            m_faceOffsets.reserve(geometry.faceCount() + 1);
+            m_facePlanes.reserve(geometry.faceCount());
+            m_packedFacePlanes.reserve(geometry.faceCount());
+            m_faces.reserve(geometry.faceCount());
+
+            m_faceOffsets.push_back(0);
+            for (const auto* face : geometry.faces()) {
+                for (const auto* halfEdge : face->boundary()) {
+                    m_faceVertexIndices.push_back(vertexIndex(halfEdge->origin()));
+                }
+                m_faceOffsets.push_back(m_faceVertexIndices.size());
+
+                auto* brushFace = face->payload();
+                m_facePlanes.push_back(brushFace != nullptr ? brushFace->boundary() : Plane3(face->origin(), face->normal()));
+                m_faces.push_back(brushFace);
+                m_packedFacePlanes.add(m_facePlanes.back());
+            }
+
+            m_edgeVertexIndices.reserve(2 * geometry.edgeCount());
+            m_edgeFaceIndices.reserve(2 * geometry.edgeCount());
+            for (const auto* edge : geometry.edges()) {
+                m_edgeVertexIndices.push_back(vertexIndex(edge->firstVertex()));
+                m_edgeVertexIndices.push_back(vertexIndex(edge->secondVertex()));
+                m_edgeFaceIndices.push_back(faceIndex(edge->firstFace()));
+                m_edgeFaceIndices.push_back(faceIndex(edge->secondFace()));
+            }
+        }
+
+        void FlatBrushGeometry::clear() {
+            m_vertexPositions.clear();
+            m_faceVertexIndices.clear();
+            m_faceOffsets.clear();
+            m_facePlanes.clear();
+            m_packedFacePlanes.clear();
+            m_faces.clear();
+            m_edgeVertexIndices.clear();
+            m_edgeFaceIndices.clear();
+            m_bounds = BBox3();
+        }
+
+        bool FlatBrushGeometry::empty() const {
+            return m_vertexPositions.empty();
+        }
+
+        const BBox3& FlatBrushGeometry::bounds() const {
+            return m_bounds;
+        }
+
+        size_t FlatBrushGeometry::vertexCount() const {
+            return m_vertexPositions.size();
+        }
+
+        const Vec3::List& FlatBrushGeometry::vertexPositions() const {
+            return m_vertexPositions;
+        }
+
+        const Vec3& FlatBrushGeometry::vertexPosition(const size_t vertexIndex) const {
+            assert(vertexIndex < vertexCount());
+            return m_vertexPositions[vertexIndex];
+        }
+
+        size_t FlatBrushGeometry::edgeCount() const {
+            return m_edgeVertexIndices.size() / 2;
+        }
+
+        size_t FlatBrushGeometry::edgeFirstVertex(const size_t edgeIndex) const {
+            assert(edgeIndex < edgeCount());
+            return m_edgeVertexIndices[2 * edgeIndex];
+        }
+
+        size_t FlatBrushGeometry::edgeSecondVertex(const size_t edgeIndex) const {
+            assert(edgeIndex < edgeCount());
+            return m_edgeVertexIndices[2 * edgeIndex + 1];
+        }
+
+        size_t FlatBrushGeometry::edgeFirstFace(const size_t edgeIndex) const {
+            assert(edgeIndex < edgeCount());
+            return m_edgeFaceIndices[2 * edgeIndex];
+        }
+
+        size_t FlatBrushGeometry::edgeSecondFace(const size_t edgeIndex) const {
+            assert(edgeIndex < edgeCount());
+            return m_edgeFaceIndices[2 * edgeIndex + 1];
+        }
+
+        size_t FlatBrushGeometry::faceCount() const {
+            return m_faces.size();
+        }
+
+        BrushFace* FlatBrushGeometry::face(const size_t faceIndex) const {
+            assert(faceIndex < faceCount());
+            return m_faces[faceIndex];
+        }
+
+        const Plane3& FlatBrushGeometry::facePlane(const size_t faceIndex) const {
+            assert(faceIndex < faceCount());
+            return m_facePlanes[faceIndex];
+        }
+
+        size_t FlatBrushGeometry::faceVertexCount(const size_t faceIndex) const {
+            assert(faceIndex < faceCount());
+            return m_faceOffsets[faceIndex + 1] - m_faceOffsets[faceIndex];
+        }
+
+        const size_t* FlatBrushGeometry::faceVertexIndicesBegin(const size_t faceIndex) const {
+            assert(faceIndex < faceCount());
+            return m_faceVertexIndices.data() + m_faceOffsets[faceIndex];
+        }
+
+        const size_t* FlatBrushGeometry::faceVertexIndicesEnd(const size_t faceIndex) const {
+            assert(faceIndex < faceCount());
+            return m_faceVertexIndices.data() + m_faceOffsets[faceIndex + 1];
+        }
+
+        bool FlatBrushGeometry::hasVertex(const Vec3& position, const FloatType epsilon) const {
+            for (const auto& vertexPosition : m_vertexPositions) {
+                if (position.equals(vertexPosition, epsilon)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        Vec3 FlatBrushGeometry::findClosestVertexPosition(const Vec3& position) const {
+            ensure(!empty(), "geometry is empty");
+
+            auto closestDistance2 = std::numeric_limits<FloatType>::max();
+            size_t closestIndex = 0;
+            for (size_t i = 0; i < m_vertexPositions.size(); ++i) {
+                const auto distance2 = position.squaredDistanceTo(m_vertexPositions[i]);
+                if (distance2 < closestDistance2) {
+                    closestDistance2 = distance2;
+                    closestIndex = i;
+                }
+            }
+            return m_vertexPositions[closestIndex];
+        }
+
+        bool FlatBrushGeometry::hasEdge(const Vec3& position1, const Vec3& position2, const FloatType epsilon) const {
+            for (size_t i = 0; i < m_edgeVertexIndices.size(); i += 2) {
+                const auto& first = m_vertexPositions[m_edgeVertexIndices[i]];
+                const auto& second = m_vertexPositions[m_edgeVertexIndices[i + 1]];
+                if ((first.equals(position1, epsilon) && second.equals(position2, epsilon)) ||
+                    (first.equals(position2, epsilon) && second.equals(position1, epsilon))) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool FlatBrushGeometry::hasFace(const Vec3::List& positions, const FloatType epsilon) const {
+            for (size_t i = 0; i < faceCount(); ++i) {
+                if (faceHasVertexPositions(i, positions, epsilon)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool FlatBrushGeometry::faceHasVertexPositions(const size_t faceIndex, const Vec3::List& positions, const FloatType epsilon) const {
+            const auto count = faceVertexCount(faceIndex);
+            if (positions.size() != count) {
+                return false;
+            }
+
+            const auto* indices = faceVertexIndicesBegin(faceIndex);
+            for (size_t start = 0; start < count; ++start) {
+                size_t i = 0;
+                while (i < count && m_vertexPositions[indices[(start + i) % count]].equals(positions[i], epsilon)) {
+                    ++i;
+                }
+                if (i == count) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool FlatBrushGeometry::containsPoint(const Vec3& point) const {
+            if (empty() || !m_bounds.contains(point)) {
+                return false;
+            }
+
+            for (const auto& plane : m_facePlanes) {
+                if (plane.pointStatus(point) == Math::PointStatus::PSAbove) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        FloatType FlatBrushGeometry::intersectWithRay(const Ray3& ray, size_t& faceIndex) const {
+            const auto hit = RayKernels::intersectConvexWithRay(ray, m_packedFacePlanes);
+            if (hit.outside ||
+                hit.enterPlane == faceCount() ||
+                Math::neg(hit.enterDistance) ||
+                hit.enterDistance > hit.exitDistance + Math::Constants<FloatType>::almostZero()) {
+                return Math::nan<FloatType>();
+            }
+
+            const auto distance = intersectFaceWithRay(hit.enterPlane, ray);
+            if (!Math::isnan(distance)) {
+                faceIndex = hit.enterPlane;
+                return distance;
+            }
+
+            for (size_t i = 0; i < faceCount(); ++i) {
+                const auto faceDistance = intersectFaceWithRay(i, ray);
+                if (!Math::isnan(faceDistance)) {
+                    faceIndex = i;
+                    return faceDistance;
+                }
+            }
+            return Math::nan<FloatType>();
+        }
+
+        FloatType FlatBrushGeometry::intersectFaceWithRay(const size_t faceIndex, const Ray3& ray) const {
+            const auto& plane = m_facePlanes[faceIndex];
+            if (!Math::neg(plane.normal.dot(ray.direction))) {
+                return Math::nan<FloatType>();
+            }
+
+            const auto getPosition = [this](const size_t index) { return m_vertexPositions[index]; };
+            return intersectPolygonWithRay(ray, plane, faceVertexIndicesBegin(faceIndex), faceVertexIndicesEnd(faceIndex), getPosition);
+        }
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_FlatBrushGeometry
+#define TrenchBroom_FlatBrushGeometry
+
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "RayKernels.h"
+#include "Model/BrushGeometry.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushFace;
+
+        /**
+         * An immutable copy of the geometry of a finished brush, stored in contiguous arrays. Vertices, edges and
+         * faces are referred to by their indices into these arrays. The read only queries of a brush use this
+         * representation, while the half edge geometry is only used for editing.
+         *
+         * The faces are stored in the same order as the faces of the half edge geometry, and the vertex indices of
+         * every face are stored in counter clockwise order, starting with the origin of the first half edge of its
+         * boundary.
+         */
+        class FlatBrushGeometry {
+        private:
+            Vec3::List m_vertexPositions;
+
+            /**
+             * The vertex indices of the boundaries of all faces. The boundary of face i is stored in the range
+             * [m_faceOffsets[i], m_faceOffsets[i + 1]).
+             */
+            std::vector<size_t> m_faceVertexIndices;
+            std::vector<size_t> m_faceOffsets;
+            Plane3::List m_facePlanes;
+            RayKernels::PackedPlanes m_packedFacePlanes;
+            std::vector<BrushFace*> m_faces;
+
+            /**
+             * Two entries per edge, ordered like the first and second half edge of the edge.
+             */
+            std::vector<size_t> m_edgeVertexIndices;
+            std::vector<size_t> m_edgeFaceIndices;
+
+            BBox3 m_bounds;
+        public:
+            FlatBrushGeometry();
+            explicit FlatBrushGeometry(const BrushGeometry& geometry);
+
+            void clear();
+            bool empty() const;
+
+            const BBox3& bounds() const;
+
+            size_t vertexCount() const;
+            const Vec3::List& vertexPositions() const;
+            const Vec3& vertexPosition(size_t vertexIndex) const;
+
+            size_t edgeCount() const;
+            size_t edgeFirstVertex(size_t edgeIndex) const;
+            size_t edgeSecondVertex(size_t edgeIndex) const;
+            size_t edgeFirstFace(size_t edgeIndex) const;
+            size_t edgeSecondFace(size_t edgeIndex) const;
+
+            size_t faceCount() const;
+            BrushFace* face(size_t faceIndex) const;
+            const Plane3& facePlane(size_t faceIndex) const;
+            size_t faceVertexCount(size_t faceIndex) const;
+            const size_t* faceVertexIndicesBegin(size_t faceIndex) const;
+            const size_t* faceVertexIndicesEnd(size_t faceIndex) const;
+        public: // queries
+            bool hasVertex(const Vec3& position, FloatType epsilon = static_cast<FloatType>(0.0)) const;
+            Vec3 findClosestVertexPosition(const Vec3& position) const;
+            bool hasEdge(const Vec3& position1, const Vec3& position2, FloatType epsilon = static_cast<FloatType>(0.0)) const;
+            /**
+             * Checks whether there is a face with the given vertex positions in counter clockwise order, starting at
+             * any of its vertices.
+             */
+            bool hasFace(const Vec3::List& positions, FloatType epsilon = static_cast<FloatType>(0.0)) const;
+            bool containsPoint(const Vec3& point) const;
+
+            /**
+             * Intersects the given ray with the front facing faces of this geometry. Returns the distance of the hit
+             * and sets the given face index to the index of the hit face, or returns NaN if the ray misses.
+             *
+             * The face through which the ray enters the geometry is found by intersecting the ray with all face
+             * planes at once. Only that face is checked for containing the hit point, unless the ray grazes an edge
+             * or a face, in which case all faces are checked one by one.
+             */
+            FloatType intersectWithRay(const Ray3& ray, size_t& faceIndex) const;
+        private:
+            FloatType intersectFaceWithRay(size_t faceIndex, const Ray3& ray) const;
+            bool faceHasVertexPositions(size_t faceIndex, const Vec3::List& positions, FloatType epsilon) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_FlatBrushGeometry) */
@@ -19,6 +19,7 @@
 
 #include "Game.h"
 
+#include "ProgressStatus.h"
 #include "Model/BrushContentTypeBuilder.h"
 #include "Model/GameFactory.h"
 
@@ -70,7 +71,22 @@ namespace TrenchBroom {
         }
         
         World* Game::loadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const {
-            return doLoadMap(format, worldBounds, path, logger);
+            NullProgressStatus status;
+            return loadMap(format, worldBounds, path, logger, status);
+        }
+
+        World* Game::loadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger, ProgressStatus& status) const {
+            return doLoadMap(format, worldBounds, path, logger, status, LoadedNodesCallback());
+        }
+
+        World* Game::loadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger, ProgressStatus& status, const LoadedNodesCallback& callback) const {
+            ensure(callback, "callback is empty");
+            return doLoadMap(format, worldBounds, path, logger, status, callback);
+        }
+
+        void Game::writeMapCache(const World* world, const IO::Path& path, Logger* logger) const {
+            ensure(world != nullptr, "world is null");
+            doWriteMapCache(world, path, logger);
         }
 
         void Game::writeMap(World* world, const IO::Path& path) const {
@@ -34,8 +34,11 @@
 #include "Model/MapFormat.h"
 #include "Model/ModelTypes.h"
 
+#include <functional>
+
 namespace TrenchBroom {
     class Logger;
+    class ProgressStatus;
     
     namespace Assets {
         class TextureManager;
@@ -50,6 +53,12 @@ namespace TrenchBroom {
                 TP_File,
                 TP_Directory
             } TexturePackageType;
+
+            /**
+             * Receives the world and the nodes that were read from a map file while the map file is being read, see
+             * IO::WorldReader::PublishCallback.
+             */
+            typedef std::function<void(World* world, const ParentChildrenMap& nodes)> LoadedNodesCallback;
         private:
             mutable BrushContentTypeBuilder* m_brushContentTypeBuilder;
         protected:
@@ -73,6 +82,25 @@ namespace TrenchBroom {
         public: // loading and writing map files
             World* newMap(MapFormat::Type format, const BBox3& worldBounds) const;
             World* loadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const;
+            /**
+             * Reports the progress of parsing the map file to the given status. If the status is cancelled, loading
+             * stops with a CancelledException.
+             */
+            World* loadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger, ProgressStatus& status) const;
+            /**
+             * Like the previous overload, but passes the world and the nodes that were read to the given callback
+             * while the map file is being read, so that loading can happen on another thread while the world is
+             * being used, see IO::WorldReader. The callback is not called if the world is loaded from the map cache.
+             *
+             * If the callback was called, the returned world is the world that was passed to the callback, and the
+             * map cache is not written, since the world is only complete once the callback's owner has added all
+             * nodes. Call writeMapCache then.
+             */
+            World* loadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger, ProgressStatus& status, const LoadedNodesCallback& callback) const;
+            /**
+             * Writes the map cache for the map file at the given path if the map cache is enabled.
+             */
+            void writeMapCache(const World* world, const IO::Path& path, Logger* logger) const;
             void writeMap(World* world, const IO::Path& path) const;
             void exportMap(World* world, Model::ExportFormat format, const IO::Path& path) const;
         public: // parsing and serializing objects
@@ -114,7 +142,8 @@ namespace TrenchBroom {
             virtual size_t doMaxPropertyLength() const = 0;
             
             virtual World* doNewMap(MapFormat::Type format, const BBox3& worldBounds) const = 0;
-            virtual World* doLoadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const = 0;
+            virtual World* doLoadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger, ProgressStatus& status, const LoadedNodesCallback& callback) const = 0;
+            virtual void doWriteMapCache(const World* world, const IO::Path& path, Logger* logger) const = 0;
             virtual void doWriteMap(World* world, const IO::Path& path) const = 0;
             virtual void doExportMap(World* world, Model::ExportFormat format, const IO::Path& path) const = 0;
             
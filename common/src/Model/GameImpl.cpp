@@ -20,7 +20,14 @@
 #include "GameImpl.h"
 
 #include "Macros.h"
+#include "PreferenceManager.h"
+#include "Preferences.h"
+#include "Assets/MdlModel.h"
 #include "Assets/Palette.h"
+#include "EL/EvaluationContext.h"
+#include "EL/Interpolator.h"
+#include "EL/VariableStore.h"
+#include "IO/AssetCache.h"
 #include "IO/BrushFaceReader.h"
 #include "IO/Bsp29Parser.h"
 #include "IO/DefParser.h"
@@ -32,12 +39,14 @@
 #include "IO/IdPakFileSystem.h"
 #include "IO/IdWalTextureReader.h"
 #include "IO/IOUtils.h"
+#include "IO/MapCache.h"
 #include "IO/MapParser.h"
 #include "IO/MdlParser.h"
 #include "IO/Md2Parser.h"
 #include "IO/NodeReader.h"
 #include "IO/NodeWriter.h"
 #include "IO/ObjSerializer.h"
+#include "IO/ProgressParserStatus.h"
 #include "IO/WorldReader.h"
 #include "IO/SimpleParserStatus.h"
 #include "IO/SystemPaths.h"
@@ -51,6 +60,7 @@
 #include "Exceptions.h"
 
 #include <cstdio>
+#include <fstream>
 
 namespace TrenchBroom {
     namespace Model {
@@ -58,7 +68,13 @@ namespace TrenchBroom {
         m_config(config),
         m_gamePath(gamePath) {
             initializeFileSystem(logger);
+
+            // the preference is read here because models are loaded on background threads
+            if (pref(Preferences::UseAssetCache))
+                m_assetCache.reset(new IO::AssetCache(IO::SystemPaths::userDataDirectory() + IO::Path("Cache")));
         }
+
+        GameImpl::~GameImpl() {}
         
         void GameImpl::initializeFileSystem(Logger* logger) {
             const GameConfig::FileSystemConfig& fileSystemConfig = m_config.fileSystemConfig();
@@ -145,11 +161,58 @@ namespace TrenchBroom {
             return new World(format, brushContentTypeBuilder(), worldBounds);
         }
 
-        World* GameImpl::doLoadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const {
-            IO::SimpleParserStatus parserStatus(logger);
+        World* GameImpl::doLoadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger, ProgressStatus& status, const LoadedNodesCallback& callback) const {
+            IO::ProgressParserStatus parserStatus(logger, status);
             const IO::MappedFile::Ptr file = IO::Disk::openFile(IO::Disk::fixPath(path));
+            if (!pref(Preferences::UseMapCache)) {
+                IO::WorldReader reader(file->begin(), file->end(), brushContentTypeBuilder());
+                if (callback)
+                    return reader.read(format, worldBounds, parserStatus, callback);
+                return reader.read(format, worldBounds, parserStatus);
+            }
+
+            const IO::MapCache cache(file->begin(), file->end(), static_cast<int64_t>(IO::Disk::fileModificationTime(path)));
+            World* world = readMapCache(cache, format, worldBounds, path, logger);
+            if (world != nullptr)
+                return world;
+
             IO::WorldReader reader(file->begin(), file->end(), brushContentTypeBuilder());
-            return reader.read(format, worldBounds, parserStatus);
+            if (callback)
+                return reader.read(format, worldBounds, parserStatus, callback);
+
+            world = reader.read(format, worldBounds, parserStatus);
+            writeMapCache(cache, world, path, logger);
+            return world;
+        }
+
+        void GameImpl::doWriteMapCache(const World* world, const IO::Path& path, Logger* logger) const {
+            if (!pref(Preferences::UseMapCache))
+                return;
+
+            const IO::MappedFile::Ptr file = IO::Disk::openFile(IO::Disk::fixPath(path));
+            const IO::MapCache cache(file->begin(), file->end(), static_cast<int64_t>(IO::Disk::fileModificationTime(path)));
+            writeMapCache(cache, world, path, logger);
+        }
+
+        World* GameImpl::readMapCache(const IO::MapCache& cache, const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const {
+            const IO::Path cachePath = IO::MapCache::cachePath(IO::Disk::fixPath(path));
+            if (!IO::Disk::fileExists(cachePath))
+                return nullptr;
+
+            const IO::MappedFile::Ptr cacheFile = IO::Disk::openFile(cachePath);
+            World* world = cache.read(cacheFile->begin(), cacheFile->end(), format, worldBounds, brushContentTypeBuilder());
+            if (world != nullptr && logger != nullptr)
+                logger->info("Loaded map from cache file '" + cachePath.asString() + "'");
+            return world;
+        }
+
+        void GameImpl::writeMapCache(const IO::MapCache& cache, const World* world, const IO::Path& path, Logger* logger) const {
+            const IO::Path cachePath = IO::MapCache::cachePath(IO::Disk::fixPath(path));
+            std::ofstream stream(cachePath.asString().c_str(), std::ios::out | std::ios::binary);
+            if (stream.is_open())
+                cache.write(world, stream);
+            if ((!stream.is_open() || !stream.good()) && logger != nullptr)
+                logger->warn("Could not write map cache file '" + cachePath.asString() + "'");
         }
 
         void GameImpl::doWriteMap(World* world, const IO::Path& path) const {
@@ -212,7 +275,7 @@ namespace TrenchBroom {
             const IO::Path::List paths = extractTextureCollections(node);
 
             const IO::Path::List fileSearchPaths = textureCollectionSearchPaths(documentPath);
-            IO::TextureLoader textureLoader(variables, m_gameFS, fileSearchPaths, m_config.textureConfig());
+            IO::TextureLoader textureLoader(variables, m_gameFS, fileSearchPaths, m_config.textureConfig(), m_assetCache.get());
             textureLoader.loadTextures(paths, textureManager);
         }
 
@@ -368,10 +431,54 @@ namespace TrenchBroom {
         }
 
         Assets::EntityModel* GameImpl::loadMdlModel(const String& name, const IO::MappedFile::Ptr& file) const {
-            const Assets::Palette palette = loadTexturePalette();
+            if (m_assetCache == nullptr)
+                return parseMdlModel(name, file);
+            
+            // the model's skins depend on the palette, too, so without a readable palette the model is not cached
+            IO::MappedFile::Ptr paletteFile;
+            try {
+                const IO::Path palettePath = texturePalettePath();
+                if (!palettePath.isEmpty() && m_gameFS.fileExists(palettePath))
+                    paletteFile = m_gameFS.openFile(palettePath);
+            } catch (const Exception&) {}
+            
+            if (paletteFile.get() == nullptr)
+                return parseMdlModel(name, file);
+            
+            IO::AssetCache::Key key;
+            key.add("mdl");
+            key.add(static_cast<uint64_t>(IO::AssetCache::MdlModelVersion));
+            key.add(file->path().asString());
+            key.addContents(*file);
+            key.addContents(*paletteFile);
+            
+            const IO::MappedFile::Ptr entry = m_assetCache->read(key);
+            if (entry.get() != nullptr) {
+                try {
+                    IO::AssetCache::Reader reader(entry);
+                    return IO::AssetCache::readMdlModel(reader, name);
+                } catch (const FileFormatException&) {
+                    // the entry is damaged and will be replaced below
+                }
+            }
+            
+            Assets::MdlModel* model = parseMdlModel(name, file);
+            
+            try {
+                IO::AssetCache::Writer writer;
+                IO::AssetCache::writeMdlModel(writer, *model);
+                m_assetCache->write(key, writer.data());
+            } catch (const Exception&) {
+                // the model can still be used, but it will be parsed again next time
+            }
+            return model;
+        }
 
+        Assets::MdlModel* GameImpl::parseMdlModel(const String& name, const IO::MappedFile::Ptr& file) const {
+            const Assets::Palette palette = loadTexturePalette();
+            
             IO::MdlParser parser(name, file->begin(), file->end(), palette);
-            return parser.parseModel();
+            return static_cast<Assets::MdlModel*>(parser.parseModel());
         }
 
         Assets::EntityModel* GameImpl::loadMd2Model(const String& name, const IO::MappedFile::Ptr& file) const {
@@ -381,12 +488,17 @@ namespace TrenchBroom {
             return parser.parseModel();
         }
 
+        IO::Path GameImpl::texturePalettePath() const {
+            // Be aware that the variables in the palette path cannot be resolved here because there is no entity to
+            // take their values from, so they are interpolated as empty values. However, since so far the only game
+            // that uses such variables is Daikatana, and the Daikatana models do not refer to the global palette, we
+            // can ignore this here.
+            const String pathSpec = m_config.textureConfig().palette.asString();
+            return IO::Path(EL::interpolate(pathSpec, EL::EvaluationContext(EL::NullVariableStore())));
+        }
+
         Assets::Palette GameImpl::loadTexturePalette() const {
-            // Be aware that this function does not work when the palette path contains variables.
-            // However, since so far the only game that uses such variables is Daikatana, and the
-            // Daikatana models do not refer to the global palette, we can ignore this here.
-            const IO::Path& path = m_config.textureConfig().palette;
-            return Assets::Palette::loadFile(m_gameFS, path);
+            return Assets::Palette::loadFile(m_gameFS, texturePalettePath());
         }
 
         const BrushContentType::List& GameImpl::doBrushContentTypes() const {
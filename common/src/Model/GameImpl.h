@@ -29,10 +29,20 @@
 #include "Model/GameConfig.h"
 #include "Model/ModelTypes.h"
 
+#include <memory>
 
 namespace TrenchBroom {
     class Logger;
     
+    namespace Assets {
+        class MdlModel;
+    }
+    
+    namespace IO {
+        class AssetCache;
+        class MapCache;
+    }
+    
     namespace Model {
         class GameImpl : public Game {
         private:
@@ -41,8 +51,10 @@ namespace TrenchBroom {
             IO::Path::List m_additionalSearchPaths;
             
             IO::FileSystemHierarchy m_gameFS;
+            std::unique_ptr<IO::AssetCache> m_assetCache;
         public:
             GameImpl(GameConfig& config, const IO::Path& gamePath, Logger* logger);
+            ~GameImpl() override;
         private:
             void initializeFileSystem(Logger* logger);
             void addSearchPath(const IO::Path& searchPath, Logger* logger);
@@ -59,7 +71,10 @@ namespace TrenchBroom {
             size_t doMaxPropertyLength() const override;
 
             World* doNewMap(MapFormat::Type format, const BBox3& worldBounds) const override;
-            World* doLoadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const override;
+            World* doLoadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger, ProgressStatus& status, const LoadedNodesCallback& callback) const override;
+            void doWriteMapCache(const World* world, const IO::Path& path, Logger* logger) const override;
+            World* readMapCache(const IO::MapCache& cache, MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const;
+            void writeMapCache(const IO::MapCache& cache, const World* world, const IO::Path& path, Logger* logger) const;
             void doWriteMap(World* world, const IO::Path& path) const override;
             void doExportMap(World* world, Model::ExportFormat format, const IO::Path& path) const override;
 
@@ -88,7 +103,9 @@ namespace TrenchBroom {
 
             Assets::EntityModel* loadBspModel(const String& name, const IO::MappedFile::Ptr& file) const;
             Assets::EntityModel* loadMdlModel(const String& name, const IO::MappedFile::Ptr& file) const;
+            Assets::MdlModel* parseMdlModel(const String& name, const IO::MappedFile::Ptr& file) const;
             Assets::EntityModel* loadMd2Model(const String& name, const IO::MappedFile::Ptr& file) const;
+            IO::Path texturePalettePath() const;
             Assets::Palette loadTexturePalette() const;
             
             const BrushContentType::List& doBrushContentTypes() const override;
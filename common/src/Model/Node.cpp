@@ -568,6 +568,10 @@ namespace TrenchBroom {
             return m_lineNumber;
         }
 
+        size_t Node::lineCount() const {
+            return m_lineCount;
+        }
+
         void Node::setFilePosition(const size_t lineNumber, const size_t lineCount) {
             m_lineNumber = lineNumber;
             m_lineCount = lineCount;
@@ -20,7 +20,6 @@
 #include "NonIntegerVerticesIssueGenerator.h"
 
 #include "Model/Brush.h"
-#include "Model/BrushGeometry.h"
 #include "Model/Issue.h"
 #include "Model/IssueQuickFix.h"
 #include "Model/MapFacade.h"
@@ -65,8 +64,8 @@ namespace TrenchBroom {
         }
 
         void NonIntegerVerticesIssueGenerator::doGenerate(Brush* brush, IssueList& issues) const {
-            for (const BrushVertex* vertex : brush->vertices()) {
-                if (!vertex->position().isInteger()) {
+            for (const Vec3& position : brush->vertexPositions()) {
+                if (!position.isInteger()) {
                     issues.push_back(new NonIntegerVerticesIssue(brush));
                     return;
                 }
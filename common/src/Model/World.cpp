@@ -169,6 +169,12 @@ namespace TrenchBroom {
             m_nodeTree.clearAndBuild(collect.nodes(), [](const auto* node){ return node->bounds(); });
         }
 
+        NodeList World::findNodesIntersecting(const BBox3& bounds) const {
+            NodeList result;
+            m_nodeTree.findIntersectors(bounds, std::back_inserter(result));
+            return result;
+        }
+
         class World::InvalidateAllIssuesVisitor : public NodeVisitor {
         private:
             void doVisit(World* world) override   { invalidateIssues(world);  }
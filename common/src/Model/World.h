@@ -79,6 +79,11 @@ namespace TrenchBroom {
             void disableNodeTreeUpdates();
             void enableNodeTreeUpdates();
             void rebuildNodeTree();
+        public: // node tree queries
+            /**
+             * Returns every group, entity and brush whose bounds intersect the given bounds.
+             */
+            NodeList findNodesIntersecting(const BBox3& bounds) const;
         private:
             class InvalidateAllIssuesVisitor;
             void invalidateAllIssues();
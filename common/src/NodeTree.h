@@ -130,6 +130,15 @@ public:
      */
     virtual List findIntersectors(const Ray<T,S>& ray) const = 0;
 
+    /**
+     * Finds every data item in this tree whose bounding box intersects with the given bounding box and returns a list
+     * of those items.
+     *
+     * @param bounds the bounding box to test
+     * @return a list containing all found data items
+     */
+    virtual List findIntersectors(const Box& bounds) const = 0;
+
     /**
      * Finds every data item in this tree whose bounding box contains the given point and returns a list of those items.
      *
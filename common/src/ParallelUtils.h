@@ -0,0 +1,240 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ParallelUtils_h
+#define TrenchBroom_ParallelUtils_h
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ParallelUtils {
+    /**
+     * Returns the number of worker threads to use for parallel work, which is the number of hardware threads
+     * reported by the system, but at least 1.
+     */
+    inline size_t threadCount() {
+        const size_t count = static_cast<size_t>(std::thread::hardware_concurrency());
+        return std::max(count, static_cast<size_t>(1));
+    }
+
+    /**
+     * Returns the number of worker threads that are currently running in calls to forEachIndex.
+     */
+    inline std::atomic<size_t>& activeWorkerCount() {
+        static std::atomic<size_t> count(0);
+        return count;
+    }
+
+    /**
+     * Reserves up to the given number of additional worker threads and returns the number of threads that were
+     * actually reserved. Nested parallel calls thereby share the threads reported by threadCount() instead of
+     * multiplying them.
+     */
+    inline size_t acquireWorkers(const size_t requested) {
+        const size_t maximum = threadCount() - 1;
+        std::atomic<size_t>& active = activeWorkerCount();
+        size_t current = active.load();
+        size_t granted = 0;
+        do {
+            granted = current < maximum ? std::min(requested, maximum - current) : 0;
+        } while (granted > 0 && !active.compare_exchange_weak(current, current + granted));
+        return granted;
+    }
+
+    inline void releaseWorkers(const size_t count) {
+        activeWorkerCount() -= count;
+    }
+
+    /**
+     * A fixed set of threads that run the tasks submitted by forEachIndex, so that parallel calls do not create and
+     * join threads every time. The pool has one thread less than threadCount() because the thread calling
+     * forEachIndex participates in the work. Since forEachIndex only submits as many tasks as it could reserve
+     * workers, a submitted task never waits for a thread that is busy with other work.
+     */
+    class WorkerPool {
+    public:
+        typedef std::function<void()> Task;
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<Task> m_tasks;
+        std::vector<std::thread> m_threads;
+        bool m_stopping;
+    public:
+        static WorkerPool& instance() {
+            static WorkerPool pool(threadCount() - 1);
+            return pool;
+        }
+
+        explicit WorkerPool(const size_t size) :
+        m_stopping(false) {
+            m_threads.reserve(size);
+            for (size_t i = 0; i < size; ++i)
+                m_threads.push_back(std::thread([this]() { run(); }));
+        }
+
+        ~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_condition.notify_all();
+            for (std::thread& thread : m_threads)
+                thread.join();
+        }
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /**
+         * Runs the given task on one of the threads of this pool. The task must not throw.
+         */
+        void submit(Task task) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.push_back(std::move(task));
+            }
+            m_condition.notify_one();
+        }
+    private:
+        void run() {
+            while (true) {
+                Task task;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+                    if (m_tasks.empty())
+                        return;
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+                task();
+            }
+        }
+    };
+
+    /**
+     * Calls the given function once for every index in [0, count), distributing the calls across the threads of
+     * the worker pool. The indices are handed out in ascending order, but the calls may complete in any order.
+     * The calling thread participates in the work and this function only returns once all calls have completed.
+     *
+     * If any call throws an exception, no further indices are handed out, and the first exception that was
+     * caught is rethrown on the calling thread.
+     *
+     * The given function must be safe to call concurrently from multiple threads. It may call forEachIndex itself,
+     * in which case the nested call only uses the worker threads that are not busy yet.
+     */
+    template <typename F>
+    void forEachIndex(const size_t count, F func) {
+        const size_t workerCount = count > 1 ? acquireWorkers(std::min(threadCount(), count) - 1) + 1 : 1;
+        if (workerCount <= 1) {
+            for (size_t i = 0; i < count; ++i)
+                func(i);
+            return;
+        }
+
+        std::atomic<size_t> next(0);
+        std::atomic<bool> failed(false);
+        std::exception_ptr exception;
+        std::mutex exceptionMutex;
+
+        const auto work = [&]() {
+            size_t i = next++;
+            while (i < count && !failed) {
+                try {
+                    func(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(exceptionMutex);
+                    if (!failed) {
+                        exception = std::current_exception();
+                        failed = true;
+                    }
+                }
+                i = next++;
+            }
+        };
+
+        // the last worker notifies while holding the lock, so that this frame outlives every access by the workers
+        size_t pending = workerCount - 1;
+        std::mutex doneMutex;
+        std::condition_variable done;
+
+        WorkerPool& pool = WorkerPool::instance();
+        for (size_t i = 0; i < workerCount - 1; ++i) {
+            pool.submit([&]() {
+                work();
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (--pending == 0)
+                    done.notify_one();
+            });
+        }
+        work();
+
+        {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            done.wait(lock, [&]() { return pending == 0; });
+        }
+        releaseWorkers(workerCount - 1);
+
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+    /**
+     * Like forEachIndex, but reports the fraction of completed calls to the given status and stops handing out
+     * indices once the status reports that the work was cancelled. The status must provide the member functions
+     * progress(double) and cancelled(). Both are only called on the calling thread, after each call of the given
+     * function that the calling thread completes.
+     *
+     * Returns false if the status reported that the work was cancelled. The given function may then not have been
+     * called for some of the indices.
+     */
+    template <typename F, typename S>
+    bool forEachIndex(const size_t count, F func, S& status) {
+        const std::thread::id caller = std::this_thread::get_id();
+        std::atomic<size_t> completed(0);
+        std::atomic<bool> cancelled(false);
+
+        forEachIndex(count, [&](const size_t i) {
+            if (cancelled)
+                return;
+
+            func(i);
+
+            const size_t current = ++completed;
+            if (std::this_thread::get_id() == caller) {
+                status.progress(static_cast<double>(current) / static_cast<double>(count));
+                if (status.cancelled())
+                    cancelled = true;
+            }
+        });
+
+        return !cancelled;
+    }
+}
+
+#endif
@@ -488,6 +488,30 @@ public: // Clipping
      */
     ClipResult clip(const Polyhedron& polyhedron);
     ClipResult clip(const Polyhedron& polyhedron, Callback& callback);
+public: // Construction from halfspaces
+    /**
+     Replaces this polyhedron with the intersection of the halfspaces below the given planes. Instead of clipping a
+     large polyhedron with every plane, the corners are computed directly from the intersection points of all plane
+     triples, which is much cheaper for the small plane sets of brushes.
+     
+     On success, planeFaces contains the face that lies on each plane, or null if a plane only touches the result or
+     coincides with an earlier plane.
+     
+     Returns false and leaves this polyhedron unchanged if the result is unbounded or degenerate, or if the corners
+     cannot be connected consistently due to floating point imprecision. Callers should then fall back to clipping.
+     */
+    bool intersectHalfspaces(const typename Plane<T,3>::List& planes, std::vector<Face*>& planeFaces);
+
+    /**
+     Replaces this polyhedron with the polyhedron that has the given vertices and faces. Each face is given by the
+     indices of its vertices in counter clockwise order when viewed from above the face. An empty index list creates
+     no face.
+
+     On success, faces contains the face created for each index list, or null if the index list is empty.
+
+     Returns false and leaves this polyhedron unchanged if the faces do not form a closed polyhedron.
+     */
+    bool buildFromFaces(const typename V::List& positions, const std::vector<std::vector<size_t>>& faceIndices, std::vector<Face*>& faces);
 public: // Intersection
     Polyhedron intersect(const Polyhedron& other) const;
     Polyhedron intersect(Polyhedron other, const Callback& callback) const;
@@ -0,0 +1,219 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Polyhedron_Halfspaces_h
+#define TrenchBroom_Polyhedron_Halfspaces_h
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+template <typename T, typename FP, typename VP>
+bool Polyhedron<T,FP,VP>::intersectHalfspaces(const typename Plane<T,3>::List& planes, std::vector<Face*>& planeFaces) {
+    typedef std::vector<size_t> IndexList;
+
+    const T epsilon = Math::Constants<T>::pointStatusEpsilon();
+    const size_t planeCount = planes.size();
+    if (planeCount < 4)
+        return false;
+
+    // Every corner of the polyhedron is the intersection point of three planes which is not above any plane.
+    typename V::List positions;
+    for (size_t i = 0; i < planeCount; ++i) {
+        for (size_t j = i + 1; j < planeCount; ++j) {
+            const V ij = crossed(planes[i].normal, planes[j].normal);
+            for (size_t k = j + 1; k < planeCount; ++k) {
+                const V jk = crossed(planes[j].normal, planes[k].normal);
+                const T det = planes[i].normal.dot(jk);
+                if (Math::zero(det, Math::Constants<T>::almostZero()))
+                    continue;
+
+                const V ki = crossed(planes[k].normal, planes[i].normal);
+                const V position = (planes[i].distance * jk + planes[j].distance * ki + planes[k].distance * ij) / det;
+
+                const auto isAbove = [&position](const Plane<T,3>& plane) {
+                    return plane.pointStatus(position) == Math::PointStatus::PSAbove;
+                };
+                if (std::any_of(std::begin(planes), std::end(planes), isAbove))
+                    continue;
+
+                const auto isSame = [&position, epsilon](const V& other) { return other.equals(position, epsilon); };
+                if (std::none_of(std::begin(positions), std::end(positions), isSame))
+                    positions.push_back(position);
+            }
+        }
+    }
+
+    if (positions.size() < 4)
+        return false;
+
+    // Collect the corners on every plane in counter clockwise order when viewed from above the plane.
+    std::vector<IndexList> faceIndices(planeCount);
+    std::vector<IndexList> faceCorners;
+
+    for (size_t i = 0; i < planeCount; ++i) {
+        const Plane<T,3>& plane = planes[i];
+
+        IndexList indices;
+        for (size_t j = 0; j < positions.size(); ++j) {
+            if (plane.pointStatus(positions[j]) == Math::PointStatus::PSInside)
+                indices.push_back(j);
+        }
+
+        // The plane only touches the polyhedron, or it coincides with an earlier plane.
+        if (indices.size() < 3 || std::find(std::begin(faceCorners), std::end(faceCorners), indices) != std::end(faceCorners))
+            continue;
+        faceCorners.push_back(indices);
+
+        V center = V::Null;
+        for (const size_t index : indices)
+            center += positions[index];
+        center /= static_cast<T>(indices.size());
+
+        const V u = plane.normal.makePerpendicular();
+        const V v = crossed(plane.normal, u);
+
+        std::vector<std::pair<T, size_t>> angles;
+        angles.reserve(indices.size());
+        for (const size_t index : indices) {
+            const V direction = positions[index] - center;
+            angles.push_back(std::make_pair(std::atan2(direction.dot(v), direction.dot(u)), index));
+        }
+        std::sort(std::begin(angles), std::end(angles));
+
+        for (size_t j = 0; j < angles.size(); ++j) {
+            // two corners in the same direction mean that the face is degenerate
+            if (j > 0 && Math::eq(angles[j].first, angles[j - 1].first, Math::Constants<T>::almostZero()))
+                return false;
+            faceIndices[i].push_back(angles[j].second);
+        }
+    }
+
+    std::vector<Face*> faces;
+    if (!buildFromFaces(positions, faceIndices, faces))
+        return false;
+
+    using std::swap;
+    swap(planeFaces, faces);
+    return true;
+}
+
+template <typename T, typename FP, typename VP>
+bool Polyhedron<T,FP,VP>::buildFromFaces(const typename V::List& positions, const std::vector<std::vector<size_t>>& faceIndices, std::vector<Face*>& faces) {
+    typedef std::vector<size_t> IndexList;
+    typedef std::pair<size_t, size_t> DirectedEdge;
+
+    // Check that the faces form a closed manifold before creating anything. Every half edge must be unique and have
+    // a twin running in the opposite direction.
+    std::vector<DirectedEdge> directedEdges;
+    std::vector<size_t> vertexFaceCount(positions.size(), 0);
+    size_t faceCount = 0;
+    for (const IndexList& indices : faceIndices) {
+        if (indices.empty())
+            continue;
+        if (indices.size() < 3)
+            return false;
+
+        for (size_t j = 0; j < indices.size(); ++j) {
+            if (indices[j] >= positions.size())
+                return false;
+            ++vertexFaceCount[indices[j]];
+
+            const DirectedEdge directedEdge(indices[j], indices[(j + 1) % indices.size()]);
+            if (directedEdge.first == directedEdge.second)
+                return false;
+            directedEdges.push_back(directedEdge);
+        }
+        ++faceCount;
+    }
+
+    std::sort(std::begin(directedEdges), std::end(directedEdges));
+    if (std::adjacent_find(std::begin(directedEdges), std::end(directedEdges)) != std::end(directedEdges))
+        return false;
+
+    for (const DirectedEdge& directedEdge : directedEdges) {
+        if (!std::binary_search(std::begin(directedEdges), std::end(directedEdges), DirectedEdge(directedEdge.second, directedEdge.first)))
+            return false;
+    }
+
+    for (const size_t count : vertexFaceCount) {
+        if (count < 3)
+            return false;
+    }
+
+    const size_t edgeCount = directedEdges.size() / 2;
+    if (positions.size() < 4 || positions.size() + faceCount != edgeCount + 2)
+        return false;
+
+    Polyhedron result;
+
+    std::vector<Vertex*> vertices;
+    vertices.reserve(positions.size());
+    for (const V& position : positions) {
+        Vertex* vertex = new Vertex(position);
+        result.m_vertices.append(vertex, 1);
+        vertices.push_back(vertex);
+    }
+
+    std::vector<Face*> newFaces(faceIndices.size(), nullptr);
+    std::vector<std::pair<DirectedEdge, HalfEdge*>> halfEdges;
+    halfEdges.reserve(directedEdges.size());
+    for (size_t i = 0; i < faceIndices.size(); ++i) {
+        const IndexList& indices = faceIndices[i];
+        if (indices.empty())
+            continue;
+
+        HalfEdgeList boundary;
+        for (size_t j = 0; j < indices.size(); ++j) {
+            HalfEdge* halfEdge = new HalfEdge(vertices[indices[j]]);
+            boundary.append(halfEdge, 1);
+            halfEdges.push_back(std::make_pair(DirectedEdge(indices[j], indices[(j + 1) % indices.size()]), halfEdge));
+        }
+
+        newFaces[i] = new Face(boundary);
+        result.m_faces.append(newFaces[i], 1);
+    }
+
+    // The half edges are sorted like the directed edges, so the twin of each half edge is at the same position as its
+    // reversed directed edge.
+    std::sort(std::begin(halfEdges), std::end(halfEdges), [](const std::pair<DirectedEdge, HalfEdge*>& lhs, const std::pair<DirectedEdge, HalfEdge*>& rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    for (const auto& entry : halfEdges) {
+        const DirectedEdge& directedEdge = entry.first;
+        if (directedEdge.first < directedEdge.second) {
+            const auto twin = std::lower_bound(std::begin(directedEdges), std::end(directedEdges), DirectedEdge(directedEdge.second, directedEdge.first));
+            const size_t twinIndex = static_cast<size_t>(std::distance(std::begin(directedEdges), twin));
+            result.m_edges.append(new Edge(entry.second, halfEdges[twinIndex].second), 1);
+        }
+    }
+
+    result.updateBounds();
+    assert(result.checkInvariant());
+
+    using std::swap;
+    swap(*this, result);
+    swap(faces, newFaces);
+    return true;
+}
+
+#endif /* TrenchBroom_Polyhedron_Halfspaces_h */
@@ -36,6 +36,8 @@ namespace TrenchBroom {
         Preference<Color> PointFileColor(IO::Path("Renderer/Colors/Point file"), Color(0.0f, 1.0f, 0.0f, 1.0f));
         Preference<Color> PortalFileBorderColor(IO::Path("Renderer/Colors/Portal file border"), Color(1.0f, 1.0f, 1.0f, 0.5f));
         Preference<Color> PortalFileFillColor(IO::Path("Renderer/Colors/Portal file fill"), Color(1.0f, 0.4f, 0.4f, 0.2f));
+        Preference<bool>  OcclusionCulling(IO::Path("Renderer/Occlusion culling"), false);
+        Preference<bool>  CompactBrushVertices(IO::Path("Renderer/Compact brush vertices"), false);
         
         Preference<Color>& axisColor(Math::Axis::Type axis) {
             switch (axis) {
@@ -120,6 +122,8 @@ namespace TrenchBroom {
         Preference<int> TextureMagFilter(IO::Path("Renderer/Texture mode mag filter"), 0x2600);
 
         Preference<bool> TextureLock(IO::Path("Editor/Texture lock"), true);
+        Preference<bool> UseMapCache(IO::Path("Editor/Use map cache"), false);
+        Preference<bool> UseAssetCache(IO::Path("Editor/Use asset cache"), false);
 
         Preference<IO::Path>& RendererFontPath() {
             static Preference<IO::Path> fontPath(IO::Path("Renderer/Font name"), IO::Path("fonts/SourceSansPro-Regular.otf"));
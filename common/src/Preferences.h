@@ -43,6 +43,8 @@ namespace TrenchBroom {
         extern Preference<Color> PointFileColor;
         extern Preference<Color> PortalFileBorderColor;
         extern Preference<Color> PortalFileFillColor;
+        extern Preference<bool>  OcclusionCulling;
+        extern Preference<bool>  CompactBrushVertices;
         
         Preference<Color>& axisColor(Math::Axis::Type axis);
         
@@ -117,6 +119,8 @@ namespace TrenchBroom {
         extern Preference<int> TextureMagFilter;
         
         extern Preference<bool> TextureLock;
+        extern Preference<bool> UseMapCache;
+        extern Preference<bool> UseAssetCache;
         
         Preference<IO::Path>& RendererFontPath();
         extern Preference<int> RendererFontSize;
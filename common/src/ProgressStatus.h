@@ -0,0 +1,49 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ProgressStatus
+#define TrenchBroom_ProgressStatus
+
+namespace TrenchBroom {
+    /**
+     * Receives the progress of a long running operation and tells the operation whether it should stop early. Both
+     * functions are only called on the thread that started the operation.
+     */
+    class ProgressStatus {
+    public:
+        virtual ~ProgressStatus();
+    public:
+        void progress(double progress);
+        bool cancelled() const;
+    private:
+        virtual void doProgress(double progress) = 0;
+        virtual bool doCancelled() const = 0;
+    };
+
+    /**
+     * Ignores the progress and never cancels.
+     */
+    class NullProgressStatus : public ProgressStatus {
+    private:
+        void doProgress(double progress) override;
+        bool doCancelled() const override;
+    };
+}
+
+#endif /* defined(TrenchBroom_ProgressStatus) */
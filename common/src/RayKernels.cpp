@@ -0,0 +1,265 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RayKernels.h"
+
+#include "MathUtils.h"
+
+#include <algorithm>
+
+namespace RayKernels {
+    void PackedPlanes::reserve(const size_t count) {
+        m_normalX.reserve(count);
+        m_normalY.reserve(count);
+        m_normalZ.reserve(count);
+        m_distance.reserve(count);
+    }
+
+    void PackedPlanes::add(const Plane<double,3>& plane) {
+        m_normalX.push_back(plane.normal.x());
+        m_normalY.push_back(plane.normal.y());
+        m_normalZ.push_back(plane.normal.z());
+        m_distance.push_back(plane.distance);
+    }
+
+    void PackedPlanes::clear() {
+        m_normalX.clear();
+        m_normalY.clear();
+        m_normalZ.clear();
+        m_distance.clear();
+    }
+
+    size_t PackedPlanes::size() const {
+        return m_distance.size();
+    }
+
+    const double* PackedPlanes::normalX() const {
+        return m_normalX.data();
+    }
+
+    const double* PackedPlanes::normalY() const {
+        return m_normalY.data();
+    }
+
+    const double* PackedPlanes::normalZ() const {
+        return m_normalZ.data();
+    }
+
+    const double* PackedPlanes::distance() const {
+        return m_distance.data();
+    }
+
+    namespace {
+        /**
+         * Accumulates the enter and exit distances of the planes. Of several planes with the same enter distance, the
+         * one with the lowest index is kept.
+         */
+        class ConvexHitAccumulator {
+        private:
+            const double m_parallelEpsilon;
+            ConvexHit m_hit;
+        public:
+            explicit ConvexHitAccumulator(const size_t planeCount) :
+            m_parallelEpsilon(Math::Constants<double>::pointStatusEpsilon()),
+            m_hit({ false, planeCount, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() }) {}
+
+            /**
+             * Adds the plane with the given index. The denominator is the dot product of the plane normal and the ray
+             * direction, and the numerator is the signed distance of the ray origin below the plane.
+             */
+            void addPlane(const size_t index, const double denominator, const double numerator) {
+                if (denominator < 0.0) {
+                    addEnter(index, numerator / denominator);
+                } else if (denominator > 0.0) {
+                    addExit(numerator / denominator);
+                } else if (numerator < -m_parallelEpsilon) {
+                    m_hit.outside = true;
+                }
+            }
+
+            void addEnter(const size_t index, const double distance) {
+                if (distance > m_hit.enterDistance || (distance == m_hit.enterDistance && index < m_hit.enterPlane)) {
+                    m_hit.enterPlane = index;
+                    m_hit.enterDistance = distance;
+                }
+            }
+
+            void addExit(const double distance) {
+                m_hit.exitDistance = std::min(m_hit.exitDistance, distance);
+            }
+
+            void addOutside(const bool outside) {
+                m_hit.outside |= outside;
+            }
+
+            double parallelEpsilon() const {
+                return m_parallelEpsilon;
+            }
+
+            const ConvexHit& hit() const {
+                return m_hit;
+            }
+        };
+
+#if defined(TrenchBroom_RayKernels_AVX)
+        size_t accumulatePlanes(const Ray<double,3>& ray, const PackedPlanes& planes, ConvexHitAccumulator& accumulator) {
+            const size_t count = planes.size() - planes.size() % 4;
+            if (count == 0) {
+                return 0;
+            }
+
+            const __m256d originX = _mm256_set1_pd(ray.origin.x());
+            const __m256d originY = _mm256_set1_pd(ray.origin.y());
+            const __m256d originZ = _mm256_set1_pd(ray.origin.z());
+            const __m256d directionX = _mm256_set1_pd(ray.direction.x());
+            const __m256d directionY = _mm256_set1_pd(ray.direction.y());
+            const __m256d directionZ = _mm256_set1_pd(ray.direction.z());
+            const __m256d zero = _mm256_setzero_pd();
+            const __m256d parallelEpsilon = _mm256_set1_pd(-accumulator.parallelEpsilon());
+            const __m256d four = _mm256_set1_pd(4.0);
+
+            __m256d index = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+            __m256d enterIndex = _mm256_set1_pd(static_cast<double>(planes.size()));
+            __m256d enterDistance = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+            __m256d exitDistance = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+            __m256d outside = zero;
+
+            for (size_t i = 0; i < count; i += 4) {
+                const __m256d normalX = _mm256_loadu_pd(planes.normalX() + i);
+                const __m256d normalY = _mm256_loadu_pd(planes.normalY() + i);
+                const __m256d normalZ = _mm256_loadu_pd(planes.normalZ() + i);
+                const __m256d distance = _mm256_loadu_pd(planes.distance() + i);
+
+                const __m256d denominator = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(normalX, directionX), _mm256_mul_pd(normalY, directionY)), _mm256_mul_pd(normalZ, directionZ));
+                const __m256d numerator = _mm256_sub_pd(distance, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(normalX, originX), _mm256_mul_pd(normalY, originY)), _mm256_mul_pd(normalZ, originZ)));
+                const __m256d t = _mm256_div_pd(numerator, denominator);
+
+                const __m256d enter = _mm256_and_pd(_mm256_cmp_pd(denominator, zero, _CMP_LT_OQ), _mm256_cmp_pd(t, enterDistance, _CMP_GT_OQ));
+                enterDistance = _mm256_blendv_pd(enterDistance, t, enter);
+                enterIndex = _mm256_blendv_pd(enterIndex, index, enter);
+
+                const __m256d exit = _mm256_cmp_pd(denominator, zero, _CMP_GT_OQ);
+                exitDistance = _mm256_blendv_pd(exitDistance, _mm256_min_pd(exitDistance, t), exit);
+
+                const __m256d parallel = _mm256_and_pd(_mm256_cmp_pd(denominator, zero, _CMP_EQ_OQ), _mm256_cmp_pd(numerator, parallelEpsilon, _CMP_LT_OQ));
+                outside = _mm256_or_pd(outside, parallel);
+
+                index = _mm256_add_pd(index, four);
+            }
+
+            alignas(32) double enterIndices[4];
+            alignas(32) double enterDistances[4];
+            alignas(32) double exitDistances[4];
+            _mm256_store_pd(enterIndices, enterIndex);
+            _mm256_store_pd(enterDistances, enterDistance);
+            _mm256_store_pd(exitDistances, exitDistance);
+
+            for (size_t i = 0; i < 4; ++i) {
+                accumulator.addEnter(static_cast<size_t>(enterIndices[i]), enterDistances[i]);
+                accumulator.addExit(exitDistances[i]);
+            }
+            accumulator.addOutside(_mm256_movemask_pd(outside) != 0);
+
+            return count;
+        }
+#elif defined(TrenchBroom_RayKernels_SSE2)
+        __m128d select(const __m128d mask, const __m128d ifTrue, const __m128d ifFalse) {
+            return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse));
+        }
+
+        size_t accumulatePlanes(const Ray<double,3>& ray, const PackedPlanes& planes, ConvexHitAccumulator& accumulator) {
+            const size_t count = planes.size() - planes.size() % 2;
+            if (count == 0) {
+                return 0;
+            }
+
+            const __m128d originX = _mm_set1_pd(ray.origin.x());
+            const __m128d originY = _mm_set1_pd(ray.origin.y());
+            const __m128d originZ = _mm_set1_pd(ray.origin.z());
+            const __m128d directionX = _mm_set1_pd(ray.direction.x());
+            const __m128d directionY = _mm_set1_pd(ray.direction.y());
+            const __m128d directionZ = _mm_set1_pd(ray.direction.z());
+            const __m128d zero = _mm_setzero_pd();
+            const __m128d parallelEpsilon = _mm_set1_pd(-accumulator.parallelEpsilon());
+            const __m128d two = _mm_set1_pd(2.0);
+
+            __m128d index = _mm_set_pd(1.0, 0.0);
+            __m128d enterIndex = _mm_set1_pd(static_cast<double>(planes.size()));
+            __m128d enterDistance = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+            __m128d exitDistance = _mm_set1_pd(std::numeric_limits<double>::infinity());
+            __m128d outside = zero;
+
+            for (size_t i = 0; i < count; i += 2) {
+                const __m128d normalX = _mm_loadu_pd(planes.normalX() + i);
+                const __m128d normalY = _mm_loadu_pd(planes.normalY() + i);
+                const __m128d normalZ = _mm_loadu_pd(planes.normalZ() + i);
+                const __m128d distance = _mm_loadu_pd(planes.distance() + i);
+
+                const __m128d denominator = _mm_add_pd(_mm_add_pd(_mm_mul_pd(normalX, directionX), _mm_mul_pd(normalY, directionY)), _mm_mul_pd(normalZ, directionZ));
+                const __m128d numerator = _mm_sub_pd(distance, _mm_add_pd(_mm_add_pd(_mm_mul_pd(normalX, originX), _mm_mul_pd(normalY, originY)), _mm_mul_pd(normalZ, originZ)));
+                const __m128d t = _mm_div_pd(numerator, denominator);
+
+                const __m128d enter = _mm_and_pd(_mm_cmplt_pd(denominator, zero), _mm_cmpgt_pd(t, enterDistance));
+                enterDistance = select(enter, t, enterDistance);
+                enterIndex = select(enter, index, enterIndex);
+
+                const __m128d exit = _mm_cmpgt_pd(denominator, zero);
+                exitDistance = select(exit, _mm_min_pd(exitDistance, t), exitDistance);
+
+                const __m128d parallel = _mm_and_pd(_mm_cmpeq_pd(denominator, zero), _mm_cmplt_pd(numerator, parallelEpsilon));
+                outside = _mm_or_pd(outside, parallel);
+
+                index = _mm_add_pd(index, two);
+            }
+
+            alignas(16) double enterIndices[2];
+            alignas(16) double enterDistances[2];
+            alignas(16) double exitDistances[2];
+            _mm_store_pd(enterIndices, enterIndex);
+            _mm_store_pd(enterDistances, enterDistance);
+            _mm_store_pd(exitDistances, exitDistance);
+
+            for (size_t i = 0; i < 2; ++i) {
+                accumulator.addEnter(static_cast<size_t>(enterIndices[i]), enterDistances[i]);
+                accumulator.addExit(exitDistances[i]);
+            }
+            accumulator.addOutside(_mm_movemask_pd(outside) != 0);
+
+            return count;
+        }
+#else
+        size_t accumulatePlanes(const Ray<double,3>& ray, const PackedPlanes& planes, ConvexHitAccumulator& accumulator) {
+            return 0;
+        }
+#endif
+    }
+
+    ConvexHit intersectConvexWithRay(const Ray<double,3>& ray, const PackedPlanes& planes) {
+        ConvexHitAccumulator accumulator(planes.size());
+
+        // the kernel handles as many planes as fit into its registers, and the remaining planes are handled here
+        for (size_t i = accumulatePlanes(ray, planes, accumulator); i < planes.size(); ++i) {
+            const double denominator = planes.normalX()[i] * ray.direction.x() + planes.normalY()[i] * ray.direction.y() + planes.normalZ()[i] * ray.direction.z();
+            const double numerator = planes.distance()[i] - (planes.normalX()[i] * ray.origin.x() + planes.normalY()[i] * ray.origin.y() + planes.normalZ()[i] * ray.origin.z());
+            accumulator.addPlane(i, denominator, numerator);
+        }
+
+        return accumulator.hit();
+    }
+}
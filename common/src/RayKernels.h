@@ -0,0 +1,170 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_RayKernels_h
+#define TrenchBroom_RayKernels_h
+
+#include "BBox.h"
+#include "Plane.h"
+#include "Ray.h"
+#include "Vec.h"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TrenchBroom_RayKernels_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define TrenchBroom_RayKernels_AVX
+#include <immintrin.h>
+#endif
+
+/**
+ * Vectorized kernels for the ray intersection tests used when picking. The kernels use AVX or SSE2 if the compiler
+ * targets them, and fall back to scalar code otherwise.
+ */
+namespace RayKernels {
+    /**
+     * A ray that is prepared for slab tests against axis aligned boxes. If the ray is parallel to an axis, the slab
+     * of that axis is not intersected with the ray; instead, the origin must lie between the slab's planes.
+     */
+    template <typename T, size_t S>
+    struct SlabRay {
+        Vec<T,S> origin;
+        Vec<T,S> invDirection;
+        bool parallel[S];
+
+        explicit SlabRay(const Ray<T,S>& ray) :
+        origin(ray.origin) {
+            for (size_t i = 0; i < S; ++i) {
+                parallel[i] = ray.direction[i] == static_cast<T>(0.0);
+                invDirection[i] = parallel[i] ? static_cast<T>(0.0) : static_cast<T>(1.0) / ray.direction[i];
+            }
+        }
+    };
+
+    /**
+     * Checks whether the given ray hits the given box or starts inside of it.
+     */
+    template <typename T, size_t S>
+    bool intersectsBox(const SlabRay<T,S>& ray, const BBox<T,S>& box) {
+        T tNear = static_cast<T>(0.0);
+        T tFar = std::numeric_limits<T>::infinity();
+        for (size_t i = 0; i < S; ++i) {
+            if (ray.parallel[i]) {
+                if (ray.origin[i] < box.min[i] || ray.origin[i] > box.max[i]) {
+                    return false;
+                }
+            } else {
+                const T t1 = (box.min[i] - ray.origin[i]) * ray.invDirection[i];
+                const T t2 = (box.max[i] - ray.origin[i]) * ray.invDirection[i];
+                tNear = std::max(tNear, std::min(t1, t2));
+                tFar = std::min(tFar, std::max(t1, t2));
+            }
+        }
+        return tNear <= tFar;
+    }
+
+    /**
+     * Checks whether the given ray hits the given boxes or starts inside of them. Both boxes are tested at once,
+     * which suits the two children of a node of a binary tree.
+     */
+    template <typename T, size_t S>
+    void intersectsBoxes(const SlabRay<T,S>& ray, const BBox<T,S>& box1, const BBox<T,S>& box2, bool& hit1, bool& hit2) {
+        hit1 = intersectsBox(ray, box1);
+        hit2 = intersectsBox(ray, box2);
+    }
+
+#if defined(TrenchBroom_RayKernels_SSE2)
+    inline void intersectsBoxes(const SlabRay<double,3>& ray, const BBox<double,3>& box1, const BBox<double,3>& box2, bool& hit1, bool& hit2) {
+        // lane 0 holds the first box and lane 1 holds the second box
+        __m128d tNear = _mm_setzero_pd();
+        __m128d tFar = _mm_set1_pd(std::numeric_limits<double>::infinity());
+        __m128d inside = _mm_cmpeq_pd(tNear, tNear);
+        for (size_t i = 0; i < 3; ++i) {
+            const __m128d origin = _mm_set1_pd(ray.origin[i]);
+            const __m128d min = _mm_set_pd(box2.min[i], box1.min[i]);
+            const __m128d max = _mm_set_pd(box2.max[i], box1.max[i]);
+            if (ray.parallel[i]) {
+                inside = _mm_and_pd(inside, _mm_and_pd(_mm_cmple_pd(min, origin), _mm_cmple_pd(origin, max)));
+            } else {
+                const __m128d invDirection = _mm_set1_pd(ray.invDirection[i]);
+                const __m128d t1 = _mm_mul_pd(_mm_sub_pd(min, origin), invDirection);
+                const __m128d t2 = _mm_mul_pd(_mm_sub_pd(max, origin), invDirection);
+                tNear = _mm_max_pd(tNear, _mm_min_pd(t1, t2));
+                tFar = _mm_min_pd(tFar, _mm_max_pd(t1, t2));
+            }
+        }
+
+        const int mask = _mm_movemask_pd(_mm_and_pd(inside, _mm_cmple_pd(tNear, tFar)));
+        hit1 = (mask & 1) != 0;
+        hit2 = (mask & 2) != 0;
+    }
+#endif
+
+    /**
+     * The planes bounding a convex polyhedron, stored as separate arrays of the normal components and distances.
+     */
+    class PackedPlanes {
+    private:
+        std::vector<double> m_normalX;
+        std::vector<double> m_normalY;
+        std::vector<double> m_normalZ;
+        std::vector<double> m_distance;
+    public:
+        void reserve(size_t count);
+        void add(const Plane<double,3>& plane);
+        void clear();
+        size_t size() const;
+
+        const double* normalX() const;
+        const double* normalY() const;
+        const double* normalZ() const;
+        const double* distance() const;
+    };
+
+    /**
+     * The result of intersecting a ray with a convex polyhedron. The ray is inside of every plane between the enter
+     * and the exit distance, so it hits the polyhedron if the enter distance is not greater than the exit distance.
+     */
+    struct ConvexHit {
+        /**
+         * Whether the ray is parallel to one of the planes and starts above it, in which case it cannot hit.
+         */
+        bool outside;
+        /**
+         * The index of the plane that the ray enters last, or the number of planes if the ray is not directed
+         * against any plane.
+         */
+        size_t enterPlane;
+        double enterDistance;
+        double exitDistance;
+    };
+
+    /**
+     * Intersects the given ray with the convex polyhedron bounded by the given planes. The planes face outwards.
+     */
+    ConvexHit intersectConvexWithRay(const Ray<double,3>& ray, const PackedPlanes& planes);
+}
+
+#endif /* defined(TrenchBroom_RayKernels_h) */
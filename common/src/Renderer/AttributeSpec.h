@@ -196,7 +196,9 @@ namespace TrenchBroom {
             typedef AttributeSpec<AttributeType_Position, GL_FLOAT, 2> P2;
             typedef AttributeSpec<AttributeType_Position, GL_FLOAT, 3> P3;
             typedef AttributeSpec<AttributeType_Normal, GL_FLOAT, 3> N;
+            typedef AttributeSpec<AttributeType_Normal, GL_BYTE, 3> NB;
             typedef AttributeSpec<AttributeType_TexCoord0, GL_FLOAT, 2> T02;
+            typedef AttributeSpec<AttributeType_TexCoord0, GL_HALF_FLOAT, 2> T02H;
             typedef AttributeSpec<AttributeType_TexCoord1, GL_FLOAT, 2> T12;
             typedef AttributeSpec<AttributeType_Color, GL_FLOAT, 4> C4;
         }
@@ -26,8 +26,11 @@
 #include "Model/BrushGeometry.h"
 #include "Model/EditorContext.h"
 #include "Model/NodeVisitor.h"
+#include "ParallelUtils.h"
 #include "Renderer/IndexArrayMapBuilder.h"
 #include "Renderer/BrushRendererArrays.h"
+#include "Renderer/Camera.h"
+#include "Renderer/OcclusionBuffer.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/TexturedIndexArrayBuilder.h"
@@ -35,6 +38,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -114,10 +118,22 @@ namespace TrenchBroom {
                                    EdgeRenderPolicy::RenderAll);
         }
 
+        // Chunk
+
+        BrushRenderer::Chunk::Chunk() :
+        brushCount(0),
+        edgeIndices(std::make_shared<BrushIndexArray>()),
+        transparentFaces(std::make_shared<TextureToBrushIndicesMap>()),
+        opaqueFaces(std::make_shared<TextureToBrushIndicesMap>()) {}
+
         // BrushRenderer
 
+        const float BrushRenderer::ChunkSize = 1024.0f;
+
         BrushRenderer::BrushRenderer(const bool transparent) :
         m_filter(new NoFilter(transparent)),
+        m_vertexFormat(BrushVertexFormat::Full),
+        m_renderersValid(false),
         m_showEdges(false),
         m_grayscale(false),
         m_tint(false),
@@ -193,15 +209,9 @@ namespace TrenchBroom {
             m_brushInfo.clear();
             m_allBrushes.clear();
             m_invalidBrushes.clear();
-
-            m_vertexArray = std::make_shared<BrushVertexArray>();
-            m_edgeIndices = std::make_shared<BrushIndexArray>();
-            m_transparentFaces = std::make_shared<TextureToBrushIndicesMap>();
-            m_opaqueFaces = std::make_shared<TextureToBrushIndicesMap>();
-
-            m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, m_opaqueFaces, m_faceColor);
-            m_transparentFaceRenderer = FaceRenderer(m_vertexArray, m_transparentFaces, m_faceColor);
-            m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, m_edgeIndices);
+            m_chunks.clear();
+            m_vertexArray = std::make_shared<BrushVertexArray>(m_vertexFormat);
+            m_renderersValid = false;
         }
 
         void BrushRenderer::setFaceColor(const Color& faceColor) {
@@ -247,6 +257,20 @@ namespace TrenchBroom {
             }
         }
 
+        void BrushRenderer::setVertexFormat(const BrushVertexFormat vertexFormat) {
+            if (vertexFormat != m_vertexFormat) {
+                m_vertexFormat = vertexFormat;
+                invalidate();
+                m_chunks.clear();
+                m_vertexArray = std::make_shared<BrushVertexArray>(m_vertexFormat);
+                m_renderersValid = false;
+            }
+        }
+
+        size_t BrushRenderer::vertexDataSize() const {
+            return m_vertexArray->sizeInBytes();
+        }
+
         void BrushRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
             renderOpaque(renderContext, renderBatch);
             renderTransparent(renderContext, renderBatch);
@@ -256,6 +280,8 @@ namespace TrenchBroom {
             if (!m_allBrushes.empty()) {
                 if (!valid())
                     validate();
+                updateRenderers(renderContext);
+
                 if (renderContext.showFaces())
                     renderOpaqueFaces(renderBatch);
                 if (renderContext.showEdges() || m_showEdges)
@@ -267,12 +293,46 @@ namespace TrenchBroom {
             if (!m_allBrushes.empty()) {
                 if (!valid())
                     validate();
+                updateRenderers(renderContext);
+
                 if (renderContext.showFaces())
                     renderTransparentFaces(renderBatch);
             }
         }
 
+        void BrushRenderer::updateRenderers(const RenderContext& renderContext) {
+            std::vector<const Chunk*> visibleChunks;
+            visibleChunks.reserve(m_visibleChunks.size());
+            for (const auto& [key, chunk] : m_chunks) {
+                if (visible(chunk, renderContext))
+                    visibleChunks.push_back(&chunk);
+            }
+
+            if (m_renderersValid && visibleChunks == m_visibleChunks)
+                return;
+
+            TextureToBrushIndicesMapList opaqueFaces;
+            TextureToBrushIndicesMapList transparentFaces;
+            BrushIndexArrayList edgeIndices;
+            for (const Chunk* chunk : visibleChunks) {
+                opaqueFaces.push_back(chunk->opaqueFaces);
+                transparentFaces.push_back(chunk->transparentFaces);
+                edgeIndices.push_back(chunk->edgeIndices);
+            }
+
+            m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, std::move(opaqueFaces), m_faceColor);
+            m_transparentFaceRenderer = FaceRenderer(m_vertexArray, std::move(transparentFaces), m_faceColor);
+            m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, std::move(edgeIndices));
+
+            m_visibleChunks = std::move(visibleChunks);
+            m_renderersValid = true;
+        }
+
         void BrushRenderer::renderOpaqueFaces(RenderBatch& renderBatch) {
+            if (m_visibleChunks.empty())
+                return;
+
+            m_opaqueFaceRenderer.setFaceColor(m_faceColor);
             m_opaqueFaceRenderer.setGrayscale(m_grayscale);
             m_opaqueFaceRenderer.setTint(m_tint);
             m_opaqueFaceRenderer.setTintColor(m_tintColor);
@@ -280,6 +340,10 @@ namespace TrenchBroom {
         }
         
         void BrushRenderer::renderTransparentFaces(RenderBatch& renderBatch) {
+            if (m_visibleChunks.empty())
+                return;
+
+            m_transparentFaceRenderer.setFaceColor(m_faceColor);
             m_transparentFaceRenderer.setGrayscale(m_grayscale);
             m_transparentFaceRenderer.setTint(m_tint);
             m_transparentFaceRenderer.setTintColor(m_tintColor);
@@ -288,11 +352,22 @@ namespace TrenchBroom {
         }
         
         void BrushRenderer::renderEdges(RenderBatch& renderBatch) {
+            if (m_visibleChunks.empty())
+                return;
+
             if (m_showOccludedEdges)
                 m_edgeRenderer.renderOnTop(renderBatch, m_occludedEdgeColor);
             m_edgeRenderer.render(renderBatch, m_edgeColor);
         }
 
+        bool BrushRenderer::visible(const Chunk& chunk, const RenderContext& renderContext) {
+            if (chunk.brushCount == 0 || !renderContext.camera().frustumIntersects(chunk.bounds))
+                return false;
+
+            const OcclusionBuffer* occlusionBuffer = renderContext.occlusionBuffer();
+            return occlusionBuffer == nullptr || !occlusionBuffer->occluded(chunk.bounds);
+        }
+
         class BrushRenderer::FilterWrapper : public BrushRenderer::Filter {
         private:
             const Filter& m_filter;
@@ -317,20 +392,6 @@ namespace TrenchBroom {
             }
         };
 
-        void BrushRenderer::validate() {
-            assert(!valid());
-
-            for (auto brush : m_invalidBrushes) {
-                validateBrush(brush);
-            }
-            m_invalidBrushes.clear();
-            assert(valid());
-
-            m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, m_opaqueFaces, m_faceColor);
-            m_transparentFaceRenderer = FaceRenderer(m_vertexArray, m_transparentFaces, m_faceColor);
-            m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, m_edgeIndices);
-        }
-
         static size_t triIndicesCountForPolygon(const size_t vertexCount) {
             assert(vertexCount >= 3);
             const size_t indexCount = 3 * (vertexCount - 2);
@@ -398,7 +459,65 @@ namespace TrenchBroom {
             }
         }
 
-        void BrushRenderer::validateBrush(const Model::Brush* brush) {
+        struct BrushRenderer::StagedFaceIndices {
+            const Assets::Texture* texture;
+            size_t offset;
+            size_t count;
+        };
+
+        struct BrushRenderer::StagedBrush {
+            const Model::Brush* brush;
+            Filter::RenderOpacity renderType;
+            size_t vertexOffset;
+            size_t vertexCount;
+            size_t edgeIndexOffset;
+            size_t edgeIndexCount;
+            size_t faceIndicesOffset;
+            size_t faceIndicesCount;
+        };
+
+        struct BrushRenderer::StagingBuffer {
+            std::vector<BrushVertexArray::Vertex> vertices;
+            std::vector<BrushVertexArray::CompactVertex> compactVertices;
+            std::vector<GLuint> edgeIndices;
+            std::vector<GLuint> faceIndices;
+            std::vector<StagedFaceIndices> faceIndexRanges;
+            std::vector<StagedBrush> brushes;
+        };
+
+        const size_t BrushRenderer::MinBrushesPerStagingBatch = 256;
+
+        void BrushRenderer::validate() {
+            assert(!valid());
+
+            // split the invalid brushes into contiguous batches so that the brushes are inserted in the same order
+            // as if they were validated one by one
+            const std::vector<const Model::Brush*> brushes(std::begin(m_invalidBrushes), std::end(m_invalidBrushes));
+            const size_t batchCount = std::max(static_cast<size_t>(1),
+                                               std::min(ParallelUtils::threadCount(),
+                                                        brushes.size() / MinBrushesPerStagingBatch));
+
+            std::vector<StagingBuffer> buffers(batchCount);
+            ParallelUtils::forEachIndex(batchCount, [&](const size_t i) {
+                const size_t first = brushes.size() * i / batchCount;
+                const size_t last = brushes.size() * (i + 1) / batchCount;
+                for (size_t j = first; j < last; ++j) {
+                    stageBrush(brushes[j], buffers[i]);
+                }
+            });
+
+            for (const StagingBuffer& buffer : buffers) {
+                for (const StagedBrush& staged : buffer.brushes) {
+                    insertStagedBrush(staged, buffer);
+                }
+            }
+
+            m_invalidBrushes.clear();
+            m_renderersValid = false;
+            assert(valid());
+        }
+
+        void BrushRenderer::stageBrush(const Model::Brush* brush, StagingBuffer& buffer) const {
             assert(m_allBrushes.find(brush) != m_allBrushes.end());
             assert(m_invalidBrushes.find(brush) != m_invalidBrushes.end());
             assert(m_brushInfo.find(brush) == m_brushInfo.end());
@@ -415,7 +534,9 @@ namespace TrenchBroom {
                 return;
             }
 
-            BrushInfo& info = m_brushInfo[brush];
+            StagedBrush staged;
+            staged.brush = brush;
+            staged.renderType = renderType;
 
             // collect vertices
             auto& brushCache = brush->brushRendererBrushCache();
@@ -423,35 +544,27 @@ namespace TrenchBroom {
             const auto& cachedVertices = brushCache.cachedVertices();
             ensure(!cachedVertices.empty(), "Brush must have cached vertices");
 
-            assert(m_vertexArray != nullptr);
-            auto [vertBlock, dest] = m_vertexArray->getPointerToInsertVerticesAt(cachedVertices.size());
-            std::memcpy(dest, cachedVertices.data(), cachedVertices.size() * sizeof(*dest));
-            info.vertexHolderKey = vertBlock;
-
-            const GLuint brushVerticesStartIndex = static_cast<GLuint>(vertBlock->pos);
-
-            // insert edge indices into VBO
-            {
-                const size_t edgeIndexCount = countMarkedEdgeIndices(brush, edgePolicy);
-                if (edgeIndexCount > 0) {
-                    auto[key, dest] = m_edgeIndices->getPointerToInsertElementsAt(edgeIndexCount);
-                    info.edgeIndicesKey = key;
-                    getMarkedEdgeIndices(brush, edgePolicy, brushVerticesStartIndex, dest);
-                } else {
-                    // it's possible to have no edges to render
-                    // e.g. select all faces of a brush, and the unselected brush renderer
-                    // will hit this branch.
-                    ensure(info.edgeIndicesKey == nullptr, "BrushInfo not initialized");
-                }
+            staged.vertexCount = cachedVertices.size();
+            if (m_vertexFormat == BrushVertexFormat::Compact) {
+                staged.vertexOffset = buffer.compactVertices.size();
+                buffer.compactVertices.resize(staged.vertexOffset + staged.vertexCount);
+                brushCache.getCompactVertices(buffer.compactVertices.data() + staged.vertexOffset);
+            } else {
+                staged.vertexOffset = buffer.vertices.size();
+                buffer.vertices.insert(std::end(buffer.vertices), std::begin(cachedVertices), std::end(cachedVertices));
             }
 
-            // insert face indices
+            // collect edge indices, relative to the first vertex of the brush
+            staged.edgeIndexOffset = buffer.edgeIndices.size();
+            staged.edgeIndexCount = countMarkedEdgeIndices(brush, edgePolicy);
+            buffer.edgeIndices.resize(staged.edgeIndexOffset + staged.edgeIndexCount);
+            getMarkedEdgeIndices(brush, edgePolicy, 0, buffer.edgeIndices.data() + staged.edgeIndexOffset);
 
-            auto& facesSortedByTex = brushCache.cachedFacesSortedByTexture();
+            // collect face indices, relative to the first vertex of the brush
+            const auto& facesSortedByTex = brushCache.cachedFacesSortedByTexture();
             const size_t facesSortedByTexSize = facesSortedByTex.size();
 
-            std::shared_ptr<TextureToBrushIndicesMap> faceVboPtr = \
-                (renderType == Filter::RenderOpacity::Opaque) ? m_opaqueFaces : m_transparentFaces;
+            staged.faceIndicesOffset = buffer.faceIndexRanges.size();
 
             size_t nextI;
             for (size_t i = 0; i < facesSortedByTexSize; i = nextI) {
@@ -477,39 +590,113 @@ namespace TrenchBroom {
                     continue;
                 }
 
-                TextureToBrushIndicesMap& faceVboMap = *faceVboPtr;
-                std::shared_ptr<BrushIndexArray>& holderPtr = faceVboMap[texture];
+                const size_t offset = buffer.faceIndices.size();
+                buffer.faceIndices.resize(offset + indexCount);
+
+                GLuint* dest = buffer.faceIndices.data() + offset;
+                GLuint* currentDest = dest;
+                for (size_t j = i; j < nextI; ++j) {
+                    const BrushRendererBrushCache::CachedFace& cache = facesSortedByTex[j];
+                    if (cache.face->isMarked()) {
+                        addTriIndicesForPolygon(currentDest,
+                                                static_cast<GLuint>(cache.indexOfFirstVertexRelativeToBrush),
+                                                cache.vertexCount);
+
+                        currentDest += triIndicesCountForPolygon(cache.vertexCount);
+                    }
+                }
+                assert(currentDest == (dest + indexCount));
+
+                buffer.faceIndexRanges.push_back({ texture, offset, indexCount });
+            }
+
+            staged.faceIndicesCount = buffer.faceIndexRanges.size() - staged.faceIndicesOffset;
+            buffer.brushes.push_back(staged);
+        }
+
+        static void copyIndices(const GLuint* source, const size_t count, const GLuint baseIndex, GLuint* dest) {
+            for (size_t i = 0; i < count; ++i) {
+                dest[i] = baseIndex + source[i];
+            }
+        }
 
+        void BrushRenderer::insertStagedBrush(const StagedBrush& staged, const StagingBuffer& buffer) {
+            const Model::Brush* brush = staged.brush;
+            assert(m_brushInfo.find(brush) == m_brushInfo.end());
+
+            Chunk& chunk = chunkForBrush(brush);
+            BrushInfo& info = m_brushInfo[brush];
+            info.chunk = &chunk;
+
+            // insert vertices into VBO
+            assert(m_vertexArray != nullptr);
+            AllocationTracker::Block* vertBlock;
+            if (m_vertexArray->format() == BrushVertexFormat::Compact) {
+                auto [block, dest] = m_vertexArray->getPointerToInsertCompactVerticesAt(staged.vertexCount);
+                std::memcpy(dest, buffer.compactVertices.data() + staged.vertexOffset, staged.vertexCount * sizeof(*dest));
+                vertBlock = block;
+            } else {
+                auto [block, dest] = m_vertexArray->getPointerToInsertVerticesAt(staged.vertexCount);
+                std::memcpy(dest, buffer.vertices.data() + staged.vertexOffset, staged.vertexCount * sizeof(*dest));
+                vertBlock = block;
+            }
+            info.vertexHolderKey = vertBlock;
+
+            const GLuint brushVerticesStartIndex = static_cast<GLuint>(vertBlock->pos);
+
+            // insert edge indices into VBO
+            if (staged.edgeIndexCount > 0) {
+                auto [key, dest] = chunk.edgeIndices->getPointerToInsertElementsAt(staged.edgeIndexCount);
+                info.edgeIndicesKey = key;
+                copyIndices(buffer.edgeIndices.data() + staged.edgeIndexOffset, staged.edgeIndexCount,
+                            brushVerticesStartIndex, dest);
+            } else {
+                // it's possible to have no edges to render
+                // e.g. select all faces of a brush, and the unselected brush renderer
+                // will hit this branch.
+                ensure(info.edgeIndicesKey == nullptr, "BrushInfo not initialized");
+            }
+
+            // insert face indices into VBO
+            TextureToBrushIndicesMap& faceVboMap = \
+                (staged.renderType == Filter::RenderOpacity::Opaque) ? *chunk.opaqueFaces : *chunk.transparentFaces;
+            for (size_t i = 0; i < staged.faceIndicesCount; ++i) {
+                const StagedFaceIndices& range = buffer.faceIndexRanges[staged.faceIndicesOffset + i];
+
+                std::shared_ptr<BrushIndexArray>& holderPtr = faceVboMap[range.texture];
                 if (holderPtr == nullptr) {
                     // inserts into map!
                     holderPtr = std::make_shared<BrushIndexArray>();
                 }
 
-                auto [key, dest] = holderPtr->getPointerToInsertElementsAt(indexCount);
+                auto [key, dest] = holderPtr->getPointerToInsertElementsAt(range.count);
 
                 // update info
-                if (renderType == Filter::RenderOpacity::Opaque) {
-                    info.opaqueFaceIndicesKeys.push_back({texture, key});
+                if (staged.renderType == Filter::RenderOpacity::Opaque) {
+                    info.opaqueFaceIndicesKeys.push_back({range.texture, key});
                 } else {
-                    info.transparentFaceIndicesKeys.push_back({texture, key});
+                    info.transparentFaceIndicesKeys.push_back({range.texture, key});
                 }
 
-                // process all faces with this texture (they'll be consecutive)
-                GLuint *currentDest = dest;
-                for (size_t j = i; j < nextI; ++j) {
-                    const BrushRendererBrushCache::CachedFace& cache = facesSortedByTex[j];
-                    if (cache.face->isMarked()) {
-                        addTriIndicesForPolygon(currentDest,
-                                                static_cast<GLuint>(brushVerticesStartIndex +
-                                                                    cache.indexOfFirstVertexRelativeToBrush),
-                                                cache.vertexCount);
+                copyIndices(buffer.faceIndices.data() + range.offset, range.count, brushVerticesStartIndex, dest);
+            }
+        }
 
-                        currentDest += triIndicesCountForPolygon(cache.vertexCount);
-                    }
-                }
-                assert(indexCount > 0);
-                assert(currentDest == (dest + indexCount));
+        BrushRenderer::Chunk& BrushRenderer::chunkForBrush(const Model::Brush* brush) {
+            const BBox3f bounds(brush->bounds());
+            const Vec3f center = bounds.center();
+            const ChunkKey key(static_cast<int>(std::floor(center.x() / ChunkSize)),
+                               static_cast<int>(std::floor(center.y() / ChunkSize)),
+                               static_cast<int>(std::floor(center.z() / ChunkSize)));
+
+            Chunk& chunk = m_chunks[key];
+            if (chunk.brushCount == 0) {
+                chunk.bounds = bounds;
+            } else {
+                chunk.bounds.mergeWith(bounds);
             }
+            ++chunk.brushCount;
+            return chunk;
         }
 
         void BrushRenderer::addBrush(const Model::Brush* brush) {
@@ -548,28 +735,32 @@ namespace TrenchBroom {
             auto it = m_brushInfo.find(brush);
 
             if (it == m_brushInfo.end()) {
-                // This means BrushRenderer::validateBrush skipped rendering the brush, so it was never
+                // This means BrushRenderer::stageBrush skipped rendering the brush, so it was never
                 // uploaded to the VBO's
                 return;
             }
 
             const BrushInfo& info = it->second;
+            Chunk& chunk = *info.chunk;
 
             // update Vbo's
             m_vertexArray->deleteVerticesWithKey(info.vertexHolderKey);
             if (info.edgeIndicesKey != nullptr) {
-                m_edgeIndices->zeroElementsWithKey(info.edgeIndicesKey);
+                chunk.edgeIndices->zeroElementsWithKey(info.edgeIndicesKey);
             }
 
             for (const auto& [texture, opaqueKey] : info.opaqueFaceIndicesKeys) {
-                std::shared_ptr<BrushIndexArray> faceIndexHolder = m_opaqueFaces->at(texture);
+                std::shared_ptr<BrushIndexArray> faceIndexHolder = chunk.opaqueFaces->at(texture);
                 faceIndexHolder->zeroElementsWithKey(opaqueKey);
             }
             for (const auto& [texture, transparentKey] : info.transparentFaceIndicesKeys) {
-                std::shared_ptr<BrushIndexArray> faceIndexHolder = m_transparentFaces->at(texture);
+                std::shared_ptr<BrushIndexArray> faceIndexHolder = chunk.transparentFaces->at(texture);
                 faceIndexHolder->zeroElementsWithKey(transparentKey);
             }
 
+            assert(chunk.brushCount > 0);
+            --chunk.brushCount;
+
             m_brushInfo.erase(it);
         }
     }
@@ -26,6 +26,7 @@
 #include "Renderer/FaceRenderer.h"
 #include "Model/Brush.h"
 #include "Renderer/AllocationTracker.h"
+#include "Renderer/BrushRendererArrays.h"
 
 #include <tuple>
 #include <map>
@@ -126,9 +127,34 @@ namespace TrenchBroom {
         private:
             class FilterWrapper;
         private:
+            /**
+             * The brushes are grouped into chunks by the grid cell that contains the center of their bounds. Every
+             * chunk has its own index arrays, so that chunks outside of the viewing frustum can be skipped entirely
+             * when rendering. The vertices of all chunks are stored in a single vertex array, which allows the index
+             * arrays of the visible chunks to be rendered with one draw call per texture.
+             */
+            struct Chunk {
+                /**
+                 * The union of the bounds of the brushes in this chunk. The bounds do not shrink when a brush is
+                 * removed, but they are reset when the chunk becomes empty.
+                 */
+                BBox3f bounds;
+                size_t brushCount;
+
+                BrushIndexArrayPtr edgeIndices;
+                std::shared_ptr<TextureToBrushIndicesMap> transparentFaces;
+                std::shared_ptr<TextureToBrushIndicesMap> opaqueFaces;
+
+                Chunk();
+            };
+
+            using ChunkKey = std::tuple<int, int, int>;
+            static const float ChunkSize;
+
             Filter* m_filter;
 
             struct BrushInfo {
+                Chunk* chunk;
                 AllocationTracker::Block* vertexHolderKey;
                 AllocationTracker::Block* edgeIndicesKey;
                 std::vector<std::pair<const Assets::Texture*, AllocationTracker::Block*>> opaqueFaceIndicesKeys;
@@ -147,11 +173,21 @@ namespace TrenchBroom {
             std::set<const Model::Brush*> m_allBrushes;
             std::set<const Model::Brush*> m_invalidBrushes;
 
+            /**
+             * Empty chunks are kept so that their arrays can be reused when brushes are invalidated and validated
+             * again.
+             */
+            std::map<ChunkKey, Chunk> m_chunks;
+            BrushVertexFormat m_vertexFormat;
             BrushVertexArrayPtr m_vertexArray;
-            BrushIndexArrayPtr m_edgeIndices;
-            std::shared_ptr<TextureToBrushIndicesMap> m_transparentFaces;
-            std::shared_ptr<TextureToBrushIndicesMap> m_opaqueFaces;
 
+            /**
+             * The renderers refer to the index arrays of the visible chunks. They are only recreated when brushes
+             * were validated or when the set of visible chunks changes, so that the index arrays need not be merged
+             * again in every frame.
+             */
+            std::vector<const Chunk*> m_visibleChunks;
+            bool m_renderersValid;
             FaceRenderer m_opaqueFaceRenderer;
             FaceRenderer m_transparentFaceRenderer;
             IndexedEdgeRenderer m_edgeRenderer;
@@ -171,6 +207,8 @@ namespace TrenchBroom {
             template <typename FilterT>
             BrushRenderer(const FilterT& filter) :
             m_filter(new FilterT(filter)),
+            m_vertexFormat(BrushVertexFormat::Full),
+            m_renderersValid(false),
             m_showEdges(false),
             m_grayscale(false),
             m_tint(false),
@@ -215,14 +253,26 @@ namespace TrenchBroom {
             void setOccludedEdgeColor(const Color& occludedEdgeColor);
             void setTransparencyAlpha(float transparencyAlpha);
             void setShowHiddenBrushes(bool showHiddenBrushes);
+
+            /**
+             * Sets the layout of the vertices uploaded to the VBO. Changing the format discards all chunks and
+             * invalidates all brushes.
+             */
+            void setVertexFormat(BrushVertexFormat vertexFormat);
+            /**
+             * Returns the number of bytes taken by the vertices of all chunks.
+             */
+            size_t vertexDataSize() const;
         public: // rendering
             void render(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderOpaque(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderTransparent(RenderContext& renderContext, RenderBatch& renderBatch);
         private:
+            void updateRenderers(const RenderContext& renderContext);
             void renderOpaqueFaces(RenderBatch& renderBatch);
             void renderTransparentFaces(RenderBatch& renderBatch);
             void renderEdges(RenderBatch& renderBatch);
+            static bool visible(const Chunk& chunk, const RenderContext& renderContext);
 
         public:
             /**
@@ -230,7 +280,20 @@ namespace TrenchBroom {
              */
             void validate();
         private:
-            void validateBrush(const Model::Brush* brush);
+            /**
+             * The vertices and indices of the invalid brushes are generated on worker threads. Every thread writes
+             * into the staging buffer of its batch of brushes, with the indices relative to the first vertex of their
+             * brush. The staged data is then copied into the arrays on the calling thread, because the arrays and
+             * chunks are not thread safe.
+             */
+            struct StagedFaceIndices;
+            struct StagedBrush;
+            struct StagingBuffer;
+            static const size_t MinBrushesPerStagingBatch;
+
+            void stageBrush(const Model::Brush* brush, StagingBuffer& buffer) const;
+            void insertStagedBrush(const StagedBrush& staged, const StagingBuffer& buffer);
+            Chunk& chunkForBrush(const Model::Brush* brush);
             void addBrush(const Model::Brush* brush);
             void removeBrush(const Model::Brush* brush);
 
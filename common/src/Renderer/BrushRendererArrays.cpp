@@ -19,9 +19,14 @@
 
 #include "Renderer/BrushRendererArrays.h"
 
+#include "Renderer/DrawCallCounter.h"
+
 #include <cassert>
 #include <algorithm>
 #include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
 
 namespace TrenchBroom {
     // BrushIndexArray
@@ -30,11 +35,20 @@ namespace TrenchBroom {
 
         // DirtyRangeTracker
 
+        const size_t DirtyRangeTracker::MaxRanges = 64;
+
+        DirtyRangeTracker::Range::Range(const size_t i_pos, const size_t i_size)
+                : pos(i_pos), size(i_size) {}
+
+        bool DirtyRangeTracker::Range::operator==(const Range& other) const {
+            return pos == other.pos && size == other.size;
+        }
+
         DirtyRangeTracker::DirtyRangeTracker(const size_t initial_capacity)
-                : m_dirtyPos(0), m_dirtySize(0), m_capacity(initial_capacity) {}
+                : m_ranges(), m_capacity(initial_capacity) {}
 
         DirtyRangeTracker::DirtyRangeTracker()
-                : m_dirtyPos(0), m_dirtySize(0), m_capacity(0) {}
+                : m_ranges(), m_capacity(0) {}
 
         void DirtyRangeTracker::expand(const size_t newcap) {
             if (newcap <= m_capacity) {
@@ -55,16 +69,70 @@ namespace TrenchBroom {
             if (pos + size > m_capacity) {
                 throw std::invalid_argument("markDirty provided range out of bounds");
             }
+            if (size == 0) {
+                return;
+            }
+
+            size_t newPos = pos;
+            size_t newEnd = pos + size;
+
+            // merge with the preceding range if it overlaps or touches the new range
+            auto it = m_ranges.upper_bound(newPos);
+            if (it != std::begin(m_ranges) && std::prev(it)->second >= newPos) {
+                --it;
+            }
+
+            // merge with all following ranges that overlap or touch the new range
+            while (it != std::end(m_ranges) && it->first <= newEnd) {
+                newPos = std::min(newPos, it->first);
+                newEnd = std::max(newEnd, it->second);
+                it = m_ranges.erase(it);
+            }
 
-            const size_t newPos = std::min(pos, m_dirtyPos);
-            const size_t newEnd = std::max(pos + size, m_dirtyPos + m_dirtySize);
+            m_ranges.insert(it, std::make_pair(newPos, newEnd));
 
-            m_dirtyPos = newPos;
-            m_dirtySize = newEnd - newPos;
+            if (m_ranges.size() > MaxRanges) {
+                mergeClosestRanges();
+            }
         }
 
         bool DirtyRangeTracker::clean() const {
-            return m_dirtySize == 0;
+            return m_ranges.empty();
+        }
+
+        DirtyRangeTracker::RangeList DirtyRangeTracker::ranges() const {
+            RangeList result;
+            result.reserve(m_ranges.size());
+            for (const auto& [pos, end] : m_ranges) {
+                result.push_back(Range(pos, end - pos));
+            }
+            return result;
+        }
+
+        size_t DirtyRangeTracker::dirtySize() const {
+            size_t result = 0;
+            for (const auto& [pos, end] : m_ranges) {
+                result += end - pos;
+            }
+            return result;
+        }
+
+        void DirtyRangeTracker::mergeClosestRanges() {
+            assert(m_ranges.size() > 1);
+
+            auto closest = std::begin(m_ranges);
+            size_t closestGap = std::numeric_limits<size_t>::max();
+            for (auto it = std::begin(m_ranges), next = std::next(it); next != std::end(m_ranges); ++it, ++next) {
+                const size_t gap = next->first - it->second;
+                if (gap < closestGap) {
+                    closest = it;
+                    closestGap = gap;
+                }
+            }
+
+            const auto next = std::next(closest);
+            closest->second = next->second;
+            m_ranges.erase(next);
         }
 
         // IndexHolder
@@ -83,13 +151,75 @@ namespace TrenchBroom {
             const GLsizei renderCount = static_cast<GLsizei>(count);
             const GLvoid *renderOffset = reinterpret_cast<GLvoid *>(m_block->offset() + sizeof(Index) * offset);
 
+            m_block->bind();
             glAssert(glDrawElements(primType, renderCount, glType<Index>(), renderOffset));
+            DrawCallCounter::count();
+        }
+
+        VboBlock* IndexHolder::block() const {
+            return m_block;
         }
 
         std::shared_ptr<IndexHolder> IndexHolder::swap(std::vector<IndexHolder::Index> &elements) {
             return std::make_shared<IndexHolder>(elements);
         }
 
+        // MultiDrawIndices
+
+        MultiDrawIndices::Range::Range(VboBlock* i_block, const size_t i_count) :
+        block(i_block),
+        count(i_count) {}
+
+        void MultiDrawIndices::add(const BrushIndexArray& indexArray) {
+            m_indexArrays.push_back(&indexArray);
+        }
+
+        bool MultiDrawIndices::empty() const {
+            return std::all_of(std::begin(m_indexArrays), std::end(m_indexArrays), [](const BrushIndexArray* indexArray) {
+                return indexArray->empty();
+            });
+        }
+
+        void MultiDrawIndices::render(const PrimType primType) {
+            m_ranges.clear();
+            for (const BrushIndexArray* indexArray : m_indexArrays) {
+                if (!indexArray->empty()) {
+                    assert(indexArray->prepared());
+                    m_ranges.emplace_back(indexArray->m_indexHolder.block(), indexArray->m_indexHolder.size());
+                }
+            }
+
+            // blocks from different buffers cannot be rendered with the same draw call
+            std::stable_sort(std::begin(m_ranges), std::end(m_ranges), [](const Range& lhs, const Range& rhs) {
+                return lhs.block->arena() < rhs.block->arena();
+            });
+
+            size_t first = 0;
+            while (first < m_ranges.size()) {
+                const size_t arena = m_ranges[first].block->arena();
+
+                m_counts.clear();
+                m_offsets.clear();
+
+                size_t last = first;
+                while (last < m_ranges.size() && m_ranges[last].block->arena() == arena) {
+                    const Range& range = m_ranges[last++];
+                    m_counts.push_back(static_cast<GLsizei>(range.count));
+                    m_offsets.push_back(reinterpret_cast<const GLvoid*>(range.block->offset()));
+                }
+
+                m_ranges[first].block->bind();
+                if (m_counts.size() == 1) {
+                    glAssert(glDrawElements(primType, m_counts.front(), glType<Index>(), m_offsets.front()));
+                } else {
+                    glAssert(glMultiDrawElements(primType, m_counts.data(), glType<Index>(), m_offsets.data(), static_cast<GLsizei>(m_counts.size())));
+                }
+                DrawCallCounter::count();
+
+                first = last;
+            }
+        }
+
         VertexArrayInterface::~VertexArrayInterface() {}
 
         // BrushIndexArray
@@ -144,12 +274,34 @@ namespace TrenchBroom {
 
         // BrushVertexArray
 
-        BrushVertexArray::BrushVertexArray() : m_vertexHolder(),
-                                               m_allocationTracker(0) {}
+        BrushVertexArray::BrushVertexArray(const BrushVertexFormat format) :
+        m_format(format),
+        m_vertexHolder(),
+        m_compactVertexHolder(),
+        m_allocationTracker(0) {}
+
+        BrushVertexFormat BrushVertexArray::format() const {
+            return m_format;
+        }
+
+        size_t BrushVertexArray::sizeInBytes() const {
+            return m_vertexHolder.size() * sizeof(Vertex) + m_compactVertexHolder.size() * sizeof(CompactVertex);
+        }
 
         std::pair<AllocationTracker::Block*, BrushVertexArray::Vertex*> BrushVertexArray::getPointerToInsertVerticesAt(const size_t vertexCount) {
+            assert(m_format == BrushVertexFormat::Full);
+            return getPointerToInsertAt(m_vertexHolder, vertexCount);
+        }
+
+        std::pair<AllocationTracker::Block*, BrushVertexArray::CompactVertex*> BrushVertexArray::getPointerToInsertCompactVerticesAt(const size_t vertexCount) {
+            assert(m_format == BrushVertexFormat::Compact);
+            return getPointerToInsertAt(m_compactVertexHolder, vertexCount);
+        }
+
+        template <typename V>
+        std::pair<AllocationTracker::Block*, V*> BrushVertexArray::getPointerToInsertAt(VertexHolder<V>& holder, const size_t vertexCount) {
             if (auto block = m_allocationTracker.allocate(vertexCount); block != nullptr) {
-                Vertex* dest = m_vertexHolder.getPointerToWriteElementsTo(block->pos, vertexCount);
+                V* dest = holder.getPointerToWriteElementsTo(block->pos, vertexCount);
                 return {block, dest};
             }
 
@@ -157,13 +309,13 @@ namespace TrenchBroom {
             const size_t newSize = std::max(2 * m_allocationTracker.capacity(),
                                             m_allocationTracker.capacity() + vertexCount);
             m_allocationTracker.expand(newSize);
-            m_vertexHolder.resize(newSize);
+            holder.resize(newSize);
 
             // insert again
             auto block = m_allocationTracker.allocate(vertexCount);
             assert(block != nullptr);
 
-            Vertex* dest = m_vertexHolder.getPointerToWriteElementsTo(block->pos, vertexCount);
+            V* dest = holder.getPointerToWriteElementsTo(block->pos, vertexCount);
             return {block, dest};
         }
 
@@ -177,20 +329,26 @@ namespace TrenchBroom {
         }
 
         bool BrushVertexArray::setupVertices() {
+            if (m_format == BrushVertexFormat::Compact)
+                return m_compactVertexHolder.setupVertices();
             return m_vertexHolder.setupVertices();
         }
 
         void BrushVertexArray::cleanupVertices() {
-            m_vertexHolder.cleanupVertices();
+            if (m_format == BrushVertexFormat::Compact)
+                m_compactVertexHolder.cleanupVertices();
+            else
+                m_vertexHolder.cleanupVertices();
         }
 
         bool BrushVertexArray::prepared() const {
-            return m_vertexHolder.prepared();
+            return m_vertexHolder.prepared() && m_compactVertexHolder.prepared();
         }
 
         void BrushVertexArray::prepare(Vbo& vbo) {
             m_vertexHolder.prepare(vbo);
-            assert(m_vertexHolder.prepared());
+            m_compactVertexHolder.prepare(vbo);
+            assert(prepared());
         }
     }
 }
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <vector>
 #include <cassert>
+#include <map>
 #include <unordered_map>
 
 namespace TrenchBroom {
@@ -36,11 +37,31 @@ namespace TrenchBroom {
         class Brush;
     }
     namespace Renderer {
-        struct DirtyRangeTracker {
-            size_t m_dirtyPos;
-            size_t m_dirtySize;
-            size_t m_capacity;
+        /**
+         * Tracks the disjoint ranges of elements that were modified since the last upload.
+         *
+         * Overlapping and adjacent ranges are merged. If there are more than MaxRanges ranges, the two ranges with
+         * the smallest gap between them are merged, so that the number of uploads stays bounded while edits at
+         * opposite ends of a buffer do not cause the entire buffer to be uploaded.
+         */
+        class DirtyRangeTracker {
+        public:
+            struct Range {
+                size_t pos;
+                size_t size;
+
+                Range(size_t i_pos, size_t i_size);
+                bool operator==(const Range& other) const;
+            };
+
+            using RangeList = std::vector<Range>;
 
+            static const size_t MaxRanges;
+        private:
+            // maps the start of each range to its end
+            std::map<size_t, size_t> m_ranges;
+            size_t m_capacity;
+        public:
             /**
              * New trackers are initially clean.
              */
@@ -54,6 +75,18 @@ namespace TrenchBroom {
             size_t capacity() const;
             void markDirty(size_t pos, size_t size);
             bool clean() const;
+
+            /**
+             * Returns the dirty ranges in ascending order.
+             */
+            RangeList ranges() const;
+
+            /**
+             * Returns the total number of dirty elements.
+             */
+            size_t dirtySize() const;
+        private:
+            void mergeClosestRanges();
         };
 
         /**
@@ -62,14 +95,14 @@ namespace TrenchBroom {
          * Non-copyable; meant to be held in a std::shared_ptr.
          * Able to be resized, and handles copying edits made in the local std::vector to the VBO.
          *
-         * Currently uses a single range to track the modified region which might upload much more than necessary;
-         * it might be worth mapping the VBO and editing it directly.
+         * Only the ranges that were modified since the last upload are written to the VBO, each with a separate
+         * write.
          */
         template<typename T>
         class VboBlockHolder {
         protected:
             std::vector<T> m_snapshot;
-            DirtyRangeTracker m_dirtyRange;
+            DirtyRangeTracker m_dirtyRanges;
             VboBlock *m_block;
 
         private:
@@ -83,21 +116,23 @@ namespace TrenchBroom {
             void allocateBlock(Vbo &vbo) {
                 assert(m_block == nullptr);
 
+                // the block is kept across frames even if it is first prepared by a one shot renderable
                 ActivateVbo activate(vbo);
+                StreamVboBlocks persistent(vbo, false);
                 m_block = vbo.allocateBlock(m_snapshot.size() * sizeof(T));
                 assert(m_block != nullptr);
 
                 MapVboBlock map(m_block);
                 m_block->writeElements(0, m_snapshot);
 
-                m_dirtyRange = DirtyRangeTracker(m_snapshot.size());
-                assert(m_dirtyRange.clean());
-                assert((m_block->capacity() / sizeof(T)) == m_dirtyRange.capacity());
+                m_dirtyRanges = DirtyRangeTracker(m_snapshot.size());
+                assert(m_dirtyRanges.clean());
+                assert((m_block->capacity() / sizeof(T)) == m_dirtyRanges.capacity());
             }
 
         public:
             VboBlockHolder() : m_snapshot(),
-                               m_dirtyRange(0),
+                               m_dirtyRanges(0),
                                m_block(nullptr) {}
 
             /**
@@ -105,11 +140,11 @@ namespace TrenchBroom {
              */
             explicit VboBlockHolder(std::vector<T> &elements)
                     : m_snapshot(),
-                      m_dirtyRange(elements.size()),
+                      m_dirtyRanges(elements.size()),
                       m_block(nullptr) {
 
                 const size_t elementsCount = elements.size();
-                m_dirtyRange.markDirty(0, elementsCount);
+                m_dirtyRanges.markDirty(0, elementsCount);
 
                 elements.swap(m_snapshot);
 
@@ -127,21 +162,21 @@ namespace TrenchBroom {
 
             void resize(const size_t newSize) {
                 m_snapshot.resize(newSize);
-                m_dirtyRange.expand(newSize);
+                m_dirtyRanges.expand(newSize);
             }
 
             T* getPointerToWriteElementsTo(const size_t offsetWithinBlock, const size_t elementCount) {
                 assert(offsetWithinBlock + elementCount <= m_snapshot.size());
 
                 // mark dirty range
-                m_dirtyRange.markDirty(offsetWithinBlock, elementCount);
+                m_dirtyRanges.markDirty(offsetWithinBlock, elementCount);
 
                 return m_snapshot.data() + offsetWithinBlock;
             }
 
             bool prepared() const {
                 // NOTE: this returns true if the capacity is 0
-                return m_dirtyRange.clean();
+                return m_dirtyRanges.clean();
             }
 
             void prepare(Vbo& vbo) {
@@ -161,7 +196,7 @@ namespace TrenchBroom {
                 }
 
                 // resize?
-                if (m_dirtyRange.capacity() != (m_block->capacity() / sizeof(T))) {
+                if (m_dirtyRanges.capacity() != (m_block->capacity() / sizeof(T))) {
                     freeBlock();
                     allocateBlock(vbo);
                     assert(prepared());
@@ -172,17 +207,14 @@ namespace TrenchBroom {
                 ActivateVbo activate(vbo);
                 MapVboBlock map(m_block);
 
-                if (!m_dirtyRange.clean()) {
-                    const size_t pos = m_dirtyRange.m_dirtyPos;
-                    const size_t size = m_dirtyRange.m_dirtySize;
-
-                    const size_t bytesFromStart = pos * sizeof(T);
+                for (const auto& range : m_dirtyRanges.ranges()) {
+                    const size_t bytesFromStart = range.pos * sizeof(T);
                     m_block->writeArray(bytesFromStart,
-                                        m_snapshot.data() + pos,
-                                        size);
+                                        m_snapshot.data() + range.pos,
+                                        range.size);
                 }
 
-                m_dirtyRange = DirtyRangeTracker(m_snapshot.size());
+                m_dirtyRanges = DirtyRangeTracker(m_snapshot.size());
                 assert(prepared());
             }
 
@@ -207,15 +239,60 @@ namespace TrenchBroom {
             void zeroRange(size_t offsetWithinBlock, size_t count);
             void render(PrimType primType, size_t offset, size_t count) const;
 
+            VboBlock* block() const;
+
             static std::shared_ptr<IndexHolder> swap(std::vector<Index>& elements);
         };
 
+        class BrushIndexArray;
+
+        /**
+         * Collects several brush index arrays that refer to the same vertex array so that they can be rendered with
+         * as few draw calls as possible. The index arrays that reside in the same buffer are rendered with a single
+         * call to glMultiDrawElements.
+         *
+         * Only references to the index arrays are kept, and their buffer blocks are looked up when rendering, so the
+         * collected arrays can be reused across frames even if the arrays are modified and uploaded again. The
+         * caller must keep the arrays alive.
+         */
+        class MultiDrawIndices {
+        private:
+            using Index = IndexHolder::Index;
+
+            struct Range {
+                VboBlock* block;
+                size_t count;
+
+                Range(VboBlock* i_block, size_t i_count);
+            };
+
+            std::vector<const BrushIndexArray*> m_indexArrays;
+            std::vector<Range> m_ranges;
+            std::vector<GLsizei> m_counts;
+            std::vector<const GLvoid*> m_offsets;
+        public:
+            void add(const BrushIndexArray& indexArray);
+
+            /**
+             * Returns true if all collected arrays are empty.
+             */
+            bool empty() const;
+
+            /**
+             * Renders the collected indices. The index arrays must be prepared and the vertex array must be set up.
+             * Empty arrays are skipped.
+             */
+            void render(PrimType primType);
+        };
+
         /**
          * VboBlock handle that supports dynamically allocating ranges of indices, grows as needed, and also
          * supports freeing allocations and zeroing the corresponding indicies so they become degenerate primitives.
          */
         class BrushIndexArray {
         private:
+            friend class MultiDrawIndices;
+
             IndexHolder m_indexHolder;
             AllocationTracker m_allocationTracker;
         public:
@@ -265,6 +342,7 @@ namespace TrenchBroom {
 
             bool setupVertices() override {
                 ensure(VboBlockHolder<V>::m_block != nullptr, "block is null");
+                VboBlockHolder<V>::m_block->bind();
                 V::Spec::setup(VboBlockHolder<V>::m_block->offset());
                 return true;
             }
@@ -282,19 +360,42 @@ namespace TrenchBroom {
             }
         };
 
+        /**
+         * The layout of the vertices in a BrushVertexArray. Full vertices store every attribute as floats and take
+         * 32 bytes, compact vertices store the texture coordinates as half floats and the normal as bytes and take
+         * 20 bytes.
+         */
+        enum class BrushVertexFormat {
+            Full,
+            Compact
+        };
+
         /**
          * Same as BrushIndexArray but for vertices instead of indices.
          * The only difference is deleteVerticesWithKey() doesn't need to zero out
          * the deleted memory in the VBO, while BrushIndexArray's does.
+         *
+         * Depending on its format, the array stores either full or compact vertices, and only the matching
+         * getPointerToInsert method may be called.
          */
         class BrushVertexArray {
-        private:
+        public:
             using Vertex = Renderer::VertexSpecs::P3NT2::Vertex;
-
+            using CompactVertex = Renderer::VertexSpecs::P3T2HNB::Vertex;
+        private:
+            BrushVertexFormat m_format;
             VertexHolder<Vertex> m_vertexHolder;
+            VertexHolder<CompactVertex> m_compactVertexHolder;
             AllocationTracker m_allocationTracker;
         public:
-            BrushVertexArray();
+            explicit BrushVertexArray(BrushVertexFormat format = BrushVertexFormat::Full);
+
+            BrushVertexFormat format() const;
+
+            /**
+             * Returns the number of bytes that the vertices take in memory, including free space.
+             */
+            size_t sizeInBytes() const;
 
             /**
              * Call this to request writing the given number of vertices.
@@ -305,6 +406,7 @@ namespace TrenchBroom {
              * and also a Vertex pointer where the caller should write `elementCount` Vertex objects.
              */
             std::pair<AllocationTracker::Block*, Vertex*> getPointerToInsertVerticesAt(size_t vertexCount);
+            std::pair<AllocationTracker::Block*, CompactVertex*> getPointerToInsertCompactVerticesAt(size_t vertexCount);
 
             void deleteVerticesWithKey(AllocationTracker::Block* key);
 
@@ -315,6 +417,9 @@ namespace TrenchBroom {
             // uploading the VBO
             bool prepared() const;
             void prepare(Vbo& vbo);
+        private:
+            template <typename V>
+            std::pair<AllocationTracker::Block*, V*> getPointerToInsertAt(VertexHolder<V>& holder, size_t vertexCount);
         };
     }
 }
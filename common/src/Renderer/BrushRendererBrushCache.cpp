@@ -21,7 +21,11 @@
 
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
-#include "Model/BrushGeometry.h"
+#include "Model/FlatBrushGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -56,35 +60,41 @@ namespace TrenchBroom {
                 return;
             }
 
+            const Model::FlatBrushGeometry& geometry = brush->flatGeometry();
+
             // build vertex cache and face cache
 
             m_cachedVertices.clear();
-            m_cachedVertices.reserve(brush->vertexCount());
+            m_cachedVertices.reserve(2 * geometry.edgeCount());
 
             m_cachedFacesSortedByTexture.clear();
-            m_cachedFacesSortedByTexture.reserve(brush->faceCount());
+            m_cachedFacesSortedByTexture.reserve(geometry.faceCount());
 
-            for (Model::BrushFace* face : brush->faces()) {
-                const size_t indexOfFirstVertexRelativeToBrush = m_cachedVertices.size();
+            // For every vertex of the brush, the index of one of its cached vertices, relative to the brush's first
+            // vertex being 0. This is used below when building the edge cache.
+            // NOTE: we'll overwrite the index as we visit the same vertex several times while visiting different
+            // faces, this is fine.
+            std::vector<size_t> cachedVertexIndices(geometry.vertexCount());
 
-                const Model::BrushHalfEdge* first = face->geometry()->boundary().front();
-                const Model::BrushHalfEdge* current = first;
-                do {
-                    Model::BrushVertex* vertex = current->origin();
+            for (size_t faceIndex = 0; faceIndex < geometry.faceCount(); ++faceIndex) {
+                Model::BrushFace* face = geometry.face(faceIndex);
+                const size_t indexOfFirstVertexRelativeToBrush = m_cachedVertices.size();
 
-                    // Set the vertex payload to the index, relative to the brush's first vertex being 0.
-                    // This is used below when building the edge cache.
-                    // NOTE: we'll overwrite the payload as we visit the same vertex several times while visiting
-                    // different faces, this is fine.
-                    const size_t currentIndex = m_cachedVertices.size();
-                    vertex->setPayload(static_cast<GLuint>(currentIndex));
+                const auto cacheVertex = [&](const size_t vertexIndex) {
+                    cachedVertexIndices[vertexIndex] = m_cachedVertices.size();
 
-                    const Vec3& position = vertex->position();
+                    const Vec3& position = geometry.vertexPosition(vertexIndex);
                     m_cachedVertices.emplace_back(position, face->boundary().normal, face->textureCoords(position));
+                };
 
-                    // The boundary is in CCW order, but the renderer expects CW order:
-                    current = current->previous();
-                } while (current != first);
+                // The boundary is in CCW order, but the renderer expects CW order, so we visit the first vertex and
+                // then the remaining vertices in reverse order:
+                const size_t* first = geometry.faceVertexIndicesBegin(faceIndex);
+                const size_t* current = geometry.faceVertexIndicesEnd(faceIndex);
+                cacheVertex(*first);
+                while (--current != first) {
+                    cacheVertex(*current);
+                }
 
                 // face cache
                 m_cachedFacesSortedByTexture.emplace_back(face, indexOfFirstVertexRelativeToBrush);
@@ -100,13 +110,13 @@ namespace TrenchBroom {
             // Build edge index cache
 
             m_cachedEdges.clear();
-            m_cachedEdges.reserve(brush->edgeCount());
+            m_cachedEdges.reserve(geometry.edgeCount());
 
-            for (const Model::BrushEdge* currentEdge : brush->edges()) {
-                const auto face1 = currentEdge->firstFace()->payload();
-                const auto face2 = currentEdge->secondFace()->payload();
-                const auto vertexIndex1RelativeToBrush = currentEdge->firstVertex()->payload();
-                const auto vertexIndex2RelativeToBrush = currentEdge->secondVertex()->payload();
+            for (size_t edgeIndex = 0; edgeIndex < geometry.edgeCount(); ++edgeIndex) {
+                const auto face1 = geometry.face(geometry.edgeFirstFace(edgeIndex));
+                const auto face2 = geometry.face(geometry.edgeSecondFace(edgeIndex));
+                const auto vertexIndex1RelativeToBrush = cachedVertexIndices[geometry.edgeFirstVertex(edgeIndex)];
+                const auto vertexIndex2RelativeToBrush = cachedVertexIndices[geometry.edgeSecondVertex(edgeIndex)];
 
                 m_cachedEdges.emplace_back(face1, face2, vertexIndex1RelativeToBrush, vertexIndex2RelativeToBrush);
             }
@@ -119,6 +129,36 @@ namespace TrenchBroom {
             return m_cachedVertices;
         }
 
+        void BrushRendererBrushCache::getCompactVertices(CompactVertex* dest) const {
+            assert(m_rendererCacheValid);
+
+            for (const CachedFace& cachedFace : m_cachedFacesSortedByTexture) {
+                const size_t first = cachedFace.indexOfFirstVertexRelativeToBrush;
+                const size_t last = first + cachedFace.vertexCount;
+
+                Vec2f minTexCoords(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+                for (size_t i = first; i < last; ++i) {
+                    const Vec2f& texCoords = m_cachedVertices[i].v3;
+                    minTexCoords[0] = std::min(minTexCoords[0], texCoords[0]);
+                    minTexCoords[1] = std::min(minTexCoords[1], texCoords[1]);
+                }
+                const Vec2f offset(std::floor(minTexCoords[0]), std::floor(minTexCoords[1]));
+
+                for (size_t i = first; i < last; ++i) {
+                    const Vertex& vertex = m_cachedVertices[i];
+                    const Vec2f texCoords = vertex.v3 - offset;
+                    const Vec3f& normal = vertex.v2;
+
+                    dest[i] = CompactVertex(vertex.v1,
+                                            CompactVertexSpec::A2::ElementType(floatToHalf(texCoords[0]),
+                                                                               floatToHalf(texCoords[1])),
+                                            CompactVertexSpec::A3::ElementType(static_cast<GLbyte>(std::round(normal[0] * 127.0f)),
+                                                                               static_cast<GLbyte>(std::round(normal[1] * 127.0f)),
+                                                                               static_cast<GLbyte>(std::round(normal[2] * 127.0f))));
+                }
+            }
+        }
+
         const std::vector<BrushRendererBrushCache::CachedFace>& BrushRendererBrushCache::cachedFacesSortedByTexture() const {
             assert(m_rendererCacheValid);
             return m_cachedFacesSortedByTexture;
@@ -39,6 +39,8 @@ namespace TrenchBroom {
         public:
             using VertexSpec = Renderer::VertexSpecs::P3NT2;
             using Vertex = VertexSpec::Vertex;
+            using CompactVertexSpec = Renderer::VertexSpecs::P3T2HNB;
+            using CompactVertex = CompactVertexSpec::Vertex;
 
             struct CachedFace {
                 const Assets::Texture* texture;
@@ -89,6 +91,15 @@ namespace TrenchBroom {
              * Returns all vertices for all faces of the brush.
              */
             const std::vector<Vertex>& cachedVertices() const;
+            /**
+             * Converts all cached vertices to the compact vertex format and writes them to the given destination,
+             * which must have room for cachedVertices().size() vertices.
+             *
+             * Half floats lose precision quickly as the texture coordinates grow, so the texture coordinates of every
+             * face are shifted by a whole number of texture repetitions that brings them close to zero. Since
+             * textures repeat, this does not change how the face looks.
+             */
+            void getCompactVertices(CompactVertex* dest) const;
             const std::vector<CachedFace>& cachedFacesSortedByTexture() const;
             const std::vector<CachedEdge>& cachedEdges() const;
         };
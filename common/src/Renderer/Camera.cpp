@@ -155,6 +155,23 @@ namespace TrenchBroom {
             doComputeFrustumPlanes(top, right, bottom, left);
         }
 
+        bool Camera::frustumIntersects(const BBox3f& bounds) const {
+            Plane3f planes[4];
+            frustumPlanes(planes[0], planes[1], planes[2], planes[3]);
+            
+            // the normals of the frustum planes point outwards, so the box is outside of the frustum if the corner
+            // that is farthest from the direction of any of the normals is above that plane
+            for (size_t i = 0; i < 4; ++i) {
+                const Plane3f& plane = planes[i];
+                Vec3f corner;
+                for (size_t j = 0; j < 3; ++j)
+                    corner[j] = plane.normal[j] >= 0.0f ? bounds.min[j] : bounds.max[j];
+                if (plane.pointDistance(corner) > 0.0f)
+                    return false;
+            }
+            return true;
+        }
+
         Ray3f Camera::viewRay() const {
             return Ray3f(m_position, m_direction);
         }
@@ -106,6 +106,12 @@ namespace TrenchBroom {
             const Mat4x4f verticalBillboardMatrix() const;
             void frustumPlanes(Plane3f& topPlane, Plane3f& rightPlane, Plane3f& bottomPlane, Plane3f& leftPlane) const;
             
+            /**
+             * Indicates whether the given bounding box intersects the viewing frustum. Only the side planes of the
+             * frustum are checked, so a box that is beyond the far plane counts as intersecting.
+             */
+            bool frustumIntersects(const BBox3f& bounds) const;
+            
             Ray3f viewRay() const;
             Ray3f pickRay(int x, int y) const;
             Ray3f pickRay(const Vec3f& point) const;
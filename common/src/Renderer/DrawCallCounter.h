@@ -0,0 +1,42 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_DrawCallCounter
+#define TrenchBroom_DrawCallCounter
+
+#include <cstddef>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        /**
+         * Counts the draw calls issued by the renderer on the CPU side. This allows to check how well the geometry
+         * is batched without having to query the OpenGL driver.
+         */
+        class DrawCallCounter {
+        private:
+            static size_t s_drawCalls;
+        public:
+            static void count(size_t drawCalls = 1);
+            static size_t drawCalls();
+            static void reset();
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_DrawCallCounter) */
@@ -26,6 +26,8 @@
 #include "Renderer/ShaderProgram.h"
 #include "Renderer/BrushRendererArrays.h"
 
+#include <algorithm>
+
 namespace TrenchBroom {
     namespace Renderer {
         EdgeRenderer::Params::Params(const float i_width, const float i_offset, const bool i_onTop) :
@@ -163,26 +165,34 @@ namespace TrenchBroom {
 
         // IndexedEdgeRenderer::Render
 
-        IndexedEdgeRenderer::Render::Render(const EdgeRenderer::Params& params, BrushVertexArrayPtr vertexArray, BrushIndexArrayPtr indexArray) :
+        IndexedEdgeRenderer::Render::Render(const EdgeRenderer::Params& params, BrushVertexArrayPtr vertexArray, BrushIndexArrayList indexArrays) :
         RenderBase(params),
         m_vertexArray(vertexArray),
-        m_indexArray(indexArray) {}
+        m_indexArrays(std::move(indexArrays)) {}
 
         void IndexedEdgeRenderer::Render::prepareVerticesAndIndices(Vbo& vertexVbo, Vbo& indexVbo) {
             m_vertexArray->prepare(vertexVbo);
-            m_indexArray->prepare(indexVbo);
+            for (const auto& indexArray : m_indexArrays) {
+                indexArray->prepare(indexVbo);
+            }
         }
 
         void IndexedEdgeRenderer::Render::doRender(RenderContext& renderContext) {
-            if (m_indexArray->empty()) {
+            const auto empty = [](const BrushIndexArrayPtr& indexArray) { return indexArray->empty(); };
+            if (std::all_of(std::begin(m_indexArrays), std::end(m_indexArrays), empty)) {
                 return;
             }
             renderEdges(renderContext);
         }
         
         void IndexedEdgeRenderer::Render::doRenderVertices(RenderContext& renderContext) {
+            MultiDrawIndices indices;
+            for (const auto& indexArray : m_indexArrays) {
+                indices.add(*indexArray);
+            }
+
             m_vertexArray->setupVertices();
-            m_indexArray->render(GL_LINES);
+            indices.render(GL_LINES);
             m_vertexArray->cleanupVertices();
         }
 
@@ -191,12 +201,15 @@ namespace TrenchBroom {
         IndexedEdgeRenderer::IndexedEdgeRenderer() {}
         
         IndexedEdgeRenderer::IndexedEdgeRenderer(BrushVertexArrayPtr vertexArray, BrushIndexArrayPtr indexArray) :
+        IndexedEdgeRenderer(vertexArray, BrushIndexArrayList{ indexArray }) {}
+
+        IndexedEdgeRenderer::IndexedEdgeRenderer(BrushVertexArrayPtr vertexArray, BrushIndexArrayList indexArrays) :
         m_vertexArray(vertexArray),
-        m_indexArray(indexArray) {}
+        m_indexArrays(std::move(indexArrays)) {}
         
         IndexedEdgeRenderer::IndexedEdgeRenderer(const IndexedEdgeRenderer& other) :
         m_vertexArray(other.m_vertexArray),
-        m_indexArray(other.m_indexArray) {}
+        m_indexArrays(other.m_indexArrays) {}
         
         IndexedEdgeRenderer& IndexedEdgeRenderer::operator=(IndexedEdgeRenderer other) {
             using std::swap;
@@ -207,11 +220,11 @@ namespace TrenchBroom {
         void swap(IndexedEdgeRenderer& left, IndexedEdgeRenderer& right) {
             using std::swap;
             swap(left.m_vertexArray, right.m_vertexArray);
-            swap(left.m_indexArray, right.m_indexArray);
+            swap(left.m_indexArrays, right.m_indexArrays);
         }
         
         void IndexedEdgeRenderer::doRender(RenderBatch& renderBatch, const EdgeRenderer::Params& params) {
-            renderBatch.addOneShot(new Render(params, m_vertexArray, m_indexArray));
+            renderBatch.addOneShot(new Render(params, m_vertexArray, m_indexArrays));
         }
     }
 }
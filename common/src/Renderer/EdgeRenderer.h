@@ -40,6 +40,7 @@ namespace TrenchBroom {
 
         using BrushVertexArrayPtr = std::shared_ptr<BrushVertexArray>;
         using BrushIndexArrayPtr = std::shared_ptr<BrushIndexArray>;
+        using BrushIndexArrayList = std::vector<BrushIndexArrayPtr>;
 
         class EdgeRenderer {
         public:
@@ -113,9 +114,9 @@ namespace TrenchBroom {
             class Render : public RenderBase, public IndexedRenderable {
             private:
                 BrushVertexArrayPtr m_vertexArray;
-                BrushIndexArrayPtr m_indexArray;
+                BrushIndexArrayList m_indexArrays;
             public:
-                Render(const Params& params, BrushVertexArrayPtr vertexArray, BrushIndexArrayPtr indexArray);
+                Render(const Params& params, BrushVertexArrayPtr vertexArray, BrushIndexArrayList indexArrays);
             private:
                 void prepareVerticesAndIndices(Vbo& vertexVbo, Vbo& indexVbo) override;
                 void doRender(RenderContext& renderContext) override;
@@ -123,10 +124,15 @@ namespace TrenchBroom {
             };
         private:
             BrushVertexArrayPtr m_vertexArray;
-            BrushIndexArrayPtr m_indexArray;
+            BrushIndexArrayList m_indexArrays;
         public:
             IndexedEdgeRenderer();
             IndexedEdgeRenderer(BrushVertexArrayPtr vertexArray, BrushIndexArrayPtr indexArray);
+            /**
+             * All index arrays must refer to the given vertex array. They are rendered with as few draw calls as
+             * possible.
+             */
+            IndexedEdgeRenderer(BrushVertexArrayPtr vertexArray, BrushIndexArrayList indexArrays);
 
             IndexedEdgeRenderer(const IndexedEdgeRenderer& other);
             IndexedEdgeRenderer& operator=(IndexedEdgeRenderer other);
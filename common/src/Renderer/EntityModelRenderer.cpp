@@ -28,6 +28,7 @@
 #include "Assets/EntityModelManager.h"
 #include "Model/EditorContext.h"
 #include "Model/Entity.h"
+#include "Renderer/Camera.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/Shaders.h"
 #include "Renderer/ShaderManager.h"
@@ -36,9 +37,21 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        const float EntityModelRenderer::FullLodMinSize = 96.0f;
+        const float EntityModelRenderer::ReducedLodMinSize = 16.0f;
+
+        TexturedIndexRangeRenderer* EntityModelRenderer::LodRenderers::select(const float projectedSize) const {
+            if (projectedSize >= FullLodMinSize)
+                return full;
+            if (projectedSize >= ReducedLodMinSize)
+                return reduced;
+            return impostor;
+        }
+
         EntityModelRenderer::EntityModelRenderer(Assets::EntityModelManager& entityModelManager, const Model::EditorContext& editorContext) :
         m_entityModelManager(entityModelManager),
         m_editorContext(editorContext),
+        m_instanced(false),
         m_applyTinting(false),
         m_showHiddenEntities(false) {}
 
@@ -47,32 +60,34 @@ namespace TrenchBroom {
         }
         
         void EntityModelRenderer::addEntity(Model::Entity* entity) {
-            const Assets::ModelSpecification& modelSpec = entity->modelSpecification();
-            TexturedIndexRangeRenderer* renderer = m_entityModelManager.renderer(modelSpec);
-            if (renderer != nullptr)
-                m_entities.insert(std::make_pair(entity, renderer));
+            LodRenderers renderers;
+            if (lodRenderers(entity, renderers))
+                m_entities.insert(std::make_pair(entity, renderers));
         }
         
         void EntityModelRenderer::updateEntity(Model::Entity* entity) {
-            const Assets::ModelSpecification& modelSpec = entity->modelSpecification();
-            TexturedIndexRangeRenderer* renderer = m_entityModelManager.renderer(modelSpec);
+            LodRenderers renderers;
+            const bool hasRenderers = lodRenderers(entity, renderers);
             EntityMap::iterator it = m_entities.find(entity);
             
-            if (renderer == nullptr && it == std::end(m_entities))
+            if (!hasRenderers && it == std::end(m_entities))
                 return;
             
             if (it == std::end(m_entities)) {
-                m_entities.insert(std::make_pair(entity, renderer));
+                m_entities.insert(std::make_pair(entity, renderers));
             } else {
-                if (renderer == nullptr)
+                if (!hasRenderers) {
                     m_entities.erase(it);
-                else if (it->second != renderer)
-                    it->second = renderer;
+                    removeInstance(entity);
+                } else {
+                    it->second = renderers;
+                }
             }
         }
 
         void EntityModelRenderer::clear() {
             m_entities.clear();
+            clearInstances();
         }
 
         bool EntityModelRenderer::applyTinting() const {
@@ -99,15 +114,126 @@ namespace TrenchBroom {
             m_showHiddenEntities = showHiddenEntities;
         }
 
-        void EntityModelRenderer::render(RenderBatch& renderBatch) {
+        void EntityModelRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
+            m_instanced = glInstancingSupported();
+            if (m_instanced)
+                updateInstances(renderContext.camera());
+            else
+                clearInstances();
             renderBatch.add(this);
         }
 
+        bool EntityModelRenderer::lodRenderers(const Model::Entity* entity, LodRenderers& renderers) const {
+            const Assets::ModelSpecification& modelSpec = entity->modelSpecification();
+            renderers.full = m_entityModelManager.renderer(modelSpec, Assets::EntityModelLod::Full);
+            if (renderers.full == nullptr)
+                return false;
+            
+            renderers.reduced = m_entityModelManager.renderer(modelSpec, Assets::EntityModelLod::Reduced);
+            if (renderers.reduced == nullptr)
+                renderers.reduced = renderers.full;
+            
+            renderers.impostor = m_entityModelManager.renderer(modelSpec, Assets::EntityModelLod::Impostor);
+            if (renderers.impostor == nullptr)
+                renderers.impostor = renderers.reduced;
+            return true;
+        }
+
+        TexturedIndexRangeRenderer* EntityModelRenderer::selectRenderer(const Model::Entity* entity, const LodRenderers& renderers, const Camera& camera) const {
+            const BBox3& bounds = entity->bounds();
+            const float projectedSize = static_cast<float>(bounds.size().length()) / camera.perspectiveScalingFactor(Vec3f(bounds.center()));
+            return renderers.select(projectedSize);
+        }
+
+        Mat4x4f EntityModelRenderer::modelMatrix(const Model::Entity* entity) {
+            const Mat4x4f translation(translationMatrix(entity->origin()));
+            const Mat4x4f rotation(entity->rotation());
+            return translation * rotation;
+        }
+
+        void EntityModelRenderer::updateInstances(const Camera& camera) {
+            for (const auto& entry : m_entities) {
+                const Model::Entity* entity = entry.first;
+                if (!m_showHiddenEntities && !m_editorContext.visible(entity)) {
+                    removeInstance(entity);
+                    continue;
+                }
+                
+                TexturedIndexRangeRenderer* renderer = selectRenderer(entity, entry.second, camera);
+                const auto it = m_instanceRenderers.find(entity);
+                if (it != std::end(m_instanceRenderers) && it->second != renderer)
+                    removeInstance(entity);
+                m_instanceRenderers[entity] = renderer;
+                
+                std::unique_ptr<InstanceArray>& instances = m_instances[renderer];
+                if (instances == nullptr)
+                    instances = std::make_unique<InstanceArray>(4);
+                
+                // the instance is only uploaded again if the entity was moved or rotated
+                const Mat4x4f matrix = modelMatrix(entity);
+                instances->set(entity, matrix.v);
+            }
+            
+            auto it = std::begin(m_instances);
+            while (it != std::end(m_instances)) {
+                if (it->second->empty())
+                    it = m_instances.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        void EntityModelRenderer::removeInstance(const Model::Entity* entity) {
+            const auto it = m_instanceRenderers.find(entity);
+            if (it == std::end(m_instanceRenderers))
+                return;
+            
+            const auto instancesIt = m_instances.find(it->second);
+            if (instancesIt != std::end(m_instances))
+                instancesIt->second->remove(entity);
+            m_instanceRenderers.erase(it);
+        }
+
+        void EntityModelRenderer::clearInstances() {
+            m_instances.clear();
+            m_instanceRenderers.clear();
+        }
+
         void EntityModelRenderer::doPrepareVertices(Vbo& vertexVbo) {
             m_entityModelManager.prepare(vertexVbo);
+            for (const auto& entry : m_instances)
+                entry.second->prepare(vertexVbo);
         }
         
         void EntityModelRenderer::doRender(RenderContext& renderContext) {
+            if (m_instanced)
+                renderInstanced(renderContext);
+            else
+                renderIndividually(renderContext);
+        }
+
+        void EntityModelRenderer::renderInstanced(RenderContext& renderContext) {
+            PreferenceManager& prefs = PreferenceManager::instance();
+            
+            ActiveShader shader(renderContext.shaderManager(), Shaders::InstancedEntityModelShader);
+            shader.set("Brightness", prefs.get(Preferences::Brightness));
+            shader.set("ApplyTinting", m_applyTinting);
+            shader.set("TintColor", m_tintColor);
+            shader.set("GrayScale", false);
+            shader.set("Texture", 0);
+            
+            glAssert(glEnable(GL_TEXTURE_2D));
+            glAssert(glActiveTexture(GL_TEXTURE0));
+            
+            const InstanceArray::AttributeLocations locations = InstanceArray::matrixLocations(shader.attributeLocation("InstanceTransformation"));
+            for (const auto& entry : m_instances) {
+                TexturedIndexRangeRenderer* renderer = entry.first;
+                InstanceArray& instances = *entry.second;
+                renderer->renderInstanced(instances, locations);
+            }
+        }
+
+        void EntityModelRenderer::renderIndividually(RenderContext& renderContext) {
             PreferenceManager& prefs = PreferenceManager::instance();
             
             ActiveShader shader(renderContext.shaderManager(), Shaders::EntityModelShader);
@@ -120,18 +246,14 @@ namespace TrenchBroom {
             glAssert(glEnable(GL_TEXTURE_2D));
             glAssert(glActiveTexture(GL_TEXTURE0));
             
+            const Camera& camera = renderContext.camera();
             for (const auto& entry : m_entities) {
                 Model::Entity* entity = entry.first;
                 if (!m_showHiddenEntities && !m_editorContext.visible(entity))
                     continue;
                 
-                TexturedIndexRangeRenderer* renderer = entry.second;
-                
-                const Mat4x4f translation(translationMatrix(entity->origin()));
-                const Mat4x4f rotation(entity->rotation());
-                const Mat4x4f matrix = translation * rotation;
-                MultiplyModelMatrix multMatrix(renderContext.transformation(), matrix);
-                
+                TexturedIndexRangeRenderer* renderer = selectRenderer(entity, entry.second, camera);
+                MultiplyModelMatrix multMatrix(renderContext.transformation(), modelMatrix(entity));
                 renderer->render();
             }
         }
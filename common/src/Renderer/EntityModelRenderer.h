@@ -23,9 +23,11 @@
 #include "Color.h"
 #include "Assets/ModelDefinition.h"
 #include "Model/ModelTypes.h"
+#include "Renderer/InstanceArray.h"
 #include "Renderer/Renderable.h"
 
 #include <map>
+#include <memory>
 #include <set>
 
 namespace TrenchBroom {
@@ -40,19 +42,51 @@ namespace TrenchBroom {
     }
     
     namespace Renderer {
+        class Camera;
         class RenderBatch;
         class RenderContext;
         class TexturedIndexRangeRenderer;
         
         class EntityModelRenderer : public DirectRenderable {
         private:
-            typedef std::map<Model::Entity*, TexturedIndexRangeRenderer*> EntityMap;
+            /**
+             * The renderers for every level of detail of an entity's model. If a lower level of detail is not
+             * available, the renderer of the next higher level is used in its place.
+             */
+            struct LodRenderers {
+                TexturedIndexRangeRenderer* full;
+                TexturedIndexRangeRenderer* reduced;
+                TexturedIndexRangeRenderer* impostor;
+
+                TexturedIndexRangeRenderer* select(float projectedSize) const;
+            };
+
+            typedef std::map<Model::Entity*, LodRenderers> EntityMap;
+            
+            /**
+             * If instancing is supported, all visible entities that are rendered with the same renderer are drawn
+             * with one instanced draw call per renderer. The instance arrays hold the model transformations of the
+             * entities, and every entity is kept in the array of the renderer it was last rendered with.
+             */
+            typedef std::map<TexturedIndexRangeRenderer*, std::unique_ptr<InstanceArray>> InstanceMap;
+            typedef std::map<const Model::Entity*, TexturedIndexRangeRenderer*> InstanceRendererMap;
+
+            /**
+             * The projected sizes in pixels of an entity's bounds diagonal above which the full and reduced levels of
+             * detail are rendered.
+             */
+            static const float FullLodMinSize;
+            static const float ReducedLodMinSize;
             
             Assets::EntityModelManager& m_entityModelManager;
             const Model::EditorContext& m_editorContext;
             
             EntityMap m_entities;
             
+            bool m_instanced;
+            InstanceMap m_instances;
+            InstanceRendererMap m_instanceRenderers;
+            
             bool m_applyTinting;
             Color m_tintColor;
             
@@ -95,8 +129,18 @@ namespace TrenchBroom {
             bool showHiddenEntities() const;
             void setShowHiddenEntities(bool showHiddenEntities);
             
-            void render(RenderBatch& renderBatch);
+            void render(RenderContext& renderContext, RenderBatch& renderBatch);
         private:
+            bool lodRenderers(const Model::Entity* entity, LodRenderers& renderers) const;
+            TexturedIndexRangeRenderer* selectRenderer(const Model::Entity* entity, const LodRenderers& renderers, const Camera& camera) const;
+            static Mat4x4f modelMatrix(const Model::Entity* entity);
+            
+            void updateInstances(const Camera& camera);
+            void removeInstance(const Model::Entity* entity);
+            void clearInstances();
+            
+            void renderInstanced(RenderContext& renderContext);
+            void renderIndividually(RenderContext& renderContext);
             void doPrepareVertices(Vbo& vertexVbo) override;
             void doRender(RenderContext& renderContext) override;
         };
@@ -41,6 +41,8 @@
 #include "Renderer/TextAnchor.h"
 #include "Renderer/VertexSpec.h"
 
+#include <unordered_set>
+
 namespace TrenchBroom {
     namespace Renderer {
         class EntityRenderer::EntityClassnameAnchor : public TextAnchor3D {
@@ -67,6 +69,7 @@ namespace TrenchBroom {
         m_editorContext(editorContext),
         m_modelRenderer(m_entityModelManager, m_editorContext),
         m_boundsValid(false),
+        m_modelGeneration(m_entityModelManager.modelGeneration()),
         m_showOverlays(true),
         m_showOccludedOverlays(false),
         m_tint(false),
@@ -91,6 +94,7 @@ namespace TrenchBroom {
             m_pointEntityWireframeBoundsRenderer = DirectEdgeRenderer();
             m_brushEntityWireframeBoundsRenderer = DirectEdgeRenderer();
             m_solidBoundsRenderer = TriangleRenderer();
+            m_instancedSolidBoundsRenderer.clear();
             m_modelRenderer.clear();
         }
 
@@ -151,6 +155,12 @@ namespace TrenchBroom {
         }
 
         void EntityRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
+            if (m_modelGeneration != m_entityModelManager.modelGeneration()) {
+                // models were loaded in the background, replace the placeholder bounds of their entities
+                m_modelGeneration = m_entityModelManager.modelGeneration();
+                invalidate();
+            }
+            
             if (!m_entities.empty()) {
                 renderBounds(renderContext, renderBatch);
                 renderModels(renderContext, renderBatch);
@@ -192,6 +202,12 @@ namespace TrenchBroom {
             m_solidBoundsRenderer.setApplyTinting(m_tint);
             m_solidBoundsRenderer.setTintColor(m_tintColor);
             renderBatch.add(&m_solidBoundsRenderer);
+            
+            if (!m_instancedSolidBoundsRenderer.empty()) {
+                m_instancedSolidBoundsRenderer.setApplyTinting(m_tint);
+                m_instancedSolidBoundsRenderer.setTintColor(m_tintColor);
+                renderBatch.add(&m_instancedSolidBoundsRenderer);
+            }
         }
         
         void EntityRenderer::renderModels(RenderContext& renderContext, RenderBatch& renderBatch) {
@@ -200,7 +216,7 @@ namespace TrenchBroom {
                 m_modelRenderer.setApplyTinting(m_tint);
                 m_modelRenderer.setTintColor(m_tintColor);
                 m_modelRenderer.setShowHiddenEntities(m_showHiddenEntities);
-                m_modelRenderer.render(renderBatch);
+                m_modelRenderer.render(renderContext, renderBatch);
             }
         }
         
@@ -209,6 +225,7 @@ namespace TrenchBroom {
                 Renderer::RenderService renderService(renderContext, renderBatch);
                 renderService.setForegroundColor(m_overlayTextColor);
                 renderService.setBackgroundColor(m_overlayBackgroundColor);
+                renderService.setCullOverlappingStrings(true);
                 
                 for (const Model::Entity* entity : m_entities) {
                     if (m_showHiddenEntities || m_editorContext.visible(entity)) {
@@ -320,8 +337,23 @@ namespace TrenchBroom {
         }
         
         void EntityRenderer::validateBounds() {
+            const bool instanced = glInstancingSupported();
+            
             VertexSpecs::P3NC4::Vertex::List solidVertices;
-            solidVertices.reserve(36 * m_entities.size());
+            std::unordered_set<InstancedBoxRenderer::Key> solidEntities;
+            if (!instanced)
+                solidVertices.reserve(36 * m_entities.size());
+            
+            // only the instances of entities that were added, moved or recolored are uploaded again
+            const auto addSolidBounds = [&](const Model::Entity* entity) {
+                if (instanced) {
+                    m_instancedSolidBoundsRenderer.setBox(entity, entity->bounds(), boundsColor(entity));
+                    solidEntities.insert(entity);
+                } else {
+                    BuildColoredSolidBoundsVertices solidBoundsBuilder(solidVertices, boundsColor(entity));
+                    eachBBoxFace(entity->bounds(), solidBoundsBuilder);
+                }
+            };
             
             if (m_overrideBoundsColor) {
                 VertexSpecs::P3::Vertex::List pointEntityWireframeVertices;
@@ -339,10 +371,8 @@ namespace TrenchBroom {
 
                         eachBBoxEdge(entity->bounds(), pointEntity ? pointEntityWireframeBoundsBuilder : brushEntityWireframeBoundsBuilder);
 
-                        if (!entity->hasChildren() && !m_entityModelManager.hasModel(entity)) {
-                            BuildColoredSolidBoundsVertices solidBoundsBuilder(solidVertices, boundsColor(entity));
-                            eachBBoxFace(entity->bounds(), solidBoundsBuilder);
-                        }
+                        if (!entity->hasChildren() && !m_entityModelManager.hasModel(entity))
+                            addSolidBounds(entity);
                     }
                 }
                 
@@ -360,8 +390,7 @@ namespace TrenchBroom {
                         const bool pointEntity = !entity->hasChildren();
 
                         if (!entity->hasChildren() && !m_entityModelManager.hasModel(entity)) {
-                            BuildColoredSolidBoundsVertices solidBoundsBuilder(solidVertices, boundsColor(entity));
-                            eachBBoxFace(entity->bounds(), solidBoundsBuilder);
+                            addSolidBounds(entity);
                         } else {
                             BuildColoredWireframeBoundsVertices pointEntityWireframeBoundsBuilder(pointEntityWireframeVertices, boundsColor(entity));
                             BuildColoredWireframeBoundsVertices brushEntityWireframeBoundsBuilder(brushEntityWireframeVertices, boundsColor(entity));
@@ -375,7 +404,16 @@ namespace TrenchBroom {
                 m_brushEntityWireframeBoundsRenderer = DirectEdgeRenderer(VertexArray::swap(brushEntityWireframeVertices), GL_LINES);
             }
             
-            m_solidBoundsRenderer = TriangleRenderer(VertexArray::swap(solidVertices), GL_QUADS);
+            if (instanced) {
+                const std::vector<InstancedBoxRenderer::Key> keys = m_instancedSolidBoundsRenderer.keys();
+                for (const InstancedBoxRenderer::Key key : keys) {
+                    if (solidEntities.count(key) == 0)
+                        m_instancedSolidBoundsRenderer.removeBox(key);
+                }
+                m_solidBoundsRenderer = TriangleRenderer();
+            } else {
+                m_solidBoundsRenderer = TriangleRenderer(VertexArray::swap(solidVertices), GL_QUADS);
+            }
             m_boundsValid = true;
         }
 
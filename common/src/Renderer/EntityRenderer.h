@@ -26,6 +26,7 @@
 #include "Renderer/EdgeRenderer.h"
 #include "Renderer/EntityModelRenderer.h"
 #include "Renderer/FontDescriptor.h"
+#include "Renderer/InstancedBoxRenderer.h"
 #include "Renderer/Renderable.h"
 #include "Renderer/TriangleRenderer.h"
 #include "Renderer/Vbo.h"
@@ -57,8 +58,13 @@ namespace TrenchBroom {
             DirectEdgeRenderer m_brushEntityWireframeBoundsRenderer;
 
             TriangleRenderer m_solidBoundsRenderer;
+            /**
+             * Replaces m_solidBoundsRenderer if instancing is supported.
+             */
+            InstancedBoxRenderer m_instancedSolidBoundsRenderer;
             EntityModelRenderer m_modelRenderer;
             bool m_boundsValid;
+            size_t m_modelGeneration;
             
             bool m_showOverlays;
             Color m_overlayTextColor;
@@ -31,6 +31,8 @@
 #include "Renderer/ShaderProgram.h"
 #include "Renderer/ShaderManager.h"
 
+#include <algorithm>
+
 namespace TrenchBroom {
     namespace Renderer {
         struct FaceRenderer::RenderFunc : public TextureRenderFunc {
@@ -66,8 +68,12 @@ namespace TrenchBroom {
         m_alpha(1.0f) {}
         
         FaceRenderer::FaceRenderer(BrushVertexArrayPtr vertexArray, TextureToBrushIndicesMapPtr indexArrayMap, const Color& faceColor) :
+        FaceRenderer(vertexArray, TextureToBrushIndicesMapList{ indexArrayMap }, faceColor) {}
+
+        FaceRenderer::FaceRenderer(BrushVertexArrayPtr vertexArray, TextureToBrushIndicesMapList indexArrayMaps, const Color& faceColor) :
         m_vertexArray(vertexArray),
-        m_indexArrayMap(indexArrayMap),
+        m_indexArrayMaps(std::move(indexArrayMaps)),
+        m_texturedIndices(mergeIndexArrays(m_indexArrayMaps)),
         m_faceColor(faceColor),
         m_grayscale(false),
         m_tint(false),
@@ -75,7 +81,8 @@ namespace TrenchBroom {
 
         FaceRenderer::FaceRenderer(const FaceRenderer& other) :
         m_vertexArray(other.m_vertexArray),
-        m_indexArrayMap(other.m_indexArrayMap),
+        m_indexArrayMaps(other.m_indexArrayMaps),
+        m_texturedIndices(other.m_texturedIndices),
         m_faceColor(other.m_faceColor),
         m_grayscale(other.m_grayscale),
         m_tint(other.m_tint),
@@ -91,7 +98,8 @@ namespace TrenchBroom {
         void swap(FaceRenderer& left, FaceRenderer& right)  {
             using std::swap;
             swap(left.m_vertexArray, right.m_vertexArray);
-            swap(left.m_indexArrayMap, right.m_indexArrayMap);
+            swap(left.m_indexArrayMaps, right.m_indexArrayMaps);
+            swap(left.m_texturedIndices, right.m_texturedIndices);
             swap(left.m_faceColor, right.m_faceColor);
             swap(left.m_grayscale, right.m_grayscale);
             swap(left.m_tint, right.m_tint);
@@ -99,6 +107,10 @@ namespace TrenchBroom {
             swap(left.m_alpha, right.m_alpha);
         }
 
+        void FaceRenderer::setFaceColor(const Color& faceColor) {
+            m_faceColor = faceColor;
+        }
+
         void FaceRenderer::setGrayscale(const bool grayscale) {
             m_grayscale = grayscale;
         }
@@ -122,14 +134,17 @@ namespace TrenchBroom {
         void FaceRenderer::prepareVerticesAndIndices(Vbo& vertexVbo, Vbo& indexVbo) {
             m_vertexArray->prepare(vertexVbo);
 
-            for (const auto& pair : *m_indexArrayMap) {
-                const auto& brushIndexHolderPtr = pair.second;
-                brushIndexHolderPtr->prepare(indexVbo);
+            for (const auto& indexArrayMap : m_indexArrayMaps) {
+                for (const auto& pair : *indexArrayMap) {
+                    const auto& brushIndexHolderPtr = pair.second;
+                    brushIndexHolderPtr->prepare(indexVbo);
+                }
             }
         }
         
         void FaceRenderer::doRender(RenderContext& context) {
-            if (m_indexArrayMap->empty())
+            const auto empty = [](const auto& pair) { return pair.second.empty(); };
+            if (std::all_of(std::begin(m_texturedIndices), std::end(m_texturedIndices), empty))
                 return;
 
             if (m_vertexArray->setupVertices()) {
@@ -162,13 +177,12 @@ namespace TrenchBroom {
                 if (m_alpha < 1.0f) {
                     glAssert(glDepthMask(GL_FALSE));
                 }
-                for (const auto& [texture, brushIndexHolderPtr] : *m_indexArrayMap) {
-                    if (brushIndexHolderPtr->empty()) {
-                        continue;
+                for (auto& [texture, indices] : m_texturedIndices) {
+                    if (!indices.empty()) {
+                        func.before(texture);
+                        indices.render(GL_TRIANGLES);
+                        func.after(texture);
                     }
-                    func.before(texture);
-                    brushIndexHolderPtr->render(GL_TRIANGLES);
-                    func.after(texture);
                 }
                 if (m_alpha < 1.0f) {
                     glAssert(glDepthMask(GL_TRUE));
@@ -176,5 +190,20 @@ namespace TrenchBroom {
                 m_vertexArray->cleanupVertices();
             }
         }
+
+        FaceRenderer::TexturedIndices FaceRenderer::mergeIndexArrays(const TextureToBrushIndicesMapList& indexArrayMaps) {
+            TexturedIndices result;
+            std::unordered_map<const Assets::Texture*, size_t> textureIndices;
+            for (const auto& indexArrayMap : indexArrayMaps) {
+                for (const auto& [texture, brushIndexHolderPtr] : *indexArrayMap) {
+                    const auto [it, inserted] = textureIndices.emplace(texture, result.size());
+                    if (inserted) {
+                        result.emplace_back(texture, MultiDrawIndices());
+                    }
+                    result[it->second].second.add(*brushIndexHolderPtr);
+                }
+            }
+            return result;
+        }
     }
 }
@@ -23,12 +23,15 @@
 #include "Color.h"
 #include "Assets/AssetTypes.h"
 #include "Model/BrushFace.h"
+#include "Renderer/BrushRendererArrays.h"
 #include "Renderer/Renderable.h"
 #include "Renderer/VertexArray.h"
 
 #include <map>
 #include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -42,13 +45,22 @@ namespace TrenchBroom {
         using BrushVertexArrayPtr = std::shared_ptr<BrushVertexArray>;
         using TextureToBrushIndicesMap = std::unordered_map<const Assets::Texture*, std::shared_ptr<BrushIndexArray>>;
         using TextureToBrushIndicesMapPtr = std::shared_ptr<const TextureToBrushIndicesMap>;
+        using TextureToBrushIndicesMapList = std::vector<TextureToBrushIndicesMapPtr>;
 
+        /**
+         * Renders the faces of several index array maps that refer to the same vertex array. The index arrays of all
+         * maps that belong to the same texture are merged when the renderer is created, so that every texture takes
+         * only one draw call. Every texture is still bound separately, so the number of draw calls grows with the
+         * number of textures.
+         */
         class FaceRenderer : public IndexedRenderable {
         private:
             struct RenderFunc;
+            using TexturedIndices = std::vector<std::pair<const Assets::Texture*, MultiDrawIndices>>;
 
             BrushVertexArrayPtr m_vertexArray;
-            TextureToBrushIndicesMapPtr m_indexArrayMap;
+            TextureToBrushIndicesMapList m_indexArrayMaps;
+            TexturedIndices m_texturedIndices;
             Color m_faceColor;
             bool m_grayscale;
             bool m_tint;
@@ -57,11 +69,13 @@ namespace TrenchBroom {
         public:
             FaceRenderer();
             FaceRenderer(BrushVertexArrayPtr vertexArray, TextureToBrushIndicesMapPtr indexArrayMap, const Color& faceColor);
+            FaceRenderer(BrushVertexArrayPtr vertexArray, TextureToBrushIndicesMapList indexArrayMaps, const Color& faceColor);
             
             FaceRenderer(const FaceRenderer& other);
             FaceRenderer& operator=(FaceRenderer other);
             friend void swap(FaceRenderer& left, FaceRenderer& right);
 
+            void setFaceColor(const Color& faceColor);
             void setGrayscale(bool grayscale);
             void setTint(bool tint);
             void setTintColor(const Color& color);
@@ -71,6 +85,8 @@ namespace TrenchBroom {
         private:
             void prepareVerticesAndIndices(Vbo& vertexVbo, Vbo& indexVbo) override;
             void doRender(RenderContext& context) override;
+
+            static TexturedIndices mergeIndexArrays(const TextureToBrushIndicesMapList& indexArrayMaps);
         };
 
         void swap(FaceRenderer& left, FaceRenderer& right);
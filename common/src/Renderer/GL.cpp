@@ -19,6 +19,15 @@
 
 #include "GL.h"
 
+#include <cmath>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
 namespace TrenchBroom {
     void glCheckError(const String& msg) {
         const GLenum error = glGetError();
@@ -52,6 +61,67 @@ namespace TrenchBroom {
         }
     }
 
+    GLhalf floatToHalf(const float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        const uint32_t sign = (bits >> 16) & 0x8000;
+        const uint32_t exponent = (bits >> 23) & 0xFF;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        // infinity and NaN
+        if (exponent == 0xFF)
+            return static_cast<GLhalf>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+
+        const int halfExponent = static_cast<int>(exponent) - 127 + 15;
+        if (halfExponent >= 0x1F)
+            return static_cast<GLhalf>(sign | 0x7C00);
+
+        if (halfExponent <= 0) {
+            // the result is a subnormal number or zero
+            if (halfExponent < -10)
+                return static_cast<GLhalf>(sign);
+
+            mantissa |= 0x800000;
+            const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+            const uint32_t remainder = mantissa & ((1u << shift) - 1);
+            const uint32_t halfway = 1u << (shift - 1);
+
+            uint32_t result = mantissa >> shift;
+            if (remainder > halfway || (remainder == halfway && (result & 1) != 0))
+                ++result;
+            return static_cast<GLhalf>(sign | result);
+        }
+
+        // rounding may carry into the exponent, which also yields the correct result for overflows
+        uint32_t result = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+        const uint32_t remainder = mantissa & 0x1FFF;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1) != 0))
+            ++result;
+        return static_cast<GLhalf>(sign | result);
+    }
+
+    float halfToFloat(const GLhalf value) {
+        const uint32_t sign = (static_cast<uint32_t>(value) & 0x8000) << 16;
+        const uint32_t exponent = (value >> 10) & 0x1F;
+        const uint32_t mantissa = value & 0x3FF;
+
+        if (exponent == 0) {
+            const float result = std::ldexp(static_cast<float>(mantissa), -24);
+            return sign != 0 ? -result : result;
+        }
+
+        uint32_t bits;
+        if (exponent == 0x1F)
+            bits = sign | 0x7F800000 | (mantissa << 13);
+        else
+            bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
     Func0<void> glewInitialize;
     
     Func0<GLenum> glGetError;
@@ -123,6 +193,12 @@ namespace TrenchBroom {
     Func6<void, GLenum, GLuint, GLuint, GLsizei, GLenum, const GLvoid*> glDrawRangeElements;
     Func5<void, GLenum, const GLsizei*, GLenum, const GLvoid**, GLsizei> glMultiDrawElements;
     
+    Func0<GLboolean> glInstancingSupported;
+    Func4<void, GLenum, GLint, GLsizei, GLsizei> glDrawArraysInstanced;
+    Func2<void, GLuint, GLuint> glVertexAttribDivisor;
+    
+    Func0<GLboolean> glHalfFloatVerticesSupported;
+    
     Func1<GLuint, GLenum> glCreateShader;
     Func1<void, GLuint> glDeleteShader;
     Func4<void, GLuint, GLsizei, const GLchar**, const GLint*> glShaderSource;
@@ -176,6 +252,7 @@ namespace TrenchBroom {
     Func4<void, GLint, GLsizei, GLboolean, const GLfloat*> glUniformMatrix4x3fv;
     
     Func2<GLint, GLuint, const GLchar*> glGetUniformLocation;
+    Func2<GLint, GLuint, const GLchar*> glGetAttribLocation;
     
 #ifdef __APPLE__
     Func2<void, GLenum, GLint> glFinishObjectAPPLE;
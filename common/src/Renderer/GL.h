@@ -99,6 +99,7 @@ namespace TrenchBroom {
 #define GL_UNSIGNED_INT 0x1405
 #define GL_FLOAT 0x1406
 #define GL_DOUBLE 0x140A
+#define GL_HALF_FLOAT 0x140B
 
 #define GL_MODELVIEW 0x1700
 #define GL_PROJECTION 0x1701
@@ -189,6 +190,7 @@ namespace TrenchBroom {
     typedef unsigned int GLuint;
     typedef unsigned long GLulong;
     
+    typedef unsigned short GLhalf;
     typedef float GLfloat;
     typedef double GLdouble;
     
@@ -207,6 +209,13 @@ namespace TrenchBroom {
     void glCheckError(const String& msg);
     String glGetErrorMessage(GLenum code);
 
+    /**
+     * Converts the given value to a 16 bit floating point number, rounding to the nearest representable value.
+     * Values that are too large are converted to infinity.
+     */
+    GLhalf floatToHalf(float value);
+    float halfToFloat(GLhalf value);
+
 // #define GL_DEBUG 1
 // #define GL_LOG 1
     
@@ -229,6 +238,7 @@ namespace TrenchBroom {
     template <> struct GLType<GL_UNSIGNED_INT>      { typedef GLuint    Type; };
     template <> struct GLType<GL_FLOAT>             { typedef GLfloat   Type; };
     template <> struct GLType<GL_DOUBLE>            { typedef GLdouble  Type; };
+    template <> struct GLType<GL_HALF_FLOAT>        { typedef GLhalf    Type; };
     
     template <typename T> struct GLEnum { static const GLenum Value = GL_INVALID_ENUM; };
     template <> struct GLEnum<GLbyte>   { static const GLenum Value = GL_BYTE; };
@@ -312,6 +322,20 @@ namespace TrenchBroom {
     extern Func4<void, GLenum, GLsizei, GLenum, const GLvoid*> glDrawElements;
     extern Func6<void, GLenum, GLuint, GLuint, GLsizei, GLenum, const GLvoid*> glDrawRangeElements;
     extern Func5<void, GLenum, const GLsizei*, GLenum, const GLvoid**, GLsizei> glMultiDrawElements;
+    
+    /**
+     * Instanced rendering requires the ARB_draw_instanced and ARB_instanced_arrays extensions. The functions below
+     * must only be called if glInstancingSupported returns true.
+     */
+    extern Func0<GLboolean> glInstancingSupported;
+    extern Func4<void, GLenum, GLint, GLsizei, GLsizei> glDrawArraysInstanced;
+    extern Func2<void, GLuint, GLuint> glVertexAttribDivisor;
+    
+    /**
+     * Vertex attributes of type GL_HALF_FLOAT require OpenGL 3.0 or the ARB_half_float_vertex extension. They must
+     * only be used if glHalfFloatVerticesSupported returns true.
+     */
+    extern Func0<GLboolean> glHalfFloatVerticesSupported;
 
     extern Func1<GLuint, GLenum> glCreateShader;
     extern Func1<void, GLuint> glDeleteShader;
@@ -366,6 +390,7 @@ namespace TrenchBroom {
     extern Func4<void, GLint, GLsizei, GLboolean, const GLfloat*> glUniformMatrix4x3fv;
     
     extern Func2<GLint, GLuint, const GLchar*> glGetUniformLocation;
+    extern Func2<GLint, GLuint, const GLchar*> glGetAttribLocation;
 
 #ifdef __APPLE__
     extern Func2<void, GLenum, GLint> glFinishObjectAPPLE;
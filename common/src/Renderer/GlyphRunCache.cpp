@@ -0,0 +1,72 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GlyphRunCache.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        GlyphRun::GlyphRun(const Vec2f::List& i_vertices, const Vec2f& i_size) :
+        vertices(i_vertices),
+        size(i_size) {}
+
+        const size_t GlyphRunCache::DefaultCapacity = 4096;
+
+        GlyphRunCache::GlyphRunCache(const size_t capacity) :
+        m_capacity(capacity) {
+            assert(m_capacity > 0);
+        }
+
+        GlyphRunPtr GlyphRunCache::find(const AttrString& string) {
+            const auto it = m_index.find(string);
+            if (it == std::end(m_index))
+                return nullptr;
+
+            m_entries.splice(std::begin(m_entries), m_entries, it->second);
+            return it->second->second;
+        }
+
+        GlyphRunPtr GlyphRunCache::insert(const AttrString& string, const GlyphRun& run) {
+            const auto it = m_index.find(string);
+            if (it != std::end(m_index)) {
+                m_entries.erase(it->second);
+                m_index.erase(it);
+            }
+
+            while (m_entries.size() >= m_capacity) {
+                m_index.erase(m_entries.back().first);
+                m_entries.pop_back();
+            }
+
+            m_entries.emplace_front(string, std::make_shared<const GlyphRun>(run));
+            m_index.insert(std::make_pair(string, std::begin(m_entries)));
+            return m_entries.front().second;
+        }
+
+        size_t GlyphRunCache::size() const {
+            return m_entries.size();
+        }
+
+        void GlyphRunCache::clear() {
+            m_entries.clear();
+            m_index.clear();
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_GlyphRunCache
+#define TrenchBroom_GlyphRunCache
+
+#include "VecMath.h"
+#include "AttrString.h"
+
+#include <list>
+#include <map>
+#include <memory>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        /**
+         * The laid out glyph quads of a string together with its measured size. The vertices alternate between
+         * positions and texture coordinates, as returned by TextureFont::quads.
+         */
+        struct GlyphRun {
+            Vec2f::List vertices;
+            Vec2f size;
+
+            GlyphRun(const Vec2f::List& i_vertices, const Vec2f& i_size);
+        };
+
+        using GlyphRunPtr = std::shared_ptr<const GlyphRun>;
+
+        /**
+         * Caches the glyph runs of the most recently used strings of a font. When the cache is full, the least
+         * recently used run is evicted. Evicted runs stay alive as long as they are referenced elsewhere.
+         */
+        class GlyphRunCache {
+        private:
+            using Entry = std::pair<AttrString, GlyphRunPtr>;
+            using EntryList = std::list<Entry>;
+            using EntryMap = std::map<AttrString, EntryList::iterator>;
+
+            size_t m_capacity;
+            EntryList m_entries;
+            EntryMap m_index;
+        public:
+            static const size_t DefaultCapacity;
+
+            explicit GlyphRunCache(size_t capacity = DefaultCapacity);
+
+            /**
+             * Returns the cached run of the given string and marks it as most recently used, or returns null if the
+             * string is not cached.
+             */
+            GlyphRunPtr find(const AttrString& string);
+            GlyphRunPtr insert(const AttrString& string, const GlyphRun& run);
+
+            size_t size() const;
+            void clear();
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_GlyphRunCache) */
@@ -19,6 +19,8 @@
 
 #include "IndexArray.h"
 
+#include "Renderer/Vbo.h"
+
 namespace TrenchBroom {
     namespace Renderer {
         void IndexArray::BaseHolder::render(const PrimType primType, const size_t offset, const size_t count) const {
@@ -61,8 +63,11 @@ namespace TrenchBroom {
         }
         
         void IndexArray::prepare(Vbo& vbo) {
-            if (!prepared() && !empty())
+            if (!prepared() && !empty()) {
+                // a holder that is shared with another array may outlive the current frame
+                StreamVboBlocks stream(vbo, vbo.streaming() && m_holder.use_count() == 1);
                 m_holder->prepare(vbo);
+            }
             m_prepared = true;
         }
 
@@ -22,6 +22,7 @@
 
 #include "CollectionUtils.h"
 #include "SharedPointer.h"
+#include "Renderer/DrawCallCounter.h"
 #include "Renderer/GL.h"
 #include "Renderer/Vbo.h"
 #include "Renderer/VboBlock.h"
@@ -99,7 +100,11 @@ namespace TrenchBroom {
                     const GLenum indexType     = glType<Index>();
                     const GLvoid* renderOffset = reinterpret_cast<GLvoid*>(indexOffset() + sizeof(Index) * offset);
 
+                    if (m_block != nullptr)
+                        m_block->bind();
+
                     glAssert(glDrawElements(primType, renderCount, indexType, renderOffset));
+                    DrawCallCounter::count();
                 }
             private:
                 virtual const IndexList& doGetIndices() const = 0;
@@ -118,5 +118,12 @@ namespace TrenchBroom {
                 vertexArray.render(primType, indicesAndCounts.indices, indicesAndCounts.counts, primCount);
             }
         }
+
+        void IndexRangeMap::renderInstanced(VertexArray& vertexArray, const size_t instanceCount) const {
+            // there is no instanced variant of glMultiDrawArrays, so every range is drawn separately
+            forEachRange([&](const PrimType primType, const size_t index, const size_t count) {
+                vertexArray.renderInstanced(primType, static_cast<GLint>(index), static_cast<GLsizei>(count), static_cast<GLsizei>(instanceCount));
+            });
+        }
     }
 }
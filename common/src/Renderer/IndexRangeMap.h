@@ -67,6 +67,24 @@ namespace TrenchBroom {
             void add(PrimType primType, size_t index, size_t count);
             
             void render(VertexArray& vertexArray) const;
+            void renderInstanced(VertexArray& vertexArray, size_t instanceCount) const;
+
+            /**
+             * Calls the given function with the primitive type, the index of the first vertex and the number of
+             * vertices of every range in this map.
+             */
+            template <typename F>
+            void forEachRange(F func) const {
+                for (const auto& entry : *m_data) {
+                    const PrimType primType = entry.first;
+                    const IndicesAndCounts& indicesAndCounts = entry.second;
+                    for (size_t i = 0; i < indicesAndCounts.size(); ++i) {
+                        func(primType,
+                             static_cast<size_t>(indicesAndCounts.indices[i]),
+                             static_cast<size_t>(indicesAndCounts.counts[i]));
+                    }
+                }
+            }
         };
     }
 }
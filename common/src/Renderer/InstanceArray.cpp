@@ -0,0 +1,178 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "InstanceArray.h"
+
+#include "Renderer/Vbo.h"
+#include "Renderer/VboBlock.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        InstanceArray::InstanceArray(const size_t vectorsPerInstance) :
+        m_vectorsPerInstance(vectorsPerInstance),
+        m_block(nullptr),
+        m_dirtyBegin(0),
+        m_dirtyEnd(0) {
+            assert(m_vectorsPerInstance > 0);
+        }
+        
+        InstanceArray::~InstanceArray() {
+            freeBlock();
+        }
+
+        bool InstanceArray::empty() const {
+            return m_keys.empty();
+        }
+
+        size_t InstanceArray::size() const {
+            return m_keys.size();
+        }
+
+        bool InstanceArray::contains(const Key key) const {
+            return m_indices.count(key) > 0;
+        }
+
+        const std::vector<InstanceArray::Key>& InstanceArray::keys() const {
+            return m_keys;
+        }
+
+        void InstanceArray::set(const Key key, const Vec4f* attributes) {
+            const auto it = m_indices.find(key);
+            if (it == std::end(m_indices)) {
+                const size_t index = m_keys.size();
+                m_keys.push_back(key);
+                m_indices.insert(std::make_pair(key, index));
+                m_data.insert(std::end(m_data), attributes, attributes + m_vectorsPerInstance);
+                markDirty(index);
+            } else {
+                const size_t index = it->second;
+                Vec4f* data = &m_data[index * m_vectorsPerInstance];
+                if (!std::equal(attributes, attributes + m_vectorsPerInstance, data)) {
+                    std::copy(attributes, attributes + m_vectorsPerInstance, data);
+                    markDirty(index);
+                }
+            }
+        }
+
+        void InstanceArray::remove(const Key key) {
+            const auto it = m_indices.find(key);
+            if (it == std::end(m_indices))
+                return;
+            
+            const size_t index = it->second;
+            const size_t last = m_keys.size() - 1;
+            m_indices.erase(it);
+            
+            if (index != last) {
+                const Key lastKey = m_keys[last];
+                m_keys[index] = lastKey;
+                m_indices[lastKey] = index;
+                std::copy(std::begin(m_data) + static_cast<std::ptrdiff_t>(last * m_vectorsPerInstance),
+                          std::begin(m_data) + static_cast<std::ptrdiff_t>((last + 1) * m_vectorsPerInstance),
+                          std::begin(m_data) + static_cast<std::ptrdiff_t>(index * m_vectorsPerInstance));
+                markDirty(index);
+            }
+            
+            m_keys.pop_back();
+            m_data.resize(m_keys.size() * m_vectorsPerInstance);
+            m_dirtyEnd = std::min(m_dirtyEnd, m_keys.size());
+            m_dirtyBegin = std::min(m_dirtyBegin, m_dirtyEnd);
+        }
+
+        void InstanceArray::clear() {
+            m_keys.clear();
+            m_indices.clear();
+            m_data.clear();
+            m_dirtyBegin = m_dirtyEnd = 0;
+        }
+
+        void InstanceArray::prepare(Vbo& vbo) {
+            if (empty())
+                return;
+            
+            const size_t instanceSize = m_vectorsPerInstance * sizeof(Vec4f);
+            const size_t sizeInBytes = m_keys.size() * instanceSize;
+            
+            ActivateVbo activate(vbo);
+            if (m_block == nullptr || m_block->capacity() < sizeInBytes) {
+                freeBlock();
+                
+                // the instances are kept across frames and must not be placed in the streaming ring buffer
+                StreamVboBlocks persistent(vbo, false);
+                m_block = vbo.allocateBlock(sizeInBytes);
+                m_dirtyBegin = 0;
+                m_dirtyEnd = m_keys.size();
+            }
+            
+            if (m_dirtyBegin < m_dirtyEnd) {
+                MapVboBlock map(m_block);
+                m_block->writeArray(m_dirtyBegin * instanceSize, &m_data[m_dirtyBegin * m_vectorsPerInstance], (m_dirtyEnd - m_dirtyBegin) * m_vectorsPerInstance);
+                m_dirtyBegin = m_dirtyEnd = 0;
+            }
+        }
+
+        void InstanceArray::setup(const AttributeLocations& locations) {
+            ensure(m_block != nullptr, "block is null");
+            assert(locations.size() == m_vectorsPerInstance);
+            m_block->bind();
+
+            const GLsizei stride = static_cast<GLsizei>(m_vectorsPerInstance * sizeof(Vec4f));
+            for (size_t i = 0; i < m_vectorsPerInstance; ++i) {
+                const GLuint index = locations[i];
+                const size_t offset = m_block->offset() + i * sizeof(Vec4f);
+                glAssert(glEnableVertexAttribArray(index));
+                glAssert(glVertexAttribPointer(index, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid*>(offset)));
+                glAssert(glVertexAttribDivisor(index, 1));
+            }
+        }
+
+        void InstanceArray::cleanup(const AttributeLocations& locations) {
+            assert(locations.size() == m_vectorsPerInstance);
+            for (const GLuint index : locations) {
+                glAssert(glVertexAttribDivisor(index, 0));
+                glAssert(glDisableVertexAttribArray(index));
+            }
+        }
+
+        InstanceArray::AttributeLocations InstanceArray::matrixLocations(const GLuint location) {
+            return AttributeLocations({ location, location + 1, location + 2, location + 3 });
+        }
+
+        void InstanceArray::markDirty(const size_t index) {
+            if (m_dirtyBegin == m_dirtyEnd) {
+                m_dirtyBegin = index;
+                m_dirtyEnd = index + 1;
+            } else {
+                m_dirtyBegin = std::min(m_dirtyBegin, index);
+                m_dirtyEnd = std::max(m_dirtyEnd, index + 1);
+            }
+        }
+
+        void InstanceArray::freeBlock() {
+            if (m_block != nullptr) {
+                m_block->free();
+                m_block = nullptr;
+            }
+        }
+    }
+}
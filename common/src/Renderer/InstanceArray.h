@@ -0,0 +1,98 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_InstanceArray
+#define TrenchBroom_InstanceArray
+
+#include "VecMath.h"
+#include "Renderer/GL.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class Vbo;
+        class VboBlock;
+        
+        /**
+         * Holds the per-instance vertex attributes for instanced rendering. Every instance consists of a fixed number
+         * of four component vectors and is identified by a key, e.g. the entity it is rendered for. The instances are
+         * stored contiguously in a VBO block. Only the instances that changed since the last upload are written to
+         * the block, and the block is only reallocated when it runs out of space.
+         */
+        class InstanceArray {
+        public:
+            using Key = const void*;
+            using AttributeLocations = std::vector<GLuint>;
+        private:
+            size_t m_vectorsPerInstance;
+            std::vector<Vec4f> m_data;
+            std::vector<Key> m_keys;
+            std::unordered_map<Key, size_t> m_indices;
+
+            VboBlock* m_block;
+            size_t m_dirtyBegin;
+            size_t m_dirtyEnd;
+        public:
+            explicit InstanceArray(size_t vectorsPerInstance);
+            ~InstanceArray();
+            
+            bool empty() const;
+            /**
+             * Returns the number of instances.
+             */
+            size_t size() const;
+            bool contains(Key key) const;
+            const std::vector<Key>& keys() const;
+            
+            /**
+             * Adds an instance with the given attributes or replaces the attributes of an existing instance. The
+             * instance is only uploaded again if its attributes changed.
+             */
+            void set(Key key, const Vec4f* attributes);
+            /**
+             * Removes the instance with the given key, if any. The last instance is moved into its place.
+             */
+            void remove(Key key);
+            void clear();
+
+            void prepare(Vbo& vbo);
+            /**
+             * Sets up one vertex attribute per vector of an instance at the given locations, and advances them once
+             * per instance.
+             */
+            void setup(const AttributeLocations& locations);
+            void cleanup(const AttributeLocations& locations);
+            
+            /**
+             * Returns the locations of the columns of the matrix attribute at the given location.
+             */
+            static AttributeLocations matrixLocations(GLuint location);
+        private:
+            void markDirty(size_t index);
+            void freeBlock();
+            
+            InstanceArray(const InstanceArray& other);
+            InstanceArray& operator=(const InstanceArray& other);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_InstanceArray) */
@@ -0,0 +1,125 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "InstancedBoxRenderer.h"
+
+#include "Renderer/Camera.h"
+#include "Renderer/RenderContext.h"
+#include "Renderer/Shaders.h"
+#include "Renderer/ShaderManager.h"
+#include "Renderer/VertexSpec.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        struct BuildUnitCubeVertices {
+            VertexSpecs::P3N::Vertex::List& vertices;
+            
+            BuildUnitCubeVertices(VertexSpecs::P3N::Vertex::List& i_vertices) :
+            vertices(i_vertices) {}
+            
+            void operator()(const Vec3f& v1, const Vec3f& v2, const Vec3f& v3, const Vec3f& v4, const Vec3f& n) {
+                vertices.push_back(VertexSpecs::P3N::Vertex(v1, n));
+                vertices.push_back(VertexSpecs::P3N::Vertex(v2, n));
+                vertices.push_back(VertexSpecs::P3N::Vertex(v3, n));
+                vertices.push_back(VertexSpecs::P3N::Vertex(v4, n));
+            }
+        };
+        
+        static VertexArray unitCube() {
+            VertexSpecs::P3N::Vertex::List vertices;
+            vertices.reserve(24);
+            
+            BuildUnitCubeVertices builder(vertices);
+            eachBBoxFace(BBox3f(Vec3f::Null, Vec3f(1.0f, 1.0f, 1.0f)), builder);
+            return VertexArray::swap(vertices);
+        }
+        
+        InstancedBoxRenderer::InstancedBoxRenderer() :
+        m_cube(unitCube()),
+        m_instances(3),
+        m_applyTinting(false) {}
+        
+        bool InstancedBoxRenderer::empty() const {
+            return m_instances.empty();
+        }
+        
+        const std::vector<InstancedBoxRenderer::Key>& InstancedBoxRenderer::keys() const {
+            return m_instances.keys();
+        }
+        
+        void InstancedBoxRenderer::setBox(const Key key, const BBox3& bounds, const Color& color) {
+            const Vec3f min(bounds.min);
+            const Vec3f size(bounds.size());
+            const Vec4f attributes[] = {
+                Vec4f(min, 1.0f),
+                Vec4f(size, 0.0f),
+                Vec4f(color.r(), color.g(), color.b(), color.a())
+            };
+            m_instances.set(key, attributes);
+        }
+        
+        void InstancedBoxRenderer::removeBox(const Key key) {
+            m_instances.remove(key);
+        }
+        
+        void InstancedBoxRenderer::clear() {
+            m_instances.clear();
+        }
+        
+        void InstancedBoxRenderer::setApplyTinting(const bool applyTinting) {
+            m_applyTinting = applyTinting;
+        }
+        
+        void InstancedBoxRenderer::setTintColor(const Color& tintColor) {
+            m_tintColor = tintColor;
+        }
+        
+        void InstancedBoxRenderer::doPrepareVertices(Vbo& vertexVbo) {
+            if (!m_instances.empty()) {
+                m_cube.prepare(vertexVbo);
+                m_instances.prepare(vertexVbo);
+            }
+        }
+        
+        void InstancedBoxRenderer::doRender(RenderContext& context) {
+            if (m_instances.empty())
+                return;
+            
+            ActiveShader shader(context.shaderManager(), Shaders::InstancedBoxShader);
+            shader.set("ApplyTinting", m_applyTinting);
+            shader.set("TintColor", m_tintColor);
+            shader.set("UseColor", false);
+            shader.set("Color", Color());
+            shader.set("CameraPosition", context.camera().position());
+            
+            const InstanceArray::AttributeLocations locations({
+                shader.attributeLocation("InstanceMin"),
+                shader.attributeLocation("InstanceSize"),
+                shader.attributeLocation("InstanceColor")
+            });
+            
+            if (m_cube.setup()) {
+                m_instances.setup(locations);
+                m_cube.renderInstanced(GL_QUADS, 0, static_cast<GLsizei>(m_cube.vertexCount()), static_cast<GLsizei>(m_instances.size()));
+                m_instances.cleanup(locations);
+                m_cube.cleanup();
+            }
+        }
+    }
+}
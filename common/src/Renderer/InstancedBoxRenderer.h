@@ -0,0 +1,70 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_InstancedBoxRenderer
+#define TrenchBroom_InstancedBoxRenderer
+
+#include "Color.h"
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Renderer/InstanceArray.h"
+#include "Renderer/Renderable.h"
+#include "Renderer/VertexArray.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class RenderContext;
+        
+        /**
+         * Renders solid axis aligned boxes with one instanced draw call. Every box is an instance of a unit cube that
+         * is scaled and moved to the box's bounds in the vertex shader, so adding, moving or removing a box only
+         * changes its instance attributes. Requires instancing support, see glInstancingSupported.
+         */
+        class InstancedBoxRenderer : public DirectRenderable {
+        private:
+            VertexArray m_cube;
+            InstanceArray m_instances;
+            
+            Color m_tintColor;
+            bool m_applyTinting;
+        public:
+            using Key = InstanceArray::Key;
+            
+            InstancedBoxRenderer();
+            
+            bool empty() const;
+            const std::vector<Key>& keys() const;
+            
+            void setBox(Key key, const BBox3& bounds, const Color& color);
+            void removeBox(Key key);
+            void clear();
+            
+            void setApplyTinting(bool applyTinting);
+            void setTintColor(const Color& tintColor);
+        private:
+            void doPrepareVertices(Vbo& vertexVbo) override;
+            void doRender(RenderContext& context) override;
+            
+            InstancedBoxRenderer(const InstancedBoxRenderer& other);
+            InstancedBoxRenderer& operator=(const InstancedBoxRenderer& other);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_InstancedBoxRenderer) */
@@ -25,6 +25,8 @@
 #include "Preferences.h"
 #include "Assets/EntityDefinitionManager.h"
 #include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/BrushGeometry.h"
 #include "Model/CollectMatchingNodesVisitor.h"
 #include "Model/EditorContext.h"
 #include "Model/Entity.h"
@@ -38,6 +40,7 @@
 #include "Renderer/Camera.h"
 #include "Renderer/EntityLinkRenderer.h"
 #include "Renderer/ObjectRenderer.h"
+#include "Renderer/OcclusionBuffer.h"
 #include "Renderer/RenderBatch.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/RenderService.h"
@@ -45,6 +48,7 @@
 #include "View/Selection.h"
 #include "View/MapDocument.h"
 
+#include <algorithm>
 #include <set>
 
 namespace TrenchBroom {
@@ -117,7 +121,9 @@ namespace TrenchBroom {
         m_defaultRenderer(createDefaultRenderer(m_document)),
         m_selectionRenderer(createSelectionRenderer(m_document)),
         m_lockedRenderer(createLockRenderer(m_document)),
-        m_entityLinkRenderer(new EntityLinkRenderer(m_document)) {
+        m_entityLinkRenderer(new EntityLinkRenderer(m_document)),
+        m_occlusionBuffer(new OcclusionBuffer()),
+        m_occludersValid(false) {
             bindObservers();
             setupRenderers();
         }
@@ -125,6 +131,7 @@ namespace TrenchBroom {
         MapRenderer::~MapRenderer() {
             unbindObservers();
             clear();
+            delete m_occlusionBuffer;
             delete m_entityLinkRenderer;
             delete m_lockedRenderer;
             delete m_selectionRenderer;
@@ -154,6 +161,7 @@ namespace TrenchBroom {
             m_selectionRenderer->clear();
             m_lockedRenderer->clear();
             m_entityLinkRenderer->invalidate();
+            invalidateOccluders();
         }
         
         void MapRenderer::overrideSelectionColors(const Color& color, const float mix) {
@@ -174,12 +182,20 @@ namespace TrenchBroom {
         void MapRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
             commitPendingChanges();
             setupGL(renderBatch);
+            setupBrushVertexFormat();
+
+            // the selection renderer shows occluded objects, so it must not cull them
+            const OcclusionBuffer* occlusionBuffer = updateOcclusionBuffer(renderContext);
+            renderContext.setOcclusionBuffer(occlusionBuffer);
             renderDefaultOpaque(renderContext, renderBatch);
             renderLockedOpaque(renderContext, renderBatch);
+            renderContext.setOcclusionBuffer(nullptr);
             renderSelectionOpaque(renderContext, renderBatch);
             
+            renderContext.setOcclusionBuffer(occlusionBuffer);
             renderDefaultTransparent(renderContext, renderBatch);
             renderLockedTransparent(renderContext, renderBatch);
+            renderContext.setOcclusionBuffer(nullptr);
             renderSelectionTransparent(renderContext, renderBatch);
             
             renderEntityLinks(renderContext, renderBatch);
@@ -241,6 +257,81 @@ namespace TrenchBroom {
         void MapRenderer::renderEntityLinks(RenderContext& renderContext, RenderBatch& renderBatch) {
             m_entityLinkRenderer->render(renderContext, renderBatch);
         }
+
+        class MapRenderer::CollectOccluders : public Model::NodeVisitor {
+        private:
+            /**
+             * Only brushes that are at least this large in two dimensions hide enough of the scene to be worth
+             * rasterizing.
+             */
+            static const FloatType MinSize;
+
+            const Model::EditorContext& m_editorContext;
+            Model::BrushList m_occluders;
+        public:
+            CollectOccluders(const Model::EditorContext& editorContext) : m_editorContext(editorContext) {}
+
+            const Model::BrushList& occluders() const { return m_occluders; }
+        private:
+            void doVisit(Model::World* world) override   {}
+            void doVisit(Model::Layer* layer) override   {}
+            void doVisit(Model::Group* group) override   {}
+            void doVisit(Model::Entity* entity) override {}
+
+            void doVisit(Model::Brush* brush) override   {
+                if (brush->selected() || brush->parentSelected() || brush->transparent() || !m_editorContext.visible(brush))
+                    return;
+
+                const Vec3 size = brush->bounds().size();
+                FloatType sizes[] = { size.x(), size.y(), size.z() };
+                std::sort(std::begin(sizes), std::end(sizes));
+                if (sizes[1] >= MinSize)
+                    m_occluders.push_back(brush);
+            }
+        };
+
+        const FloatType MapRenderer::CollectOccluders::MinSize = 128.0;
+
+        const OcclusionBuffer* MapRenderer::updateOcclusionBuffer(const RenderContext& renderContext) {
+            if (!renderContext.render3D() || !renderContext.showFaces() || !pref(Preferences::OcclusionCulling))
+                return nullptr;
+
+            View::MapDocumentSPtr document = lock(m_document);
+            const Model::EditorContext& editorContext = document->editorContext();
+            if (!m_occludersValid) {
+                CollectOccluders collect(editorContext);
+                document->world()->acceptAndRecurse(collect);
+                m_occluders = collect.occluders();
+                m_occludersValid = true;
+            }
+
+            const Camera& camera = renderContext.camera();
+            const Vec3 cameraPosition(camera.position());
+            m_occlusionBuffer->reset(camera);
+
+            Vec3f::List vertices;
+            for (const Model::Brush* brush : m_occluders) {
+                if (!camera.frustumIntersects(BBox3f(brush->bounds())))
+                    continue;
+
+                // the faces facing away from the camera are hidden by the others
+                for (const Model::BrushFace* face : brush->faces()) {
+                    if (face->boundary().pointStatus(cameraPosition) != Math::PointStatus::PSAbove)
+                        continue;
+
+                    vertices.clear();
+                    for (const Model::BrushVertex* vertex : face->vertices())
+                        vertices.push_back(Vec3f(vertex->position()));
+                    m_occlusionBuffer->addPolygon(vertices);
+                }
+            }
+            return m_occlusionBuffer;
+        }
+
+        void MapRenderer::invalidateOccluders() {
+            m_occludersValid = false;
+            m_occluders.clear();
+        }
         
         class MapRenderer::MatchTutorialEntities {
         private:
@@ -297,6 +388,15 @@ namespace TrenchBroom {
             setupEntityLinkRenderer();
         }
         
+        void MapRenderer::setupBrushVertexFormat() {
+            // compact vertices store their texture coordinates as half floats, which the GL might not support
+            const bool compact = pref(Preferences::CompactBrushVertices) && glHalfFloatVerticesSupported();
+            const BrushVertexFormat brushVertexFormat = compact ? BrushVertexFormat::Compact : BrushVertexFormat::Full;
+            m_defaultRenderer->setBrushVertexFormat(brushVertexFormat);
+            m_selectionRenderer->setBrushVertexFormat(brushVertexFormat);
+            m_lockedRenderer->setBrushVertexFormat(brushVertexFormat);
+        }
+        
         void MapRenderer::setupDefaultRenderer(ObjectRenderer* renderer) {
             renderer->setEntityOverlayTextColor(pref(Preferences::InfoOverlayTextColor));
             renderer->setGroupOverlayTextColor(pref(Preferences::GroupInfoOverlayTextColor));
@@ -435,9 +535,11 @@ namespace TrenchBroom {
                                              collect.lockedNodes().brushes());
             }
             invalidateEntityLinkRenderer();
+            invalidateOccluders();
         }
         
         void MapRenderer::invalidateRenderers(Renderer renderers) {
+            invalidateOccluders();
             if ((renderers & Renderer_Default) != 0)
                 m_defaultRenderer->invalidate();
             if ((renderers & Renderer_Selection) != 0)
@@ -447,6 +549,7 @@ namespace TrenchBroom {
         }
 
         void MapRenderer::invalidateBrushesInRenderers(Renderer renderers, const Model::BrushList& brushes) {
+            invalidateOccluders();
             if ((renderers & Renderer_Default) != 0) {
                 m_defaultRenderer->invalidateBrushes(brushes);
             }
@@ -38,6 +38,7 @@ namespace TrenchBroom {
     namespace Renderer {
         class EntityLinkRenderer;
         class FontManager;
+        class OcclusionBuffer;
         class ObjectRenderer;
         class RenderBatch;
         class RenderContext;
@@ -56,6 +57,10 @@ namespace TrenchBroom {
             ObjectRenderer* m_selectionRenderer;
             ObjectRenderer* m_lockedRenderer;
             EntityLinkRenderer* m_entityLinkRenderer;
+
+            OcclusionBuffer* m_occlusionBuffer;
+            Model::BrushList m_occluders;
+            bool m_occludersValid;
         public:
             MapRenderer(View::MapDocumentWPtr document);
             ~MapRenderer();
@@ -79,6 +84,15 @@ namespace TrenchBroom {
             void renderLockedOpaque(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderLockedTransparent(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderEntityLinks(RenderContext& renderContext, RenderBatch& renderBatch);
+
+            class CollectOccluders;
+
+            /**
+             * Rasterizes the occluders that are within the view frustum into the occlusion buffer, or returns null
+             * if occlusion culling does not apply to the given render context.
+             */
+            const OcclusionBuffer* updateOcclusionBuffer(const RenderContext& renderContext);
+            void invalidateOccluders();
             
             class MatchTutorialEntities;
             class FilterTutorialEntities;
@@ -90,6 +104,7 @@ namespace TrenchBroom {
             void setupSelectionRenderer(ObjectRenderer* renderer);
             void setupLockedRenderer(ObjectRenderer* renderer);
             void setupEntityLinkRenderer();
+            void setupBrushVertexFormat();
 
             typedef enum {
                 Renderer_Default            = 1,
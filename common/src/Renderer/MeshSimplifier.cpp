@@ -0,0 +1,208 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MeshSimplifier.h"
+
+#include "VecMath.h"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <tuple>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        void MeshSimplifier::addPrimitive(VertexList& triangles, const PrimType primType, const VertexList& vertices, const size_t index, const size_t count) {
+            assert(index + count <= vertices.size());
+
+            switch (primType) {
+                case GL_TRIANGLES:
+                    for (size_t i = 0; i + 2 < count; i += 3) {
+                        triangles.push_back(vertices[index + i + 0]);
+                        triangles.push_back(vertices[index + i + 1]);
+                        triangles.push_back(vertices[index + i + 2]);
+                    }
+                    break;
+                case GL_TRIANGLE_FAN:
+                case GL_POLYGON:
+                    for (size_t i = 1; i + 1 < count; ++i) {
+                        triangles.push_back(vertices[index]);
+                        triangles.push_back(vertices[index + i + 0]);
+                        triangles.push_back(vertices[index + i + 1]);
+                    }
+                    break;
+                case GL_TRIANGLE_STRIP:
+                    // every other triangle of a strip is flipped to keep the winding order consistent
+                    for (size_t i = 0; i + 2 < count; ++i) {
+                        const size_t first = i % 2 == 0 ? i : i + 1;
+                        const size_t second = i % 2 == 0 ? i + 1 : i;
+                        triangles.push_back(vertices[index + first]);
+                        triangles.push_back(vertices[index + second]);
+                        triangles.push_back(vertices[index + i + 2]);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        static BBox3f meshBounds(const MeshSimplifier::TexturedTriangles& mesh) {
+            BBox3f bounds;
+            bool first = true;
+            for (const auto& [texture, triangles] : mesh) {
+                for (const auto& vertex : triangles) {
+                    if (first) {
+                        bounds = BBox3f(vertex.v1, vertex.v1);
+                        first = false;
+                    } else {
+                        bounds.mergeWith(vertex.v1);
+                    }
+                }
+            }
+            return bounds;
+        }
+
+        static size_t cellIndex(const float value, const float min, const float cellSize, const size_t cellsPerAxis) {
+            const float cell = std::floor((value - min) / cellSize);
+            return std::min(cellsPerAxis - 1, static_cast<size_t>(std::max(0.0f, cell)));
+        }
+
+        MeshSimplifier::TexturedTriangles MeshSimplifier::simplify(const TexturedTriangles& mesh, const size_t cellsPerAxis) {
+            assert(cellsPerAxis > 0);
+
+            const BBox3f bounds = meshBounds(mesh);
+            const Vec3f cellSize = bounds.size() / static_cast<float>(cellsPerAxis);
+
+            struct Cluster {
+                Vec3f position;
+                size_t count;
+                Vec2f texCoords;
+            };
+
+            TexturedTriangles result;
+            for (const auto& [texture, triangles] : mesh) {
+                std::map<size_t, size_t> cellToCluster;
+                std::vector<Cluster> clusters;
+                std::vector<size_t> vertexToCluster;
+                vertexToCluster.reserve(triangles.size());
+
+                for (const auto& vertex : triangles) {
+                    size_t cell = 0;
+                    for (size_t i = 0; i < 3; ++i) {
+                        const float size = std::max(cellSize[i], std::numeric_limits<float>::epsilon());
+                        cell = cell * cellsPerAxis + cellIndex(vertex.v1[i], bounds.min[i], size, cellsPerAxis);
+                    }
+
+                    const auto [it, inserted] = cellToCluster.insert(std::make_pair(cell, clusters.size()));
+                    if (inserted) {
+                        clusters.push_back(Cluster{ vertex.v1, 1, vertex.v2 });
+                    } else {
+                        Cluster& cluster = clusters[it->second];
+                        cluster.position += vertex.v1;
+                        ++cluster.count;
+                    }
+                    vertexToCluster.push_back(it->second);
+                }
+
+                // keep every remaining triangle only once, regardless of which of its corners comes first
+                std::set<std::tuple<size_t, size_t, size_t>> keptTriangles;
+                VertexList simplified;
+                for (size_t i = 0; i + 2 < vertexToCluster.size(); i += 3) {
+                    const size_t c0 = vertexToCluster[i + 0];
+                    const size_t c1 = vertexToCluster[i + 1];
+                    const size_t c2 = vertexToCluster[i + 2];
+                    if (c0 == c1 || c1 == c2 || c2 == c0)
+                        continue;
+
+                    const auto key = c0 < c1 && c0 < c2 ? std::make_tuple(c0, c1, c2) :
+                                     c1 < c2 ? std::make_tuple(c1, c2, c0) : std::make_tuple(c2, c0, c1);
+                    if (!keptTriangles.insert(key).second)
+                        continue;
+
+                    for (const size_t c : { c0, c1, c2 }) {
+                        const Cluster& cluster = clusters[c];
+                        simplified.push_back(Vertex(cluster.position / static_cast<float>(cluster.count), cluster.texCoords));
+                    }
+                }
+
+                if (!simplified.empty())
+                    result[texture] = std::move(simplified);
+            }
+            return result;
+        }
+
+        MeshSimplifier::TexturedTriangles MeshSimplifier::boundingBox(const TexturedTriangles& mesh) {
+            const Assets::Texture* texture = nullptr;
+            const VertexList* vertices = nullptr;
+            for (const auto& entry : mesh) {
+                if (vertices == nullptr || entry.second.size() > vertices->size()) {
+                    texture = entry.first;
+                    vertices = &entry.second;
+                }
+            }
+
+            TexturedTriangles result;
+            if (vertices == nullptr || vertices->empty())
+                return result;
+
+            const BBox3f bounds = meshBounds(mesh);
+            const Vec3f center = bounds.center();
+
+            VertexList corners;
+            for (size_t i = 0; i < 8; ++i) {
+                const Vec3f position((i & 1) ? bounds.max.x() : bounds.min.x(),
+                                     (i & 2) ? bounds.max.y() : bounds.min.y(),
+                                     (i & 4) ? bounds.max.z() : bounds.min.z());
+
+                const auto closest = std::min_element(std::begin(*vertices), std::end(*vertices), [&](const Vertex& lhs, const Vertex& rhs) {
+                    return lhs.v1.squaredDistanceTo(position) < rhs.v1.squaredDistanceTo(position);
+                });
+                corners.push_back(Vertex(position, closest->v2));
+            }
+
+            // the corners of each side, where bit 0, 1 and 2 of a corner index select the max x, y and z coordinate
+            static const size_t Sides[6][4] = {
+                { 0, 2, 6, 4 }, { 1, 3, 7, 5 },
+                { 0, 1, 5, 4 }, { 2, 3, 7, 6 },
+                { 0, 1, 3, 2 }, { 4, 5, 7, 6 }
+            };
+
+            VertexList& triangles = result[texture];
+            for (const auto& side : Sides) {
+                for (const auto& triangle : { std::make_tuple(side[0], side[1], side[2]), std::make_tuple(side[0], side[2], side[3]) }) {
+                    const Vertex& v0 = corners[std::get<0>(triangle)];
+                    Vertex v1 = corners[std::get<1>(triangle)];
+                    Vertex v2 = corners[std::get<2>(triangle)];
+
+                    // the normal of a clockwise triangle points away from the viewer
+                    const Vec3f normal = crossed(v1.v1 - v0.v1, v2.v1 - v0.v1);
+                    const Vec3f outside = (v0.v1 + v1.v1 + v2.v1) / 3.0f - center;
+                    if (normal.dot(outside) > 0.0f)
+                        std::swap(v1, v2);
+
+                    triangles.push_back(v0);
+                    triangles.push_back(v1);
+                    triangles.push_back(v2);
+                }
+            }
+            return result;
+        }
+    }
+}
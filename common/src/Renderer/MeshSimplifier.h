@@ -0,0 +1,69 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MeshSimplifier
+#define TrenchBroom_MeshSimplifier
+
+#include "Renderer/GL.h"
+#include "Renderer/VertexSpec.h"
+
+#include <map>
+
+namespace TrenchBroom {
+    namespace Assets {
+        class Texture;
+    }
+
+    namespace Renderer {
+        /**
+         * Builds simplified versions of textured triangle meshes for rendering models at a lower level of detail.
+         */
+        class MeshSimplifier {
+        public:
+            using Vertex = VertexSpecs::P3T2::Vertex;
+            using VertexList = Vertex::List;
+            /**
+             * Maps each texture to a list of triangles, where every three consecutive vertices form a triangle.
+             */
+            using TexturedTriangles = std::map<const Assets::Texture*, VertexList>;
+
+            /**
+             * Appends the triangles of the given primitive to the given triangle list. Primitives that are not made
+             * of triangles are ignored.
+             */
+            static void addPrimitive(VertexList& triangles, PrimType primType, const VertexList& vertices, size_t index, size_t count);
+
+            /**
+             * Simplifies the given mesh by vertex clustering. A grid with the given number of cells per axis is laid
+             * over the bounds of the mesh, and the vertices in each cell that share a texture are merged into one
+             * vertex at their average position. Triangles that collapse are removed.
+             */
+            static TexturedTriangles simplify(const TexturedTriangles& mesh, size_t cellsPerAxis);
+
+            /**
+             * Returns the bounding box of the given mesh as a mesh of twelve triangles. The box is textured with the
+             * texture that covers the most triangles, and every corner takes the texture coordinates of the closest
+             * vertex with that texture. The triangles are wound clockwise when viewed from outside.
+             */
+            static TexturedTriangles boundingBox(const TexturedTriangles& mesh);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MeshSimplifier) */
@@ -133,6 +133,10 @@ namespace TrenchBroom {
             m_brushRenderer.setEdgeColor(brushEdgeColor);
         }
         
+        void ObjectRenderer::setBrushVertexFormat(const BrushVertexFormat vertexFormat) {
+            m_brushRenderer.setVertexFormat(vertexFormat);
+        }
+
         void ObjectRenderer::setShowHiddenObjects(const bool showHiddenObjects) {
             m_entityRenderer.setShowHiddenEntities(showHiddenObjects);
             m_brushRenderer.setShowHiddenBrushes(showHiddenObjects);
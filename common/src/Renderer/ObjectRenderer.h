@@ -78,6 +78,7 @@ namespace TrenchBroom {
             void setShowBrushEdges(bool showBrushEdges);
             void setBrushFaceColor(const Color& brushFaceColor);
             void setBrushEdgeColor(const Color& brushEdgeColor);
+            void setBrushVertexFormat(BrushVertexFormat vertexFormat);
             
             void setShowHiddenObjects(bool showHiddenObjects);
         public: // rendering
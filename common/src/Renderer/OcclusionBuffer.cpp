@@ -0,0 +1,279 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OcclusionBuffer.h"
+
+#include "Renderer/Camera.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        const size_t OcclusionBuffer::Width = 256;
+        const size_t OcclusionBuffer::Height = 128;
+        const float OcclusionBuffer::GuardBand = 2.0f;
+
+        OcclusionBuffer::Level::Level(const size_t i_width, const size_t i_height) :
+        width(i_width),
+        height(i_height),
+        depths(width * height, 1.0f) {}
+
+        float& OcclusionBuffer::Level::at(const size_t x, const size_t y) {
+            assert(x < width && y < height);
+            return depths[y * width + x];
+        }
+
+        float OcclusionBuffer::Level::at(const size_t x, const size_t y) const {
+            assert(x < width && y < height);
+            return depths[y * width + x];
+        }
+
+        OcclusionBuffer::OcclusionBuffer() :
+        m_transformation(Mat4x4f::Identity),
+        m_valid(true),
+        m_empty(true) {
+            size_t width = Width;
+            size_t height = Height;
+            m_levels.push_back(Level(width, height));
+            while (width > 1 || height > 1) {
+                width = (width + 1) / 2;
+                height = (height + 1) / 2;
+                m_levels.push_back(Level(width, height));
+            }
+        }
+
+        void OcclusionBuffer::reset(const Camera& camera) {
+            m_transformation = camera.projectionMatrix() * camera.viewMatrix();
+
+            Level& level = m_levels.front();
+            std::fill(std::begin(level.depths), std::end(level.depths), 1.0f);
+            m_valid = false;
+            m_empty = true;
+        }
+
+        void OcclusionBuffer::addPolygon(const Vec3f::List& vertices) {
+            if (vertices.size() < 3)
+                return;
+
+            ClipVertexList clipVertices;
+            clipVertices.reserve(vertices.size());
+            for (const Vec3f& vertex : vertices)
+                clipVertices.push_back(m_transformation * Vec4f(vertex, 1.0f));
+
+            // clipping against a guard band around the viewport keeps the window coordinates small enough for the
+            // edge functions to be precise
+            const Vec4f planes[] = {
+                Vec4f( 0.0f,  0.0f, 1.0f, 1.0f),
+                Vec4f( 1.0f,  0.0f, 0.0f, GuardBand),
+                Vec4f(-1.0f,  0.0f, 0.0f, GuardBand),
+                Vec4f( 0.0f,  1.0f, 0.0f, GuardBand),
+                Vec4f( 0.0f, -1.0f, 0.0f, GuardBand)
+            };
+
+            for (size_t i = 0; i < 5 && clipVertices.size() >= 3; ++i)
+                clipVertices = clip(clipVertices, planes[i]);
+            if (clipVertices.size() < 3)
+                return;
+
+            Vec3f::List windowVertices;
+            windowVertices.reserve(clipVertices.size());
+            for (const Vec4f& clipVertex : clipVertices)
+                windowVertices.push_back(toWindow(clipVertex));
+            rasterizePolygon(windowVertices);
+        }
+
+        bool OcclusionBuffer::occluded(const BBox3f& bounds) const {
+            if (m_empty)
+                return false;
+
+            float minX = std::numeric_limits<float>::max();
+            float minY = std::numeric_limits<float>::max();
+            float minZ = std::numeric_limits<float>::max();
+            float maxX = -std::numeric_limits<float>::max();
+            float maxY = -std::numeric_limits<float>::max();
+
+            for (size_t i = 0; i < 8; ++i) {
+                const Vec3f corner((i & 1) != 0 ? bounds.max.x() : bounds.min.x(),
+                                   (i & 2) != 0 ? bounds.max.y() : bounds.min.y(),
+                                   (i & 4) != 0 ? bounds.max.z() : bounds.min.z());
+                const Vec4f clipCorner = m_transformation * Vec4f(corner, 1.0f);
+
+                // the box reaches in front of the near plane, so it cannot be behind any occluder
+                if (clipCorner.z() < -clipCorner.w())
+                    return false;
+
+                const Vec3f window = toWindow(clipCorner);
+                minX = std::min(minX, window.x());
+                minY = std::min(minY, window.y());
+                minZ = std::min(minZ, window.z());
+                maxX = std::max(maxX, window.x());
+                maxY = std::max(maxY, window.y());
+            }
+
+            // boxes outside of the viewport are left to frustum culling
+            if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>(Width) || minY >= static_cast<float>(Height))
+                return false;
+
+            validate();
+
+            const size_t x0 = static_cast<size_t>(std::max(0.0f, std::floor(minX)));
+            const size_t y0 = static_cast<size_t>(std::max(0.0f, std::floor(minY)));
+            const size_t x1 = std::min(Width - 1, static_cast<size_t>(std::floor(maxX)));
+            const size_t y1 = std::min(Height - 1, static_cast<size_t>(std::floor(maxY)));
+
+            // find the level at which the box covers at most 4x4 pixels
+            size_t index = 0;
+            while (index + 1 < m_levels.size() && ((x1 >> index) - (x0 >> index) > 3 || (y1 >> index) - (y0 >> index) > 3))
+                ++index;
+
+            const Level& level = m_levels[index];
+            for (size_t y = (y0 >> index); y <= (y1 >> index); ++y) {
+                for (size_t x = (x0 >> index); x <= (x1 >> index); ++x) {
+                    if (level.at(x, y) >= minZ)
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        OcclusionBuffer::ClipVertexList OcclusionBuffer::clip(const ClipVertexList& vertices, const Vec4f& plane) {
+            ClipVertexList result;
+            result.reserve(vertices.size() + 1);
+
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                const Vec4f& current = vertices[i];
+                const Vec4f& next = vertices[(i + 1) % vertices.size()];
+                const float currentDistance = current.dot(plane);
+                const float nextDistance = next.dot(plane);
+
+                if (currentDistance >= 0.0f)
+                    result.push_back(current);
+                if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f)) {
+                    const float t = currentDistance / (currentDistance - nextDistance);
+                    result.push_back(current + t * (next - current));
+                }
+            }
+            return result;
+        }
+
+        Vec3f OcclusionBuffer::toWindow(const Vec4f& clipVertex) const {
+            const float w = clipVertex.w();
+            return Vec3f((clipVertex.x() / w + 1.0f) * 0.5f * static_cast<float>(Width),
+                         (clipVertex.y() / w + 1.0f) * 0.5f * static_cast<float>(Height),
+                         clipVertex.z() / w);
+        }
+
+        void OcclusionBuffer::rasterizePolygon(const Vec3f::List& vertices) {
+            const size_t count = vertices.size();
+
+            // the normal of the polygon's plane in window coordinates by Newell's method, its z component is twice
+            // the signed area of the polygon
+            Vec3f normal;
+            float minX = std::numeric_limits<float>::max();
+            float minY = std::numeric_limits<float>::max();
+            float maxX = -std::numeric_limits<float>::max();
+            float maxY = -std::numeric_limits<float>::max();
+            for (size_t i = 0; i < count; ++i) {
+                const Vec3f& current = vertices[i];
+                const Vec3f& next = vertices[(i + 1) % count];
+                normal[0] += (current.y() - next.y()) * (current.z() + next.z());
+                normal[1] += (current.z() - next.z()) * (current.x() + next.x());
+                normal[2] += (current.x() - next.x()) * (current.y() + next.y());
+                minX = std::min(minX, current.x());
+                minY = std::min(minY, current.y());
+                maxX = std::max(maxX, current.x());
+                maxY = std::max(maxY, current.y());
+            }
+
+            if (std::abs(normal.z()) < 0.01f)
+                return;
+
+            const float x0 = std::max(0.0f, std::ceil(minX));
+            const float y0 = std::max(0.0f, std::ceil(minY));
+            const float x1 = std::min(static_cast<float>(Width),  std::floor(maxX));
+            const float y1 = std::min(static_cast<float>(Height), std::floor(maxY));
+            if (x0 >= x1 || y0 >= y1)
+                return;
+
+            // the edge functions are a * (x - x0) + b * (y - y0) and are not negative within the polygon
+            const float orientation = normal.z() > 0.0f ? 1.0f : -1.0f;
+            EdgeList edges;
+            edges.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                const Vec3f& from = vertices[i];
+                const Vec3f& to = vertices[(i + 1) % count];
+
+                Edge edge;
+                edge.a = orientation * (from.y() - to.y());
+                edge.b = orientation * (to.x() - from.x());
+                edge.x = from.x() - (edge.a < 0.0f ? 1.0f : 0.0f);
+                edge.y = from.y() - (edge.b < 0.0f ? 1.0f : 0.0f);
+                edges.push_back(edge);
+            }
+
+            // the depth is linear in window coordinates, so its greatest value within a pixel is at one of its corners
+            const Vec3f& origin = vertices.front();
+            const float dzdx = -normal.x() / normal.z();
+            const float dzdy = -normal.y() / normal.z();
+            const float depthX = origin.x() - (dzdx > 0.0f ? 1.0f : 0.0f);
+            const float depthY = origin.y() - (dzdy > 0.0f ? 1.0f : 0.0f);
+
+            Level& level = m_levels.front();
+            for (float y = y0; y < y1; y += 1.0f) {
+                for (float x = x0; x < x1; x += 1.0f) {
+                    bool covered = true;
+                    for (auto it = std::begin(edges), end = std::end(edges); it != end && covered; ++it)
+                        covered = it->a * (x - it->x) + it->b * (y - it->y) >= 0.0f;
+
+                    if (covered) {
+                        const float depth = origin.z() + dzdx * (x - depthX) + dzdy * (y - depthY);
+                        float& current = level.at(static_cast<size_t>(x), static_cast<size_t>(y));
+                        if (depth < current) {
+                            current = depth;
+                            m_valid = false;
+                            m_empty = false;
+                        }
+                    }
+                }
+            }
+        }
+
+        void OcclusionBuffer::validate() const {
+            if (m_valid)
+                return;
+
+            for (size_t i = 1; i < m_levels.size(); ++i) {
+                const Level& source = m_levels[i - 1];
+                Level& target = m_levels[i];
+                for (size_t y = 0; y < target.height; ++y) {
+                    for (size_t x = 0; x < target.width; ++x) {
+                        const size_t sx = std::min(2 * x + 1, source.width - 1);
+                        const size_t sy = std::min(2 * y + 1, source.height - 1);
+                        target.at(x, y) = std::max(std::max(source.at(2 * x, 2 * y), source.at(sx, 2 * y)),
+                                                   std::max(source.at(2 * x, sy), source.at(sx, sy)));
+                    }
+                }
+            }
+            m_valid = true;
+        }
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_OcclusionBuffer
+#define TrenchBroom_OcclusionBuffer
+
+#include "VecMath.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class Camera;
+
+        /**
+         * A coarse depth buffer that is rasterized on the CPU from a few large occluders and that is used to find
+         * out whether a bounding box is hidden behind them before it is drawn.
+         *
+         * The occluders are rasterized conservatively: a pixel is only written if it is completely covered by an
+         * occluder, and it receives the greatest depth of the occluder within the pixel. From the resulting buffer,
+         * a pyramid of successively smaller buffers is built in which every pixel stores the greatest depth of the
+         * four pixels that it covers in the next larger buffer. A bounding box is tested on the level at which its
+         * projection covers only a few pixels, and it is considered occluded only if its nearest point lies behind
+         * all of them. Therefore, a box is never reported as occluded unless it is actually hidden.
+         *
+         * All depth values are normalized device coordinates, so that the buffer only depends on the camera's
+         * matrices and not on an OpenGL context.
+         */
+        class OcclusionBuffer {
+        public:
+            static const size_t Width;
+            static const size_t Height;
+        private:
+            static const float GuardBand;
+
+            typedef std::vector<float> DepthList;
+            typedef std::vector<Vec4f> ClipVertexList;
+
+            struct Level {
+                size_t width;
+                size_t height;
+                DepthList depths;
+
+                Level(size_t i_width, size_t i_height);
+
+                float& at(size_t x, size_t y);
+                float at(size_t x, size_t y) const;
+            };
+
+            typedef std::vector<Level> LevelList;
+
+            struct Edge {
+                float a;
+                float b;
+                float x;
+                float y;
+            };
+
+            typedef std::vector<Edge> EdgeList;
+
+            Mat4x4f m_transformation;
+            mutable LevelList m_levels;
+            mutable bool m_valid;
+            bool m_empty;
+        public:
+            OcclusionBuffer();
+
+            /**
+             * Removes all occluders and sets up the buffer to rasterize occluders as seen by the given camera.
+             */
+            void reset(const Camera& camera);
+
+            /**
+             * Rasterizes the given convex polygon with the given vertices in world coordinates. The parts of the
+             * polygon that lie in front of the near plane or far outside of the viewport are clipped away.
+             */
+            void addPolygon(const Vec3f::List& vertices);
+
+            /**
+             * Indicates whether the given bounding box is entirely hidden behind the occluders that were added
+             * since the last call to reset.
+             */
+            bool occluded(const BBox3f& bounds) const;
+        private:
+            /**
+             * Clips the given polygon in clip coordinates against the given plane and keeps the part for which
+             * the dot product with the plane is not negative.
+             */
+            static ClipVertexList clip(const ClipVertexList& vertices, const Vec4f& plane);
+            Vec3f toWindow(const Vec4f& clipVertex) const;
+            void rasterizePolygon(const Vec3f::List& vertices);
+
+            void validate() const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_OcclusionBuffer) */
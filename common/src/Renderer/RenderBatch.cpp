@@ -53,6 +53,7 @@ namespace TrenchBroom {
         RenderBatch::~RenderBatch() {
             ListUtils::clearAndDelete(m_oneshots);
             ListUtils::clearAndDelete(m_indexedRenderables);
+            ListUtils::clearAndDelete(m_oneshotIndexedRenderables);
         }
         
         void RenderBatch::add(Renderable* renderable) {
@@ -77,7 +78,7 @@ namespace TrenchBroom {
 
         void RenderBatch::addOneShot(DirectRenderable* renderable) {
             doAdd(renderable);
-            m_directRenderables.push_back(renderable);
+            m_oneshotDirectRenderables.push_back(renderable);
             m_oneshots.push_back(renderable);
         }
         
@@ -85,7 +86,7 @@ namespace TrenchBroom {
             IndexedRenderableWrapper* wrapper = new IndexedRenderableWrapper(m_indexVbo, renderable);
 
             doAdd(wrapper);
-            m_indexedRenderables.push_back(wrapper);
+            m_oneshotIndexedRenderables.push_back(wrapper);
             m_oneshots.push_back(renderable);
         }
         
@@ -111,6 +112,16 @@ namespace TrenchBroom {
             for (IndexedRenderable* renderable : m_indexedRenderables) {
                 renderable->prepareVerticesAndIndices(m_vertexVbo, m_indexVbo);
             }
+
+            StreamVboBlocks streamVertices(m_vertexVbo);
+            StreamVboBlocks streamIndices(m_indexVbo);
+
+            for (DirectRenderable* renderable : m_oneshotDirectRenderables) {
+                renderable->prepareVertices(m_vertexVbo);
+            }
+            for (IndexedRenderable* renderable : m_oneshotIndexedRenderables) {
+                renderable->prepareVerticesAndIndices(m_vertexVbo, m_indexVbo);
+            }
         }
 
         void RenderBatch::renderRenderables(RenderContext& renderContext) {
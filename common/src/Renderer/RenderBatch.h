@@ -47,6 +47,13 @@ namespace TrenchBroom {
             
             DirectRenderableList m_directRenderables;
             IndexedRenderableList m_indexedRenderables;
+
+            /**
+             * The one shot renderables are deleted together with this batch, so their vertices and indices are
+             * uploaded into the streaming ring buffers of the VBOs.
+             */
+            DirectRenderableList m_oneshotDirectRenderables;
+            IndexedRenderableList m_oneshotIndexedRenderables;
             
             RenderableList m_batch;
             RenderableList m_oneshots;
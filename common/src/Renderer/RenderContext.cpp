@@ -44,7 +44,8 @@ namespace TrenchBroom {
         m_gridSize(4),
         m_hideSelection(false),
         m_tintSelection(true),
-        m_showSelectionGuide(ShowSelectionGuide_Hide) {}
+        m_showSelectionGuide(ShowSelectionGuide_Hide),
+        m_occlusionBuffer(nullptr) {}
         
         bool RenderContext::render2D() const {
             return m_renderMode == RenderMode_2D;
@@ -209,7 +210,15 @@ namespace TrenchBroom {
         void RenderContext::setForceHideSelectionGuide() {
             setShowSelectionGuide(ShowSelectionGuide_ForceHide);
         }
-        
+
+        const OcclusionBuffer* RenderContext::occlusionBuffer() const {
+            return m_occlusionBuffer;
+        }
+
+        void RenderContext::setOcclusionBuffer(const OcclusionBuffer* occlusionBuffer) {
+            m_occlusionBuffer = occlusionBuffer;
+        }
+
         void RenderContext::setShowSelectionGuide(const ShowSelectionGuide showSelectionGuide) {
             switch (showSelectionGuide) {
                 case ShowSelectionGuide_Show:
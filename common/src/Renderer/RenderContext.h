@@ -31,6 +31,7 @@ namespace TrenchBroom {
     namespace Renderer {
         class Camera;
         class FontManager;
+        class OcclusionBuffer;
         class Renderable;
         class ShaderManager;
         
@@ -78,6 +79,8 @@ namespace TrenchBroom {
             bool m_tintSelection;
             
             ShowSelectionGuide m_showSelectionGuide;
+
+            const OcclusionBuffer* m_occlusionBuffer;
         public:
             RenderContext(RenderMode renderMode, const Camera& camera, FontManager& fontManager, ShaderManager& shaderManager);
 
@@ -139,6 +142,13 @@ namespace TrenchBroom {
             void setHideSelectionGuide();
             void setForceShowSelectionGuide();
             void setForceHideSelectionGuide();
+
+            /**
+             * The occlusion buffer against which renderers may test the bounds of their objects before they render
+             * them, or null if occlusion culling is disabled.
+             */
+            const OcclusionBuffer* occlusionBuffer() const;
+            void setOcclusionBuffer(const OcclusionBuffer* occlusionBuffer);
         private:
             void setShowSelectionGuide(ShowSelectionGuide showSelectionGuide);
         private:
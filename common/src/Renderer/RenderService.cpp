@@ -103,6 +103,10 @@ namespace TrenchBroom {
             m_cullingPolicy = PrimitiveRenderer::CP_CullBackfaces;
         }
 
+        void RenderService::setCullOverlappingStrings(const bool cullOverlappingStrings) {
+            m_textRenderer->setCullOverlappingStrings(cullOverlappingStrings);
+        }
+
         void RenderService::renderString(const AttrString& string, const Vec3f& position) {
             renderString(string, SimpleTextAnchor(position, TextAlignment::Bottom, Vec2f(0.0f, 16.0f)));
         }
@@ -71,6 +71,8 @@ namespace TrenchBroom {
             void setShowBackfaces();
             void setCullBackfaces();
             
+            void setCullOverlappingStrings(bool cullOverlappingStrings);
+            
             void renderString(const AttrString& string, const Vec3f& position);
             void renderString(const AttrString& string, const TextAnchor& position);
             void renderHeadsUp(const AttrString& string);
@@ -83,5 +83,9 @@ namespace TrenchBroom {
         ActiveShader::~ActiveShader() {
             m_program.deactivate();
         }
+
+        GLuint ActiveShader::attributeLocation(const String& name) const {
+            return m_program.attributeLocation(name);
+        }
     }
 }
@@ -64,6 +64,8 @@ namespace TrenchBroom {
             void set(const String& name, const T& value) {
                 m_program.set(name, value);
             }
+            
+            GLuint attributeLocation(const String& name) const;
         };
     }
 }
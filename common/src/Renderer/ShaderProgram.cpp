@@ -152,6 +152,7 @@ namespace TrenchBroom {
             }
 
             m_variableCache.clear();
+            m_attributeCache.clear();
             m_needsLinking = false;
         }
 
@@ -168,6 +169,20 @@ namespace TrenchBroom {
             return it->second;
         }
 
+        GLuint ShaderProgram::attributeLocation(const String& name) const {
+            assert(checkActive());
+            UniformVariableCache::iterator it = m_attributeCache.find(name);
+            if (it == std::end(m_attributeCache)) {
+                const GLint index = glGetAttribLocation(m_programId, name.c_str());
+                if (index == -1)
+                    throw RenderException("Location of attribute '" + name + "' could not be found in shader program " + m_name);
+                
+                m_attributeCache[name] = index;
+                return static_cast<GLuint>(index);
+            }
+            return static_cast<GLuint>(it->second);
+        }
+
         bool ShaderProgram::checkActive() const {
             GLint currentProgramId = -1;
             glAssert(glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgramId));
@@ -39,6 +39,7 @@ namespace TrenchBroom {
             GLuint m_programId;
             bool m_needsLinking;
             mutable UniformVariableCache m_variableCache;
+            mutable UniformVariableCache m_attributeCache;
         public:
             ShaderProgram(const String& name);
             ~ShaderProgram();
@@ -60,6 +61,12 @@ namespace TrenchBroom {
             void set(const String& name, const Mat2x2f& value);
             void set(const String& name, const Mat3x3f& value);
             void set(const String& name, const Mat4x4f& value);
+            
+            /**
+             * Returns the location of the vertex attribute with the given name. A matrix attribute occupies one
+             * location per column, starting at the returned location.
+             */
+            GLuint attributeLocation(const String& name) const;
         private:
             void link();
             GLint findUniformLocation(const String& name) const;
@@ -29,6 +29,7 @@ namespace TrenchBroom {
             const ShaderConfig VaryingPUniformCShader     = ShaderConfig("Varying Position / Uniform Color", "VaryingPUniformC.vertsh",     "VaryingPC.fragsh");
             const ShaderConfig MiniMapEdgeShader          = ShaderConfig("MiniMap Edges",                    "MiniMapEdge.vertsh",          "MiniMapEdge.fragsh");
             const ShaderConfig EntityModelShader          = ShaderConfig("Entity Model",                     "EntityModel.vertsh",          "EntityModel.fragsh");
+            const ShaderConfig InstancedEntityModelShader = ShaderConfig("Instanced Entity Model",           "InstancedEntityModel.vertsh", "EntityModel.fragsh");
             const ShaderConfig FaceShader                 = ShaderConfig("Face",                             "Face.vertsh",                 VectorUtils::create<String>("Grid.fragsh", "Face.fragsh"));
             const ShaderConfig ColoredTextShader          = ShaderConfig("Colored Text",                     "ColoredText.vertsh",          "Text.fragsh");
             const ShaderConfig TextShader                 = ShaderConfig("Text",                             "Text.vertsh",                 "Text.fragsh");
@@ -43,6 +44,7 @@ namespace TrenchBroom {
             const ShaderConfig EntityLinkShader           = ShaderConfig("Entity Link",                      "EntityLink.vertsh",           "EntityLink.fragsh");
             const ShaderConfig EntityLinkArrowShader      = ShaderConfig("Entity Link Arrow",                "EntityLinkArrow.vertsh",      "EntityLinkArrow.fragsh");
             const ShaderConfig TriangleShader             = ShaderConfig("Shaded Triangles",                 "Triangle.vertsh",             "Triangle.fragsh");
+            const ShaderConfig InstancedBoxShader         = ShaderConfig("Instanced Boxes",                  "InstancedBox.vertsh",         "Triangle.fragsh");
             const ShaderConfig UVViewShader               = ShaderConfig("UV View",                          "UVView.vertsh",               "UVView.fragsh");
         }
     }
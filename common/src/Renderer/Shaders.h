@@ -30,6 +30,7 @@ namespace TrenchBroom {
             extern const ShaderConfig VaryingPUniformCShader;
             extern const ShaderConfig MiniMapEdgeShader;
             extern const ShaderConfig EntityModelShader;
+            extern const ShaderConfig InstancedEntityModelShader;
             extern const ShaderConfig FaceShader;
             extern const ShaderConfig ColoredTextShader;
             extern const ShaderConfig TextBackgroundShader;
@@ -43,6 +44,7 @@ namespace TrenchBroom {
             extern const ShaderConfig EntityLinkShader;
             extern const ShaderConfig EntityLinkArrowShader;
             extern const ShaderConfig TriangleShader;
+            extern const ShaderConfig InstancedBoxShader;
             extern const ShaderConfig UVViewShader;
         }
     }
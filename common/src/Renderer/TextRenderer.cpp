@@ -30,6 +30,10 @@
 #include "Renderer/TextAnchor.h"
 #include "Renderer/TextureFont.h"
 
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
 namespace TrenchBroom {
     namespace Renderer {
         const float TextRenderer::DefaultMaxViewDistance = 768.0f;
@@ -38,14 +42,13 @@ namespace TrenchBroom {
         const size_t TextRenderer::RectCornerSegments = 3;
         const float TextRenderer::RectCornerRadius = 3.0f;
         
-        TextRenderer::Entry::Entry(Vec2f::List& i_vertices, const Vec2f& i_size, const Vec3f& i_offset, const Color& i_textColor, const Color& i_backgroundColor) :
-        size(i_size),
+        TextRenderer::Entry::Entry(GlyphRunPtr i_run, const Vec3f& i_offset, const float i_distance, const bool i_cullIfOverlapping, const Color& i_textColor, const Color& i_backgroundColor) :
+        run(std::move(i_run)),
         offset(i_offset),
+        distance(i_distance),
+        cullIfOverlapping(i_cullIfOverlapping),
         textColor(i_textColor),
-        backgroundColor(i_backgroundColor) {
-            using std::swap;
-            swap(vertices, i_vertices);
-        }
+        backgroundColor(i_backgroundColor) {}
 
         TextRenderer::EntryCollection::EntryCollection() :
         textVertexCount(0),
@@ -55,7 +58,8 @@ namespace TrenchBroom {
         m_fontDescriptor(fontDescriptor),
         m_maxViewDistance(maxViewDistance),
         m_minZoomFactor(minZoomFactor),
-        m_inset(inset) {}
+        m_inset(inset),
+        m_cullOverlappingStrings(false) {}
 
         void TextRenderer::renderString(RenderContext& renderContext, const Color& textColor, const Color& backgroundColor, const AttrString& string, const TextAnchor& position) {
             renderString(renderContext, textColor, backgroundColor, string, position, false);
@@ -65,6 +69,10 @@ namespace TrenchBroom {
             renderString(renderContext, textColor, backgroundColor, string, position, true);
         }
 
+        void TextRenderer::setCullOverlappingStrings(const bool cullOverlappingStrings) {
+            m_cullOverlappingStrings = cullOverlappingStrings;
+        }
+
         void TextRenderer::renderString(RenderContext& renderContext, const Color& textColor, const Color& backgroundColor, const AttrString& string, const TextAnchor& position, const bool onTop) {
             
             const Camera& camera = renderContext.camera();
@@ -72,47 +80,50 @@ namespace TrenchBroom {
             if (distance <= 0.0f)
                 return;
             
-            if (!isVisible(renderContext, string, position, distance, onTop))
+            // check the distance first so that strings which are too far away are never laid out
+            const bool fade = !onTop || m_cullOverlappingStrings;
+            if (fade && !isInRange(renderContext, distance))
                 return;
             
             FontManager& fontManager = renderContext.fontManager();
             TextureFont& font = fontManager.font(m_fontDescriptor);
 
-            Vec2f::List vertices = font.quads(string, true);
-            const float alphaFactor = computeAlphaFactor(renderContext, distance, onTop);
-            const Vec2f size = font.measure(string);
-            const Vec3f offset = position.offset(camera, size);
+            GlyphRunPtr run = font.glyphRun(string);
+            if (!isInViewport(renderContext, position, run->size.rounded()))
+                return;
             
+            const float alphaFactor = computeAlphaFactor(renderContext, distance, fade);
+            const Vec3f offset = position.offset(camera, run->size);
+            
+            const Entry entry(std::move(run), offset, distance, m_cullOverlappingStrings,
+                              Color(textColor, alphaFactor * textColor.a()),
+                              Color(backgroundColor, alphaFactor * backgroundColor.a()));
             if (onTop)
-                addEntry(m_entriesOnTop, Entry(vertices, size, offset,
-                                               Color(textColor, alphaFactor * textColor.a()),
-                                               Color(backgroundColor, alphaFactor * backgroundColor.a())));
+                addEntry(m_entriesOnTop, entry);
             else
-                addEntry(m_entries, Entry(vertices, size, offset,
-                                          Color(textColor, alphaFactor * textColor.a()),
-                                          Color(backgroundColor, alphaFactor * backgroundColor.a())));
+                addEntry(m_entries, entry);
         }
 
-        bool TextRenderer::isVisible(RenderContext& renderContext, const AttrString& string, const TextAnchor& position, const float distance, const bool onTop) const {
-            if (!onTop) {
-                if (renderContext.render3D() && distance > m_maxViewDistance)
-                    return false;
-                if (renderContext.render2D() && renderContext.camera().zoom() < m_minZoomFactor)
-                    return false;
-            }
-            
+        bool TextRenderer::isInRange(const RenderContext& renderContext, const float distance) const {
+            if (renderContext.render3D() && distance > m_maxViewDistance)
+                return false;
+            if (renderContext.render2D() && renderContext.camera().zoom() < m_minZoomFactor)
+                return false;
+            return true;
+        }
+
+        bool TextRenderer::isInViewport(const RenderContext& renderContext, const TextAnchor& position, const Vec2f& size) const {
             const Camera& camera = renderContext.camera();
             const Camera::Viewport& viewport = camera.unzoomedViewport();
             
-            const Vec2f size = stringSize(renderContext, string);
             const Vec2f offset = Vec2f(position.offset(camera, size)) - m_inset;
             const Vec2f actualSize = size + 2.0f * m_inset;
             
             return viewport.contains(offset.x(), offset.y(), actualSize.x(), actualSize.y());
         }
 
-        float TextRenderer::computeAlphaFactor(const RenderContext& renderContext, const float distance, const bool onTop) const {
-            if (onTop)
+        float TextRenderer::computeAlphaFactor(const RenderContext& renderContext, const float distance, const bool fade) const {
+            if (!fade)
                 return 1.0f;
 
             if (renderContext.render3D()) {
@@ -131,16 +142,10 @@ namespace TrenchBroom {
         
         void TextRenderer::addEntry(EntryCollection& collection, const Entry& entry) {
             collection.entries.push_back(entry);
-            collection.textVertexCount += entry.vertices.size();
+            collection.textVertexCount += entry.run->vertices.size() / 2;
             collection.rectVertexCount += roundedRect2DVertexCount(RectCornerSegments);
         }
         
-        Vec2f TextRenderer::stringSize(RenderContext& renderContext, const AttrString& string) const {
-            FontManager& fontManager = renderContext.fontManager();
-            TextureFont& font = fontManager.font(m_fontDescriptor);
-            return font.measure(string).rounded();
-        }
-
         void TextRenderer::doPrepareVertices(Vbo& vertexVbo) {
             prepare(m_entries, false, vertexVbo);
             prepare(m_entriesOnTop, true, vertexVbo);
@@ -153,8 +158,11 @@ namespace TrenchBroom {
             RectVertex::List rectVertices;
             rectVertices.reserve(collection.rectVertexCount);
             
-            for (const Entry& entry : collection.entries)
-                addEntry(entry, onTop, textVertices, rectVertices);
+            const std::vector<bool> visible = selectVisibleEntries(collection.entries);
+            for (size_t i = 0; i < collection.entries.size(); ++i) {
+                if (visible[i])
+                    addEntry(collection.entries[i], onTop, textVertices, rectVertices);
+            }
             
             collection.textArray = VertexArray::swap(textVertices);
             collection.rectArray = VertexArray::swap(rectVertices);
@@ -163,9 +171,104 @@ namespace TrenchBroom {
             collection.rectArray.prepare(vbo);
         }
 
+        /**
+         * Buckets the screen space rectangles of the accepted strings into a coarse grid so that the overlap tests
+         * only need to look at the rectangles in the cells covered by the tested rectangle.
+         */
+        class ScreenRectGrid {
+        private:
+            static const float CellSize;
+
+            using Rect = std::pair<Vec2f, Vec2f>;
+            using CellKey = std::pair<int, int>;
+            using CellMap = std::map<CellKey, std::vector<size_t>>;
+
+            std::vector<Rect> m_rects;
+            CellMap m_cells;
+        public:
+            bool intersects(const Vec2f& min, const Vec2f& max) const {
+                const auto [x0, y0, x1, y1] = cellRange(min, max);
+                for (int x = x0; x <= x1; ++x) {
+                    for (int y = y0; y <= y1; ++y) {
+                        const auto it = m_cells.find(CellKey(x, y));
+                        if (it == std::end(m_cells))
+                            continue;
+                        for (const size_t index : it->second) {
+                            const Rect& rect = m_rects[index];
+                            if (min.x() < rect.second.x() && rect.first.x() < max.x() &&
+                                min.y() < rect.second.y() && rect.first.y() < max.y())
+                                return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+            void insert(const Vec2f& min, const Vec2f& max) {
+                const size_t index = m_rects.size();
+                m_rects.push_back(Rect(min, max));
+
+                const auto [x0, y0, x1, y1] = cellRange(min, max);
+                for (int x = x0; x <= x1; ++x) {
+                    for (int y = y0; y <= y1; ++y)
+                        m_cells[CellKey(x, y)].push_back(index);
+                }
+            }
+        private:
+            static std::tuple<int, int, int, int> cellRange(const Vec2f& min, const Vec2f& max) {
+                return std::make_tuple(static_cast<int>(std::floor(min.x() / CellSize)),
+                                       static_cast<int>(std::floor(min.y() / CellSize)),
+                                       static_cast<int>(std::floor(max.x() / CellSize)),
+                                       static_cast<int>(std::floor(max.y() / CellSize)));
+            }
+        };
+
+        const float ScreenRectGrid::CellSize = 64.0f;
+
+        std::vector<bool> TextRenderer::selectVisibleEntries(const EntryList& entries) const {
+            std::vector<bool> result(entries.size(), true);
+
+            std::vector<size_t> cullable;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (entries[i].cullIfOverlapping)
+                    cullable.push_back(i);
+            }
+
+            if (cullable.empty())
+                return result;
+
+            ScreenRectGrid grid;
+            const auto rectMin = [&](const Entry& entry) { return Vec2f(entry.offset) - m_inset; };
+            const auto rectMax = [&](const Entry& entry) { return Vec2f(entry.offset) + entry.run->size + m_inset; };
+
+            // strings that must not be culled are always shown and hide the cullable strings which they overlap
+            for (const Entry& entry : entries) {
+                if (!entry.cullIfOverlapping)
+                    grid.insert(rectMin(entry), rectMax(entry));
+            }
+
+            // closer strings win over farther ones
+            std::stable_sort(std::begin(cullable), std::end(cullable), [&](const size_t lhs, const size_t rhs) {
+                return entries[lhs].distance < entries[rhs].distance;
+            });
+
+            for (const size_t i : cullable) {
+                const Entry& entry = entries[i];
+                const Vec2f min = rectMin(entry);
+                const Vec2f max = rectMax(entry);
+                if (grid.intersects(min, max)) {
+                    result[i] = false;
+                } else {
+                    grid.insert(min, max);
+                }
+            }
+
+            return result;
+        }
+
         void TextRenderer::addEntry(const Entry& entry, const bool onTop, TextVertex::List& textVertices, RectVertex::List& rectVertices) {
-            const Vec2f::List& stringVertices = entry.vertices;
-            const Vec2f& stringSize = entry.size;
+            const Vec2f::List& stringVertices = entry.run->vertices;
+            const Vec2f& stringSize = entry.run->size;
             
             const Vec3f& offset = entry.offset;
             
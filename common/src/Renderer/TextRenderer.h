@@ -23,6 +23,7 @@
 #include "VecMath.h"
 #include "Color.h"
 #include "Renderer/FontDescriptor.h"
+#include "Renderer/GlyphRunCache.h"
 #include "Renderer/Renderable.h"
 #include "Renderer/VertexArray.h"
 #include "Renderer/VertexSpec.h"
@@ -46,13 +47,14 @@ namespace TrenchBroom {
             static const float RectCornerRadius;
             
             struct Entry {
-                Vec2f::List vertices;
-                Vec2f size;
+                GlyphRunPtr run;
                 Vec3f offset;
+                float distance;
+                bool cullIfOverlapping;
                 Color textColor;
                 Color backgroundColor;
 
-                Entry(Vec2f::List& i_vertices, const Vec2f& i_size, const Vec3f& i_offset, const Color& i_textColor, const Color& i_backgroundColor);
+                Entry(GlyphRunPtr i_run, const Vec3f& i_offset, float i_distance, bool i_cullIfOverlapping, const Color& i_textColor, const Color& i_backgroundColor);
             };
             
             typedef std::vector<Entry> EntryList;
@@ -75,6 +77,7 @@ namespace TrenchBroom {
             float m_maxViewDistance;
             float m_minZoomFactor;
             Vec2f m_inset;
+            bool m_cullOverlappingStrings;
             
             EntryCollection m_entries;
             EntryCollection m_entriesOnTop;
@@ -83,17 +86,24 @@ namespace TrenchBroom {
             
             void renderString(RenderContext& renderContext, const Color& textColor, const Color& backgroundColor, const AttrString& string, const TextAnchor& position);
             void renderStringOnTop(RenderContext& renderContext, const Color& textColor, const Color& backgroundColor, const AttrString& string, const TextAnchor& position);
+
+            /**
+             * If enabled, the strings rendered from now on are faded out with their distance even if they are rendered
+             * on top, and they are dropped if they overlap a closer string on the screen. This is meant for large
+             * numbers of labels, such as entity classnames.
+             */
+            void setCullOverlappingStrings(bool cullOverlappingStrings);
         private:
             void renderString(RenderContext& renderContext, const Color& textColor, const Color& backgroundColor, const AttrString& string, const TextAnchor& position, bool onTop);
             
-            bool isVisible(RenderContext& renderContext, const AttrString& string, const TextAnchor& position, float distance, bool onTop) const;
-            float computeAlphaFactor(const RenderContext& renderContext, float distance, bool onTop) const;
+            bool isInRange(const RenderContext& renderContext, float distance) const;
+            bool isInViewport(const RenderContext& renderContext, const TextAnchor& position, const Vec2f& size) const;
+            float computeAlphaFactor(const RenderContext& renderContext, float distance, bool fade) const;
             void addEntry(EntryCollection& collection, const Entry& entry);
-            
-            Vec2f stringSize(RenderContext& renderContext, const AttrString& string) const;
         private:
             void doPrepareVertices(Vbo& vertexVbo) override;
             void prepare(EntryCollection& collection, bool onTop, Vbo& vbo);
+            std::vector<bool> selectVisibleEntries(const EntryList& entries) const;
             
             void addEntry(const Entry& entry, bool onTop, TextVertex::List& textVertices, RectVertex::List& rectVertices);
             
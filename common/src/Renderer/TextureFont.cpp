@@ -166,6 +166,13 @@ namespace TrenchBroom {
             return measureString.size();
         }
 
+        GlyphRunPtr TextureFont::glyphRun(const AttrString& string) {
+            GlyphRunPtr result = m_glyphRuns.find(string);
+            if (result == nullptr)
+                result = m_glyphRuns.insert(string, GlyphRun(quads(string, true), measure(string)));
+            return result;
+        }
+
         Vec2f::List TextureFont::quads(const String& string, const bool clockwise, const Vec2f& offset) {
             Vec2f::List result;
             result.reserve(string.length() * 4 * 2);
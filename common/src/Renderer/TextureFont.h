@@ -25,6 +25,7 @@
 #include "FreeType.h"
 #include "Renderer/FontGlyph.h"
 #include "Renderer/FontGlyphBuilder.h"
+#include "Renderer/GlyphRunCache.h"
 
 #include <vector>
 
@@ -41,6 +42,8 @@ namespace TrenchBroom {
             
             unsigned char m_firstChar;
             unsigned char m_charCount;
+
+            GlyphRunCache m_glyphRuns;
         public:
             TextureFont(FontTexture* texture, const FontGlyph::List& glyphs, size_t lineHeight, unsigned char firstChar, unsigned char charCount);
             ~TextureFont();
@@ -48,6 +51,12 @@ namespace TrenchBroom {
             Vec2f::List quads(const AttrString& string, bool clockwise, const Vec2f& offset = Vec2f::Null);
             Vec2f measure(const AttrString& string);
 
+            /**
+             * Returns the clockwise quads and the size of the given string. The result is cached, so repeatedly
+             * laying out the same strings, e.g. the labels of entities, is cheap.
+             */
+            GlyphRunPtr glyphRun(const AttrString& string);
+
             Vec2f::List quads(const String& string, bool clockwise, const Vec2f& offset = Vec2f::Null);
             Vec2f measure(const String& string);
             
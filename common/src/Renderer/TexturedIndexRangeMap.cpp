@@ -102,6 +102,18 @@ namespace TrenchBroom {
             }
         }
 
+        void TexturedIndexRangeMap::renderInstanced(VertexArray& vertexArray, const size_t instanceCount) {
+            DefaultTextureRenderFunc func;
+            for (const auto& entry : *m_data) {
+                const Texture* texture = entry.first;
+                const IndexRangeMap& indexArray = entry.second;
+
+                func.before(texture);
+                indexArray.renderInstanced(vertexArray, instanceCount);
+                func.after(texture);
+            }
+        }
+
         IndexRangeMap& TexturedIndexRangeMap::findCurrent(const Texture* texture) {
             if (!isCurrent(texture))
                 m_current = m_data->find(texture);
@@ -19,6 +19,8 @@
 
 #include "TexturedIndexRangeRenderer.h"
 
+#include "Renderer/InstanceArray.h"
+
 namespace TrenchBroom {
     namespace Renderer {
         TexturedIndexRangeRenderer::TexturedIndexRangeRenderer() {}
@@ -52,5 +54,17 @@ namespace TrenchBroom {
                 m_vertexArray.cleanup();
             }
         }
+
+        void TexturedIndexRangeRenderer::renderInstanced(InstanceArray& instances, const std::vector<GLuint>& locations) {
+            if (instances.empty())
+                return;
+            
+            if (m_vertexArray.setup()) {
+                instances.setup(locations);
+                m_indexRange.renderInstanced(m_vertexArray, instances.size());
+                instances.cleanup(locations);
+                m_vertexArray.cleanup();
+            }
+        }
     }
 }
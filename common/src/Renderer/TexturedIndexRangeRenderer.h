@@ -29,6 +29,7 @@ namespace TrenchBroom {
     }
     
     namespace Renderer {
+        class InstanceArray;
         class Vbo;
         class TextureRenderFunc;
         
@@ -46,6 +47,11 @@ namespace TrenchBroom {
             void prepare(Vbo& vbo);
             void render();
             void render(TextureRenderFunc& func);
+            /**
+             * Renders the model once for every instance in the given array. The per-instance attributes are bound to
+             * the vertex attributes at the given locations.
+             */
+            void renderInstanced(InstanceArray& instances, const std::vector<GLuint>& locations);
         };
     }
 }
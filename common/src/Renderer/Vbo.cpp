@@ -24,15 +24,10 @@
 
 #include <algorithm>
 #include <cassert>
+#include <limits>
 
 namespace TrenchBroom {
     namespace Renderer {
-        bool CompareVboBlocksByCapacity::operator() (const VboBlock* lhs, const VboBlock* rhs) const {
-            ensure(lhs != nullptr, "lhs is null");
-            ensure(rhs != nullptr, "rhs is null");
-            return lhs->capacity() < rhs->capacity();
-        }
-
         ActivateVbo::ActivateVbo(Vbo& vbo) :
         m_vbo(vbo),
         m_wasActive(m_vbo.active()) {
@@ -45,66 +40,74 @@ namespace TrenchBroom {
                 m_vbo.deactivate();
         }
 
-        const float Vbo::GrowthFactor = 1.5f;
+        StreamVboBlocks::StreamVboBlocks(Vbo& vbo, const bool streaming) :
+        m_vbo(vbo),
+        m_wasStreaming(m_vbo.m_streaming) {
+            m_vbo.m_streaming = streaming;
+        }
+
+        StreamVboBlocks::~StreamVboBlocks() {
+            m_vbo.m_streaming = m_wasStreaming;
+        }
+
+        Vbo::Arena::Arena(const size_t i_capacity) :
+        id(0),
+        capacity(i_capacity),
+        used(0) {}
+
+        const size_t Vbo::MinBlockSize = 64;
+        const size_t Vbo::NoArena = std::numeric_limits<size_t>::max();
 
         Vbo::Vbo(const size_t initialCapacity, const GLenum type, const GLenum usage) :
+        m_initialCapacity(initialCapacity),
         m_totalCapacity(initialCapacity),
-        m_freeCapacity(m_totalCapacity),
-        m_firstBlock(nullptr),
-        m_lastBlock(nullptr),
+        m_freeCapacity(initialCapacity),
+        m_currentArena(0),
+        m_boundArena(NoArena),
+        m_streamCapacity(initialCapacity / 4),
+        m_streamArena(NoArena),
+        m_streamHead(0),
+        m_streaming(false),
         m_state(State_Inactive),
         m_type(type),
-        m_usage(usage),
-        m_vboId(0) {
-            m_lastBlock = m_firstBlock = new VboBlock(*this, 0, m_totalCapacity, nullptr, nullptr);
-            m_freeBlocks.push_back(m_firstBlock);
-            assert(checkBlockChain());
+        m_usage(usage) {
+            // the buffer of the first arena is created when the VBO is activated for the first time
+            m_arenas.push_back(Arena(m_initialCapacity));
         }
         
         Vbo::~Vbo() {
             if (active())
                 deactivate();
             free();
-            
-            auto* block = m_firstBlock;
-            while (block != nullptr) {
-                auto* next = block->next();
+
+            for (VboBlock* block : m_blocks)
                 delete block;
-                block = next;
-            }
-            
-            m_lastBlock = m_firstBlock = nullptr;
+            m_blocks.clear();
         }
         
         VboBlock* Vbo::allocateBlock(const size_t capacity) {
-            assert(checkBlockChain());
-
             if (!active()) {
                 VboException e;
                 e << "Vbo is inactive";
                 throw e;
             }
 
-            auto it = findFreeBlock(capacity);
-            if (it == std::end(m_freeBlocks)) {
-                increaseCapacityToAccomodate(capacity);
-                it = findFreeBlock(capacity);
+            if (m_streaming) {
+                auto* block = allocateStreamedBlock(capacity);
+                if (block != nullptr)
+                    return block;
             }
-            
-            assert(it != std::end(m_freeBlocks));
-            auto* block = *it;
-            ensure(block != nullptr, "block is null");
-            removeFreeBlock(it);
-            
-            if (block->capacity() > capacity) {
-                auto* remainder = block->split(capacity);
-                if (m_lastBlock == block)
-                    m_lastBlock = remainder;
-                insertFreeBlock(remainder);
+
+            const auto sizeClass = Vbo::sizeClass(capacity);
+            auto* block = takeFreeBlock(sizeClass);
+            if (block != nullptr) {
+                block->m_capacity = capacity;
+                block->setFree(false);
+                m_freeCapacity -= sizeOfClass(sizeClass);
+                return block;
             }
-            
-            assert(checkBlockChain());
-            return block;
+
+            return allocateFromArena(capacity, sizeClass);
         }
 
         bool Vbo::active() const {
@@ -113,167 +116,221 @@ namespace TrenchBroom {
         
         void Vbo::activate() {
             assert(!active());
-            
-            if (m_vboId == 0) {
-                glAssert(glGenBuffers(1, &m_vboId));
-                glAssert(glBindBuffer(m_type, m_vboId));
-                glAssert(glBufferData(m_type, static_cast<GLsizeiptr>(m_totalCapacity), nullptr, m_usage));
-            } else {
-                glAssert(glBindBuffer(m_type, m_vboId));
-            }
+
+            m_boundArena = NoArena;
+            if (m_arenas.front().id == 0)
+                createBuffer(0);
+            else
+                bindArena(0);
             m_state = State_Active;
         }
         
         void Vbo::deactivate() {
             assert(active());
-            assert(!fullyMapped());
             assert(!partiallyMapped());
             glAssert(glBindBuffer(m_type, 0));
+            m_boundArena = NoArena;
             m_state = State_Inactive;
         }
+
+        bool Vbo::streaming() const {
+            return m_streaming;
+        }
+
+        size_t Vbo::totalCapacity() const {
+            return m_totalCapacity;
+        }
+
+        size_t Vbo::freeCapacity() const {
+            return m_freeCapacity;
+        }
+
+        size_t Vbo::arenaCount() const {
+            return m_arenas.size();
+        }
         
         GLenum Vbo::type() const {
             return m_type;
         }
 
         void Vbo::free() {
-            if (m_vboId > 0) {
-                glAssert(glDeleteBuffers(1, &m_vboId));
-                m_vboId = 0;
+            for (Arena& arena : m_arenas) {
+                if (arena.id > 0) {
+                    glAssert(glDeleteBuffers(1, &arena.id));
+                    arena.id = 0;
+                }
             }
         }
 
         void Vbo::freeBlock(VboBlock* block) {
             ensure(block != nullptr, "block is null");
             assert(!block->isFree());
-            assert(checkBlockChain());
-            
-            auto* previous = block->previous();
-            auto* next = block->next();
-            
-            if (previous != nullptr && previous->isFree() &&
-                next != nullptr && next->isFree()) {
-                removeFreeBlock(previous);
-                removeFreeBlock(next);
-                previous->mergeWithSuccessor();
-                previous->mergeWithSuccessor();
-                if (m_lastBlock == next)
-                    m_lastBlock = previous;
-                delete block;
-                delete next;
-                insertFreeBlock(previous);
-            } else if (previous != nullptr && previous->isFree()) {
-                removeFreeBlock(previous);
-                previous->mergeWithSuccessor();
-                if (m_lastBlock == block)
-                    m_lastBlock = previous;
-                delete block;
-                insertFreeBlock(previous);
-            } else if (next != nullptr && next->isFree()) {
-                removeFreeBlock(next);
-                block->mergeWithSuccessor();
-                if (m_lastBlock == next)
-                    m_lastBlock = block;
-                delete next;
-                insertFreeBlock(block);
+
+            if (block->m_streamed) {
+                freeStreamedBlock(block);
             } else {
+                block->setFree(true);
                 insertFreeBlock(block);
+                m_freeCapacity += sizeOfClass(block->m_sizeClass);
             }
-            assert(checkBlockChain());
         }
 
-        void Vbo::increaseCapacityToAccomodate(const size_t capacity) {
-            auto newMinCapacity = m_totalCapacity + capacity;
-            if (m_lastBlock->isFree())
-                newMinCapacity -= m_lastBlock->capacity();
-            
-            auto newCapacity = m_totalCapacity;
-            while (newCapacity < newMinCapacity)
-                newCapacity = static_cast<size_t>(static_cast<float>(newCapacity) * GrowthFactor);
-            
-            increaseCapacity(newCapacity - m_totalCapacity);
+        size_t Vbo::sizeClass(const size_t capacity) {
+            size_t result = 0;
+            while (sizeOfClass(result) < capacity)
+                ++result;
+            return result;
         }
 
-        void Vbo::increaseCapacity(const size_t delta) {
-            assert(active());
-            assert(!partiallyMapped());
-            assert(!fullyMapped());
-            assert(delta > 0);
-            assert(checkBlockChain());
-
-            const auto begin = (m_firstBlock->isFree() ?  m_firstBlock->capacity() : 0);
-            const auto end = m_totalCapacity - (m_lastBlock->isFree() ? m_lastBlock->capacity() : 0);
-            
-            if (m_lastBlock->isFree()) {
-                removeFreeBlock(m_lastBlock);
-                m_lastBlock->setCapacity(m_lastBlock->capacity() + delta);
-                insertFreeBlock(m_lastBlock);
-            } else {
-                auto* block = m_lastBlock->createSuccessor(delta);
-                m_lastBlock = block;
-                insertFreeBlock(m_lastBlock);
+        size_t Vbo::sizeOfClass(const size_t sizeClass) {
+            return MinBlockSize << sizeClass;
+        }
+
+        VboBlock* Vbo::allocateStreamedBlock(const size_t capacity) {
+            const auto size = std::max(MinBlockSize, (capacity + MinBlockSize - 1) / MinBlockSize * MinBlockSize);
+            if (size > m_streamCapacity)
+                return nullptr;
+
+            // the streamed blocks occupy the range from the offset of the oldest block to the head, possibly
+            // wrapping around the end of the ring buffer
+            size_t offset = 0;
+            if (!m_streamedBlocks.empty()) {
+                const auto tail = m_streamedBlocks.front()->offset();
+                if (m_streamHead > tail) {
+                    if (m_streamHead + size <= m_streamCapacity)
+                        offset = m_streamHead;
+                    else if (size <= tail)
+                        offset = 0;
+                    else
+                        return nullptr;
+                } else if (m_streamHead + size <= tail) {
+                    offset = m_streamHead;
+                } else {
+                    return nullptr;
+                }
             }
-            
-            m_totalCapacity += delta;
-            m_freeCapacity += delta;
-            assert(checkBlockChain());
-            
-            if (begin < end) {
-                auto* buffer = map();
-                
-                auto* temp = new unsigned char[end - begin];
-                memcpy(temp, buffer + begin, end - begin);
-                
-                unmap();
-                deactivate();
-                free();
-                activate();
-                buffer = map();
-                
-                memcpy(buffer + begin, temp, end - begin);
-                delete [] temp;
-                
-                unmap();
+
+            if (m_streamArena == NoArena) {
+                m_arenas.push_back(Arena(m_streamCapacity));
+                m_streamArena = m_arenas.size() - 1;
+                createBuffer(m_streamArena);
+            }
+
+            VboBlock* block = nullptr;
+            if (m_unusedBlocks.empty()) {
+                block = createBlock(m_streamArena, offset, capacity, 0);
+                block->m_streamed = true;
             } else {
-                deactivate();
-                free();
-                activate();
+                block = m_unusedBlocks.back();
+                m_unusedBlocks.pop_back();
+                block->m_offset = offset;
+                block->m_capacity = capacity;
             }
-        }
 
-        Vbo::VboBlockList::iterator Vbo::findFreeBlock(const size_t minCapacity) {
-            const VboBlock query(*this, 0, minCapacity, nullptr, nullptr);
-            return std::lower_bound(std::begin(m_freeBlocks), std::end(m_freeBlocks), &query, CompareVboBlocksByCapacity());
+            block->setFree(false);
+            m_streamedBlocks.push_back(block);
+            m_streamHead = offset + size;
+            return block;
         }
 
-        void Vbo::insertFreeBlock(VboBlock* block) {
-            auto it = std::lower_bound(std::begin(m_freeBlocks), std::end(m_freeBlocks), block, CompareVboBlocksByCapacity());
-            if (it == std::end(m_freeBlocks))
-                m_freeBlocks.push_back(block);
-            else
-                m_freeBlocks.insert(it, block);
+        void Vbo::freeStreamedBlock(VboBlock* block) {
             block->setFree(true);
-            m_freeCapacity += block->capacity();
+            while (!m_streamedBlocks.empty() && m_streamedBlocks.front()->isFree()) {
+                m_unusedBlocks.push_back(m_streamedBlocks.front());
+                m_streamedBlocks.pop_front();
+            }
         }
 
-        void Vbo::removeFreeBlock(VboBlock* block) {
-            auto it = std::lower_bound(std::begin(m_freeBlocks), std::end(m_freeBlocks), block, CompareVboBlocksByCapacity());
-            assert(it != std::end(m_freeBlocks));
-            if (*it != block) {
-                const auto end = std::upper_bound(std::begin(m_freeBlocks), std::end(m_freeBlocks), block, CompareVboBlocksByCapacity());
-                while (it != end && *it != block)
-                    ++it;
-                assert(it != end);
+        VboBlock* Vbo::takeFreeBlock(const size_t sizeClass) {
+            for (size_t i = sizeClass; i < m_freeBlocks.size(); ++i) {
+                if (!m_freeBlocks[i].empty()) {
+                    auto* block = m_freeBlocks[i].back();
+                    m_freeBlocks[i].pop_back();
+
+                    // split off the upper halves until the block has the requested size
+                    while (block->m_sizeClass > sizeClass) {
+                        --block->m_sizeClass;
+                        const auto size = sizeOfClass(block->m_sizeClass);
+                        insertFreeBlock(createBlock(block->m_arena, block->m_offset + size, size, block->m_sizeClass));
+                    }
+                    return block;
+                }
             }
-            assert(*it == block);
-            removeFreeBlock(it);
+            return nullptr;
         }
 
-        void Vbo::removeFreeBlock(const VboBlockList::iterator it) {
-            auto* block = *it;
-            m_freeBlocks.erase(it);
+        VboBlock* Vbo::allocateFromArena(const size_t capacity, const size_t sizeClass) {
+            const auto size = sizeOfClass(sizeClass);
+            if (m_arenas[m_currentArena].capacity - m_arenas[m_currentArena].used < size) {
+                retireCurrentArena();
+                m_currentArena = createArena(std::max(size, m_initialCapacity));
+            }
+
+            Arena& arena = m_arenas[m_currentArena];
+            auto* block = createBlock(m_currentArena, arena.used, capacity, sizeClass);
             block->setFree(false);
-            m_freeCapacity -= block->capacity();
+            arena.used += size;
+            m_freeCapacity -= size;
+            return block;
+        }
+
+        void Vbo::retireCurrentArena() {
+            Arena& arena = m_arenas[m_currentArena];
+
+            // split the remainder into the largest possible free blocks
+            while (arena.capacity - arena.used >= MinBlockSize) {
+                const auto remainder = arena.capacity - arena.used;
+                auto sizeClass = Vbo::sizeClass(remainder);
+                if (sizeOfClass(sizeClass) > remainder)
+                    --sizeClass;
+
+                insertFreeBlock(createBlock(m_currentArena, arena.used, sizeOfClass(sizeClass), sizeClass));
+                arena.used += sizeOfClass(sizeClass);
+            }
+
+            m_freeCapacity -= arena.capacity - arena.used;
+            arena.used = arena.capacity;
+        }
+
+        size_t Vbo::createArena(const size_t capacity) {
+            m_arenas.push_back(Arena(capacity));
+            const auto index = m_arenas.size() - 1;
+            createBuffer(index);
+
+            m_totalCapacity += capacity;
+            m_freeCapacity += capacity;
+            return index;
+        }
+
+        void Vbo::createBuffer(const size_t index) {
+            Arena& arena = m_arenas[index];
+            assert(arena.id == 0);
+
+            glAssert(glGenBuffers(1, &arena.id));
+            glAssert(glBindBuffer(m_type, arena.id));
+            glAssert(glBufferData(m_type, static_cast<GLsizeiptr>(arena.capacity), nullptr, m_usage));
+            m_boundArena = index;
+        }
+
+        VboBlock* Vbo::createBlock(const size_t arena, const size_t offset, const size_t capacity, const size_t sizeClass) {
+            auto* block = new VboBlock(*this, arena, offset, capacity, sizeClass);
+            m_blocks.push_back(block);
+            return block;
+        }
+
+        void Vbo::insertFreeBlock(VboBlock* block) {
+            assert(block->isFree());
+            if (block->m_sizeClass >= m_freeBlocks.size())
+                m_freeBlocks.resize(block->m_sizeClass + 1);
+            m_freeBlocks[block->m_sizeClass].push_back(block);
+        }
+
+        void Vbo::bindArena(const size_t arena) {
+            assert(arena < m_arenas.size());
+            if (arena != m_boundArena) {
+                glAssert(glBindBuffer(m_type, m_arenas[arena].id));
+                m_boundArena = arena;
+            }
         }
 
         bool Vbo::partiallyMapped() const {
@@ -283,7 +340,6 @@ namespace TrenchBroom {
         void Vbo::mapPartially() {
             assert(active());
             assert(!partiallyMapped());
-            assert(!fullyMapped());
             m_state = State_PartiallyMapped;
         }
         
@@ -292,59 +348,5 @@ namespace TrenchBroom {
             assert(partiallyMapped());
             m_state = State_Active;
         }
-
-        bool Vbo::fullyMapped() const {
-            return m_state == State_FullyMapped;
-        }
-        
-        unsigned char* Vbo::map() {
-            assert(active());
-            assert(!fullyMapped());
-            assert(!partiallyMapped());
-
-#ifdef __APPLE__
-            // fixes a crash on Mac OS X where a buffer could not be mapped after another windows was closed
-            glAssert(glFinishObjectAPPLE(GL_BUFFER_OBJECT_APPLE, static_cast<GLint>(m_vboId)));
-#endif
-            auto* buffer = reinterpret_cast<unsigned char *>(glMapBuffer(m_type, GL_WRITE_ONLY));
-            ensure(buffer != nullptr, "buffer is null");
-            m_state = State_FullyMapped;
-            
-            return buffer;
-        }
-        
-        void Vbo::unmap() {
-            assert(fullyMapped());
-            glAssert(glUnmapBuffer(m_type));
-            m_state = State_Active;
-        }
-
-        bool Vbo::checkBlockChain() const {
-            auto* block = m_firstBlock;
-            ensure(block != nullptr, "block is null");
-            
-            auto count = 0u;
-            auto* next = block->next();
-            while (next != nullptr) {
-                assert(next->previous() == block);
-                assert(!block->isFree() || !next->isFree());
-                block = next;
-                next = next->next();
-                ++count;
-            }
-            
-            assert(block == m_lastBlock);
-            
-            auto* previous = block->previous();
-            while (previous != nullptr) {
-                assert(previous->next() == block);
-                block = previous;
-                previous = previous->previous();
-                --count;
-            }
-            assert(count == 0);
-            
-            return true;
-        }
     }
 }
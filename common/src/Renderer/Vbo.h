@@ -25,17 +25,13 @@
 
 #include <cassert>
 #include <cstring>
+#include <deque>
 #include <vector>
 
 namespace TrenchBroom {
     namespace Renderer {
         class VboBlock;
         
-        class CompareVboBlocksByCapacity {
-        public:
-            bool operator() (const VboBlock* lhs, const VboBlock* rhs) const;
-        };
-        
         class Vbo;
         class ActivateVbo {
         private:
@@ -45,7 +41,40 @@ namespace TrenchBroom {
             ActivateVbo(Vbo& vbo);
             ~ActivateVbo();
         };
-        
+
+        /**
+         * While an instance of this class exists, the blocks allocated from the given VBO are taken from its
+         * streaming ring buffer if possible. This is meant for transient geometry that is uploaded, rendered and
+         * freed again within a frame.
+         *
+         * Passing false suspends streaming for blocks that outlive the frame even though they are allocated while
+         * transient geometry is prepared.
+         */
+        class StreamVboBlocks {
+        private:
+            Vbo& m_vbo;
+            bool m_wasStreaming;
+        public:
+            StreamVboBlocks(Vbo& vbo, bool streaming = true);
+            ~StreamVboBlocks();
+        };
+
+        /**
+         * Manages the storage of one or more OpenGL buffer objects and hands out blocks of it.
+         *
+         * The blocks are allocated from size classes whose sizes are powers of two. Freed blocks are kept in a free
+         * list per size class and are reused for the next allocation of the same size class, so that allocating
+         * and freeing a block takes constant time. If there is no free block of the requested size class, a free
+         * block of a larger size class is split in halves. Free blocks are never merged again. New blocks are cut from
+         * the unused end of the most recently created buffer, called an arena. If the arena is exhausted, a new arena
+         * is created instead of growing and copying the existing buffer, and the unused remainder of the old arena is
+         * split into free blocks.
+         *
+         * Since the blocks can reside in different buffers, a block must be bound before its offset is passed to
+         * OpenGL, see VboBlock::bind.
+         *
+         * Transient blocks can be allocated from a separate ring buffer, see StreamVboBlocks.
+         */
         class Vbo {
         public:
             typedef std::shared_ptr<Vbo> Ptr;
@@ -53,23 +82,46 @@ namespace TrenchBroom {
             typedef enum {
                 State_Inactive = 0,
                 State_Active = 1,
-                State_PartiallyMapped = 2,
-                State_FullyMapped = 3
+                State_PartiallyMapped = 2
             } State;
         private:
             typedef std::vector<VboBlock*> VboBlockList;
-            static const float GrowthFactor;
-            
+            typedef std::deque<VboBlock*> VboBlockQueue;
+
+            struct Arena {
+                GLuint id;
+                size_t capacity;
+                size_t used;
+
+                Arena(size_t i_capacity);
+            };
+
+            typedef std::vector<Arena> ArenaList;
+
+            static const size_t MinBlockSize;
+            static const size_t NoArena;
+
+            size_t m_initialCapacity;
             size_t m_totalCapacity;
             size_t m_freeCapacity;
-            VboBlockList m_freeBlocks;
-            VboBlock* m_firstBlock;
-            VboBlock* m_lastBlock;
+            ArenaList m_arenas;
+            size_t m_currentArena;
+            size_t m_boundArena;
+
+            VboBlockList m_blocks;
+            std::vector<VboBlockList> m_freeBlocks;
+
+            size_t m_streamCapacity;
+            size_t m_streamArena;
+            size_t m_streamHead;
+            VboBlockQueue m_streamedBlocks;
+            VboBlockList m_unusedBlocks;
+            bool m_streaming;
+
             State m_state;
 
             GLenum m_type;
             GLenum m_usage;
-            GLuint m_vboId;
         public:
             Vbo(size_t initialCapacity, GLenum type = GL_ARRAY_BUFFER, GLenum usage = GL_DYNAMIC_DRAW);
             ~Vbo();
@@ -79,8 +131,24 @@ namespace TrenchBroom {
             bool active() const;
             void activate();
             void deactivate();
+
+            /**
+             * Indicates whether blocks are currently allocated from the streaming ring buffer, see StreamVboBlocks.
+             */
+            bool streaming() const;
+
+            /**
+             * Returns the total capacity of all arenas, excluding the streaming ring buffer.
+             */
+            size_t totalCapacity() const;
+            /**
+             * Returns the capacity that is available for allocations without creating a new arena.
+             */
+            size_t freeCapacity() const;
+            size_t arenaCount() const;
         private:
             friend class ActivateVbo;
+            friend class StreamVboBlocks;
             friend class VboBlock;
 
             GLenum type() const;
@@ -88,22 +156,26 @@ namespace TrenchBroom {
             void free();
             void freeBlock(VboBlock* block);
 
-            void increaseCapacityToAccomodate(size_t capacity);
-            void increaseCapacity(size_t delta);
-            VboBlockList::iterator findFreeBlock(size_t minCapacity);
+            static size_t sizeClass(size_t capacity);
+            static size_t sizeOfClass(size_t sizeClass);
+
+            VboBlock* allocateStreamedBlock(size_t capacity);
+            void freeStreamedBlock(VboBlock* block);
+
+            VboBlock* takeFreeBlock(size_t sizeClass);
+            VboBlock* allocateFromArena(size_t capacity, size_t sizeClass);
+            void retireCurrentArena();
+            size_t createArena(size_t capacity);
+            void createBuffer(size_t index);
+
+            VboBlock* createBlock(size_t arena, size_t offset, size_t capacity, size_t sizeClass);
             void insertFreeBlock(VboBlock* block);
-            void removeFreeBlock(VboBlock* block);
-            void removeFreeBlock(VboBlockList::iterator it);
+
+            void bindArena(size_t arena);
 
             bool partiallyMapped() const;
             void mapPartially();
             void unmapPartially();
-            
-            bool fullyMapped() const;
-            unsigned char* map();
-            void unmap();
-
-            bool checkBlockChain() const;
         };
     }
 }
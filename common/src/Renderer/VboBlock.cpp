@@ -33,13 +33,14 @@ namespace TrenchBroom {
             m_block->unmap();
         }
 
-        VboBlock::VboBlock(Vbo& vbo, const size_t offset, const size_t capacity, VboBlock* previous, VboBlock* next) :
+        VboBlock::VboBlock(Vbo& vbo, const size_t arena, const size_t offset, const size_t capacity, const size_t sizeClass) :
         m_vbo(vbo),
-        m_free(true),
+        m_arena(arena),
         m_offset(offset),
         m_capacity(capacity),
-        m_previous(previous),
-        m_next(next),
+        m_sizeClass(sizeClass),
+        m_free(true),
+        m_streamed(false),
         m_mapped(false) {}
         
         Vbo& VboBlock::vbo() const {
@@ -54,6 +55,14 @@ namespace TrenchBroom {
             return m_capacity;
         }
 
+        size_t VboBlock::arena() const {
+            return m_arena;
+        }
+
+        void VboBlock::bind() {
+            m_vbo.bindArena(m_arena);
+        }
+
         void VboBlock::free() {
             m_vbo.freeBlock(this);
         }
@@ -74,22 +83,6 @@ namespace TrenchBroom {
             m_vbo.unmapPartially();
         }
 
-        VboBlock* VboBlock::previous() const {
-            return m_previous;
-        }
-        
-        void VboBlock::setPrevious(VboBlock* previous) {
-            m_previous = previous;
-        }
-        
-        VboBlock* VboBlock::next() const {
-            return m_next;
-        }
-        
-        void VboBlock::setNext(VboBlock* next) {
-            m_next = next;
-        }
-        
         bool VboBlock::isFree() const {
             return m_free;
         }
@@ -97,39 +90,5 @@ namespace TrenchBroom {
         void VboBlock::setFree(const bool free) {
             m_free = free;
         }
-        
-        void VboBlock::setCapacity(const size_t capacity) {
-            m_capacity = capacity;
-        }
-
-        VboBlock* VboBlock::mergeWithSuccessor() {
-            ensure(m_next != nullptr, "next is null");
-            
-            VboBlock* next = m_next;
-            VboBlock* nextNext = next->next();
-            m_next = nextNext;
-            if (m_next != nullptr)
-                m_next->setPrevious(this);
-            m_capacity += next->capacity();
-            return next;
-        }
-
-        VboBlock* VboBlock::split(const size_t capacity) {
-            assert(m_capacity > capacity);
-            const size_t remainderCapacity = m_capacity - capacity;
-            m_capacity = capacity;
-            
-            VboBlock* remainder = createSuccessor(remainderCapacity);
-            remainder->setFree(m_free);
-            return remainder;
-        }
-        
-        VboBlock* VboBlock::createSuccessor(const size_t capacity) {
-            VboBlock* successor = new VboBlock(m_vbo, m_offset + m_capacity, capacity, this, m_next);
-            if (m_next != nullptr)
-                m_next->setPrevious(successor);
-            m_next = successor;
-            return m_next;
-        }
     }
 }
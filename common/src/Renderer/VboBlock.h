@@ -45,19 +45,35 @@ namespace TrenchBroom {
             friend class MapVboBlock;
             
             Vbo& m_vbo;
-            bool m_free;
+            size_t m_arena;
             size_t m_offset;
             size_t m_capacity;
-            VboBlock* m_previous;
-            VboBlock* m_next;
+            size_t m_sizeClass;
+            bool m_free;
+            bool m_streamed;
             
             bool m_mapped;
         public:
-            VboBlock(Vbo& vbo, const size_t offset, const size_t capacity, VboBlock* previous, VboBlock* next);
+            VboBlock(Vbo& vbo, size_t arena, size_t offset, size_t capacity, size_t sizeClass);
             
             Vbo& vbo() const;
+            /**
+             * Returns the offset of this block within the buffer that contains it.
+             */
             size_t offset() const;
             size_t capacity() const;
+            /**
+             * Returns the index of the buffer that contains this block. Blocks with the same arena index can be
+             * rendered with a single draw call.
+             */
+            size_t arena() const;
+
+            /**
+             * Binds the buffer that contains this block. This must be done before the offset of this block is passed
+             * to OpenGL, e.g. to set up vertex attribute pointers or to draw from an index buffer. The VBO must be
+             * active.
+             */
+            void bind();
             
             template <typename T>
             size_t writeElements(const size_t address, const std::vector<T>& elements) {
@@ -88,6 +104,8 @@ namespace TrenchBroom {
                 static_assert(std::is_trivially_copyable<T>::value);
                 static_assert(std::is_standard_layout<T>::value);
 
+                bind();
+
                 const GLvoid* ptr = static_cast<const GLvoid*>(array);
                 const GLintptr offset = static_cast<GLintptr>(m_offset + address);
                 const GLsizeiptr sizei = static_cast<GLsizeiptr>(size);
@@ -102,18 +120,8 @@ namespace TrenchBroom {
             void map();
             void unmap();
         private:
-            VboBlock* previous() const;
-            void setPrevious(VboBlock* previous);
-            VboBlock* next() const;
-            void setNext(VboBlock* next);
-            
             bool isFree() const;
-            void setFree(const bool free);
-            void setCapacity(const size_t capacity);
-            
-            VboBlock* mergeWithSuccessor();
-            VboBlock* split(const size_t capacity);
-            VboBlock* createSuccessor(const size_t capacity);
+            void setFree(bool free);
         };
     }
 }
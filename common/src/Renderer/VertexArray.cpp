@@ -19,6 +19,9 @@
 
 #include "VertexArray.h"
 
+#include "Renderer/DrawCallCounter.h"
+#include "Renderer/Vbo.h"
+
 #include <cassert>
 #include <limits>
 
@@ -63,8 +66,11 @@ namespace TrenchBroom {
         }
 
         void VertexArray::prepare(Vbo& vbo) {
-            if (!prepared() && !empty())
+            if (!prepared() && !empty()) {
+                // a holder that is shared with another array may outlive the current frame
+                StreamVboBlocks stream(vbo, vbo.streaming() && m_holder.use_count() == 1);
                 m_holder->prepare(vbo);
+            }
             m_prepared = true;
         }
 
@@ -97,10 +103,12 @@ namespace TrenchBroom {
             if (!m_setup) {
                 if (setup()) {
                     glAssert(glDrawArrays(primType, index, count));
+                    DrawCallCounter::count();
                     cleanup();
                 }
             } else {
                 glAssert(glDrawArrays(primType, index, count));
+                DrawCallCounter::count();
             }
         }
 
@@ -111,12 +119,14 @@ namespace TrenchBroom {
                     const GLint* indexArray   = indices.data();
                     const GLsizei* countArray = counts.data();
                     glAssert(glMultiDrawArrays(primType, indexArray, countArray, primCount));
+                    DrawCallCounter::count();
                     cleanup();
                 }
             } else {
                 const GLint* indexArray   = indices.data();
                 const GLsizei* countArray = counts.data();
                 glAssert(glMultiDrawArrays(primType, indexArray, countArray, primCount));
+                DrawCallCounter::count();
             }
             
         }
@@ -127,11 +137,27 @@ namespace TrenchBroom {
                 if (setup()) {
                     const GLint* indexArray = indices.data();
                     glAssert(glDrawElements(primType, count, GL_UNSIGNED_INT, indexArray));
+                    DrawCallCounter::count();
                     cleanup();
                 }
             } else {
                 const GLint* indexArray = indices.data();
                 glAssert(glDrawElements(primType, count, GL_UNSIGNED_INT, indexArray));
+                DrawCallCounter::count();
+            }
+        }
+
+        void VertexArray::renderInstanced(const PrimType primType, const GLint index, const GLsizei count, const GLsizei instanceCount) {
+            assert(prepared());
+            if (!m_setup) {
+                if (setup()) {
+                    glAssert(glDrawArraysInstanced(primType, index, count, instanceCount));
+                    DrawCallCounter::count();
+                    cleanup();
+                }
+            } else {
+                glAssert(glDrawArraysInstanced(primType, index, count, instanceCount));
+                DrawCallCounter::count();
             }
         }
 
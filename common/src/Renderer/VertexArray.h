@@ -73,6 +73,7 @@ namespace TrenchBroom {
                 
                 virtual void setup() override {
                     ensure(m_block != nullptr, "block is null");
+                    m_block->bind();
                     VertexSpec::setup(m_block->offset());
                 }
                 
@@ -267,6 +268,11 @@ namespace TrenchBroom {
             void render(PrimType primType, GLint index, GLsizei count);
             void render(PrimType primType, const GLIndices& indices, const GLCounts& counts, GLint primCount);
             void render(PrimType primType, const GLIndices& indices, GLsizei count);
+            /**
+             * Renders the given range of vertices once per instance. The per-instance attributes must have been set
+             * up by the caller.
+             */
+            void renderInstanced(PrimType primType, GLint index, GLsizei count, GLsizei instanceCount);
             void cleanup();
         private:
             VertexArray(BaseHolder::Ptr holder);
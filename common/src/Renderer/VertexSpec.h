@@ -176,6 +176,12 @@ namespace TrenchBroom {
             typedef VertexSpec3<AttributeSpecs::P3, AttributeSpecs::N, AttributeSpecs::C4> P3NC4;
             typedef VertexSpec3<AttributeSpecs::P3, AttributeSpecs::T02, AttributeSpecs::C4> P3T2C4;
             typedef VertexSpec3<AttributeSpecs::P3, AttributeSpecs::N, AttributeSpecs::T02> P3NT2;
+
+            /**
+             * A compact variant of P3NT2 with half float texture coordinates and byte normals. The normal is placed
+             * last so that the attributes need no padding between them.
+             */
+            typedef VertexSpec3<AttributeSpecs::P3, AttributeSpecs::T02H, AttributeSpecs::NB> P3T2HNB;
         }
     }
 }
@@ -242,6 +242,10 @@ namespace TrenchBroom {
 
                 frame->openDocument(game, mapFormat, path);
                 return true;
+            } catch (const CancelledException& e) {
+                if (frame != nullptr)
+                    frame->Close();
+                return false;
             } catch (const FileNotFoundException& e) {
                 m_recentDocuments->removePath(IO::Path(path));
                 if (frame != nullptr)
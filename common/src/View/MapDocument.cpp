@@ -19,9 +19,11 @@
 
 #include "View/MapDocument.h"
 
+#include "ParallelUtils.h"
 #include "PreferenceManager.h"
 #include "Preferences.h"
 #include "Polyhedron.h"
+#include "ProgressStatus.h"
 #include "Assets/EntityDefinitionManager.h"
 #include "Assets/EntityModelManager.h"
 #include "Assets/Texture.h"
@@ -87,6 +89,7 @@
 #include "View/EntityDefinitionFileCommand.h"
 #include "View/FindPlanePointsCommand.h"
 #include "View/Grid.h"
+#include "View/MapLoadThread.h"
 #include "View/MapViewConfig.h"
 #include "View/MoveBrushEdgesCommand.h"
 #include "View/MoveBrushFacesCommand.h"
@@ -110,6 +113,7 @@
 #include "View/TransformObjectsCommand.h"
 #include "View/ViewEffectsService.h"
 
+#include <algorithm>
 #include <cassert>
 #include <numeric>
 
@@ -251,12 +255,22 @@ namespace TrenchBroom {
         }
         
         void MapDocument::loadDocument(const Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GameSPtr game, const IO::Path& path) {
+            NullProgressStatus status;
+            loadDocument(mapFormat, worldBounds, game, path, status);
+        }
+
+        void MapDocument::loadDocument(const Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GameSPtr game, const IO::Path& path, ProgressStatus& status) {
             info("Loading document from " + path.asString());
             
             clearDocument();
-            loadWorld(mapFormat, worldBounds, game, path);
+            try {
+                loadWorld(mapFormat, worldBounds, game, path, status);
+            } catch (...) {
+                // remove the nodes that were added before loading failed
+                clearDocument();
+                throw;
+            }
             
-            loadAssets();
             registerIssueGenerators();
             
             documentWasLoadedNotifier(this);
@@ -1031,23 +1045,44 @@ namespace TrenchBroom {
         }
 
         bool MapDocument::csgConvexMerge() {
+            NullProgressStatus status;
+            return csgConvexMerge(status);
+        }
+
+        bool MapDocument::csgConvexMerge(ProgressStatus& status) {
             if (!hasSelectedBrushFaces() && !selectedNodes().hasOnlyBrushes())
                 return false;
             
-            Polyhedron3 polyhedron;
+            Vec3::List points;
             
             if (hasSelectedBrushFaces()) {
                 for (const Model::BrushFace* face : selectedBrushFaces()) {
                     for (const Model::BrushVertex* vertex : face->vertices())
-                        polyhedron.addPoint(vertex->position());
+                        points.push_back(vertex->position());
                 }
             } else if (selectedNodes().hasOnlyBrushes()) {
-                for (const Model::Brush* brush : selectedNodes().brushes()) {
-                    for (const Model::BrushVertex* vertex : brush->vertices())
-                        polyhedron.addPoint(vertex->position());
-                }
+                for (const Model::Brush* brush : selectedNodes().brushes())
+                    VectorUtils::append(points, brush->vertexPositions());
             }
             
+            // The convex hull of the vertices of the convex hulls of several batches of points is the convex hull of
+            // all points, so the hulls of the batches are built in parallel.
+            const size_t batchCount = std::min(points.size(), 4 * ParallelUtils::threadCount());
+            std::vector<Vec3::List> batchVertices(batchCount);
+            const bool completed = ParallelUtils::forEachIndex(batchCount, [&](const size_t i) {
+                const size_t first = points.size() * i / batchCount;
+                const size_t last = points.size() * (i + 1) / batchCount;
+                const Polyhedron3 batch(Vec3::List(std::begin(points) + static_cast<std::ptrdiff_t>(first), std::begin(points) + static_cast<std::ptrdiff_t>(last)));
+                batchVertices[i] = batch.vertexPositions();
+            }, status);
+            
+            if (!completed)
+                return false;
+            
+            Polyhedron3 polyhedron;
+            for (const Vec3::List& vertices : batchVertices)
+                polyhedron.addPoints(vertices);
+            
             if (!polyhedron.polyhedron() || !polyhedron.closed())
                 return false;
             
@@ -1075,22 +1110,45 @@ namespace TrenchBroom {
         }
         
         bool MapDocument::csgSubtract() {
+            NullProgressStatus status;
+            return csgSubtract(status);
+        }
+        
+        bool MapDocument::csgSubtract(ProgressStatus& status) {
             const Model::BrushList brushes = selectedNodes().brushes();
             if (brushes.size() < 2)
                 return false;
             
-            const Model::BrushList minuends(std::begin(brushes), std::end(brushes) - 1);
             Model::Brush* subtrahend = brushes.back();
             
+            // Only the brushes that touch the subtrahend are affected, and the node tree finds them without testing
+            // every selected brush.
+            const Model::NodeList touching = m_world->findNodesIntersecting(subtrahend->bounds());
+            const Model::NodeSet touchingSet(std::begin(touching), std::end(touching));
+            
+            Model::BrushList minuends;
+            Model::NodeList unaffected;
+            for (auto it = std::begin(brushes), end = std::end(brushes) - 1; it != end; ++it) {
+                Model::Brush* brush = *it;
+                if (touchingSet.count(brush) > 0) {
+                    minuends.push_back(brush);
+                } else {
+                    unaffected.push_back(brush);
+                }
+            }
+            
+            const std::vector<Model::BrushList> fragments = Model::Brush::subtract(*m_world, m_worldBounds, currentTextureName(), minuends, subtrahend, status);
+            if (fragments.size() != minuends.size())
+                return false;
+            
             Model::ParentChildrenMap toAdd;
             Model::NodeList toRemove;
             toRemove.push_back(subtrahend);
             
-            for (Model::Brush* minuend : minuends) {
-                const Model::BrushList result = minuend->subtract(*m_world, m_worldBounds, currentTextureName(), subtrahend);
-                if (!result.empty()) {
-                    VectorUtils::append(toAdd[minuend->parent()], result);
-                    toRemove.push_back(minuend);
+            for (size_t i = 0; i < minuends.size(); ++i) {
+                if (!fragments[i].empty()) {
+                    VectorUtils::append(toAdd[minuends[i]->parent()], fragments[i]);
+                    toRemove.push_back(minuends[i]);
                 }
             }
             
@@ -1099,40 +1157,36 @@ namespace TrenchBroom {
             const Model::NodeList added = addNodes(toAdd);
             removeNodes(toRemove);
             select(added);
+            select(unaffected);
             
             return true;
         }
 
         bool MapDocument::csgIntersect() {
+            NullProgressStatus status;
+            return csgIntersect(status);
+        }
+
+        bool MapDocument::csgIntersect(ProgressStatus& status) {
             const Model::BrushList brushes = selectedNodes().brushes();
             if (brushes.size() < 2)
                 return false;
             
-            Model::Brush* result = brushes.front()->clone(m_worldBounds);
-
-            bool valid = true;
-            Model::BrushList::const_iterator it, end;
-            for (it = std::begin(brushes), end = std::end(brushes); it != end && valid; ++it) {
-                Model::Brush* brush = *it;
-                try {
-                    result->intersect(m_worldBounds, brush);
-                } catch (const GeometryException&) {
-                    valid = false;
-                }
-            }
+            Model::Brush* result = Model::Brush::intersect(*m_world, m_worldBounds, brushes, status);
+            if (result == nullptr && status.cancelled())
+                return false;
             
             const Model::NodeList toRemove(std::begin(brushes), std::end(brushes));
             
             Transaction transaction(this, "CSG Intersect");
             deselect(toRemove);
             
-            if (valid) {
+            if (result != nullptr) {
                 addNode(result, currentParent());
                 removeNodes(toRemove);
                 select(result);
             } else {
                 removeNodes(toRemove);
-                delete result;
             }
             
             return true;
@@ -1464,14 +1518,71 @@ namespace TrenchBroom {
             setPath(IO::Path(DefaultDocumentName));
         }
         
-        void MapDocument::loadWorld(const Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GameSPtr game, const IO::Path& path) {
+        void MapDocument::loadWorld(const Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GameSPtr game, const IO::Path& path, ProgressStatus& status) {
             m_worldBounds = worldBounds;
             m_game = game;
-            m_world = m_game->loadMap(mapFormat, m_worldBounds, path, this);
+            
+            MapLoadThread loader(m_game, mapFormat, m_worldBounds, path);
+            bool loading = true;
+            while (loading) {
+                loading = loader.wait(status, *this);
+                if (m_world == nullptr) {
+                    Model::World* world = loader.takeWorld();
+                    if (world != nullptr)
+                        setLoadedWorld(world, path);
+                }
+                if (m_world != nullptr)
+                    addLoadedNodes(loader.takeNodes());
+            }
+            
+            if (loader.published()) {
+                // the world is only complete now that all nodes were added
+                m_world->rebuildNodeTree();
+                m_world->enableNodeTreeUpdates();
+                m_game->writeMapCache(m_world, path, this);
+            }
+        }
+        
+        void MapDocument::setLoadedWorld(Model::World* world, const IO::Path& path) {
+            m_world = world;
             setCurrentLayer(m_world->defaultLayer());
             
             updateGameSearchPaths();
             setPath(path);
+            loadAssets();
+        }
+        
+        void MapDocument::addLoadedNodes(const Model::ParentChildrenMap& nodes) {
+            if (nodes.empty())
+                return;
+            
+            // Only the nodes whose parents are in the world already are added with notifications. The other nodes
+            // were read along with their parents, so they are added to their parents first. The parents are in
+            // ascending order because the map is.
+            Model::NodeList parents;
+            for (const auto& entry : nodes) {
+                Model::Node* parent = entry.first;
+                if (parent == m_world || parent->parent() != nullptr)
+                    parents.push_back(parent);
+            }
+            
+            for (const auto& entry : nodes) {
+                if (!std::binary_search(std::begin(parents), std::end(parents), entry.first))
+                    entry.first->addChildren(entry.second);
+            }
+            
+            Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyParents(nodesWillChangeNotifier, nodesDidChangeNotifier, Model::collectParents(parents));
+            
+            Model::NodeList addedNodes;
+            for (Model::Node* parent : parents) {
+                const Model::NodeList& children = nodes.find(parent)->second;
+                parent->addChildren(children);
+                VectorUtils::append(addedNodes, children);
+            }
+            
+            setEntityDefinitions(addedNodes);
+            setTextures(addedNodes);
+            nodesWereAddedNotifier(addedNodes);
         }
         
         void MapDocument::clearWorld() {
@@ -1714,6 +1825,9 @@ namespace TrenchBroom {
         }
         
         void MapDocument::updateGameSearchPaths() {
+            // models are loaded from the game's file systems on background threads
+            clearEntityModels();
+
             const IO::Path::List additionalSearchPaths = IO::Path::asPaths(mods());
             m_game->setAdditionalSearchPaths(additionalSearchPaths, this);
         }
@@ -1816,9 +1930,10 @@ namespace TrenchBroom {
             if (isGamePathPreference(path)) {
                 const Model::GameFactory& gameFactory = Model::GameFactory::instance();
                 const IO::Path newGamePath = gameFactory.gamePath(m_game->gameName());
-                m_game->setGamePath(newGamePath, this);
                 
+                // models are loaded from the game's file systems on background threads
                 clearEntityModels();
+                m_game->setGamePath(newGamePath, this);
                 
                 unsetTextures();
                 loadTextures();
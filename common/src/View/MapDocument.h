@@ -40,6 +40,8 @@
 
 class Color;
 namespace TrenchBroom {
+    class ProgressStatus;
+
     namespace Assets {
         class EntityDefinitionManager;
         class EntityModelManager;
@@ -179,6 +181,15 @@ namespace TrenchBroom {
         public: // new, load, save document
             void newDocument(Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GameSPtr game);
             void loadDocument(Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GameSPtr game, const IO::Path& path);
+            /**
+             * Reports the progress of reading the map file to the given status. If the status is cancelled, loading
+             * stops with a CancelledException and the document is left empty.
+             *
+             * The map file is read on another thread, and the nodes are added to the document while they are read.
+             * If the given status processes UI events when it reports the progress, the views show the nodes that
+             * were added so far.
+             */
+            void loadDocument(Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GameSPtr game, const IO::Path& path, ProgressStatus& status);
             void saveDocument();
             void saveDocumentAs(const IO::Path& path);
             void saveDocumentTo(const IO::Path& path);
@@ -303,6 +314,14 @@ namespace TrenchBroom {
             bool csgConvexMerge();
             bool csgSubtract();
             bool csgIntersect();
+
+            /**
+             * These variants report their progress to the given status and do not change the map if the status
+             * reports that the operation was cancelled.
+             */
+            bool csgConvexMerge(ProgressStatus& status);
+            bool csgSubtract(ProgressStatus& status);
+            bool csgIntersect(ProgressStatus& status);
             bool csgHollow();
         public:
             bool clipBrushes(const Vec3& p1, const Vec3& p2, const Vec3& p3);
@@ -385,7 +404,9 @@ namespace TrenchBroom {
             Model::NodeList findNodesContaining(const Vec3& point) const;
         private: // world management
             void createWorld(Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GameSPtr game);
-            void loadWorld(Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GameSPtr game, const IO::Path& path);
+            void loadWorld(Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GameSPtr game, const IO::Path& path, ProgressStatus& status);
+            void setLoadedWorld(Model::World* world, const IO::Path& path);
+            void addLoadedNodes(const Model::ParentChildrenMap& nodes);
             void clearWorld();
             void initializeWorld(const BBox3& worldBounds);
         public: // asset management
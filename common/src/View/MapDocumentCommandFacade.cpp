@@ -826,8 +826,7 @@ namespace TrenchBroom {
             Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyParents(nodesWillChangeNotifier, nodesDidChangeNotifier, parents);
             Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyNodes(nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
             
-            for (Model::Brush* brush : brushes)
-                brush->rebuildGeometry(m_worldBounds);
+            Model::Brush::rebuildGeometry(m_worldBounds, brushes);
 
             invalidateSelectionBounds();
         }
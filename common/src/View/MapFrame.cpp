@@ -22,6 +22,7 @@
 #include "TrenchBroomApp.h"
 #include "Preferences.h"
 #include "PreferenceManager.h"
+#include "Assets/EntityModelManager.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/ResourceUtils.h"
 #include "Model/AttributableNode.h"
@@ -54,6 +55,7 @@
 #include "View/MapFrameDropTarget.h"
 #include "View/Menu.h"
 #include "View/OpenClipboard.h"
+#include "View/ProgressDialogStatus.h"
 #include "View/RenderView.h"
 #include "View/ReplaceTextureDialog.h"
 #include "View/SplitterWindow2.h"
@@ -62,6 +64,7 @@
 #include "View/ViewUtils.h"
 #include "View/wxUtils.h"
 
+#include <wx/app.h>
 #include <wx/clipbrd.h>
 #include <wx/display.h>
 #include <wx/filedlg.h>
@@ -127,6 +130,9 @@ namespace TrenchBroom {
 
             m_document->setParentLogger(logger());
             m_document->setViewEffectsService(m_mapView);
+            
+            // entity models are loaded in the background, wake up the views so that they can pick them up
+            m_document->entityModelManager().setLoadCallback([]() { ::wxWakeUpIdle(); });
 
             m_autosaveTimer = new wxTimer(this);
             m_autosaveTimer->Start(1000);
@@ -246,7 +252,8 @@ namespace TrenchBroom {
         bool MapFrame::openDocument(Model::GameSPtr game, const Model::MapFormat::Type mapFormat, const IO::Path& path) {
             if (!confirmOrDiscardChanges())
                 return false;
-            m_document->loadDocument(mapFormat, MapDocument::DefaultWorldBounds, game, path);
+            ProgressDialogStatus status(this, "Loading " + path.lastComponent().asString());
+            m_document->loadDocument(mapFormat, MapDocument::DefaultWorldBounds, game, path, status);
             return true;
         }
 
@@ -1152,7 +1159,8 @@ namespace TrenchBroom {
             if (IsBeingDeleted()) return;
 
             if (canDoCsgConvexMerge()) { // on gtk, menu shortcuts remain enabled even if the menu item is disabled
-                m_document->csgConvexMerge();
+                ProgressDialogStatus status(this, "CSG Convex Merge");
+                m_document->csgConvexMerge(status);
             }
         }
 
@@ -1160,7 +1168,8 @@ namespace TrenchBroom {
             if (IsBeingDeleted()) return;
             
             if (canDoCsgSubtract()) { // on gtk, menu shortcuts remain enabled even if the menu item is disabled
-                m_document->csgSubtract();
+                ProgressDialogStatus status(this, "CSG Subtract");
+                m_document->csgSubtract(status);
             }
         }
 
@@ -1168,7 +1177,8 @@ namespace TrenchBroom {
             if (IsBeingDeleted()) return;
             
             if (canDoCsgIntersect()) { // on gtk, menu shortcuts remain enabled even if the menu item is disabled
-                m_document->csgIntersect();
+                ProgressDialogStatus status(this, "CSG Intersect");
+                m_document->csgIntersect(status);
             }
         }
 
@@ -0,0 +1,172 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapLoadThread.h"
+
+#include "CollectionUtils.h"
+#include "PreferenceManager.h"
+#include "Preferences.h"
+#include "Model/Game.h"
+#include "Model/Node.h"
+#include "Model/World.h"
+
+#include <chrono>
+
+#include <wx/string.h>
+
+namespace TrenchBroom {
+    namespace View {
+        const long MapLoadThread::UpdateInterval = 100;
+
+        MapLoadThread::LoadStatus::LoadStatus() :
+        m_progress(0.0),
+        m_cancelled(false) {}
+
+        double MapLoadThread::LoadStatus::currentProgress() const {
+            return m_progress;
+        }
+
+        void MapLoadThread::LoadStatus::cancel() {
+            m_cancelled = true;
+        }
+
+        void MapLoadThread::LoadStatus::doProgress(const double progress) {
+            m_progress = progress;
+        }
+
+        bool MapLoadThread::LoadStatus::doCancelled() const {
+            return m_cancelled;
+        }
+
+        void MapLoadThread::LoadLogger::forward(Logger& logger) {
+            MessageList messages;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                messages.swap(m_messages);
+            }
+
+            for (const Message& message : messages)
+                logger.log(message.first, message.second);
+        }
+
+        void MapLoadThread::LoadLogger::doLog(const LogLevel level, const String& message) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_messages.push_back(std::make_pair(level, message));
+        }
+
+        void MapLoadThread::LoadLogger::doLog(const LogLevel level, const wxString& message) {
+            doLog(level, message.ToStdString());
+        }
+
+        MapLoadThread::MapLoadThread(Model::GameSPtr game, const Model::MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path) :
+        m_world(nullptr),
+        m_worldTaken(false),
+        m_published(false),
+        m_finished(false) {
+            // Loading initializes some state lazily that this thread may use concurrently, so initialize it here.
+            pref(Preferences::UseMapCache);
+            game->brushContentTypeBuilder();
+            m_thread = std::thread([this, game, format, worldBounds, path]() { run(game, format, worldBounds, path); });
+        }
+
+        MapLoadThread::~MapLoadThread() {
+            m_status.cancel();
+            if (m_thread.joinable())
+                m_thread.join();
+
+            // the nodes that were not taken are not attached to their parents, so every node must be deleted separately
+            for (auto& entry : m_nodes)
+                VectorUtils::clearAndDelete(entry.second);
+            if (!m_worldTaken)
+                delete m_world;
+        }
+
+        bool MapLoadThread::wait(ProgressStatus& status, Logger& logger) {
+            bool finished = false;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait_for(lock, std::chrono::milliseconds(UpdateInterval), [this]() { return m_finished; });
+                finished = m_finished;
+            }
+
+            m_logger.forward(logger);
+            if (finished) {
+                if (m_thread.joinable())
+                    m_thread.join();
+                if (m_exception)
+                    std::rethrow_exception(m_exception);
+                return false;
+            }
+
+            status.progress(m_status.currentProgress());
+            if (status.cancelled())
+                m_status.cancel();
+            return true;
+        }
+
+        Model::World* MapLoadThread::takeWorld() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_worldTaken || m_world == nullptr)
+                return nullptr;
+            m_worldTaken = true;
+            return m_world;
+        }
+
+        Model::ParentChildrenMap MapLoadThread::takeNodes() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            assert(m_worldTaken);
+
+            Model::ParentChildrenMap result;
+            result.swap(m_nodes);
+            return result;
+        }
+
+        bool MapLoadThread::published() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_published;
+        }
+
+        void MapLoadThread::run(Model::GameSPtr game, const Model::MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path) {
+            Model::World* world = nullptr;
+            std::exception_ptr exception;
+            try {
+                world = game->loadMap(format, worldBounds, path, &m_logger, m_status, [this](Model::World* i_world, const Model::ParentChildrenMap& nodes) {
+                    publish(i_world, nodes);
+                });
+            } catch (...) {
+                exception = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (world != nullptr)
+                m_world = world;
+            m_exception = exception;
+            m_finished = true;
+            m_condition.notify_all();
+        }
+
+        void MapLoadThread::publish(Model::World* world, const Model::ParentChildrenMap& nodes) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_world = world;
+            m_published = true;
+            for (const auto& entry : nodes)
+                VectorUtils::append(m_nodes[entry.first], entry.second);
+        }
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapLoadThread
+#define TrenchBroom_MapLoadThread
+
+#include "Logger.h"
+#include "Macros.h"
+#include "ProgressStatus.h"
+#include "StringUtils.h"
+#include "VecMath.h"
+#include "IO/Path.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelTypes.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace View {
+        /**
+         * Loads a map file on a separate thread, so that the thread that waits for the load can add the nodes to the
+         * document as they are read and can keep processing UI events in the meantime, see Model::Game::loadMap.
+         *
+         * The waiting thread passes on the progress and the log messages of the load, and it cancels the load if it
+         * was cancelled. The world and the nodes that were read are owned by this object until they are taken.
+         */
+        class MapLoadThread {
+        private:
+            static const long UpdateInterval;
+
+            /**
+             * Records the progress of the load and tells it whether it was cancelled.
+             */
+            class LoadStatus : public ProgressStatus {
+            private:
+                std::atomic<double> m_progress;
+                std::atomic<bool> m_cancelled;
+            public:
+                LoadStatus();
+
+                double currentProgress() const;
+                void cancel();
+            private:
+                void doProgress(double progress) override;
+                bool doCancelled() const override;
+            };
+
+            /**
+             * Records the log messages of the load, since the document's logger must only be used by the thread that
+             * waits for the load.
+             */
+            class LoadLogger : public Logger {
+            private:
+                typedef std::pair<LogLevel, String> Message;
+                typedef std::vector<Message> MessageList;
+
+                std::mutex m_mutex;
+                MessageList m_messages;
+            public:
+                void forward(Logger& logger);
+            private:
+                void doLog(LogLevel level, const String& message) override;
+                void doLog(LogLevel level, const wxString& message) override;
+            };
+
+            LoadStatus m_status;
+            LoadLogger m_logger;
+
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            Model::World* m_world;
+            bool m_worldTaken;
+            bool m_published;
+            Model::ParentChildrenMap m_nodes;
+            bool m_finished;
+            std::exception_ptr m_exception;
+
+            std::thread m_thread;
+        public:
+            /**
+             * Starts loading the map file at the given path.
+             */
+            MapLoadThread(Model::GameSPtr game, Model::MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path);
+
+            /**
+             * Cancels the load, waits for it to stop and deletes the world and the nodes that were not taken.
+             */
+            ~MapLoadThread();
+
+            /**
+             * Waits until the load has finished, but not longer than a short interval, and passes the progress and the
+             * log messages of the load to the given status and logger. Cancels the load if the given status was
+             * cancelled.
+             *
+             * Returns true while the load is running and false once it has finished. If the load failed or was
+             * cancelled, its exception is rethrown instead.
+             */
+            bool wait(ProgressStatus& status, Logger& logger);
+
+            /**
+             * Takes the world if it was passed by the load or if the load has finished, and returns null otherwise or
+             * if the world was taken before. Whoever takes the world also owns the nodes that are taken later.
+             */
+            Model::World* takeWorld();
+
+            /**
+             * Takes the nodes that were read since the nodes were last taken, by parent, see
+             * IO::WorldReader::PublishCallback. The nodes are not attached to their parents yet.
+             */
+            Model::ParentChildrenMap takeNodes();
+
+            /**
+             * Indicates whether the load passed the world before it had finished. If so, the world is only complete
+             * once all nodes were taken and added, and its node tree must be rebuilt then.
+             */
+            bool published();
+        private:
+            void run(Model::GameSPtr game, Model::MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path);
+            void publish(Model::World* world, const Model::ParentChildrenMap& nodes);
+
+            deleteCopyAndAssignment(MapLoadThread)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapLoadThread) */
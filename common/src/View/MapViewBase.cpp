@@ -23,6 +23,7 @@
 #include "PreferenceManager.h"
 #include "Preferences.h"
 #include "Assets/EntityDefinitionManager.h"
+#include "Assets/EntityModelManager.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
@@ -93,7 +94,8 @@ namespace TrenchBroom {
         m_toolBox(toolBox),
         m_animationManager(new AnimationManager()),
         m_renderer(renderer),
-        m_compass(nullptr) {
+        m_compass(nullptr),
+        m_entityModelGeneration(0) {
             setToolBox(toolBox);
             toolBox.addWindow(this);
             bindEvents();
@@ -250,6 +252,7 @@ namespace TrenchBroom {
 		void MapViewBase::bindEvents() {
             Bind(wxEVT_SET_FOCUS, &MapViewBase::OnSetFocus, this);
             Bind(wxEVT_KILL_FOCUS, &MapViewBase::OnKillFocus, this);
+            Bind(wxEVT_IDLE, &MapViewBase::OnIdle, this);
 
             Bind(wxEVT_MENU, &MapViewBase::OnToggleClipSide,               this, CommandIds::Actions::ToggleClipSide);
             Bind(wxEVT_MENU, &MapViewBase::OnPerformClip,                  this, CommandIds::Actions::PerformClip);
@@ -737,6 +740,20 @@ namespace TrenchBroom {
             event.Skip();
 		}
 
+        void MapViewBase::OnIdle(wxIdleEvent& event) {
+            if (IsBeingDeleted() || expired(m_document)) return;
+
+            // redraw once entity models that were loaded in the background replace their placeholders
+            MapDocumentSPtr document = lock(m_document);
+            Assets::EntityModelManager& entityModelManager = document->entityModelManager();
+            entityModelManager.collectLoadedModels();
+            if (entityModelManager.modelGeneration() != m_entityModelGeneration) {
+                m_entityModelGeneration = entityModelManager.modelGeneration();
+                Refresh();
+            }
+            event.Skip();
+        }
+
         void MapViewBase::OnActivateFrame(wxActivateEvent& event) {
             if (IsBeingDeleted()) return;
 
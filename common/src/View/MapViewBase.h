@@ -76,6 +76,8 @@ namespace TrenchBroom {
         private:
             Renderer::MapRenderer& m_renderer;
             Renderer::Compass* m_compass;
+            
+            size_t m_entityModelGeneration;
         protected:
             MapViewBase(wxWindow* parent, Logger* logger, MapDocumentWPtr document, MapViewToolBox& toolBox, Renderer::MapRenderer& renderer, GLContextManager& contextManager);
             
@@ -193,6 +195,7 @@ namespace TrenchBroom {
             void OnSetFocus(wxFocusEvent& event);
             void OnKillFocus(wxFocusEvent& event);
             void OnActivateFrame(wxActivateEvent& event);
+            void OnIdle(wxIdleEvent& event);
         protected: // accelerator table management
             void updateAcceleratorTable();
         private:
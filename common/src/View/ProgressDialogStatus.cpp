@@ -0,0 +1,61 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProgressDialogStatus.h"
+
+#include <wx/progdlg.h>
+
+#include <algorithm>
+
+namespace TrenchBroom {
+    namespace View {
+        const long ProgressDialogStatus::ShowDelay = 500;
+        const int ProgressDialogStatus::Maximum = 1000;
+
+        ProgressDialogStatus::ProgressDialogStatus(wxWindow* parent, const wxString& title) :
+        m_parent(parent),
+        m_title(title),
+        m_dialog(nullptr),
+        m_cancelled(false) {}
+
+        ProgressDialogStatus::~ProgressDialogStatus() {
+            delete m_dialog;
+        }
+
+        void ProgressDialogStatus::doProgress(const double progress) {
+            if (m_cancelled)
+                return;
+
+            if (m_dialog == nullptr) {
+                if (m_stopWatch.Time() < ShowDelay)
+                    return;
+                m_dialog = new wxProgressDialog(m_title, "Please wait...", Maximum, m_parent, wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME);
+            }
+
+            // stay below the maximum, since the dialog stops accepting updates once the maximum is reached
+            const int value = std::min(static_cast<int>(progress * Maximum), Maximum - 1);
+            if (!m_dialog->Update(value))
+                m_cancelled = true;
+        }
+
+        bool ProgressDialogStatus::doCancelled() const {
+            return m_cancelled;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ProgressDialogStatus
+#define TrenchBroom_ProgressDialogStatus
+
+#include "Macros.h"
+#include "ProgressStatus.h"
+
+#include <wx/stopwatch.h>
+#include <wx/string.h>
+
+class wxProgressDialog;
+class wxWindow;
+
+namespace TrenchBroom {
+    namespace View {
+        /**
+         * Shows the progress in a modal dialog that allows cancelling the operation. The dialog only appears once the
+         * operation has taken longer than a short delay, so that quick operations do not flash a dialog.
+         */
+        class ProgressDialogStatus : public ProgressStatus {
+        private:
+            static const long ShowDelay;
+            static const int Maximum;
+
+            wxWindow* m_parent;
+            wxString m_title;
+            wxStopWatch m_stopWatch;
+            wxProgressDialog* m_dialog;
+            bool m_cancelled;
+        public:
+            ProgressDialogStatus(wxWindow* parent, const wxString& title);
+            ~ProgressDialogStatus() override;
+        private:
+            void doProgress(double progress) override;
+            bool doCancelled() const override;
+
+            deleteCopyAndAssignment(ProgressDialogStatus)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_ProgressDialogStatus) */
@@ -30,6 +30,7 @@ using VEC = Vec<AABB::FloatType, AABB::Components>;
 
 void assertTree(const std::string& exp, const AABB& actual);
 void assertIntersectors(const AABB& tree, const Ray<AABB::FloatType, AABB::Components>& ray, std::initializer_list<AABB::DataType> items);
+void assertIntersectors(const AABB& tree, const BOX& bounds, std::initializer_list<AABB::DataType> items);
 
 TEST(AABBTreeTest, createEmptyTree) {
     AABB tree;
@@ -468,6 +469,23 @@ TEST(AABBTreeTest, findIntersectorsFromInsideRootBBox) {
     assertIntersectors(tree, RAY(VEC(0.0,  0.0,  0.0), VEC::PosX), { 2u });
 }
 
+TEST(AABBTreeTest, findIntersectorsOfBounds) {
+    AABB tree;
+    assertIntersectors(tree, BOX(VEC(-1.0, -1.0, -1.0), VEC(1.0, 1.0, 1.0)), {});
+
+    tree.insert(BOX(VEC(-4.0, -1.0, -1.0), VEC(-2.0, +1.0, +1.0)), 1u);
+    tree.insert(BOX(VEC(+2.0, -1.0, -1.0), VEC(+4.0, +1.0, +1.0)), 2u);
+    tree.insert(BOX(VEC(-1.0, +2.0, -1.0), VEC(+1.0, +4.0, +1.0)), 3u);
+
+    assertIntersectors(tree, BOX(VEC(-1.0, -1.0, -1.0), VEC(1.0, 1.0, 1.0)), {});
+    assertIntersectors(tree, BOX(VEC(-3.0, -1.0, -1.0), VEC(1.0, 1.0, 1.0)), { 1u });
+    assertIntersectors(tree, BOX(VEC(-3.0, -1.0, -1.0), VEC(3.0, 1.0, 1.0)), { 1u, 2u });
+    assertIntersectors(tree, BOX(VEC(-5.0, -5.0, -5.0), VEC(5.0, 5.0, 5.0)), { 1u, 2u, 3u });
+
+    // touching bounds intersect
+    assertIntersectors(tree, BOX(VEC(-1.0, 1.0, -1.0), VEC(1.0, 2.0, 1.0)), { 3u });
+}
+
 void assertTree(const std::string& exp, const AABB& actual) {
     std::stringstream str;
     actual.print(str);
@@ -482,3 +500,15 @@ void assertIntersectors(const AABB& tree, const Ray<AABB::FloatType, AABB::Compo
 
     ASSERT_EQ(expected, actual);
 }
+
+void assertIntersectors(const AABB& tree, const BOX& bounds, std::initializer_list<AABB::DataType> items) {
+    const std::set<AABB::DataType> expected(items);
+    std::set<AABB::DataType> actual;
+
+    tree.findIntersectors(bounds, std::inserter(actual, std::end(actual)));
+
+    ASSERT_EQ(expected, actual);
+
+    const AABB::List list = tree.findIntersectors(bounds);
+    ASSERT_EQ(expected, std::set<AABB::DataType>(std::begin(list), std::end(list)));
+}
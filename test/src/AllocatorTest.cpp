@@ -0,0 +1,110 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Allocator.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+class AllocatorTestObject : public Allocator<AllocatorTestObject> {
+public:
+    size_t value;
+    
+    explicit AllocatorTestObject(const size_t i_value) :
+    value(i_value) {}
+};
+
+TEST(AllocatorTest, reuseFreedBlocks) {
+    AllocatorTestObject* first = new AllocatorTestObject(1);
+    delete first;
+    
+    AllocatorTestObject* second = new AllocatorTestObject(2);
+    ASSERT_EQ(first, second);
+    delete second;
+}
+
+TEST(AllocatorTest, deleteOnOtherThread) {
+    std::vector<AllocatorTestObject*> objects;
+    for (size_t i = 0; i < 10000; ++i)
+        objects.push_back(new AllocatorTestObject(i));
+    
+    std::thread worker([&objects]() {
+        for (AllocatorTestObject* object : objects)
+            delete object;
+    });
+    worker.join();
+    
+    // the blocks freed on the worker thread are returned to the arena of this thread
+    AllocatorTestObject* object = new AllocatorTestObject(0);
+    ASSERT_TRUE(std::find(std::begin(objects), std::end(objects), object) != std::end(objects));
+    delete object;
+}
+
+TEST(AllocatorTest, allocateOnOtherThread) {
+    std::vector<AllocatorTestObject*> objects;
+    std::thread worker([&objects]() {
+        for (size_t i = 0; i < 10000; ++i)
+            objects.push_back(new AllocatorTestObject(i));
+    });
+    worker.join();
+    
+    // the arena of the worker thread outlives the worker thread
+    for (size_t i = 0; i < objects.size(); ++i)
+        ASSERT_EQ(i, objects[i]->value);
+    for (AllocatorTestObject* object : objects)
+        delete object;
+}
+
+TEST(AllocatorTest, scratchArena) {
+    AllocatorTestObject* outside = new AllocatorTestObject(0);
+    
+    {
+        const ScratchArena scratch;
+        ASSERT_EQ(&scratch, ScratchArena::current());
+        
+        std::vector<AllocatorTestObject*> objects;
+        for (size_t i = 0; i < 10000; ++i)
+            objects.push_back(new AllocatorTestObject(i));
+        for (size_t i = 0; i < objects.size(); ++i)
+            ASSERT_EQ(i, objects[i]->value);
+        for (AllocatorTestObject* object : objects)
+            delete object;
+        
+        // objects allocated outside of the scratch arena are freed as usual
+        delete outside;
+    }
+    
+    ASSERT_EQ(nullptr, ScratchArena::current());
+    
+    AllocatorTestObject* object = new AllocatorTestObject(0);
+    ASSERT_EQ(outside, object);
+    delete object;
+}
+
+TEST(AllocatorTest, nestedScratchArenas) {
+    const ScratchArena outer;
+    {
+        const ScratchArena inner;
+        ASSERT_EQ(&inner, ScratchArena::current());
+    }
+    ASSERT_EQ(&outer, ScratchArena::current());
+}
@@ -0,0 +1,127 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Exceptions.h"
+#include "Assets/EntityModel.h"
+#include "Assets/EntityModelManager.h"
+#include "IO/EntityModelLoader.h"
+#include "IO/Path.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace TrenchBroom {
+    namespace Assets {
+        class TestEntityModel : public EntityModel {
+        private:
+            Renderer::TexturedIndexRangeRenderer* doBuildRenderer(const size_t skinIndex, const size_t frameIndex) const override { return nullptr; }
+            Renderer::MeshSimplifier::TexturedTriangles doGetTriangles(const size_t skinIndex, const size_t frameIndex) const override { return Renderer::MeshSimplifier::TexturedTriangles(); }
+            BBox3f doGetBounds(const size_t skinIndex, const size_t frameIndex) const override { return BBox3f(8.0f); }
+            BBox3f doGetTransformedBounds(const size_t skinIndex, const size_t frameIndex, const Mat4x4f& transformation) const override { return BBox3f(8.0f); }
+            void doPrepare(int minFilter, int magFilter) override {}
+            void doSetTextureMode(int minFilter, int magFilter) override {}
+        };
+        
+        class TestEntityModelLoader : public IO::EntityModelLoader {
+        private:
+            Assets::EntityModel* doLoadEntityModel(const IO::Path& path) const override {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                if (path.extension() != "mdl")
+                    throw GameException("Unsupported model format '" + path.asString() + "'");
+                return new TestEntityModel();
+            }
+        };
+        
+        inline void waitForModels(EntityModelManager& manager) {
+            while (manager.loading()) {
+                manager.collectLoadedModels();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        
+        TEST(EntityModelManagerTest, requestModelLoadsInBackground) {
+            TestEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+            
+            std::atomic<size_t> callbackCount(0);
+            manager.setLoadCallback([&callbackCount]() { ++callbackCount; });
+            
+            const IO::Path path("progs/player.mdl");
+            const size_t generation = manager.modelGeneration();
+            
+            ASSERT_TRUE(manager.requestModel(path) == nullptr);
+            ASSERT_TRUE(manager.loading());
+            
+            waitForModels(manager);
+            ASSERT_EQ(1u, callbackCount);
+            ASSERT_NE(generation, manager.modelGeneration());
+            
+            EntityModel* model = manager.requestModel(path);
+            ASSERT_TRUE(model != nullptr);
+            ASSERT_EQ(model, manager.model(path));
+            ASSERT_FALSE(manager.loading());
+        }
+        
+        TEST(EntityModelManagerTest, requestMissingModel) {
+            TestEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+            
+            const IO::Path path("progs/player.txt");
+            ASSERT_TRUE(manager.requestModel(path) == nullptr);
+            waitForModels(manager);
+            
+            // failed models are not loaded again
+            ASSERT_TRUE(manager.requestModel(path) == nullptr);
+            ASSERT_FALSE(manager.loading());
+            ASSERT_TRUE(manager.safeGetModel(path) == nullptr);
+        }
+        
+        TEST(EntityModelManagerTest, modelWaitsForBackgroundLoad) {
+            TestEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+            
+            const IO::Path path("progs/player.mdl");
+            ASSERT_TRUE(manager.requestModel(path) == nullptr);
+            
+            EntityModel* model = manager.model(path);
+            ASSERT_TRUE(model != nullptr);
+            ASSERT_FALSE(manager.loading());
+            ASSERT_EQ(model, manager.requestModel(path));
+        }
+        
+        TEST(EntityModelManagerTest, clearWhileLoading) {
+            TestEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+            
+            for (size_t i = 0; i < 32; ++i)
+                manager.requestModel(IO::Path("progs/model" + std::to_string(i) + ".mdl"));
+            ASSERT_TRUE(manager.loading());
+            
+            manager.clear();
+            ASSERT_FALSE(manager.loading());
+        }
+    }
+}
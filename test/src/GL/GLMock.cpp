@@ -87,6 +87,14 @@ namespace TrenchBroom {
         
         glDrawArrays.bindMemFunc(this, &GLMock::DrawArrays);
         glMultiDrawArrays.bindMemFunc(this, &GLMock::MultiDrawArrays);
+        glDrawElements.bindMemFunc(this, &GLMock::DrawElements);
+        glMultiDrawElements.bindMemFunc(this, &GLMock::MultiDrawElements);
+        
+        glInstancingSupported.bindMemFunc(this, &GLMock::InstancingSupported);
+        glDrawArraysInstanced.bindMemFunc(this, &GLMock::DrawArraysInstanced);
+        glVertexAttribDivisor.bindMemFunc(this, &GLMock::VertexAttribDivisor);
+        
+        glHalfFloatVerticesSupported.bindMemFunc(this, &GLMock::HalfFloatVerticesSupported);
         
         glCreateShader.bindMemFunc(this, &GLMock::CreateShader);
         glDeleteShader.bindMemFunc(this, &GLMock::DeleteShader);
@@ -141,6 +149,7 @@ namespace TrenchBroom {
         glUniformMatrix4x3fv.bindMemFunc(this, &GLMock::UniformMatrix4x3fv);
         
         glGetUniformLocation.bindMemFunc(this, &GLMock::GetUniformLocation);
+        glGetAttribLocation.bindMemFunc(this, &GLMock::GetAttribLocation);
         
 #ifdef __APPLE__
         glFinishObjectAPPLE.bindMemFunc(this, &GLMock::FinishObjectAPPLE);
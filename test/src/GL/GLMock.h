@@ -94,6 +94,14 @@ namespace TrenchBroom {
         
         MOCK_METHOD3(DrawArrays, void(GLenum, GLint, GLsizei));
         MOCK_METHOD4(MultiDrawArrays, void(GLenum, const GLint*, const GLsizei*, GLsizei));
+        MOCK_METHOD4(DrawElements, void(GLenum, GLsizei, GLenum, const GLvoid*));
+        MOCK_METHOD5(MultiDrawElements, void(GLenum, const GLsizei*, GLenum, const GLvoid**, GLsizei));
+        
+        MOCK_METHOD0(InstancingSupported, GLboolean());
+        MOCK_METHOD4(DrawArraysInstanced, void(GLenum, GLint, GLsizei, GLsizei));
+        MOCK_METHOD2(VertexAttribDivisor, void(GLuint, GLuint));
+        
+        MOCK_METHOD0(HalfFloatVerticesSupported, GLboolean());
         
         MOCK_METHOD1(CreateShader, GLuint(GLenum));
         MOCK_METHOD1(DeleteShader, void(GLuint));
@@ -148,6 +156,7 @@ namespace TrenchBroom {
         MOCK_METHOD4(UniformMatrix4x3fv, void(GLint, GLsizei, GLboolean, const GLfloat*));
         
         MOCK_METHOD2(GetUniformLocation, GLint(GLuint, const GLchar*));
+        MOCK_METHOD2(GetAttribLocation, GLint(GLuint, const GLchar*));
         
 #ifdef __APPLE__
         void FinishObjectAPPLE(GLenum, GLint) {}
@@ -0,0 +1,162 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Assets/MdlModel.h"
+#include "Assets/Texture.h"
+#include "IO/AssetCache.h"
+#include "IO/DiskIO.h"
+#include "IO/Path.h"
+
+#include <cstring>
+
+#include <wx/filefn.h>
+
+namespace TrenchBroom {
+    namespace IO {
+        inline void deleteAssetCache(const Path& directory) {
+            if (!Disk::directoryExists(directory))
+                return;
+            for (const Path& file : Disk::getDirectoryContents(directory))
+                Disk::deleteFile(directory + file);
+            ASSERT_TRUE(::wxRmdir(directory.asString()));
+        }
+
+        inline MappedFile::Ptr toMappedFile(const String& data) {
+            char* buffer = new char[data.size()];
+            std::memcpy(buffer, data.data(), data.size());
+            return MappedFile::Ptr(new MappedFileBuffer(Path("cache"), buffer, data.size()));
+        }
+
+        TEST(AssetCacheTest, keyDependsOnAllValues) {
+            AssetCache::Key key1;
+            key1.add("ab");
+            key1.add("c");
+
+            AssetCache::Key key2;
+            key2.add("a");
+            key2.add("bc");
+
+            AssetCache::Key key3;
+            key3.add("ab");
+            key3.add("c");
+
+            ASSERT_NE(key1.hash(), key2.hash());
+            ASSERT_EQ(key1.hash(), key3.hash());
+            ASSERT_EQ(16u, key1.asString().size());
+        }
+
+        TEST(AssetCacheTest, writeAndReadEntry) {
+            const Path directory = Disk::getCurrentWorkingDir() + Path("assetcachetest");
+            deleteAssetCache(directory);
+
+            const AssetCache cache(directory);
+
+            AssetCache::Key key;
+            key.add("some asset");
+
+            AssetCache::Key otherKey;
+            otherKey.add("some other asset");
+
+            ASSERT_TRUE(cache.read(key).get() == nullptr);
+
+            cache.write(key, "some contents");
+            MappedFile::Ptr entry = cache.read(key);
+            ASSERT_TRUE(entry.get() != nullptr);
+            ASSERT_EQ(String("some contents"), String(entry->begin(), entry->end()));
+            ASSERT_TRUE(cache.read(otherKey).get() == nullptr);
+
+            cache.write(key, "other contents");
+            entry = cache.read(key);
+            ASSERT_TRUE(entry.get() != nullptr);
+            ASSERT_EQ(String("other contents"), String(entry->begin(), entry->end()));
+            entry.reset();
+
+            deleteAssetCache(directory);
+        }
+
+        TEST(AssetCacheTest, writeAndReadMdlModel) {
+            typedef Assets::MdlFrame::Vertex Vertex;
+
+            Assets::TextureBuffer buffer(2 * 2 * 4);
+            for (size_t i = 0; i < buffer.size(); ++i)
+                buffer[i] = static_cast<unsigned char>(i);
+
+            Assets::MdlModel model("model");
+            model.addSkin(new Assets::MdlSkin(new Assets::Texture("skin", 2, 2, Color(0.5f, 0.25f, 0.125f, 1.0f), buffer, GL_RGBA, Assets::TextureType::Masked)));
+
+            Assets::MdlFrame::VertexList vertices;
+            vertices.push_back(Vertex(Vec3f(0.0f, 0.0f, 0.0f), Vec2f(0.0f, 0.0f)));
+            vertices.push_back(Vertex(Vec3f(8.0f, 0.0f, 0.0f), Vec2f(1.0f, 0.0f)));
+            vertices.push_back(Vertex(Vec3f(0.0f, 8.0f, 4.0f), Vec2f(0.0f, 1.0f)));
+            const BBox3f bounds(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(8.0f, 8.0f, 4.0f));
+            model.addFrame(new Assets::MdlFrame("frame", vertices, bounds));
+            model.addFrame(new Assets::MdlFrameGroup());
+
+            AssetCache::Writer writer;
+            AssetCache::writeMdlModel(writer, model);
+
+            AssetCache::Reader reader(toMappedFile(writer.data()));
+            Assets::MdlModel* cachedModel = AssetCache::readMdlModel(reader, "model");
+            ASSERT_TRUE(reader.eof());
+
+            ASSERT_EQ(1u, cachedModel->skins().size());
+            const Assets::Texture* texture = cachedModel->skins().front()->firstPicture();
+            ASSERT_EQ("skin", texture->name());
+            ASSERT_EQ(2u, texture->width());
+            ASSERT_EQ(2u, texture->height());
+            ASSERT_EQ(GL_RGBA, texture->format());
+            ASSERT_TRUE(texture->type() == Assets::TextureType::Masked);
+            ASSERT_EQ(Color(0.5f, 0.25f, 0.125f, 1.0f), texture->averageColor());
+            ASSERT_FALSE(texture->isPrepared());
+
+            // the mip buffers are only copied from the cache when they are requested
+            const Assets::TextureBuffer::List& buffers = texture->buffers();
+            ASSERT_EQ(1u, buffers.size());
+            ASSERT_EQ(buffer.size(), buffers.front().size());
+            ASSERT_EQ(0, std::memcmp(buffer.ptr(), buffers.front().ptr(), buffer.size()));
+
+            ASSERT_EQ(2u, cachedModel->frames().size());
+            const Assets::MdlFrame* frame = cachedModel->frames().front()->firstFrame();
+            ASSERT_EQ("frame", frame->name());
+            ASSERT_EQ(bounds, frame->bounds());
+            ASSERT_EQ(vertices, frame->triangles());
+            ASSERT_TRUE(cachedModel->frames().back()->firstFrame() == nullptr);
+
+            delete cachedModel;
+        }
+
+        TEST(AssetCacheTest, readDamagedMdlModel) {
+            Assets::TextureBuffer buffer(2 * 2 * 4);
+            Assets::MdlModel model("model");
+            model.addSkin(new Assets::MdlSkin(new Assets::Texture("skin", 2, 2, Color(), buffer, GL_RGBA, Assets::TextureType::Opaque)));
+            model.addFrame(new Assets::MdlFrameGroup());
+
+            AssetCache::Writer writer;
+            AssetCache::writeMdlModel(writer, model);
+            const String& data = writer.data();
+
+            for (size_t size = 0; size < data.size(); ++size) {
+                AssetCache::Reader reader(toMappedFile(data.substr(0, size)));
+                ASSERT_THROW(AssetCache::readMdlModel(reader, "model"), FileFormatException);
+            }
+        }
+    }
+}
@@ -72,5 +72,28 @@ namespace TrenchBroom {
             assertTexture("blowjob_machine",   128, 128, wadFS, textureLoader);
             assertTexture("lasthopeofhuman",   128, 128, wadFS, textureLoader);
         }
+
+        TEST(IdMipTextureReaderTest, testLoadTextureLazily) {
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("data/palette.lmp"));
+            
+            TextureReader::TextureNameStrategy nameStrategy;
+            IdMipTextureReader textureLoader(nameStrategy, palette);
+            
+            const Path wadPath = Disk::getCurrentWorkingDir() + Path("data/IO/Wad/cr8_czg.wad");
+            WadFileSystem wadFS(wadPath);
+            
+            // textures read from a file defer decoding, but must compute the same average color as eagerly read ones
+            const MappedFile::Ptr file = wadFS.openFile(Path("speedM_1.D"));
+            const Assets::Texture* lazyTexture = textureLoader.readTexture(file);
+            const Assets::Texture* eagerTexture = textureLoader.readTexture(file->begin(), file->end(), file->path());
+            
+            ASSERT_EQ(eagerTexture->name(), lazyTexture->name());
+            ASSERT_EQ(eagerTexture->averageColor(), lazyTexture->averageColor());
+            ASSERT_FALSE(lazyTexture->isPrepared());
+            
+            delete eagerTexture;
+            delete lazyTexture;
+        }
     }
 }
@@ -0,0 +1,175 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "IO/MapCache.h"
+#include "IO/NodeWriter.h"
+#include "IO/Path.h"
+#include "IO/TestParserStatus.h"
+#include "IO/WorldReader.h"
+#include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/Entity.h"
+#include "Model/Group.h"
+#include "Model/Layer.h"
+#include "Model/World.h"
+
+#include <sstream>
+
+namespace TrenchBroom {
+    namespace IO {
+        static const String MapCacheTestData("{\n"
+                                             "\"classname\" \"worldspawn\"\n"
+                                             "\"message\" \"yay\"\n"
+                                             "{\n"
+                                             "( -64 -64 -16 ) ( -64 -63 -16 ) ( -64 -64 -15 ) __TB_empty [ 0 -1 0 0 ] [ 0 0 -1 0 ] 0 1 1\n"
+                                             "( -64 -64 -16 ) ( -64 -64 -15 ) ( -63 -64 -16 ) __TB_empty [ 1 0 0 0 ] [ 0 0 -1 0 ] 0 1 1\n"
+                                             "( -64 -64 -16 ) ( -63 -64 -16 ) ( -64 -63 -16 ) __TB_empty [ -1 0 0 0 ] [ 0 -1 0 0 ] 0 1 1\n"
+                                             "( 64 64 16 ) ( 64 65 16 ) ( 65 64 16 ) __TB_empty [ 1 0 0 0 ] [ 0 -1 0 0 ] 0 1 1\n"
+                                             "( 64 64 16 ) ( 65 64 16 ) ( 64 64 17 ) __TB_empty [ -1 0 0 0 ] [ 0 0 -1 0 ] 0 1 1\n"
+                                             "( 64 64 16 ) ( 64 64 17 ) ( 64 65 16 ) some_tex [ 0 0.707107 0.707107 12 ] [ 0 -0.707107 0.707107 4 ] 45 0.5 2\n"
+                                             "}\n"
+                                             "}\n"
+                                             "{\n"
+                                             "\"classname\" \"func_group\"\n"
+                                             "\"_tb_type\" \"_tb_layer\"\n"
+                                             "\"_tb_name\" \"My Layer\"\n"
+                                             "\"_tb_id\" \"1\"\n"
+                                             "}\n"
+                                             "{\n"
+                                             "\"classname\" \"func_group\"\n"
+                                             "\"_tb_type\" \"_tb_group\"\n"
+                                             "\"_tb_name\" \"My Group\"\n"
+                                             "\"_tb_id\" \"2\"\n"
+                                             "\"_tb_layer\" \"1\"\n"
+                                             "{\n"
+                                             "( 0 0 0 ) ( 0 1 0 ) ( 0 0 1 ) tex [ 0 -1 0 0 ] [ 0 0 -1 0 ] 0 1 1\n"
+                                             "( 0 0 0 ) ( 0 0 1 ) ( 1 0 0 ) tex [ 1 0 0 0 ] [ 0 0 -1 0 ] 0 1 1\n"
+                                             "( 0 0 0 ) ( 1 0 0 ) ( 0 1 0 ) tex [ -1 0 0 0 ] [ 0 -1 0 0 ] 0 1 1\n"
+                                             "( 8 8 8 ) ( 8 9 8 ) ( 9 8 8 ) tex [ 1 0 0 0 ] [ 0 -1 0 0 ] 0 1 1\n"
+                                             "( 8 8 8 ) ( 9 8 8 ) ( 8 8 9 ) tex [ -1 0 0 0 ] [ 0 0 -1 0 ] 0 1 1\n"
+                                             "( 8 8 8 ) ( 8 8 9 ) ( 8 9 8 ) tex [ 0 1 0 0 ] [ 0 0 -1 0 ] 0 1 1\n"
+                                             "}\n"
+                                             "}\n"
+                                             "{\n"
+                                             "\"classname\" \"light\"\n"
+                                             "\"origin\" \"1 2 3\"\n"
+                                             "\"_tb_group\" \"2\"\n"
+                                             "}\n");
+
+        inline String writeWorld(Model::World* world) {
+            StringStream str;
+            NodeWriter writer(world, str);
+            writer.writeMap();
+            return str.str();
+        }
+
+        inline String writeCache(const MapCache& cache, const Model::World* world) {
+            std::stringstream str;
+            cache.write(world, str);
+            return str.str();
+        }
+
+        TEST(MapCacheTest, writeAndReadWorld) {
+            const BBox3 worldBounds(8192);
+            const MapCache cache(MapCacheTestData.data(), MapCacheTestData.data() + MapCacheTestData.size(), 1234);
+
+            TestParserStatus status;
+            WorldReader reader(MapCacheTestData, nullptr);
+            Model::World* world = reader.read(Model::MapFormat::Valve, worldBounds, status);
+            ASSERT_TRUE(world != nullptr);
+
+            const String data = writeCache(cache, world);
+            Model::World* cachedWorld = cache.read(data.data(), data.data() + data.size(), Model::MapFormat::Valve, worldBounds, nullptr);
+            ASSERT_TRUE(cachedWorld != nullptr);
+
+            ASSERT_EQ(world->lineNumber(), cachedWorld->lineNumber());
+            ASSERT_EQ(world->lineCount(), cachedWorld->lineCount());
+
+            // the serializer assigns new layer and group ids every time, so we compare the worldspawn entity only
+            const String expected = writeWorld(world);
+            const String actual = writeWorld(cachedWorld);
+            ASSERT_EQ(expected.substr(0, expected.find("// entity 1")), actual.substr(0, actual.find("// entity 1")));
+
+            ASSERT_EQ(2u, cachedWorld->children().size());
+            const Model::Layer* layer = static_cast<const Model::Layer*>(cachedWorld->children().back());
+            ASSERT_EQ("My Layer", layer->name());
+            ASSERT_EQ(1u, layer->children().size());
+
+            const Model::Group* group = static_cast<const Model::Group*>(layer->children().front());
+            ASSERT_EQ("My Group", group->name());
+            ASSERT_EQ(2u, group->children().size());
+
+            const Model::Brush* groupBrush = static_cast<const Model::Brush*>(group->children().front());
+            ASSERT_EQ(6u, groupBrush->faces().size());
+            ASSERT_EQ(BBox3(Vec3(0.0, 0.0, 0.0), Vec3(8.0, 8.0, 8.0)), groupBrush->bounds());
+
+            const Model::Entity* light = static_cast<const Model::Entity*>(group->children().back());
+            ASSERT_EQ("light", light->classname());
+            ASSERT_EQ("1 2 3", light->attribute("origin"));
+
+            const Model::Brush* originalBrush = static_cast<const Model::Brush*>(world->defaultLayer()->children().front());
+            const Model::Brush* brush = static_cast<const Model::Brush*>(cachedWorld->defaultLayer()->children().front());
+            ASSERT_EQ(4u, brush->lineNumber());
+            ASSERT_EQ(originalBrush->lineCount(), brush->lineCount());
+            ASSERT_TRUE(brush->bounds().contains(Vec3(64.0, 64.0, 16.0)));
+
+            // the geometry is created from the cached vertices rather than computed from the face planes
+            ASSERT_TRUE(brush->fullySpecified());
+            ASSERT_EQ(originalBrush->vertexPositions(), brush->vertexPositions());
+            ASSERT_EQ(originalBrush->edgeCount(), brush->edgeCount());
+            for (size_t i = 0; i < brush->faces().size(); ++i)
+                ASSERT_TRUE(brush->faces()[i]->hasVertices(originalBrush->faces()[i]->polygon()));
+
+            delete cachedWorld;
+            delete world;
+        }
+
+        TEST(MapCacheTest, readOutdatedCache) {
+            const BBox3 worldBounds(8192);
+            const char* begin = MapCacheTestData.data();
+            const char* end = begin + MapCacheTestData.size();
+            const MapCache cache(begin, end, 1234);
+
+            TestParserStatus status;
+            WorldReader reader(MapCacheTestData, nullptr);
+            Model::World* world = reader.read(Model::MapFormat::Valve, worldBounds, status);
+            const String data = writeCache(cache, world);
+            delete world;
+
+            // modified, touched or truncated map files as well as different formats must not use the cache
+            const MapCache modifiedCache(begin, end - 1, 1234);
+            ASSERT_TRUE(modifiedCache.read(data.data(), data.data() + data.size(), Model::MapFormat::Valve, worldBounds, nullptr) == nullptr);
+
+            const MapCache touchedCache(begin, end, 1235);
+            ASSERT_TRUE(touchedCache.read(data.data(), data.data() + data.size(), Model::MapFormat::Valve, worldBounds, nullptr) == nullptr);
+
+            ASSERT_TRUE(cache.read(data.data(), data.data() + data.size(), Model::MapFormat::Standard, worldBounds, nullptr) == nullptr);
+
+            // damaged cache files must not be used
+            for (size_t size = 0; size < data.size(); size += 7)
+                ASSERT_TRUE(cache.read(data.data(), data.data() + size, Model::MapFormat::Valve, worldBounds, nullptr) == nullptr);
+        }
+
+        TEST(MapCacheTest, cachePath) {
+            ASSERT_EQ(Path("maps/test.map.tbcache"), MapCache::cachePath(Path("maps/test.map")));
+        }
+    }
+}
@@ -19,15 +19,21 @@
 
 #include <gtest/gtest.h>
 
+#include "CollectionUtils.h"
 #include "StringUtils.h"
+#include "IO/BrushFaceReader.h"
 #include "IO/NodeWriter.h"
+#include "IO/TestParserStatus.h"
 #include "Model/Brush.h"
 #include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
 #include "Model/Group.h"
 #include "Model/Layer.h"
 #include "Model/MapFormat.h"
 #include "Model/World.h"
 
+#include <cstdio>
+
 namespace TrenchBroom {
     namespace IO {
         TEST(NodeWriterTest, writeEmptyMap) {
@@ -95,6 +101,48 @@ namespace TrenchBroom {
                          "}\n", result.c_str());
         }
         
+        TEST(NodeWriterTest, writeWorldspawnWithBrushToFile) {
+            const BBox3 worldBounds(8192.0);
+            
+            Model::World map(Model::MapFormat::Quake2, nullptr, worldBounds);
+            map.addOrUpdateAttribute("classname", "worldspawn");
+            
+            Model::BrushBuilder builder(&map, worldBounds);
+            Model::Brush* brush = builder.createCube(64.0, "none");
+            map.defaultLayer()->addChild(brush);
+            
+            FILE* file = std::tmpfile();
+            ASSERT_TRUE(file != nullptr);
+            
+            NodeWriter writer(&map, file);
+            writer.writeMap();
+            
+            const long size = std::ftell(file);
+            ASSERT_GT(size, 0);
+            String result(static_cast<size_t>(size), ' ');
+            std::rewind(file);
+            ASSERT_EQ(static_cast<size_t>(size), std::fread(&result[0], 1, result.size(), file));
+            std::fclose(file);
+            
+            ASSERT_STREQ("// entity 0\n"
+                         "{\n"
+                         "\"classname\" \"worldspawn\"\n"
+                         "// brush 0\n"
+                         "{\n"
+                         "( -32 -32 -32 ) ( -32 -31 -32 ) ( -32 -32 -31 ) none 0 0 0 1 1 0 0 0\n"
+                         "( 32 32 32 ) ( 32 32 33 ) ( 32 33 32 ) none 0 0 0 1 1 0 0 0\n"
+                         "( -32 -32 -32 ) ( -32 -32 -31 ) ( -31 -32 -32 ) none 0 0 0 1 1 0 0 0\n"
+                         "( 32 32 32 ) ( 33 32 32 ) ( 32 32 33 ) none 0 0 0 1 1 0 0 0\n"
+                         "( 32 32 32 ) ( 32 33 32 ) ( 33 32 32 ) none 0 0 0 1 1 0 0 0\n"
+                         "( -32 -32 -32 ) ( -31 -32 -32 ) ( -32 -31 -32 ) none 0 0 0 1 1 0 0 0\n"
+                         "}\n"
+                         "}\n", result.c_str());
+            
+            ASSERT_EQ(5u, brush->lineNumber());
+            ASSERT_TRUE(brush->containsLine(12));
+            ASSERT_FALSE(brush->containsLine(13));
+        }
+        
         TEST(NodeWriterTest, writeWorldspawnWithBrushInCustomLayer) {
             const BBox3 worldBounds(8192.0);
             
@@ -374,6 +422,55 @@ namespace TrenchBroom {
             delete brush;
         }
 
+        TEST(NodeWriterTest, writeFacesWithLargeAndTinyCoordinatesToFile) {
+            const BBox3 worldBounds(1048576.0);
+            
+            Model::World map(Model::MapFormat::Quake2, nullptr, worldBounds);
+            Model::BrushBuilder builder(&map, worldBounds);
+            Model::Brush* brush = builder.createCuboid(BBox3(Vec3(1.0e-7, 2.5e-9, -123456.789), Vec3(100000.0, 300000.0, 7.0)), "none");
+            
+            FILE* file = std::tmpfile();
+            ASSERT_TRUE(file != nullptr);
+            
+            NodeWriter writer(&map, file);
+            writer.writeBrushFaces(brush->faces());
+            
+            const long size = std::ftell(file);
+            ASSERT_GT(size, 0);
+            String result(static_cast<size_t>(size), ' ');
+            std::rewind(file);
+            ASSERT_EQ(static_cast<size_t>(size), std::fread(&result[0], 1, result.size(), file));
+            std::fclose(file);
+            
+            // the output must match what the serializer wrote with fprintf
+            String expected;
+            for (const Model::BrushFace* face : brush->faces()) {
+                const Model::BrushFace::Points& points = face->points();
+                char line[512];
+                std::snprintf(line, sizeof(line),
+                              "( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) %s %.6g %.6g %.6g %.6g %.6g %d %d %.6g\n",
+                              points[0].x(), points[0].y(), points[0].z(),
+                              points[1].x(), points[1].y(), points[1].z(),
+                              points[2].x(), points[2].y(), points[2].z(),
+                              face->textureName().c_str(),
+                              face->xOffset(), face->yOffset(), face->rotation(), face->xScale(), face->yScale(),
+                              face->surfaceContents(), face->surfaceFlags(), face->surfaceValue());
+                expected += line;
+            }
+            ASSERT_EQ(expected, result);
+            
+            TestParserStatus status;
+            BrushFaceReader reader(result, &map);
+            Model::BrushFaceList faces = reader.read(worldBounds, status);
+            ASSERT_EQ(brush->faces().size(), faces.size());
+            for (size_t i = 0; i < faces.size(); ++i) {
+                for (size_t j = 0; j < 3; ++j)
+                    ASSERT_EQ(brush->faces()[i]->points()[j], faces[i]->points()[j]);
+            }
+            
+            VectorUtils::clearAndDelete(faces);
+            delete brush;
+        }
         
         TEST(NodeWriterTest, writePropertiesWithQuotationMarks) {
             const BBox3 worldBounds(8192.0);
@@ -0,0 +1,117 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Assets/Palette.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureCollection.h"
+#include "IO/AssetCache.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/DiskIO.h"
+#include "IO/IdMipTextureReader.h"
+#include "IO/Path.h"
+#include "IO/TextureCollectionLoader.h"
+#include "IO/WadFileSystem.h"
+
+#include <cstring>
+
+#include <wx/filefn.h>
+
+namespace TrenchBroom {
+    namespace IO {
+        TEST(TextureCollectionLoaderTest, loadWadCollection) {
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("data/palette.lmp"));
+            
+            TextureReader::PathSuffixNameStrategy nameStrategy(1, true);
+            IdMipTextureReader textureReader(nameStrategy, palette);
+            
+            const Path::List searchPaths(1, Disk::getCurrentWorkingDir() + Path("data/IO/Wad"));
+            FileTextureCollectionLoader loader(searchPaths);
+            
+            Assets::TextureCollection* collection = loader.loadTextureCollection(Path("cr8_czg.wad"), "D", textureReader);
+            ASSERT_TRUE(collection != nullptr);
+            
+            // the textures are decoded in parallel, but must be added in the order of the wad directory
+            const Assets::TextureList& textures = collection->textures();
+            ASSERT_EQ(21u, textures.size());
+            
+            const Path::List files = WadFileSystem(Disk::getCurrentWorkingDir() + Path("data/IO/Wad/cr8_czg.wad")).findItems(Path(""));
+            for (size_t i = 0; i < files.size(); ++i)
+                ASSERT_EQ(files[i].deleteExtension().asString(), textures[i]->name());
+            
+            delete collection;
+        }
+        
+        TEST(TextureCollectionLoaderTest, loadWadCollectionFromCache) {
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("data/palette.lmp"));
+            
+            TextureReader::PathSuffixNameStrategy nameStrategy(1, true);
+            IdMipTextureReader textureReader(nameStrategy, palette);
+            
+            const Path cacheDirectory = Disk::getCurrentWorkingDir() + Path("texturecachetest");
+            const AssetCache cache(cacheDirectory);
+            AssetCache::Key readerKey;
+            readerKey.add("idmip");
+            
+            const Path::List searchPaths(1, Disk::getCurrentWorkingDir() + Path("data/IO/Wad"));
+            FileTextureCollectionLoader loader(searchPaths);
+            loader.setAssetCache(&cache, readerKey);
+            
+            // the first load writes the textures to the cache once they are decoded, the second one reads them from it
+            Assets::TextureCollection* decoded = loader.loadTextureCollection(Path("cr8_czg.wad"), "D", textureReader);
+            ASSERT_FALSE(Disk::directoryExists(cacheDirectory));
+            
+            decoded->decode();
+            const Path::List entries = Disk::getDirectoryContents(cacheDirectory);
+            ASSERT_EQ(1u, entries.size());
+            
+            Assets::TextureCollection* cached = loader.loadTextureCollection(Path("cr8_czg.wad"), "D", textureReader);
+            
+            const Assets::TextureList& decodedTextures = decoded->textures();
+            const Assets::TextureList& cachedTextures = cached->textures();
+            ASSERT_EQ(decodedTextures.size(), cachedTextures.size());
+            for (size_t i = 0; i < decodedTextures.size(); ++i) {
+                const Assets::Texture* expected = decodedTextures[i];
+                const Assets::Texture* actual = cachedTextures[i];
+                ASSERT_EQ(expected->name(), actual->name());
+                ASSERT_EQ(expected->width(), actual->width());
+                ASSERT_EQ(expected->height(), actual->height());
+                ASSERT_EQ(expected->averageColor(), actual->averageColor());
+                
+                const Assets::TextureBuffer::List& expectedBuffers = expected->buffers();
+                const Assets::TextureBuffer::List& actualBuffers = actual->buffers();
+                ASSERT_EQ(expectedBuffers.size(), actualBuffers.size());
+                for (size_t j = 0; j < expectedBuffers.size(); ++j) {
+                    ASSERT_EQ(expectedBuffers[j].size(), actualBuffers[j].size());
+                    ASSERT_EQ(0, std::memcmp(expectedBuffers[j].ptr(), actualBuffers[j].ptr(), expectedBuffers[j].size()));
+                }
+            }
+            
+            delete cached;
+            delete decoded;
+            
+            for (const Path& entry : entries)
+                Disk::deleteFile(cacheDirectory + entry);
+            ASSERT_TRUE(::wxRmdir(cacheDirectory.asString()));
+        }
+    }
+}
@@ -19,13 +19,20 @@
 
 #include <gtest/gtest.h>
 
+#include "ProgressStatus.h"
+#include "IO/ProgressParserStatus.h"
 #include "IO/TestParserStatus.h"
 #include "IO/WorldReader.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 #include "Model/Entity.h"
+#include "Model/Layer.h"
 #include "Model/World.h"
 
+#include <cstdlib>
+#include <map>
+#include <vector>
+
 namespace TrenchBroom {
     namespace IO {
         inline Model::BrushFace* findFaceByPoints(const Model::BrushFaceList& faces, const Vec3& point0, const Vec3& point1, const Vec3& point2) {
@@ -412,6 +419,57 @@ namespace TrenchBroom {
             delete world;
         }
         
+        TEST(WorldReaderTest, parseQuake2BrushFaceAttributes) {
+            const String data("{\n"
+                              "\"classname\" \"worldspawn\"\n"
+                              "{\n"
+                              "( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) tex1 1.5e1 .25 -0.5 1.03433 -0.55 8 16 2.5\n"
+                              "( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) tex2 0.12345678901234567 0 0 1 1 // comment\n"
+                              "( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) tex3 0 0 0 1 1 0 0 0\n"
+                              "( 64 64  -0 ) ( -0 64  -0 ) ( 64 64 -16 ) tex4 0 0 0 1 1\n"
+                              "( 64 64  -0 ) ( 64 64 -16 ) ( 64 -0  -0 ) tex5 0 0 0 1 1 0 0 0\n"
+                              "( 64 64  -0 ) ( 64 -0  -0 ) ( -0 64  -0 ) {tex6 0 0 0 1 1 0 0 0\n"
+                              "}\n"
+                              "}\n");
+            BBox3 worldBounds(8192);
+            
+            IO::TestParserStatus status;
+            WorldReader reader(data, nullptr);
+            
+            Model::World* world = reader.read(Model::MapFormat::Quake2, worldBounds, status);
+            
+            ASSERT_EQ(1u, world->childCount());
+            Model::Node* defaultLayer = world->children().front();
+            ASSERT_EQ(1u, defaultLayer->childCount());
+            
+            Model::Brush* brush = static_cast<Model::Brush*>(defaultLayer->children().front());
+            const Model::BrushFaceList& faces = brush->faces();
+            ASSERT_EQ(6u, faces.size());
+            
+            const Model::BrushFace* face1 = findFaceByPoints(faces, Vec3(  0.0,   0.0, -16.0), Vec3(  0.0,   0.0,   0.0), Vec3( 64.0,   0.0, -16.0));
+            ASSERT_TRUE(face1 != nullptr);
+            ASSERT_STREQ("tex1", face1->textureName().c_str());
+            ASSERT_EQ(15.0f, face1->xOffset());
+            ASSERT_EQ(0.25f, face1->yOffset());
+            ASSERT_EQ(-0.5f, face1->rotation());
+            ASSERT_EQ(static_cast<float>(std::atof("1.03433")), face1->xScale());
+            ASSERT_EQ(static_cast<float>(std::atof("-0.55")), face1->yScale());
+            ASSERT_EQ(8, face1->surfaceContents());
+            ASSERT_EQ(16, face1->surfaceFlags());
+            ASSERT_EQ(2.5f, face1->surfaceValue());
+            
+            const Model::BrushFace* face2 = findFaceByPoints(faces, Vec3(  0.0,   0.0, -16.0), Vec3(  0.0,  64.0, -16.0), Vec3(  0.0,   0.0,   0.0));
+            ASSERT_TRUE(face2 != nullptr);
+            ASSERT_STREQ("tex2", face2->textureName().c_str());
+            ASSERT_EQ(static_cast<float>(std::atof("0.12345678901234567")), face2->xOffset());
+            
+            const Model::BrushFace* face6 = findFaceByPoints(faces, Vec3( 64.0,  64.0,   0.0), Vec3( 64.0,   0.0,   0.0), Vec3(  0.0,  64.0,   0.0));
+            ASSERT_TRUE(face6 != nullptr);
+            ASSERT_STREQ("{tex6", face6->textureName().c_str());
+            
+            delete world;
+        }
+
         TEST(WorldReaderTest, parseQuakeBrushWithNumericalTextureName) {
             const String data("{\n"
                               "\"classname\" \"worldspawn\"\n"
@@ -761,6 +819,349 @@ namespace TrenchBroom {
             delete world;
         }
 
+        static String makeBrush(const String& textureName) {
+            return "{\n"
+                   "( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) " + textureName + " 0 0 0 1 1\n"
+                   "( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) " + textureName + " 0 0 0 1 1\n"
+                   "( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) " + textureName + " 0 0 0 1 1\n"
+                   "( 64 64  -0 ) ( -0 64  -0 ) ( 64 64 -16 ) " + textureName + " 0 0 0 1 1\n"
+                   "( 64 64  -0 ) ( 64 64 -16 ) ( 64 -0  -0 ) " + textureName + " 0 0 0 1 1\n"
+                   "( 64 64  -0 ) ( 64 -0  -0 ) ( -0 64  -0 ) " + textureName + " 0 0 0 1 1\n"
+                   "}\n";
+        }
+
+        TEST(WorldReaderTest, parseLargeMapInParallel) {
+            const size_t brushCount = 600;
+
+            StringStream str;
+            str << "// Game: Quake\n"
+                   "// Format: Standard\n"
+                   "{\n"
+                   "\"classname\" \"worldspawn\"\n";
+            for (size_t i = 0; i < brushCount; ++i)
+                str << makeBrush("tex" + std::to_string(i));
+            str << "}\n"
+                   "{\n"
+                   "\"classname\" \"info_player_start\"\n"
+                   "\"origin\" \"1 2 3\"\n"
+                   "}\n"
+                   "// a comment between entities\n"
+                   "{\n"
+                   "\"classname\" \"func_wall\"\n"
+                   << makeBrush("{blue") <<
+                   "}\n";
+            const String data = str.str();
+            BBox3 worldBounds(8192);
+
+            IO::TestParserStatus status;
+            WorldReader reader(data, nullptr);
+
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds, status);
+
+            ASSERT_TRUE(world != nullptr);
+            ASSERT_EQ(3u, world->lineNumber());
+            ASSERT_EQ(1u, world->childCount());
+
+            Model::Node* defaultLayer = world->children().front();
+            const Model::NodeList& children = defaultLayer->children();
+            ASSERT_EQ(brushCount + 2u, children.size());
+
+            for (size_t i = 0; i < brushCount; ++i) {
+                Model::Brush* brush = static_cast<Model::Brush*>(children[i]);
+                ASSERT_EQ(5u + 8u * i, brush->lineNumber());
+                ASSERT_STREQ(("tex" + std::to_string(i)).c_str(), brush->faces().front()->textureName().c_str());
+            }
+
+            const size_t entityLine = 5u + 8u * brushCount + 1u;
+            Model::Entity* playerStart = static_cast<Model::Entity*>(children[brushCount]);
+            ASSERT_EQ(entityLine, playerStart->lineNumber());
+            ASSERT_STREQ("info_player_start", playerStart->classname().c_str());
+
+            Model::Entity* funcWall = static_cast<Model::Entity*>(children[brushCount + 1u]);
+            ASSERT_EQ(entityLine + 5u, funcWall->lineNumber());
+            ASSERT_EQ(1u, funcWall->childCount());
+
+            Model::Brush* brush = static_cast<Model::Brush*>(funcWall->children().front());
+            ASSERT_EQ(entityLine + 7u, brush->lineNumber());
+            ASSERT_STREQ("{blue", brush->faces().front()->textureName().c_str());
+
+            delete world;
+        }
+
+        TEST(WorldReaderTest, parseLargeMapWithErrorInParallel) {
+            StringStream str;
+            str << "{\n"
+                   "\"classname\" \"worldspawn\"\n";
+            for (size_t i = 0; i < 300; ++i)
+                str << makeBrush("tex");
+            str << "}\n"
+                   "{\n"
+                   "\"classname\" \"func_wall\"\n"
+                   "{\n"
+                   "( -0 -0 -16 ) ( -0 -0  -0 ) tex 0 0 0 1 1\n"
+                   "}\n"
+                   "}\n";
+            const String data = str.str();
+            BBox3 worldBounds(8192);
+
+            IO::TestParserStatus status;
+            WorldReader reader(data, nullptr);
+
+            ASSERT_THROW(reader.read(Model::MapFormat::Standard, worldBounds, status), ParserException);
+        }
+
+        class ChunkedParserStatus : public ParserStatus {
+        private:
+            double m_cancelProgress;
+        public:
+            std::vector<double> progress;
+        public:
+            ChunkedParserStatus(const double cancelProgress = 2.0) :
+            ParserStatus(nullptr),
+            m_cancelProgress(cancelProgress) {}
+        private:
+            void doProgress(const double i_progress) override {
+                progress.push_back(i_progress);
+            }
+
+            bool doCancelled() const override {
+                return !progress.empty() && progress.back() >= m_cancelProgress;
+            }
+        };
+
+        static String makeLargeMap(const size_t brushCount) {
+            StringStream str;
+            str << "{\n"
+                   "\"classname\" \"worldspawn\"\n";
+            for (size_t i = 0; i < brushCount; ++i)
+                str << makeBrush("tex");
+            str << "}\n";
+            for (size_t i = 0; i < 10; ++i) {
+                str << "{\n"
+                       "\"classname\" \"func_wall\"\n"
+                    << makeBrush("{blue") <<
+                       "}\n";
+            }
+            return str.str();
+        }
+
+        TEST(WorldReaderTest, parseLargeMapInChunks) {
+            const String data = makeLargeMap(600);
+            BBox3 worldBounds(8192);
+
+            ChunkedParserStatus status;
+            WorldReader reader(data, nullptr);
+            reader.setChunkSize(4096);
+
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds, status);
+            ASSERT_TRUE(world != nullptr);
+            ASSERT_EQ(610u, world->defaultLayer()->childCount());
+
+            ASSERT_LT(2u, status.progress.size());
+            for (size_t i = 1; i < status.progress.size(); ++i)
+                ASSERT_LT(status.progress[i - 1], status.progress[i]);
+            ASSERT_DOUBLE_EQ(1.0, status.progress.back());
+
+            delete world;
+        }
+
+        TEST(WorldReaderTest, cancelParsingLargeMap) {
+            const String data = makeLargeMap(600);
+            BBox3 worldBounds(8192);
+
+            ChunkedParserStatus status(0.5);
+            WorldReader reader(data, nullptr);
+            reader.setChunkSize(4096);
+
+            ASSERT_THROW(reader.read(Model::MapFormat::Standard, worldBounds, status), CancelledException);
+            ASSERT_LE(0.5, status.progress.back());
+            ASSERT_GT(1.0, status.progress.back());
+        }
+
+        class CancellingProgressStatus : public ProgressStatus {
+        public:
+            size_t progressCount = 0;
+        private:
+            void doProgress(const double progress) override {
+                ++progressCount;
+            }
+
+            bool doCancelled() const override {
+                return progressCount >= 2;
+            }
+        };
+
+        TEST(WorldReaderTest, cancelParsingLargeMapThroughProgressStatus) {
+            const String data = makeLargeMap(600);
+            BBox3 worldBounds(8192);
+
+            CancellingProgressStatus progressStatus;
+            ProgressParserStatus status(nullptr, progressStatus);
+            WorldReader reader(data, nullptr);
+            reader.setChunkSize(4096);
+
+            ASSERT_THROW(reader.read(Model::MapFormat::Standard, worldBounds, status), CancelledException);
+            ASSERT_EQ(2u, progressStatus.progressCount);
+        }
+
+        TEST(WorldReaderTest, parseLargeMapWithErrorInLaterChunk) {
+            const String data = makeLargeMap(600) +
+                                "{\n"
+                                "\"classname\" \"func_wall\"\n"
+                                "{\n"
+                                "( -0 -0 -16 ) ( -0 -0  -0 ) tex 0 0 0 1 1\n"
+                                "}\n"
+                                "}\n";
+            BBox3 worldBounds(8192);
+
+            ChunkedParserStatus status;
+            WorldReader reader(data, nullptr);
+            reader.setChunkSize(4096);
+
+            ASSERT_THROW(reader.read(Model::MapFormat::Standard, worldBounds, status), ParserException);
+        }
+
+        TEST(WorldReaderTest, parseLargeMapWithUnscannableLaterChunk) {
+            const String data = makeLargeMap(600) + "garbage\n";
+            BBox3 worldBounds(8192);
+
+            ChunkedParserStatus status;
+            WorldReader reader(data, nullptr);
+            reader.setChunkSize(4096);
+
+            ASSERT_THROW(reader.read(Model::MapFormat::Standard, worldBounds, status), ParserException);
+            ASSERT_FALSE(status.progress.empty());
+        }
+
+        class PublishedNodes {
+        public:
+            Model::World* world = nullptr;
+            std::map<Model::Node*, size_t> batches;
+            size_t batchCount = 0;
+        public:
+            void publish(Model::World* i_world, const Model::ParentChildrenMap& nodes) {
+                if (world == nullptr)
+                    world = i_world;
+                ASSERT_EQ(world, i_world);
+
+                // every parent is the world, a node that was published before, or a node in the same batch
+                Model::NodeSet children;
+                for (const auto& entry : nodes)
+                    children.insert(std::begin(entry.second), std::end(entry.second));
+                for (const auto& entry : nodes) {
+                    Model::Node* parent = entry.first;
+                    ASSERT_TRUE(parent == world || parent == world->defaultLayer() || batches.count(parent) > 0 || children.count(parent) > 0);
+                }
+
+                for (const auto& entry : nodes) {
+                    for (Model::Node* child : entry.second) {
+                        ASSERT_TRUE(child->parent() == nullptr);
+                        ASSERT_LT(0u, child->lineCount());
+                        batches[child] = batchCount;
+                    }
+                    entry.first->addChildren(entry.second);
+                }
+                ++batchCount;
+            }
+        };
+
+        static String makeMapWithLargeEntity() {
+            StringStream str;
+            str << "{\n"
+                   "\"classname\" \"worldspawn\"\n";
+            for (size_t i = 0; i < 100; ++i)
+                str << makeBrush("tex");
+            str << "}\n"
+                   "{\n"
+                   "\"classname\" \"func_door\"\n"
+                   "\"_tb_group\" \"1\"\n"
+                << makeBrush("{blue") <<
+                   "}\n"
+                   "{\n"
+                   "\"classname\" \"func_wall\"\n";
+            for (size_t i = 0; i < 100; ++i)
+                str << makeBrush("{blue");
+            str << "}\n"
+                   "{\n"
+                   "\"classname\" \"func_group\"\n"
+                   "\"_tb_type\" \"_tb_group\"\n"
+                   "\"_tb_name\" \"My Group\"\n"
+                   "\"_tb_id\" \"1\"\n"
+                   "}\n";
+            for (size_t i = 0; i < 10; ++i) {
+                str << "{\n"
+                       "\"classname\" \"func_wall\"\n"
+                    << makeBrush("{blue") <<
+                       "}\n";
+            }
+            return str.str();
+        }
+
+        TEST(WorldReaderTest, publishNodesWhileReading) {
+            const String data = makeMapWithLargeEntity();
+            BBox3 worldBounds(8192);
+
+            ChunkedParserStatus expectedStatus;
+            WorldReader expectedReader(data, nullptr);
+            Model::World* expected = expectedReader.read(Model::MapFormat::Standard, worldBounds, expectedStatus);
+
+            PublishedNodes published;
+            ChunkedParserStatus status;
+            WorldReader reader(data, nullptr);
+            reader.setChunkSize(4096);
+
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds, status, [&published](Model::World* i_world, const Model::ParentChildrenMap& nodes) {
+                published.publish(i_world, nodes);
+            });
+            ASSERT_EQ(published.world, world);
+            ASSERT_LT(2u, published.batchCount);
+            ASSERT_EQ(expected->lineNumber(), world->lineNumber());
+
+            const Model::NodeList& expectedChildren = expected->defaultLayer()->children();
+            const Model::NodeList& children = world->defaultLayer()->children();
+            ASSERT_EQ(expectedChildren.size(), children.size());
+            for (size_t i = 0; i < children.size(); ++i) {
+                ASSERT_EQ(expectedChildren[i]->lineNumber(), children[i]->lineNumber());
+                ASSERT_EQ(expectedChildren[i]->childCount(), children[i]->childCount());
+            }
+
+            // the large entity spans several chunks, but it is published together with its brushes
+            Model::Node* funcWall = children[100];
+            ASSERT_EQ(100u, funcWall->childCount());
+            for (Model::Node* brush : funcWall->children())
+                ASSERT_EQ(published.batches[funcWall], published.batches[brush]);
+            ASSERT_LT(published.batches[children.front()], published.batches[funcWall]);
+
+            // the group was read after its member, so the member is only published at the end
+            Model::Node* group = children[101];
+            ASSERT_EQ(1u, group->childCount());
+            ASSERT_EQ(published.batchCount - 1u, published.batches[group->children().front()]);
+
+            delete world;
+            delete expected;
+        }
+
+        TEST(WorldReaderTest, cancelPublishingNodes) {
+            const String data = makeMapWithLargeEntity();
+            BBox3 worldBounds(8192);
+
+            PublishedNodes published;
+            ChunkedParserStatus status(0.5);
+            WorldReader reader(data, nullptr);
+            reader.setChunkSize(4096);
+
+            ASSERT_THROW(reader.read(Model::MapFormat::Standard, worldBounds, status, [&published](Model::World* i_world, const Model::ParentChildrenMap& nodes) {
+                published.publish(i_world, nodes);
+            }), CancelledException);
+
+            // the published world and nodes are owned by the callback, the others were deleted by the reader
+            ASSERT_TRUE(published.world != nullptr);
+            ASSERT_LT(0u, published.batchCount);
+            ASSERT_LT(0u, published.world->defaultLayer()->childCount());
+
+            delete published.world;
+        }
+
         /*
         TEST(WorldReaderTest, parseIssueIgnoreFlags) {
             const String data("{"
@@ -20,6 +20,7 @@
 #include <gtest/gtest.h>
 
 #include "TestUtils.h"
+#include "ProgressStatus.h"
 
 #include "Assets/Texture.h"
 #include "IO/NodeReader.h"
@@ -905,6 +906,70 @@ namespace TrenchBroom {
             delete brush;
         }
 
+        TEST(BrushTest, rebuildGeometryOfBrushList) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+
+            BrushBuilder builder(&world, worldBounds);
+            BrushList brushes;
+            for (size_t i = 0; i < 32; ++i)
+                brushes.push_back(builder.createCube(static_cast<FloatType>(2 * (i + 1)), "texture"));
+
+            Brush::rebuildGeometry(worldBounds, brushes);
+
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                const Brush* brush = brushes[i];
+                const FloatType halfSize = static_cast<FloatType>(i + 1);
+                ASSERT_TRUE(brush->fullySpecified());
+                ASSERT_EQ(6u, brush->faces().size());
+                ASSERT_EQ(8u, brush->vertexCount());
+                ASSERT_EQ(BBox3(Vec3(-halfSize, -halfSize, -halfSize), Vec3(halfSize, halfSize, halfSize)), brush->bounds());
+            }
+
+            VectorUtils::clearAndDelete(brushes);
+        }
+
+        TEST(BrushTest, createBrushFromVertices) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+
+            BrushBuilder builder(&world, worldBounds);
+            const Brush* cube = builder.createCube(64.0, "texture");
+
+            const FlatBrushGeometry& geometry = cube->flatGeometry();
+            std::vector<std::vector<size_t>> faceVertexIndices;
+            for (const BrushFace* face : cube->faces()) {
+                size_t faceIndex = 0;
+                while (geometry.face(faceIndex) != face)
+                    ++faceIndex;
+                faceVertexIndices.push_back(std::vector<size_t>(geometry.faceVertexIndicesBegin(faceIndex), geometry.faceVertexIndicesEnd(faceIndex)));
+            }
+
+            BrushFaceList faces;
+            for (const BrushFace* face : cube->faces())
+                faces.push_back(face->clone());
+
+            Brush brush(worldBounds, faces, geometry.vertexPositions(), faceVertexIndices);
+            ASSERT_TRUE(brush.fullySpecified());
+            ASSERT_EQ(geometry.vertexPositions(), brush.vertexPositions());
+            ASSERT_EQ(cube->bounds(), brush.bounds());
+            for (size_t i = 0; i < faces.size(); ++i)
+                ASSERT_EQ(faces[i], brush.faces()[i]);
+
+            // invalid vertices cause the geometry to be computed from the face planes
+            BrushFaceList otherFaces;
+            for (const BrushFace* face : cube->faces())
+                otherFaces.push_back(face->clone());
+
+            faceVertexIndices.front().pop_back();
+            const Brush otherBrush(worldBounds, otherFaces, geometry.vertexPositions(), faceVertexIndices);
+            ASSERT_TRUE(otherBrush.fullySpecified());
+            ASSERT_EQ(8u, otherBrush.vertexCount());
+            ASSERT_EQ(cube->bounds(), otherBrush.bounds());
+
+            delete cube;
+        }
+
         TEST(BrushTest, moveEdge) {
             const BBox3 worldBounds(4096.0);
             World world(MapFormat::Standard, nullptr, worldBounds);
@@ -2637,6 +2702,80 @@ namespace TrenchBroom {
             VectorUtils::deleteAll(result);
         }
         
+        class CancelledProgressStatus : public ProgressStatus {
+        private:
+            void doProgress(const double progress) override {}
+            bool doCancelled() const override { return true; }
+        };
+
+        TEST(BrushTest, subtractFromBrushes) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+
+            BrushBuilder builder(&world, worldBounds);
+            const BrushList minuends {
+                builder.createCuboid(BBox3(Vec3(-64.0, -16.0, -16.0), Vec3(-32.0, 16.0, 16.0)), "minuend1"),
+                builder.createCuboid(BBox3(Vec3(-16.0, -16.0, -16.0), Vec3(16.0, 16.0, 16.0)), "minuend2"),
+                builder.createCuboid(BBox3(Vec3(32.0, -16.0, -16.0), Vec3(64.0, 16.0, 16.0)), "minuend3")
+            };
+            Brush* subtrahend = builder.createCuboid(BBox3(Vec3(-48.0, -8.0, -8.0), Vec3(48.0, 8.0, 32.0)), "subtrahend");
+
+            NullProgressStatus status;
+            const std::vector<BrushList> result = Brush::subtract(world, worldBounds, "default", minuends, subtrahend, status);
+            ASSERT_EQ(minuends.size(), result.size());
+
+            for (size_t i = 0; i < minuends.size(); ++i) {
+                BrushList expected = minuends[i]->subtract(world, worldBounds, "default", subtrahend);
+                ASSERT_EQ(expected.size(), result[i].size());
+
+                for (size_t j = 0; j < expected.size(); ++j) {
+                    ASSERT_EQ(SetUtils::makeSet(expected[j]->vertexPositions()), SetUtils::makeSet(result[i][j]->vertexPositions()));
+                    for (const BrushFace* face : expected[j]->faces())
+                        ASSERT_EQ(face->textureName(), result[i][j]->findFace(face->boundary())->textureName());
+                }
+
+                VectorUtils::deleteAll(expected);
+            }
+
+            CancelledProgressStatus cancelled;
+            ASSERT_TRUE(Brush::subtract(world, worldBounds, "default", minuends, subtrahend, cancelled).empty());
+
+            for (const BrushList& fragments : result)
+                VectorUtils::deleteAll(fragments);
+            VectorUtils::deleteAll(minuends);
+            delete subtrahend;
+        }
+
+        TEST(BrushTest, intersectBrushes) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+
+            BrushBuilder builder(&world, worldBounds);
+            BrushList brushes {
+                builder.createCuboid(BBox3(Vec3(-32.0, -32.0, -32.0), Vec3(16.0, 32.0, 32.0)), "brush1"),
+                builder.createCuboid(BBox3(Vec3(-16.0, -32.0, -32.0), Vec3(32.0, 32.0, 32.0)), "brush2"),
+                builder.createCuboid(BBox3(Vec3(-32.0, -8.0, -32.0), Vec3(32.0, 32.0, 32.0)), "brush3")
+            };
+
+            NullProgressStatus status;
+            Brush* result = Brush::intersect(world, worldBounds, brushes, status);
+            ASSERT_TRUE(result != nullptr);
+            ASSERT_EQ(BBox3(Vec3(-16.0, -8.0, -32.0), Vec3(16.0, 32.0, 32.0)), result->bounds());
+            ASSERT_EQ(6u, result->faceCount());
+            ASSERT_EQ(String("brush1"), result->findFace(Vec3::PosX)->textureName());
+            ASSERT_EQ(String("brush2"), result->findFace(Vec3::NegX)->textureName());
+            ASSERT_EQ(String("brush3"), result->findFace(Vec3::NegY)->textureName());
+            delete result;
+
+            CancelledProgressStatus cancelled;
+            ASSERT_TRUE(Brush::intersect(world, worldBounds, brushes, cancelled) == nullptr);
+
+            brushes.push_back(builder.createCuboid(BBox3(Vec3(64.0, 64.0, 64.0), Vec3(96.0, 96.0, 96.0)), "brush4"));
+            ASSERT_TRUE(Brush::intersect(world, worldBounds, brushes, status) == nullptr);
+
+            VectorUtils::deleteAll(brushes);
+        }
+
         TEST(BrushTest, subtractTruncatedCones) {
             // https://github.com/kduske/TrenchBroom/issues/1469
 
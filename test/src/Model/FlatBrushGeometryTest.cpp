@@ -0,0 +1,162 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Model/BrushGeometry.h"
+#include "Algorithms.h"
+#include "Model/FlatBrushGeometry.h"
+
+#include <random>
+
+namespace TrenchBroom {
+    namespace Model {
+        TEST(FlatBrushGeometryTest, emptyGeometry) {
+            const FlatBrushGeometry geometry;
+            ASSERT_TRUE(geometry.empty());
+            ASSERT_EQ(0u, geometry.vertexCount());
+            ASSERT_EQ(0u, geometry.edgeCount());
+            ASSERT_EQ(0u, geometry.faceCount());
+            ASSERT_FALSE(geometry.containsPoint(Vec3::Null));
+        }
+
+        TEST(FlatBrushGeometryTest, copyCube) {
+            const BrushGeometry cube(BBox3(Vec3(-8.0, -8.0, -8.0), Vec3(8.0, 8.0, 8.0)));
+            const FlatBrushGeometry geometry(cube);
+
+            ASSERT_FALSE(geometry.empty());
+            ASSERT_EQ(cube.bounds(), geometry.bounds());
+            ASSERT_EQ(cube.vertexCount(), geometry.vertexCount());
+            ASSERT_EQ(cube.edgeCount(), geometry.edgeCount());
+            ASSERT_EQ(cube.faceCount(), geometry.faceCount());
+            ASSERT_EQ(cube.vertexPositions(), geometry.vertexPositions());
+
+            size_t faceIndex = 0;
+            for (const BrushFaceGeometry* face : cube.faces()) {
+                ASSERT_EQ(face->vertexCount(), geometry.faceVertexCount(faceIndex));
+
+                const size_t* vertexIndex = geometry.faceVertexIndicesBegin(faceIndex);
+                for (const BrushHalfEdge* halfEdge : face->boundary()) {
+                    ASSERT_EQ(halfEdge->origin()->position(), geometry.vertexPosition(*vertexIndex++));
+                }
+                ASSERT_EQ(geometry.faceVertexIndicesEnd(faceIndex), vertexIndex);
+
+                ASSERT_VEC_EQ(face->normal(), geometry.facePlane(faceIndex).normal);
+                ++faceIndex;
+            }
+
+            size_t edgeIndex = 0;
+            for (const BrushEdge* edge : cube.edges()) {
+                ASSERT_EQ(edge->firstVertex()->position(), geometry.vertexPosition(geometry.edgeFirstVertex(edgeIndex)));
+                ASSERT_EQ(edge->secondVertex()->position(), geometry.vertexPosition(geometry.edgeSecondVertex(edgeIndex)));
+                ASSERT_VEC_EQ(edge->firstFace()->normal(), geometry.facePlane(geometry.edgeFirstFace(edgeIndex)).normal);
+                ASSERT_VEC_EQ(edge->secondFace()->normal(), geometry.facePlane(geometry.edgeSecondFace(edgeIndex)).normal);
+                ++edgeIndex;
+            }
+        }
+
+        TEST(FlatBrushGeometryTest, findVerticesEdgesAndFaces) {
+            const FlatBrushGeometry geometry(BrushGeometry(BBox3(Vec3(-8.0, -8.0, -8.0), Vec3(8.0, 8.0, 8.0))));
+
+            ASSERT_TRUE(geometry.hasVertex(Vec3(8.0, -8.0, 8.0)));
+            ASSERT_FALSE(geometry.hasVertex(Vec3(8.0, -8.0, 8.1)));
+            ASSERT_TRUE(geometry.hasVertex(Vec3(8.0, -8.0, 8.1), 0.2));
+            ASSERT_EQ(Vec3(8.0, 8.0, 8.0), geometry.findClosestVertexPosition(Vec3(7.0, 9.0, 100.0)));
+
+            ASSERT_TRUE(geometry.hasEdge(Vec3(-8.0, -8.0, -8.0), Vec3(-8.0, -8.0, 8.0)));
+            ASSERT_TRUE(geometry.hasEdge(Vec3(-8.0, -8.0, 8.0), Vec3(-8.0, -8.0, -8.0)));
+            ASSERT_FALSE(geometry.hasEdge(Vec3(-8.0, -8.0, -8.0), Vec3(8.0, 8.0, 8.0)));
+
+            const Vec3::List top { Vec3(-8.0, -8.0, 8.0), Vec3(8.0, -8.0, 8.0), Vec3(8.0, 8.0, 8.0), Vec3(-8.0, 8.0, 8.0) };
+            const Vec3::List topRotated { Vec3(8.0, 8.0, 8.0), Vec3(-8.0, 8.0, 8.0), Vec3(-8.0, -8.0, 8.0), Vec3(8.0, -8.0, 8.0) };
+            const Vec3::List topReversed(top.rbegin(), top.rend());
+            ASSERT_TRUE(geometry.hasFace(top));
+            ASSERT_TRUE(geometry.hasFace(topRotated));
+            ASSERT_FALSE(geometry.hasFace(topReversed));
+            ASSERT_FALSE(geometry.hasFace(Vec3::List(top.begin(), top.begin() + 3)));
+        }
+
+        TEST(FlatBrushGeometryTest, containsPoint) {
+            const FlatBrushGeometry geometry(BrushGeometry(BBox3(Vec3(-8.0, -8.0, -8.0), Vec3(8.0, 8.0, 8.0))));
+
+            ASSERT_TRUE(geometry.containsPoint(Vec3::Null));
+            ASSERT_TRUE(geometry.containsPoint(Vec3(8.0, 8.0, 8.0)));
+            ASSERT_FALSE(geometry.containsPoint(Vec3(8.1, 0.0, 0.0)));
+            ASSERT_FALSE(geometry.containsPoint(Vec3(0.0, 0.0, 100.0)));
+        }
+
+        TEST(FlatBrushGeometryTest, intersectWithRay) {
+            const FlatBrushGeometry geometry(BrushGeometry(BBox3(Vec3(-8.0, -8.0, -8.0), Vec3(8.0, 8.0, 8.0))));
+
+            size_t faceIndex = geometry.faceCount();
+            const FloatType distance = geometry.intersectWithRay(Ray3(Vec3(0.0, 0.0, 32.0), Vec3::NegZ), faceIndex);
+            ASSERT_DOUBLE_EQ(24.0, distance);
+            ASSERT_LT(faceIndex, geometry.faceCount());
+            ASSERT_VEC_EQ(Vec3::PosZ, geometry.facePlane(faceIndex).normal);
+
+            // the ray leaves the geometry through its back faces only
+            ASSERT_TRUE(Math::isnan(geometry.intersectWithRay(Ray3(Vec3::Null, Vec3::PosX), faceIndex)));
+            ASSERT_TRUE(Math::isnan(geometry.intersectWithRay(Ray3(Vec3(0.0, 16.0, 32.0), Vec3::NegZ), faceIndex)));
+        }
+
+        TEST(FlatBrushGeometryTest, intersectWithRayMatchesFaces) {
+            const Vec3::List points {
+                Vec3(-32.0, -16.0, -8.0), Vec3(32.0, -16.0, -8.0), Vec3(0.0, 24.0, -8.0),
+                Vec3(-16.0, -8.0, 16.0), Vec3(16.0, -8.0, 16.0), Vec3(0.0, 8.0, 24.0), Vec3(4.0, 0.0, -20.0),
+                Vec3(20.0, 20.0, 0.0), Vec3(-20.0, 15.0, 3.0)
+            };
+            const BrushGeometry polyhedron(points);
+            const FlatBrushGeometry geometry(polyhedron);
+
+            std::mt19937 random(1234);
+            std::uniform_real_distribution<FloatType> distribution(-1.0, 1.0);
+            for (size_t i = 0; i < 20000; ++i) {
+                const Vec3 origin = Vec3(distribution(random), distribution(random), distribution(random)) * 64.0;
+                const Vec3 target = Vec3(distribution(random), distribution(random), distribution(random)) * 32.0;
+                const Ray3 ray(origin, (target - origin).normalized());
+
+                // the polygon test can report hits outside of the polygon if the ray is in line with one of its edges
+                // when projected, but such points are not inside of the polyhedron
+                FloatType expectedDistance = Math::nan<FloatType>();
+                for (const BrushFaceGeometry* face : polyhedron.faces()) {
+                    if (Math::neg(face->normal().dot(ray.direction))) {
+                        const FloatType faceDistance = intersectPolygonWithRay(ray, Plane3(face->origin(), face->normal()), face->boundary().begin(), face->boundary().end(), BrushGeometry::GetVertexPosition());
+                        if (!Math::isnan(faceDistance) && geometry.containsPoint(ray.pointAtDistance(faceDistance))) {
+                            expectedDistance = faceDistance;
+                            break;
+                        }
+                    }
+                }
+
+                size_t faceIndex = geometry.faceCount();
+                const FloatType distance = geometry.intersectWithRay(ray, faceIndex);
+                if (Math::isnan(expectedDistance)) {
+                    ASSERT_TRUE(Math::isnan(distance));
+                } else {
+                    ASSERT_DOUBLE_EQ(expectedDistance, distance);
+                    ASSERT_LT(faceIndex, geometry.faceCount());
+                }
+            }
+        }
+    }
+}
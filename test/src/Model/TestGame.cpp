@@ -59,10 +59,11 @@ namespace TrenchBroom {
             return new World(format, brushContentTypeBuilder(), worldBounds);
         }
         
-        World* TestGame::doLoadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const {
+        World* TestGame::doLoadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger, ProgressStatus& status, const LoadedNodesCallback& callback) const {
             return new World(format, brushContentTypeBuilder(), worldBounds);
         }
         
+        void TestGame::doWriteMapCache(const World* world, const IO::Path& path, Logger* logger) const {}
         void TestGame::doWriteMap(World* world, const IO::Path& path) const {}
         void TestGame::doExportMap(World* world, Model::ExportFormat format, const IO::Path& path) const {}
         
@@ -44,7 +44,8 @@ namespace TrenchBroom {
             size_t doMaxPropertyLength() const override;
             
             World* doNewMap(MapFormat::Type format, const BBox3& worldBounds) const override;
-            World* doLoadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const override;
+            World* doLoadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger, ProgressStatus& status, const LoadedNodesCallback& callback) const override;
+            void doWriteMapCache(const World* world, const IO::Path& path, Logger* logger) const override;
             void doWriteMap(World* world, const IO::Path& path) const override;
             void doExportMap(World* world, Model::ExportFormat format, const IO::Path& path) const override;
             
@@ -2640,6 +2640,95 @@ TEST(PolyhedronTest, intersection_polygon_polyhedron_any_orientation) {
     }, cube);
 }
 
+TEST(PolyhedronTest, intersectHalfspacesCube) {
+    const BBox3d bounds(Vec3d(-16.0, -16.0, -16.0), Vec3d(16.0, 16.0, 16.0));
+    
+    Plane3d::List planes;
+    planes.push_back(Plane3d(16.0, Vec3d::PosX));
+    planes.push_back(Plane3d(16.0, Vec3d::NegX));
+    planes.push_back(Plane3d(16.0, Vec3d::PosY));
+    planes.push_back(Plane3d(16.0, Vec3d::NegY));
+    planes.push_back(Plane3d(16.0, Vec3d::PosZ));
+    planes.push_back(Plane3d(16.0, Vec3d::NegZ));
+    
+    Polyhedron3d p;
+    std::vector<Face*> faces;
+    ASSERT_TRUE(p.intersectHalfspaces(planes, faces));
+    ASSERT_TRUE(p.closed());
+    ASSERT_EQ(Polyhedron3d(bounds), p);
+    ASSERT_EQ(bounds, p.bounds());
+    
+    ASSERT_EQ(planes.size(), faces.size());
+    for (size_t i = 0; i < planes.size(); ++i) {
+        ASSERT_TRUE(faces[i] != nullptr);
+        ASSERT_TRUE(planes[i].normal.equals(faces[i]->normal()));
+    }
+}
+
+TEST(PolyhedronTest, intersectHalfspacesWithRedundantPlanes) {
+    Plane3d::List planes;
+    planes.push_back(Plane3d(16.0, Vec3d::PosX));
+    planes.push_back(Plane3d(16.0, Vec3d::NegX));
+    planes.push_back(Plane3d(16.0, Vec3d::PosY));
+    planes.push_back(Plane3d(16.0, Vec3d::NegY));
+    planes.push_back(Plane3d(16.0, Vec3d::PosZ));
+    planes.push_back(Plane3d(16.0, Vec3d::NegZ));
+    planes.push_back(Plane3d(32.0, Vec3d::PosX)); // does not touch the cube
+    planes.push_back(Plane3d(16.0, Vec3d::NegY)); // coincides with an earlier plane
+    planes.push_back(Plane3d(Vec3d(16.0, 16.0, 16.0), Vec3d(1.0, 1.0, 1.0).normalized())); // touches a corner
+    
+    Polyhedron3d p;
+    std::vector<Face*> faces;
+    ASSERT_TRUE(p.intersectHalfspaces(planes, faces));
+    ASSERT_EQ(6u, p.faceCount());
+    ASSERT_EQ(8u, p.vertexCount());
+    
+    ASSERT_TRUE(faces[3] != nullptr);
+    ASSERT_TRUE(faces[6] == nullptr);
+    ASSERT_TRUE(faces[7] == nullptr);
+    ASSERT_TRUE(faces[8] == nullptr);
+}
+
+TEST(PolyhedronTest, intersectHalfspacesMatchesClipping) {
+    // a cube with a chamfered edge and a clipped corner
+    Plane3d::List planes;
+    planes.push_back(Plane3d(16.0, Vec3d::PosX));
+    planes.push_back(Plane3d(16.0, Vec3d::NegX));
+    planes.push_back(Plane3d(16.0, Vec3d::PosY));
+    planes.push_back(Plane3d(16.0, Vec3d::NegY));
+    planes.push_back(Plane3d(16.0, Vec3d::PosZ));
+    planes.push_back(Plane3d(16.0, Vec3d::NegZ));
+    planes.push_back(Plane3d(Vec3d(16.0, 8.0, 0.0), Vec3d(1.0, 1.0, 0.0).normalized()));
+    planes.push_back(Plane3d(Vec3d(-8.0, -16.0, -16.0), Vec3d(-1.0, -1.0, -1.0).normalized()));
+    
+    Polyhedron3d clipped(BBox3d(64.0));
+    for (const Plane3d& plane : planes)
+        clipped.clip(plane);
+    
+    Polyhedron3d p;
+    std::vector<Face*> faces;
+    ASSERT_TRUE(p.intersectHalfspaces(planes, faces));
+    ASSERT_TRUE(p.closed());
+    ASSERT_EQ(clipped.vertexCount(), p.vertexCount());
+    ASSERT_EQ(clipped.edgeCount(), p.edgeCount());
+    ASSERT_EQ(clipped.faceCount(), p.faceCount());
+    ASSERT_TRUE(p.hasVertices(clipped.vertexPositions(), 0.0001));
+}
+
+TEST(PolyhedronTest, intersectHalfspacesUnbounded) {
+    Plane3d::List planes;
+    planes.push_back(Plane3d(16.0, Vec3d::PosX));
+    planes.push_back(Plane3d(16.0, Vec3d::NegX));
+    planes.push_back(Plane3d(16.0, Vec3d::PosY));
+    planes.push_back(Plane3d(16.0, Vec3d::NegY));
+    planes.push_back(Plane3d(16.0, Vec3d::PosZ));
+    
+    Polyhedron3d p(BBox3d(8.0));
+    std::vector<Face*> faces;
+    ASSERT_FALSE(p.intersectHalfspaces(planes, faces));
+    ASSERT_EQ(Polyhedron3d(BBox3d(8.0)), p);
+}
+
 bool hasVertex(const Polyhedron3d& p, const Vec3d& point, const double epsilon) {
     return p.hasVertex(point, epsilon);
 }
@@ -0,0 +1,141 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "RayKernels.h"
+#include "MathUtils.h"
+#include "TestUtils.h"
+
+#include <random>
+
+namespace {
+    Vec3d randomVec(std::mt19937& random, const double min, const double max) {
+        std::uniform_real_distribution<double> distribution(min, max);
+        return Vec3d(distribution(random), distribution(random), distribution(random));
+    }
+
+    BBox3d randomBox(std::mt19937& random) {
+        const Vec3d p1 = randomVec(random, -64.0, 64.0);
+        const Vec3d p2 = randomVec(random, -64.0, 64.0);
+        return BBox3d(min(p1, p2), max(p1, p2));
+    }
+
+    Ray3d randomRay(std::mt19937& random) {
+        return Ray3d(randomVec(random, -128.0, 128.0), randomVec(random, -1.0, 1.0).normalized());
+    }
+
+    RayKernels::PackedPlanes cubePlanes(const double size) {
+        RayKernels::PackedPlanes planes;
+        planes.add(Plane3d(size, Vec3d::PosX));
+        planes.add(Plane3d(size, Vec3d::NegX));
+        planes.add(Plane3d(size, Vec3d::PosY));
+        planes.add(Plane3d(size, Vec3d::NegY));
+        planes.add(Plane3d(size, Vec3d::PosZ));
+        planes.add(Plane3d(size, Vec3d::NegZ));
+        return planes;
+    }
+}
+
+TEST(RayKernelsTest, intersectsBox) {
+    const BBox3d box(Vec3d(-8.0, -8.0, -8.0), Vec3d(8.0, 8.0, 8.0));
+
+    ASSERT_TRUE(RayKernels::intersectsBox(RayKernels::SlabRay<double,3>(Ray3d(Vec3d(-16.0, 0.0, 0.0), Vec3d::PosX)), box));
+    ASSERT_FALSE(RayKernels::intersectsBox(RayKernels::SlabRay<double,3>(Ray3d(Vec3d(-16.0, 0.0, 0.0), Vec3d::NegX)), box));
+    ASSERT_FALSE(RayKernels::intersectsBox(RayKernels::SlabRay<double,3>(Ray3d(Vec3d(-16.0, 16.0, 0.0), Vec3d::PosX)), box));
+
+    // starting inside of the box
+    ASSERT_TRUE(RayKernels::intersectsBox(RayKernels::SlabRay<double,3>(Ray3d(Vec3d::Null, Vec3d::NegZ)), box));
+
+    // parallel to and on a face of the box
+    ASSERT_TRUE(RayKernels::intersectsBox(RayKernels::SlabRay<double,3>(Ray3d(Vec3d(-16.0, 8.0, 0.0), Vec3d::PosX)), box));
+    ASSERT_TRUE(RayKernels::intersectsBox(RayKernels::SlabRay<double,3>(Ray3d(Vec3d(-16.0, -8.0, -8.0), Vec3d::PosX)), box));
+}
+
+TEST(RayKernelsTest, intersectsBoxesMatchesBBox) {
+    std::mt19937 random(4711);
+    for (size_t i = 0; i < 10000; ++i) {
+        const BBox3d box1 = randomBox(random);
+        const BBox3d box2 = randomBox(random);
+        const Ray3d ray = randomRay(random);
+
+        bool hit1, hit2;
+        RayKernels::intersectsBoxes(RayKernels::SlabRay<double,3>(ray), box1, box2, hit1, hit2);
+
+        ASSERT_EQ(box1.contains(ray.origin) || !Math::isnan(box1.intersectWithRay(ray)), hit1);
+        ASSERT_EQ(box2.contains(ray.origin) || !Math::isnan(box2.intersectWithRay(ray)), hit2);
+    }
+}
+
+TEST(RayKernelsTest, intersectConvexWithRay) {
+    const RayKernels::PackedPlanes planes = cubePlanes(8.0);
+
+    const RayKernels::ConvexHit hit = RayKernels::intersectConvexWithRay(Ray3d(Vec3d(0.0, 0.0, 32.0), Vec3d::NegZ), planes);
+    ASSERT_FALSE(hit.outside);
+    ASSERT_EQ(4u, hit.enterPlane);
+    ASSERT_DOUBLE_EQ(24.0, hit.enterDistance);
+    ASSERT_DOUBLE_EQ(40.0, hit.exitDistance);
+
+    const RayKernels::ConvexHit miss = RayKernels::intersectConvexWithRay(Ray3d(Vec3d(0.0, 16.0, 32.0), Vec3d::NegZ), planes);
+    ASSERT_TRUE(miss.outside);
+
+    const RayKernels::ConvexHit inside = RayKernels::intersectConvexWithRay(Ray3d(Vec3d::Null, Vec3d::PosX), planes);
+    ASSERT_FALSE(inside.outside);
+    ASSERT_EQ(1u, inside.enterPlane);
+    ASSERT_DOUBLE_EQ(-8.0, inside.enterDistance);
+    ASSERT_DOUBLE_EQ(8.0, inside.exitDistance);
+}
+
+TEST(RayKernelsTest, intersectConvexWithRayMatchesScalar) {
+    std::mt19937 random(815);
+    for (size_t planeCount = 1; planeCount <= 11; ++planeCount) {
+        for (size_t i = 0; i < 1000; ++i) {
+            Plane3d::List planes;
+            RayKernels::PackedPlanes packedPlanes;
+            for (size_t j = 0; j < planeCount; ++j) {
+                planes.push_back(Plane3d(randomVec(random, 8.0, 64.0).x(), randomVec(random, -1.0, 1.0).normalized()));
+                packedPlanes.add(planes.back());
+            }
+
+            const Ray3d ray = randomRay(random);
+            const RayKernels::ConvexHit hit = RayKernels::intersectConvexWithRay(ray, packedPlanes);
+
+            size_t enterPlane = planeCount;
+            double enterDistance = -std::numeric_limits<double>::infinity();
+            double exitDistance = std::numeric_limits<double>::infinity();
+            for (size_t j = 0; j < planeCount; ++j) {
+                const double denominator = planes[j].normal.dot(ray.direction);
+                const double distance = -planes[j].pointDistance(ray.origin) / denominator;
+                if (denominator < 0.0 && distance > enterDistance) {
+                    enterPlane = j;
+                    enterDistance = distance;
+                } else if (denominator > 0.0) {
+                    exitDistance = std::min(exitDistance, distance);
+                }
+            }
+
+            ASSERT_FALSE(hit.outside);
+            ASSERT_EQ(enterPlane, hit.enterPlane);
+            if (enterPlane < planeCount) {
+                ASSERT_DOUBLE_EQ(enterDistance, hit.enterDistance);
+            }
+            ASSERT_DOUBLE_EQ(exitDistance, hit.exitDistance);
+        }
+    }
+}
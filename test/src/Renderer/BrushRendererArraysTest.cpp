@@ -0,0 +1,167 @@
+/*
+ Copyright (C) 2018 Eric Wasylishen
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "GL/GLMock.h"
+#include "Renderer/BrushRendererArrays.h"
+#include "Renderer/DrawCallCounter.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        using Range = DirtyRangeTracker::Range;
+        using RangeList = DirtyRangeTracker::RangeList;
+
+        TEST(DirtyRangeTrackerTest, newTrackerIsClean) {
+            DirtyRangeTracker t(100);
+            EXPECT_EQ(100u, t.capacity());
+            EXPECT_TRUE(t.clean());
+            EXPECT_EQ(RangeList{}, t.ranges());
+        }
+
+        TEST(DirtyRangeTrackerTest, expandMarksNewRangeDirty) {
+            DirtyRangeTracker t(100);
+            t.expand(150);
+            EXPECT_EQ(150u, t.capacity());
+            EXPECT_EQ((RangeList{Range(100, 50)}), t.ranges());
+            EXPECT_THROW(t.expand(150), std::invalid_argument);
+        }
+
+        TEST(DirtyRangeTrackerTest, keepsDisjointRanges) {
+            DirtyRangeTracker t(1000);
+            t.markDirty(900, 10);
+            t.markDirty(0, 10);
+            t.markDirty(500, 0);
+            EXPECT_FALSE(t.clean());
+            EXPECT_EQ((RangeList{Range(0, 10), Range(900, 10)}), t.ranges());
+            EXPECT_EQ(20u, t.dirtySize());
+            EXPECT_THROW(t.markDirty(995, 10), std::invalid_argument);
+        }
+
+        TEST(DirtyRangeTrackerTest, mergesOverlappingAndAdjacentRanges) {
+            DirtyRangeTracker t(1000);
+            t.markDirty(10, 10);
+            t.markDirty(30, 10);
+            t.markDirty(50, 10);
+
+            // adjacent to the first range
+            t.markDirty(20, 5);
+            EXPECT_EQ((RangeList{Range(10, 15), Range(30, 10), Range(50, 10)}), t.ranges());
+
+            // overlaps the second and the third range
+            t.markDirty(35, 20);
+            EXPECT_EQ((RangeList{Range(10, 15), Range(30, 30)}), t.ranges());
+
+            // contained in the first range
+            t.markDirty(12, 2);
+            EXPECT_EQ((RangeList{Range(10, 15), Range(30, 30)}), t.ranges());
+
+            // covers everything
+            t.markDirty(0, 100);
+            EXPECT_EQ((RangeList{Range(0, 100)}), t.ranges());
+        }
+
+        TEST(DirtyRangeTrackerTest, mergesClosestRangesWhenThereAreTooMany) {
+            const size_t count = DirtyRangeTracker::MaxRanges;
+
+            DirtyRangeTracker t(100 * (count + 1));
+            for (size_t i = 0; i < count; ++i) {
+                t.markDirty(100 * i, 10);
+            }
+            EXPECT_EQ(count, t.ranges().size());
+
+            // the gap between this range and the first one is the smallest
+            t.markDirty(15, 10);
+            const RangeList ranges = t.ranges();
+            ASSERT_EQ(count, ranges.size());
+            EXPECT_EQ(Range(0, 25), ranges.front());
+            EXPECT_EQ(Range(100, 10), ranges[1]);
+        }
+
+        TEST(MultiDrawIndicesTest, rendersArraysInSameBufferWithOneDrawCall) {
+            using namespace testing;
+
+            NiceMock<GLMock> glMock;
+            Vbo vbo(0xFFFF, GL_ELEMENT_ARRAY_BUFFER);
+            ActivateVbo activate(vbo);
+
+            BrushIndexArray first;
+            BrushIndexArray second;
+            BrushIndexArray empty;
+            first.getPointerToInsertElementsAt(6);
+            second.getPointerToInsertElementsAt(3);
+            first.prepare(vbo);
+            second.prepare(vbo);
+            empty.prepare(vbo);
+
+            MultiDrawIndices indices;
+            indices.add(first);
+            indices.add(second);
+            indices.add(empty);
+            ASSERT_FALSE(indices.empty());
+
+            std::vector<GLsizei> counts;
+            EXPECT_CALL(glMock, DrawElements(_, _, _, _)).Times(0);
+            EXPECT_CALL(glMock, MultiDrawElements(GL_TRIANGLES, _, GL_UNSIGNED_INT, _, 2))
+                .WillOnce(Invoke([&](GLenum, const GLsizei* c, GLenum, const GLvoid**, const GLsizei n) {
+                    counts.assign(c, c + n);
+                }));
+
+            DrawCallCounter::reset();
+            indices.render(GL_TRIANGLES);
+            EXPECT_EQ(1u, DrawCallCounter::drawCalls());
+            EXPECT_EQ((std::vector<GLsizei>{6, 3}), counts);
+        }
+
+        TEST(MultiDrawIndicesTest, rendersCurrentContentsWhenReused) {
+            using namespace testing;
+
+            NiceMock<GLMock> glMock;
+            Vbo vbo(0xFFFF, GL_ELEMENT_ARRAY_BUFFER);
+            ActivateVbo activate(vbo);
+
+            BrushIndexArray indexArray;
+            MultiDrawIndices indices;
+            indices.add(indexArray);
+            ASSERT_TRUE(indices.empty());
+
+            indexArray.getPointerToInsertElementsAt(6);
+            indexArray.prepare(vbo);
+            ASSERT_FALSE(indices.empty());
+
+            std::vector<GLsizei> counts;
+            EXPECT_CALL(glMock, DrawElements(GL_TRIANGLES, _, GL_UNSIGNED_INT, _))
+                .WillRepeatedly(Invoke([&](GLenum, const GLsizei count, GLenum, const GLvoid*) {
+                    counts.push_back(count);
+                }));
+
+            indices.render(GL_TRIANGLES);
+
+            // growing the array moves it to a new block, which may have room for more indices than requested
+            indexArray.getPointerToInsertElementsAt(3);
+            indexArray.prepare(vbo);
+            indices.render(GL_TRIANGLES);
+
+            ASSERT_EQ(2u, counts.size());
+            EXPECT_EQ(6, counts[0]);
+            EXPECT_GE(counts[1], 9);
+        }
+    }
+}
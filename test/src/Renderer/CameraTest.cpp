@@ -21,6 +21,7 @@
 #include <gmock/gmock.h>
 
 #include "Renderer/Camera.h"
+#include "Renderer/OrthographicCamera.h"
 #include "Renderer/PerspectiveCamera.h"
 
 namespace TrenchBroom {
@@ -33,5 +34,26 @@ namespace TrenchBroom {
             ASSERT_FALSE(c.right().nan());
             ASSERT_FALSE(c.up().nan());
         }
+        
+        TEST(CameraTest, perspectiveFrustumIntersects) {
+            const PerspectiveCamera c(90.0f, 1.0f, 8192.0f, Camera::Viewport(0, 0, 800, 600), Vec3f::Null, Vec3f::PosX, Vec3f::PosZ);
+            
+            ASSERT_TRUE(c.frustumIntersects(BBox3f(Vec3f(100.0f, -10.0f, -10.0f), Vec3f(120.0f, 10.0f, 10.0f))));
+            ASSERT_TRUE(c.frustumIntersects(BBox3f(Vec3f(-10.0f, -10.0f, -10.0f), Vec3f(10.0f, 10.0f, 10.0f))));
+            ASSERT_TRUE(c.frustumIntersects(BBox3f(Vec3f(100.0f, 90.0f, -10.0f), Vec3f(120.0f, 200.0f, 10.0f))));
+            
+            // behind the camera and beside the frustum
+            ASSERT_FALSE(c.frustumIntersects(BBox3f(Vec3f(-120.0f, -10.0f, -10.0f), Vec3f(-100.0f, 10.0f, 10.0f))));
+            ASSERT_FALSE(c.frustumIntersects(BBox3f(Vec3f(100.0f, 150.0f, -10.0f), Vec3f(120.0f, 200.0f, 10.0f))));
+            ASSERT_FALSE(c.frustumIntersects(BBox3f(Vec3f(100.0f, -10.0f, 150.0f), Vec3f(120.0f, 10.0f, 200.0f))));
+        }
+        
+        TEST(CameraTest, orthographicFrustumIntersects) {
+            const OrthographicCamera c(1.0f, 8192.0f, Camera::Viewport(0, 0, 800, 600), Vec3f::Null, Vec3f::NegZ, Vec3f::PosY);
+            
+            ASSERT_TRUE(c.frustumIntersects(BBox3f(Vec3f(390.0f, -10.0f, -1000.0f), Vec3f(410.0f, 10.0f, -900.0f))));
+            ASSERT_FALSE(c.frustumIntersects(BBox3f(Vec3f(410.0f, -10.0f, -10.0f), Vec3f(420.0f, 10.0f, 10.0f))));
+            ASSERT_FALSE(c.frustumIntersects(BBox3f(Vec3f(-10.0f, -320.0f, -10.0f), Vec3f(10.0f, -310.0f, 10.0f))));
+        }
     }
 }
@@ -0,0 +1,60 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Renderer/GL.h"
+
+#include <limits>
+
+namespace TrenchBroom {
+    TEST(GLTest, floatToHalf) {
+        ASSERT_EQ(0x0000, floatToHalf(0.0f));
+        ASSERT_EQ(0x8000, floatToHalf(-0.0f));
+        ASSERT_EQ(0x3C00, floatToHalf(1.0f));
+        ASSERT_EQ(0xC000, floatToHalf(-2.0f));
+        ASSERT_EQ(0x3555, floatToHalf(1.0f / 3.0f));
+        ASSERT_EQ(0x7BFF, floatToHalf(65504.0f));
+
+        // too large values become infinity
+        ASSERT_EQ(0x7C00, floatToHalf(65536.0f));
+        ASSERT_EQ(0xFC00, floatToHalf(-std::numeric_limits<float>::infinity()));
+
+        // subnormal numbers and underflow
+        ASSERT_EQ(0x0001, floatToHalf(5.9604645e-8f));
+        ASSERT_EQ(0x0200, floatToHalf(3.0517578e-5f));
+        ASSERT_EQ(0x0000, floatToHalf(1.0e-9f));
+
+        // ties are rounded to even
+        ASSERT_EQ(0x3C00, floatToHalf(1.0f + 1.0f / 2048.0f));
+        ASSERT_EQ(0x3C02, floatToHalf(1.0f + 3.0f / 2048.0f));
+    }
+
+    TEST(GLTest, halfToFloat) {
+        ASSERT_EQ(0.0f, halfToFloat(0x0000));
+        ASSERT_EQ(1.0f, halfToFloat(0x3C00));
+        ASSERT_EQ(-2.0f, halfToFloat(0xC000));
+        ASSERT_EQ(65504.0f, halfToFloat(0x7BFF));
+        ASSERT_EQ(std::numeric_limits<float>::infinity(), halfToFloat(0x7C00));
+        ASSERT_FLOAT_EQ(5.9604645e-8f, halfToFloat(0x0001));
+
+        for (GLhalf value = 0; value < 0x7C00; ++value)
+            ASSERT_EQ(value, floatToHalf(halfToFloat(value)));
+    }
+}
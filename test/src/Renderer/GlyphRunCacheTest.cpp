@@ -0,0 +1,75 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "AttrString.h"
+#include "Renderer/GlyphRunCache.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        static GlyphRun makeRun(const float width) {
+            return GlyphRun(Vec2f::List(1, Vec2f(width, 0.0f)), Vec2f(width, 10.0f));
+        }
+
+        TEST(GlyphRunCacheTest, findInsertedRun) {
+            GlyphRunCache cache(4);
+            ASSERT_EQ(nullptr, cache.find(AttrString("light")));
+
+            const GlyphRunPtr inserted = cache.insert(AttrString("light"), makeRun(5.0f));
+            const GlyphRunPtr found = cache.find(AttrString("light"));
+            ASSERT_EQ(inserted, found);
+            ASSERT_EQ(Vec2f(5.0f, 10.0f), found->size);
+            ASSERT_EQ(1u, cache.size());
+        }
+
+        TEST(GlyphRunCacheTest, evictLeastRecentlyUsedRun) {
+            GlyphRunCache cache(2);
+            cache.insert(AttrString("a"), makeRun(1.0f));
+            cache.insert(AttrString("b"), makeRun(2.0f));
+
+            // touch a so that b becomes the least recently used run
+            ASSERT_NE(nullptr, cache.find(AttrString("a")));
+
+            const GlyphRunPtr c = cache.insert(AttrString("c"), makeRun(3.0f));
+            ASSERT_EQ(2u, cache.size());
+            ASSERT_NE(nullptr, cache.find(AttrString("a")));
+            ASSERT_EQ(nullptr, cache.find(AttrString("b")));
+            ASSERT_EQ(c, cache.find(AttrString("c")));
+        }
+
+        TEST(GlyphRunCacheTest, evictedRunStaysAlive) {
+            GlyphRunCache cache(1);
+            const GlyphRunPtr a = cache.insert(AttrString("a"), makeRun(1.0f));
+            cache.insert(AttrString("b"), makeRun(2.0f));
+
+            ASSERT_EQ(nullptr, cache.find(AttrString("a")));
+            ASSERT_EQ(Vec2f(1.0f, 10.0f), a->size);
+        }
+
+        TEST(GlyphRunCacheTest, replaceRun) {
+            GlyphRunCache cache(2);
+            cache.insert(AttrString("a"), makeRun(1.0f));
+            cache.insert(AttrString("a"), makeRun(2.0f));
+
+            ASSERT_EQ(1u, cache.size());
+            ASSERT_EQ(Vec2f(2.0f, 10.0f), cache.find(AttrString("a"))->size);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "GL/GLMock.h"
+#include "Renderer/InstanceArray.h"
+#include "Renderer/Vbo.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        TEST(InstanceArrayTest, setAndRemoveInstances) {
+            const int a = 0, b = 0, c = 0;
+            const Vec4f attributes[] = { Vec4f(1.0f, 2.0f, 3.0f, 4.0f), Vec4f(5.0f, 6.0f, 7.0f, 8.0f) };
+            
+            InstanceArray instances(2);
+            ASSERT_TRUE(instances.empty());
+            
+            instances.set(&a, attributes);
+            instances.set(&b, attributes);
+            instances.set(&c, attributes);
+            instances.set(&a, attributes);
+            ASSERT_EQ(3u, instances.size());
+            ASSERT_EQ(std::vector<InstanceArray::Key>({ &a, &b, &c }), instances.keys());
+            
+            // the last instance takes the place of the removed one
+            instances.remove(&a);
+            ASSERT_EQ(2u, instances.size());
+            ASSERT_FALSE(instances.contains(&a));
+            ASSERT_EQ(std::vector<InstanceArray::Key>({ &c, &b }), instances.keys());
+            
+            instances.remove(&a);
+            ASSERT_EQ(2u, instances.size());
+            
+            instances.clear();
+            ASSERT_TRUE(instances.empty());
+        }
+        
+        TEST(InstanceArrayTest, uploadOnlyChangedInstances) {
+            using namespace testing;
+            NiceMock<GLMock> glMock;
+            
+            const int a = 0, b = 0;
+            const Vec4f first[]  = { Vec4f(1.0f, 2.0f, 3.0f, 4.0f) };
+            const Vec4f second[] = { Vec4f(5.0f, 6.0f, 7.0f, 8.0f) };
+            
+            Vbo vbo(0xFFFF, GL_ARRAY_BUFFER);
+            InstanceArray instances(1);
+            
+            // both instances are uploaded with one write
+            instances.set(&a, first);
+            instances.set(&b, first);
+            EXPECT_CALL(glMock, BufferSubData(GL_ARRAY_BUFFER, 0, 32, _)).Times(1);
+            instances.prepare(vbo);
+            Mock::VerifyAndClearExpectations(&glMock);
+            
+            // unchanged instances are not uploaded again
+            instances.set(&a, first);
+            EXPECT_CALL(glMock, BufferSubData(_, _, _, _)).Times(0);
+            instances.prepare(vbo);
+            Mock::VerifyAndClearExpectations(&glMock);
+            
+            // only the changed instance is uploaded
+            instances.set(&b, second);
+            EXPECT_CALL(glMock, BufferSubData(GL_ARRAY_BUFFER, 16, 16, _)).Times(1);
+            instances.prepare(vbo);
+            Mock::VerifyAndClearExpectations(&glMock);
+        }
+    }
+}
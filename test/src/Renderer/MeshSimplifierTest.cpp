@@ -0,0 +1,124 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "Renderer/MeshSimplifier.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        using Vertex = MeshSimplifier::Vertex;
+
+        inline Vertex vertex(const float x, const float y, const float z) {
+            return Vertex(Vec3f(x, y, z), Vec2f(x, y));
+        }
+
+        TEST(MeshSimplifierTest, addFanAndStrip) {
+            MeshSimplifier::VertexList vertices;
+            for (size_t i = 0; i < 5; ++i)
+                vertices.push_back(vertex(static_cast<float>(i), 0.0f, 0.0f));
+
+            MeshSimplifier::VertexList fan;
+            MeshSimplifier::addPrimitive(fan, GL_TRIANGLE_FAN, vertices, 0, 5);
+            ASSERT_EQ(9u, fan.size());
+            ASSERT_EQ(vertices[0], fan[6]);
+            ASSERT_EQ(vertices[3], fan[7]);
+            ASSERT_EQ(vertices[4], fan[8]);
+
+            MeshSimplifier::VertexList strip;
+            MeshSimplifier::addPrimitive(strip, GL_TRIANGLE_STRIP, vertices, 1, 4);
+            ASSERT_EQ(6u, strip.size());
+            ASSERT_EQ(vertices[1], strip[0]);
+            ASSERT_EQ(vertices[2], strip[1]);
+            ASSERT_EQ(vertices[3], strip[2]);
+            ASSERT_EQ(vertices[3], strip[3]);
+            ASSERT_EQ(vertices[2], strip[4]);
+            ASSERT_EQ(vertices[4], strip[5]);
+
+            MeshSimplifier::VertexList lines;
+            MeshSimplifier::addPrimitive(lines, GL_LINES, vertices, 0, 4);
+            ASSERT_TRUE(lines.empty());
+        }
+
+        TEST(MeshSimplifierTest, simplifyDenseGrid) {
+            // a 16x16 grid of quads in the XY plane, with a spike in the center so that the mesh has a volume
+            const size_t n = 16;
+            MeshSimplifier::VertexList triangles;
+            for (size_t y = 0; y < n; ++y) {
+                for (size_t x = 0; x < n; ++x) {
+                    const float x0 = static_cast<float>(x), x1 = x0 + 1.0f;
+                    const float y0 = static_cast<float>(y), y1 = y0 + 1.0f;
+                    triangles.push_back(vertex(x0, y0, 0.0f));
+                    triangles.push_back(vertex(x0, y1, 0.0f));
+                    triangles.push_back(vertex(x1, y1, 0.0f));
+                    triangles.push_back(vertex(x0, y0, 0.0f));
+                    triangles.push_back(vertex(x1, y1, 0.0f));
+                    triangles.push_back(vertex(x1, y0, 0.0f));
+                }
+            }
+            triangles.push_back(vertex(7.0f, 7.0f, 0.0f));
+            triangles.push_back(vertex(8.0f, 8.0f, 16.0f));
+            triangles.push_back(vertex(9.0f, 7.0f, 0.0f));
+
+            MeshSimplifier::TexturedTriangles mesh;
+            mesh[nullptr] = triangles;
+
+            const MeshSimplifier::TexturedTriangles simplified = MeshSimplifier::simplify(mesh, 4);
+            ASSERT_EQ(1u, simplified.size());
+
+            const MeshSimplifier::VertexList& result = simplified.at(nullptr);
+            ASSERT_EQ(0u, result.size() % 3);
+            ASSERT_FALSE(result.empty());
+            ASSERT_LT(result.size(), triangles.size() / 8);
+        }
+
+        TEST(MeshSimplifierTest, boundingBox) {
+            MeshSimplifier::TexturedTriangles mesh;
+            MeshSimplifier::VertexList& triangles = mesh[nullptr];
+            triangles.push_back(vertex(-1.0f, -2.0f, -3.0f));
+            triangles.push_back(vertex( 1.0f,  2.0f, -3.0f));
+            triangles.push_back(vertex( 0.0f,  0.0f,  3.0f));
+
+            const MeshSimplifier::TexturedTriangles box = MeshSimplifier::boundingBox(mesh);
+            ASSERT_EQ(1u, box.size());
+
+            const MeshSimplifier::VertexList& result = box.at(nullptr);
+            ASSERT_EQ(36u, result.size());
+
+            for (size_t i = 0; i < result.size(); i += 3) {
+                const Vec3f& p0 = result[i + 0].v1;
+                const Vec3f& p1 = result[i + 1].v1;
+                const Vec3f& p2 = result[i + 2].v1;
+
+                // every corner is a corner of the bounds
+                for (const Vec3f& p : { p0, p1, p2 }) {
+                    ASSERT_FLOAT_EQ(1.0f, std::abs(p.x()));
+                    ASSERT_FLOAT_EQ(2.0f, std::abs(p.y()));
+                    ASSERT_FLOAT_EQ(3.0f, std::abs(p.z()));
+                }
+
+                // clockwise when viewed from outside means the normal points inwards
+                const Vec3f normal = crossed(p1 - p0, p2 - p0);
+                const Vec3f centroid = (p0 + p1 + p2) / 3.0f;
+                ASSERT_LT(normal.dot(centroid), 0.0f);
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Renderer/OcclusionBuffer.h"
+#include "Renderer/PerspectiveCamera.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        inline Vec3f::List wall(const float x, const float minY, const float maxY, const float minZ, const float maxZ) {
+            Vec3f::List vertices;
+            vertices.push_back(Vec3f(x, minY, minZ));
+            vertices.push_back(Vec3f(x, maxY, minZ));
+            vertices.push_back(Vec3f(x, maxY, maxZ));
+            vertices.push_back(Vec3f(x, minY, maxZ));
+            return vertices;
+        }
+
+        TEST(OcclusionBufferTest, emptyBufferOccludesNothing) {
+            const PerspectiveCamera camera(90.0f, 1.0f, 8192.0f, Camera::Viewport(0, 0, 800, 600), Vec3f::Null, Vec3f::PosX, Vec3f::PosZ);
+
+            OcclusionBuffer buffer;
+            buffer.reset(camera);
+            ASSERT_FALSE(buffer.occluded(BBox3f(Vec3f(200.0f, -10.0f, -10.0f), Vec3f(220.0f, 10.0f, 10.0f))));
+        }
+
+        TEST(OcclusionBufferTest, boxBehindWallIsOccluded) {
+            const PerspectiveCamera camera(90.0f, 1.0f, 8192.0f, Camera::Viewport(0, 0, 800, 600), Vec3f::Null, Vec3f::PosX, Vec3f::PosZ);
+
+            // a wall that covers the right half of the view
+            OcclusionBuffer buffer;
+            buffer.reset(camera);
+            buffer.addPolygon(wall(100.0f, -500.0f, 0.0f, -500.0f, 500.0f));
+
+            ASSERT_TRUE(buffer.occluded(BBox3f(Vec3f(200.0f, -30.0f, -10.0f), Vec3f(220.0f, -10.0f, 10.0f))));
+            ASSERT_TRUE(buffer.occluded(BBox3f(Vec3f(2000.0f, -300.0f, -100.0f), Vec3f(2200.0f, -100.0f, 100.0f))));
+
+            // in front of the wall, beside the wall, or overlapping its edge
+            ASSERT_FALSE(buffer.occluded(BBox3f(Vec3f(50.0f, -30.0f, -10.0f), Vec3f(70.0f, -10.0f, 10.0f))));
+            ASSERT_FALSE(buffer.occluded(BBox3f(Vec3f(200.0f, 10.0f, -10.0f), Vec3f(220.0f, 30.0f, 10.0f))));
+            ASSERT_FALSE(buffer.occluded(BBox3f(Vec3f(200.0f, -10.0f, -10.0f), Vec3f(220.0f, 10.0f, 10.0f))));
+
+            // the box that contains the wall itself
+            ASSERT_FALSE(buffer.occluded(BBox3f(Vec3f(100.0f, -500.0f, -500.0f), Vec3f(110.0f, 0.0f, 500.0f))));
+
+            // reaches in front of the near plane
+            ASSERT_FALSE(buffer.occluded(BBox3f(Vec3f(-10.0f, -30.0f, -10.0f), Vec3f(220.0f, -10.0f, 10.0f))));
+
+            buffer.reset(camera);
+            ASSERT_FALSE(buffer.occluded(BBox3f(Vec3f(200.0f, -30.0f, -10.0f), Vec3f(220.0f, -10.0f, 10.0f))));
+        }
+
+        TEST(OcclusionBufferTest, polygonsAreClippedAtNearPlane) {
+            const PerspectiveCamera camera(90.0f, 1.0f, 8192.0f, Camera::Viewport(0, 0, 800, 600), Vec3f::Null, Vec3f::PosX, Vec3f::PosZ);
+
+            // a floor below the camera that extends behind it
+            Vec3f::List floor;
+            floor.push_back(Vec3f(-1000.0f, -1000.0f, -8.0f));
+            floor.push_back(Vec3f(-1000.0f,  1000.0f, -8.0f));
+            floor.push_back(Vec3f( 1000.0f,  1000.0f, -8.0f));
+            floor.push_back(Vec3f( 1000.0f, -1000.0f, -8.0f));
+
+            OcclusionBuffer buffer;
+            buffer.reset(camera);
+            buffer.addPolygon(floor);
+
+            ASSERT_TRUE(buffer.occluded(BBox3f(Vec3f(200.0f, -10.0f, -64.0f), Vec3f(220.0f, 10.0f, -32.0f))));
+            ASSERT_FALSE(buffer.occluded(BBox3f(Vec3f(200.0f, -10.0f, -4.0f), Vec3f(220.0f, 10.0f, 16.0f))));
+        }
+    }
+}
@@ -78,8 +78,6 @@ namespace TrenchBroom {
             
             Vbo vbo(0xFFFF, GL_ARRAY_BUFFER);
             
-            unsigned char buffer[0xFFFF];
-            
             // activate for the first time
             EXPECT_CALL(glMock, GenBuffers(1,_)).WillOnce(SetArgumentPointee<1>(13));
             EXPECT_CALL(glMock, BindBuffer(GL_ARRAY_BUFFER, 13));
@@ -93,21 +91,18 @@ namespace TrenchBroom {
                 VboBlock* block2 = vbo.allocateBlock(646);
                 ASSERT_EQ(646u, block2->capacity());
                 
+                // the block does not fit into the remainder of the first arena, so a new arena is created
+                EXPECT_CALL(glMock, GenBuffers(1,_)).WillOnce(SetArgumentPointee<1>(14));
+                EXPECT_CALL(glMock, BindBuffer(GL_ARRAY_BUFFER, 14));
+                EXPECT_CALL(glMock, BufferData(GL_ARRAY_BUFFER, 0x10000, nullptr, GL_DYNAMIC_DRAW));
+
                 const size_t block3Capacity = 0xFFFF - block1->capacity() - block2->capacity();
                 VboBlock* block3 = vbo.allocateBlock(block3Capacity);
                 ASSERT_EQ(block3Capacity, block3->capacity());
+                ASSERT_EQ(0u, block3->offset());
+                ASSERT_EQ(2u, vbo.arenaCount());
                 
-                // buffer reallocation
-                EXPECT_CALL(glMock, MapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY)).WillOnce(Return(buffer));
-                EXPECT_CALL(glMock, UnmapBuffer(GL_ARRAY_BUFFER));
-                EXPECT_CALL(glMock, BindBuffer(GL_ARRAY_BUFFER, 0));
-                EXPECT_CALL(glMock, DeleteBuffers(1, Pointee(13)));
-                EXPECT_CALL(glMock, GenBuffers(1,_)).WillOnce(SetArgumentPointee<1>(14));
-                EXPECT_CALL(glMock, BindBuffer(GL_ARRAY_BUFFER, 14));
-                EXPECT_CALL(glMock, BufferData(GL_ARRAY_BUFFER, 0x17FFE, nullptr, GL_DYNAMIC_DRAW));
-                EXPECT_CALL(glMock, MapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY)).WillOnce(Return(buffer));
-                EXPECT_CALL(glMock, UnmapBuffer(GL_ARRAY_BUFFER));
-
+                // taken from the remainder of the first arena without reallocating
                 VboBlock* block4 = vbo.allocateBlock(373);
                 ASSERT_EQ(373u, block4->capacity());
 
@@ -116,6 +111,7 @@ namespace TrenchBroom {
             }
             
             // destroy vbo
+            EXPECT_CALL(glMock, DeleteBuffers(1, Pointee(13)));
             EXPECT_CALL(glMock, DeleteBuffers(1, Pointee(14)));
         }
 
@@ -175,6 +171,12 @@ namespace TrenchBroom {
                 // allocate and free a block
                 VboBlock* block = vbo.allocateBlock(300);
                 block->free();
+
+                // a block of the same size class reuses the freed block
+                VboBlock* other = vbo.allocateBlock(400);
+                ASSERT_EQ(block, other);
+                ASSERT_EQ(400u, other->capacity());
+                ASSERT_EQ(0u, other->offset());
                 
                 // deactivate by leaving block
                 EXPECT_CALL(glMock, BindBuffer(GL_ARRAY_BUFFER, 0));
@@ -183,5 +185,63 @@ namespace TrenchBroom {
             // destroy vbo
             EXPECT_CALL(glMock, DeleteBuffers(1, Pointee(13)));
         }
+
+        TEST(VboTest, streamBlocks) {
+            using namespace testing;
+            InSequence forceInSequenceMockCalls;
+
+            GLMock glMock;
+
+            Vbo vbo(0x1000, GL_ARRAY_BUFFER);
+
+            // activate for the first time
+            EXPECT_CALL(glMock, GenBuffers(1,_)).WillOnce(SetArgumentPointee<1>(13));
+            EXPECT_CALL(glMock, BindBuffer(GL_ARRAY_BUFFER, 13));
+            EXPECT_CALL(glMock, BufferData(GL_ARRAY_BUFFER, 0x1000, nullptr, GL_DYNAMIC_DRAW));
+            {
+                ActivateVbo activate(vbo);
+
+                // the ring buffer is created when it is used for the first time
+                EXPECT_CALL(glMock, GenBuffers(1,_)).WillOnce(SetArgumentPointee<1>(14));
+                EXPECT_CALL(glMock, BindBuffer(GL_ARRAY_BUFFER, 14));
+                EXPECT_CALL(glMock, BufferData(GL_ARRAY_BUFFER, 0x400, nullptr, GL_DYNAMIC_DRAW));
+                {
+                    StreamVboBlocks stream(vbo);
+
+                    VboBlock* block1 = vbo.allocateBlock(0x100);
+                    VboBlock* block2 = vbo.allocateBlock(0x200);
+                    ASSERT_EQ(0x000u, block1->offset());
+                    ASSERT_EQ(0x100u, block2->offset());
+
+                    // wraps around once the oldest block was freed
+                    block1->free();
+                    VboBlock* block3 = vbo.allocateBlock(0x100);
+                    VboBlock* block4 = vbo.allocateBlock(0x100);
+                    ASSERT_EQ(0x300u, block3->offset());
+                    ASSERT_EQ(0x000u, block4->offset());
+
+                    // the ring buffer is full, so the block is taken from the first arena
+                    VboBlock* block5 = vbo.allocateBlock(0x100);
+                    ASSERT_EQ(0x000u, block5->offset());
+                    ASSERT_EQ(0x1000u - 0x100u, vbo.freeCapacity());
+
+                    // blocks that outlive the frame are never streamed
+                    block2->free();
+                    {
+                        StreamVboBlocks persistent(vbo, false);
+                        VboBlock* block6 = vbo.allocateBlock(0x100);
+                        ASSERT_EQ(0x100u, block6->offset());
+                        ASSERT_EQ(0x1000u - 0x200u, vbo.freeCapacity());
+                    }
+                }
+
+                // deactivate buffer
+                EXPECT_CALL(glMock, BindBuffer(GL_ARRAY_BUFFER, 0));
+            }
+
+            // destroy vbo
+            EXPECT_CALL(glMock, DeleteBuffers(1, Pointee(13)));
+            EXPECT_CALL(glMock, DeleteBuffers(1, Pointee(14)));
+        }
     }
 }
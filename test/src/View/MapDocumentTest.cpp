@@ -298,6 +298,55 @@ namespace TrenchBroom {
             ASSERT_EQ(BBox3(Vec3(0, 0, 0), Vec3(64, 64, 64)), brush3->bounds());
         }
 
+        TEST_F(MapDocumentTest, csgSubtractOnlyReplacesTouchingBrushes) {
+            const Model::BrushBuilder builder(document->world(), document->worldBounds());
+            
+            Model::Entity* entity = new Model::Entity();
+            document->addNode(entity, document->currentParent());
+            
+            Model::Brush* touching = builder.createCuboid(BBox3(Vec3(0, 0, 0), Vec3(64, 64, 64)), "texture");
+            Model::Brush* distant = builder.createCuboid(BBox3(Vec3(256, 0, 0), Vec3(320, 64, 64)), "texture");
+            Model::Brush* subtrahend = builder.createCuboid(BBox3(Vec3(0, 0, 0), Vec3(64, 64, 32)), "texture");
+            document->addNode(touching, entity);
+            document->addNode(distant, entity);
+            document->addNode(subtrahend, entity);
+            ASSERT_EQ(3, entity->children().size());
+            
+            document->select(Model::NodeList { touching, distant, subtrahend });
+            ASSERT_TRUE(document->csgSubtract());
+            ASSERT_EQ(2, entity->children().size());
+            ASSERT_TRUE(VectorUtils::contains(entity->children(), distant));
+            ASSERT_FALSE(VectorUtils::contains(entity->children(), touching));
+            ASSERT_TRUE(distant->selected());
+            ASSERT_EQ(2u, document->selectedNodes().brushCount());
+            
+            document->undoLastCommand();
+            ASSERT_EQ(3, entity->children().size());
+            ASSERT_TRUE(VectorUtils::contains(entity->children(), touching));
+            ASSERT_TRUE(VectorUtils::contains(entity->children(), subtrahend));
+        }
+        
+        TEST_F(MapDocumentTest, csgIntersect) {
+            const Model::BrushBuilder builder(document->world(), document->worldBounds());
+            
+            Model::Entity* entity = new Model::Entity();
+            document->addNode(entity, document->currentParent());
+            
+            Model::Brush* brush1 = builder.createCuboid(BBox3(Vec3(0, 0, 0), Vec3(64, 64, 64)), "texture");
+            Model::Brush* brush2 = builder.createCuboid(BBox3(Vec3(32, 0, 0), Vec3(96, 64, 64)), "texture");
+            Model::Brush* brush3 = builder.createCuboid(BBox3(Vec3(0, 16, 0), Vec3(96, 64, 64)), "texture");
+            document->addNode(brush1, entity);
+            document->addNode(brush2, entity);
+            document->addNode(brush3, entity);
+            
+            document->select(Model::NodeList { brush1, brush2, brush3 });
+            ASSERT_TRUE(document->csgIntersect());
+            ASSERT_EQ(1u, document->selectedNodes().brushCount());
+            
+            const Model::Brush* result = document->selectedNodes().brushes().front();
+            ASSERT_EQ(BBox3(Vec3(32, 16, 0), Vec3(64, 64, 64)), result->bounds());
+        }
+
         TEST_F(MapDocumentTest, setTextureNull) {
             Model::BrushBuilder builder(document->world(), document->worldBounds());
             Model::Brush *brush1 = builder.createCube(64.0f, Model::BrushFace::NoTextureName);